@@ -0,0 +1,211 @@
+#include "arrival.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "load_generator.h"
+
+namespace {
+
+std::vector<std::string> splitList(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::istringstream in(text);
+    std::string part;
+    while (std::getline(in, part, separator)) parts.push_back(part);
+    return parts;
+}
+
+double parseFactor(const std::string& value, const std::string& spec) {
+    char* end = nullptr;
+    double factor = std::strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || !std::isfinite(factor) || factor < 0) {
+        throw std::runtime_error("Invalid rateProfile \"" + spec + "\": \"" + value + "\" is not a factor >= 0");
+    }
+    return factor;
+}
+
+double parseSeconds(const std::string& value) {
+    return parseDurationMs(value) / 1000.0;
+}
+
+void addSegment(std::vector<RateSegment>& segments, double startSec, double endSec, double startRate, double endRate) {
+    if (endSec <= startSec) return;
+    RateSegment segment;
+    segment.startSec = startSec;
+    segment.endSec = endSec;
+    segment.startRate = startRate;
+    segment.endRate = endRate;
+    segments.push_back(segment);
+}
+
+// Per-second values, as exported from access logs: "<rps>" or "<second>,<rps>" per
+// line; blank lines and lines starting with '#' are skipped.
+std::vector<double> readTrace(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot read rate trace " + path);
+    std::vector<double> values;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        size_t separator = line.find_last_of(",\t ");
+        std::string value = separator == std::string::npos ? line : line.substr(separator + 1);
+        char* end = nullptr;
+        double rps = std::strtod(value.c_str(), &end);
+        if (value.empty() || *end != '\0' || !std::isfinite(rps) || rps < 0) {
+            throw std::runtime_error("Rate trace " + path + " line " + std::to_string(lineNumber) + ": not a req/s value");
+        }
+        values.push_back(rps);
+    }
+    if (values.empty()) throw std::runtime_error("Rate trace " + path + " has no values");
+    return values;
+}
+
+}  // namespace
+
+std::vector<RateSegment> buildRateProfile(const std::string& spec, double rate, double durationSec) {
+    std::vector<RateSegment> segments;
+    size_t colon = spec.find(':');
+    std::string kind = spec.substr(0, colon);
+    std::string args = colon == std::string::npos ? "" : spec.substr(colon + 1);
+
+    if (spec.empty()) {
+        addSegment(segments, 0.0, 1.0, rate, rate);
+    } else if (kind == "steps") {
+        std::vector<std::pair<double, double>> steps;
+        for (const auto& step : splitList(args, ',')) {
+            size_t equals = step.find('=');
+            if (equals == std::string::npos) {
+                throw std::runtime_error("Invalid rateProfile \"" + spec + "\": steps are <time>=<factor>");
+            }
+            steps.emplace_back(parseSeconds(step.substr(0, equals)), parseFactor(step.substr(equals + 1), spec));
+        }
+        if (steps.empty()) throw std::runtime_error("Invalid rateProfile \"" + spec + "\": no steps");
+        for (size_t i = 1; i < steps.size(); i++) {
+            if (steps[i].first <= steps[i - 1].first) {
+                throw std::runtime_error("Invalid rateProfile \"" + spec + "\": step times must increase");
+            }
+        }
+        // The first factor also covers the time before its step.
+        double start = 0.0;
+        for (size_t i = 0; i < steps.size(); i++) {
+            double end = i + 1 < steps.size() ? steps[i + 1].first : std::max(start, steps[i].first) + 1.0;
+            addSegment(segments, start, end, rate * steps[i].second, rate * steps[i].second);
+            start = end;
+        }
+    } else if (kind == "ramp") {
+        auto parts = splitList(args, ',');
+        if (parts.size() != 2 && parts.size() != 3) {
+            throw std::runtime_error("Invalid rateProfile \"" + spec + "\": ramp is <from>,<to>[,<time>]");
+        }
+        double over = parts.size() == 3 ? parseSeconds(parts[2]) : durationSec;
+        double from = rate * parseFactor(parts[0], spec), to = rate * parseFactor(parts[1], spec);
+        addSegment(segments, 0.0, std::max(over, 1e-3), from, to);
+    } else if (kind == "burst") {
+        auto parts = splitList(args, ',');
+        if (parts.size() != 4) {
+            throw std::runtime_error("Invalid rateProfile \"" + spec + "\": burst is <period>,<duty>,<high>,<low>");
+        }
+        double period = parseSeconds(parts[0]);
+        double duty = parseFactor(parts[1], spec);
+        double high = rate * parseFactor(parts[2], spec), low = rate * parseFactor(parts[3], spec);
+        if (period <= 0 || duty > 1) {
+            throw std::runtime_error("Invalid rateProfile \"" + spec + "\": burst needs a period > 0 and a duty in [0, 1]");
+        }
+        // Spelled out past the end of the run, so a late deadline still sees the wave.
+        for (double start = 0.0; start < durationSec + period; start += period) {
+            addSegment(segments, start, start + period * duty, high, high);
+            addSegment(segments, start + period * duty, start + period, low, low);
+        }
+    } else if (kind == "trace") {
+        std::vector<double> values = readTrace(args);
+        double mean = 0.0;
+        for (double value : values) mean += value / values.size();
+        if (mean <= 0) throw std::runtime_error("Rate trace " + args + " is all zeros");
+        for (size_t i = 0; i < values.size(); i++) {
+            addSegment(segments, static_cast<double>(i), i + 1.0, rate * values[i] / mean, rate * values[i] / mean);
+        }
+    } else {
+        throw std::runtime_error("rateProfile must start with steps:, ramp:, burst: or trace:, got \"" + spec + "\"");
+    }
+    return segments;
+}
+
+std::string portableRateProfile(const std::string& spec) {
+    if (spec.rfind("trace:", 0) != 0) {
+        std::string word = spec;
+        word.erase(std::remove_if(word.begin(), word.end(), [](unsigned char c) { return std::isspace(c); }), word.end());
+        return word;
+    }
+    std::ostringstream steps;
+    steps << "steps:" << std::setprecision(10);
+    const char* separator = "";
+    for (const auto& segment : buildRateProfile(spec, 1.0, 0.0)) {
+        steps << separator << segment.startSec << "s=" << segment.startRate;
+        separator = ",";
+    }
+    return steps.str();
+}
+
+bool isPoissonArrival(const std::string& process) {
+    if (process == "uniform") return false;
+    if (process == "poisson") return true;
+    throw std::runtime_error("arrivalProcess must be \"uniform\" or \"poisson\", got \"" + process + "\"");
+}
+
+ArrivalSchedule::ArrivalSchedule(const std::vector<RateSegment>& profile, double share, bool poisson, uint64_t seed)
+    : segments(profile), poisson(poisson), rng(seed) {
+    for (auto& segment : segments) {
+        segment.startRate *= share;
+        segment.endRate *= share;
+    }
+    RateSegment hold;
+    hold.startSec = segments.empty() ? 0.0 : segments.back().endSec;
+    hold.endSec = std::numeric_limits<double>::infinity();
+    hold.startRate = hold.endRate = segments.empty() ? 0.0 : segments.back().endRate;
+    segments.push_back(hold);
+    // A uniform schedule sends its first request right away, a Poisson one after the first draw.
+    target = poisson ? exponential() : 0.0;
+}
+
+double ArrivalSchedule::exponential() {
+    // splitmix64
+    uint64_t z = (rng += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    double uniform = (z >> 11) * 0x1.0p-53;  // [0, 1)
+    return -std::log1p(-uniform);
+}
+
+uint64_t ArrivalSchedule::next() {
+    for (; segment < segments.size(); segment++) {
+        const RateSegment& s = segments[segment];
+        bool last = std::isinf(s.endSec);
+        double length = s.endSec - s.startSec;
+        double expected = last ? (s.startRate > 0 ? std::numeric_limits<double>::infinity() : 0.0)
+                               : (s.startRate + s.endRate) / 2 * length;
+        double remaining = target - segmentArrivals;
+        if (remaining < expected) {
+            // Solve startRate * t + slope * t^2 / 2 = remaining for t, in a form that
+            // stays exact when the slope is zero.
+            double slope = last ? 0.0 : (s.endRate - s.startRate) / length;
+            double root = std::sqrt(std::max(s.startRate * s.startRate + 2 * slope * remaining, 0.0));
+            double offset = remaining > 0 ? 2 * remaining / (s.startRate + root) : 0.0;
+            double dueSec = s.startSec + std::min(offset, last ? offset : length);
+            target += poisson ? exponential() : 1.0;
+            return static_cast<uint64_t>(std::llround(dueSec * 1e9));
+        }
+        segmentArrivals += expected;
+    }
+    return UINT64_MAX;
+}
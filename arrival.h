@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Open-loop arrivals: when each request of a paced run is due. A rate profile
+// shapes the target rate over the run, in multiples of the configured rate:
+//
+//   ""                         constant
+//   "steps:0s=1,30s=3,60s=1"   the factor from each time on
+//   "ramp:0.1,2"               linear from the first factor to the second over the run
+//   "ramp:0.1,2,60s"           ... over 60s, then held
+//   "burst:10s,0.2,4,0.5"      square wave: period, fraction of it at the high factor, high, low
+//   "trace:rps.txt"            one req/s value per second (a line is "<rps>" or "<second>,<rps>"),
+//                              scaled so that its mean is the configured rate
+//
+// Past the end of a profile its last rate holds. Requests are spaced evenly along
+// the profile ("uniform") or drawn as a Poisson process following it ("poisson").
+
+struct RateSegment {
+    double startSec = 0.0;
+    double endSec = 0.0;
+    double startRate = 0.0;  // req/s, linear in between
+    double endRate = 0.0;
+};
+
+// Throws std::runtime_error for a malformed profile or an unreadable trace.
+std::vector<RateSegment> buildRateProfile(const std::string& spec, double rate, double durationSec);
+
+// The same profile as one word that needs no files: a trace becomes the equivalent
+// steps and spaces are dropped, for the agents' RUN line.
+std::string portableRateProfile(const std::string& spec);
+
+// Throws std::runtime_error unless `process` is "uniform" or "poisson".
+bool isPoissonArrival(const std::string& process);
+
+// One worker's arrivals: the profile scaled by `share`, the worker's part of the
+// rate. The k-th request is due where the expected number of arrivals so far (the
+// integral of the rate) reaches k, or, for Poisson, a sum of k exponential draws.
+class ArrivalSchedule {
+public:
+    ArrivalSchedule(const std::vector<RateSegment>& profile, double share, bool poisson, uint64_t seed);
+
+    // Offset from the start of the run, in ns, at which the next request is due;
+    // UINT64_MAX once the rate stays at zero.
+    uint64_t next();
+
+private:
+    double exponential();
+
+    std::vector<RateSegment> segments;  // the last one runs forever
+    bool poisson;
+    uint64_t rng;
+    size_t segment = 0;
+    double segmentArrivals = 0.0;  // expected arrivals before the current segment
+    double target = 0.0;           // expected arrivals at which the next request is due
+};
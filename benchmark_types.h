@@ -0,0 +1,384 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "hdr_histogram.h"
+
+struct BenchmarkConfig {
+    int connections = 100;
+    std::vector<int> connectionCounts;     // matrix axis: each setup runs at every count; empty = connections
+    int threads = 12;
+    std::string duration = "30s";
+    std::string timeout = "10s";
+    int warmupTime = 3000;                 // fixed pre-run sleep when adaptiveWarmup is off
+    int cooldownTime = 2000;
+    int runs = 3;
+    bool latencyStats = true;
+    std::string loadGenerator = "native";  // "native" (built-in epoll client) or "wrk"
+    double rate = 0;                       // target requests/sec (wrk2 -R); 0 = closed loop as fast as possible
+    std::string rateProfile;               // shape of the target rate over a run (see arrival.h); empty = constant
+    std::string arrivalProcess = "uniform";  // paced requests evenly spaced ("uniform") or as a Poisson process
+    unsigned arrivalSeed = 1;              // Poisson draws; the same seed gives every setup the same arrivals
+    std::vector<double> offeredLoads;      // extra constant-rate levels for the latency-vs-offered-load table
+    bool saturationSearch = false;         // search for the max rate that meets the SLO below
+    double sloP99Ms = 10.0;
+    double maxErrorRate = 0.001;           // fraction of requests
+    double searchStartRate = 1000;
+    int searchIterations = 6;              // bisection steps after the doubling phase
+    std::string searchDuration = "10s";    // length of each search probe
+    int parallelSlots = 1;                 // >1 runs setups concurrently in CPU-pinned slots
+    int portStride = 100;                  // port shift between slots
+    std::vector<std::string> agents;       // "host:port" load-generator agents (or "local"); empty = generate here
+    std::string targetHost = "localhost";  // address agents use to reach the servers started on this host
+    int timelineIntervalMs = 1000;         // per-run NDJSON timeline bucket (native generator); 0 = off
+    std::string timelineDir = "timelines";
+    std::string sampleArchiveDir;          // per-request binary archives of measured native runs and soaks; empty = off
+    double steadyStateTolerance = 0.10;    // warmup ends once throughput is within this fraction of steady state
+    bool adaptiveWarmup = true;            // warm up under real load until throughput and P99 settle
+    int warmupMaxTime = 30000;             // ms cap on adaptive warmup
+    int warmupWindowMs = 500;
+    int warmupWindows = 6;                 // rolling windows the CoV is computed over
+    double warmupCovThreshold = 0.05;      // req/s coefficient of variation
+    double warmupP99CovThreshold = 0.20;   // P99 coefficient of variation
+    int resourceSampleMs = 100;            // server /proc sampling interval during measurement; 0 = off
+    std::vector<std::string> scenarios = {"hello"};  // workloads each setup is run under (see scenarios.h)
+    std::vector<int> serverWorkers = {1};  // server processes per setup; 0 expands to 1, 2, 4, ... up to the CPU count
+    std::string workerMode = "reuseport";  // "reuseport" (N processes on one SO_REUSEPORT port) or "cluster" (node:cluster)
+    std::string transport = "http1";       // "http1", "http1-close", "https", "https-close" or "h2" (see README)
+    std::vector<std::string> transports;   // matrix axis: each setup runs over every transport; empty = transport
+    int h2Streams = 10;                    // concurrent streams per connection with transport "h2"
+    bool tlsSessionResumption = true;      // offer the previous TLS session when a connection is reopened
+    std::string tlsCertFile;               // server certificate and key (PEM); empty = generate a self-signed pair
+    std::string tlsKeyFile;
+    std::string resultsStore = "results/history.ndjson";  // append-only run history (results_store.h); empty = off
+    std::string compareBaseline;           // after the run, compare with "previous" or a commit prefix from the store
+    double regressionAlpha = 0.05;         // Welch's t-test significance level
+    double regressionThreshold = 0.02;     // smallest relative change that counts as a regression
+    double confidenceLevel = 0.95;         // confidence intervals of the per-run means in the report
+    std::string schedule = "sequential";   // run order across setups: "sequential", "round-robin" or "random"
+    unsigned scheduleSeed = 0;             // seed for "random"; 0 = pick one (printed and saved with the results)
+    int calibrationMs = 0;                 // fixed host-speed workload before each run to correct for drift; 0 = off
+    int harnessCheckMs = 2000;             // closed-loop run against a built-in echo server at startup; 0 = off
+    double clientCpuLimit = 0.90;          // a run is client-bound when its busiest generator thread uses this CPU share,
+    double clientLagLimitMs = 2.0;         // sends paced requests this late at P99,
+    double clientCeilingShare = 0.80;      // or reaches this fraction of the harness ceiling
+    std::string restartPolicy = "per-run"; // "per-run" (fresh server per run), "per-setup" (one server, N windows) or "both"
+    int coldStarts = 0;                    // cold-start suite: spawns per setup (e.g. 50); 0 = off
+    bool coldStartSteady = true;           // also load each spawn until throughput settles (adaptive warmup criteria)
+    int metricsPort = 0;                   // serve live Prometheus/OpenMetrics metrics on :<port>/metrics; 0 = off
+    bool liveView = false;                 // print a live status line on stderr each second of a measured run
+    std::string soakDuration;              // soak mode: one run this long per setup (e.g. "2h") after the regular runs; empty = off
+    int soakWindowSec = 60;                // soak time-series window
+    double soakRssGrowthLimit = 0.10;      // flag a significant fitted RSS growth above this fraction per hour
+    double soakP99GrowthLimit = 0.20;      // flag a significant fitted P99 growth above this fraction per hour
+    std::string networkProfile;            // sysctl profile applied for the run: "throughput" or "low-latency"; empty = record only
+    std::string networkMode = "loopback";  // "loopback" or "netns" (servers in a network namespace behind a veth pair)
+    double netemDelayMs = 0;               // round-trip delay netem adds on the veth pair in "netns" mode
+    std::string serverAddress;             // address the load generator connects to; empty = localhost, or the namespace in "netns" mode
+    std::string profileMode;               // extra profiled window per setup after its measured runs: "perf" or "cpu-prof"; empty = off
+    std::string profileDuration = "10s";   // length of the profiled window
+    std::string profileDir = "profiles";   // collapsed stacks, flamegraphs and raw profiles
+    int perfFrequency = 99;                // perf record sampling rate (Hz)
+    int instrumentIntervalMs = 0;          // event-loop/GC reports from the servers (server_instrumentation.js); 0 = off
+    std::string instrumentDir = "/dev/shm"; // where the servers' ring files are created
+};
+
+// Summary of the stable part of a run's timeline (warmup and trailing partial bucket trimmed).
+struct SteadyState {
+    bool valid = false;
+    double startSec = 0.0;
+    double endSec = 0.0;
+    int buckets = 0;
+    double requestsPerSecond = 0.0;
+    double p50Latency = 0.0;
+    double p90Latency = 0.0;
+    double p99Latency = 0.0;
+    double p999Latency = 0.0;
+    double maxLatency = 0.0;
+    int errors = 0;
+    HdrHistogram latencyHistogram;
+};
+
+// Server process resource use over a measured window (deltas for counters).
+struct ProcessStats {
+    bool valid = false;
+    int samples = 0;
+    double wallSec = 0.0;
+    double cpuUserSec = 0.0;
+    double cpuSysSec = 0.0;
+    double cpuCores = 0.0;  // (user + sys) / wall
+    double avgRssKb = 0.0;
+    long maxRssKb = 0;
+    long hwmSumKb = 0;      // VmHWM summed over the group's processes; not a group peak
+    long voluntarySwitches = 0;
+    long involuntarySwitches = 0;
+    int maxThreads = 0;
+    double requestsPerCpuSecond = 0.0;
+    double rssBytesPerConnection = 0.0;  // max RSS during the window / connections
+};
+
+// Event-loop and GC behaviour the servers report about themselves while a run is
+// measured (server_instrumentation.js). Loop delays are how late the event loop
+// got to a 10ms timer. A client P99 spike is a timeline bucket whose P99 is more
+// than twice the run's median bucket P99; it is put down to a GC pause or a loop
+// stall when one overlapping it lasted at least half of the excess latency.
+struct ServerRuntimeStats {
+    bool valid = false;
+    int processes = 0;             // server processes that reported
+    int samples = 0;               // intervals read
+    std::string runtime;           // "node 22.3.0", as the server saw itself
+    bool gcObserved = false;       // false when the runtime exposes no GC events
+    double loopDelayMeanMs = 0.0;
+    double loopDelayP99Ms = 0.0;   // highest per-interval P99
+    double loopDelayMaxMs = 0.0;
+    double loopUtilization = 0.0;  // mean event-loop utilization, 0-1
+    long gcCount = 0;
+    double gcPauseMs = 0.0;        // summed over processes
+    double gcMaxPauseMs = 0.0;
+    double gcPauseShare = 0.0;     // pause time / (window x processes)
+    int maxActiveHandles = 0;
+    double maxHeapUsedMb = 0.0;
+    int p99Spikes = 0;
+    int spikesWithGc = 0;
+    int spikesWithLoopStall = 0;   // stalls other than GC
+};
+
+// Client latency of one timeline bucket, on the CLOCK_MONOTONIC time base the servers report in.
+struct LatencyBucket {
+    double startSec = 0.0;
+    double endSec = 0.0;
+    double p99Latency = 0.0;
+};
+
+// Connection setup cost over a run (native generator): connections opened,
+// reconnects included, and the time from connect() until each could send a
+// request (TCP handshake, plus the TLS handshake when enabled).
+struct ConnectionStats {
+    bool valid = false;
+    int opened = 0;
+    int tlsHandshakes = 0;
+    int tlsResumed = 0;  // handshakes that resumed an earlier session
+    double avgSetupMs = 0.0;
+    double p50SetupMs = 0.0;
+    double p99SetupMs = 0.0;
+    double maxSetupMs = 0.0;
+    HdrHistogram setupLatency;  // microseconds; merged across runs and agents for the percentiles above
+};
+
+struct PhaseLatency {
+    double avgMs = 0.0;
+    double p50Ms = 0.0;
+    double p90Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    HdrHistogram latency;  // microseconds; merged across runs for the percentiles above
+};
+
+// Where HTTP/1.1 request latency went (native generator). The phases of a request
+// add up to its latency: `wait` until its first byte is written (schedule lag at a
+// constant rate, plus the connection setup with a new connection per request),
+// `write` until its last byte is, `firstByte` until the response starts arriving
+// (server processing and queueing), and `transfer` until the response is complete.
+struct LatencyPhases {
+    bool valid = false;
+    int requests = 0;  // requests that were timed
+    PhaseLatency wait;
+    PhaseLatency write;
+    PhaseLatency firstByte;
+    PhaseLatency transfer;
+};
+
+// How hard the native load generator itself worked during a run, to tell a
+// server-bound result from a client-bound one. Send lag only counts paced requests
+// whose connection was free by their due time, so any lateness is the client's own.
+struct ClientLoad {
+    bool valid = false;
+    int threads = 0;
+    double cpuCores = 0.0;       // generator threads' CPU time / wall time
+    double busiestThread = 0.0;  // CPU share of the busiest event-loop thread
+    long pacedSends = 0;         // paced requests with a free connection in time
+    long lateSends = 0;          // ... sent more than 1ms after their due time
+    int backlogPeak = 0;         // most such late requests one thread released at once
+    double sendLagP99Ms = 0.0;
+    double sendLagMaxMs = 0.0;
+    bool clientBound = false;    // a threshold was crossed (clientCpuLimit, clientLagLimitMs, clientCeilingShare)
+    std::string reason;          // the first one, e.g. "busiest thread 97% CPU"
+};
+
+// What the native generator manages against the built-in echo server at startup
+// (closed loop, HTTP/1.1): the most any setup can be measured at on this host.
+struct HarnessCeiling {
+    bool valid = false;
+    double requestsPerSecond = 0.0;
+    double p99Latency = 0.0;
+    int connections = 0;
+    int threads = 0;
+    double busiestThread = 0.0;  // under clientCpuLimit: the echo server or the host set the ceiling, not the client
+};
+
+struct WarmupOutcome {
+    int ms = 0;              // warmup actually spent before the measured window
+    bool converged = false;  // adaptive warmup reached its CoV thresholds before warmupMaxTime
+    int settledFromMs = 0;   // when converged: start of the first window in the settled run, from the start of load
+};
+
+// How long a freshly spawned server took to come up, from fork/exec.
+struct StartupTiming {
+    bool valid = false;                   // measured: the run started its own server
+    double listenMs = 0.0;                // until the port accepted a TCP connection
+    double firstResponseMs = 0.0;         // until the first successful response arrived
+    double firstResponseLatencyMs = 0.0;  // round trip of that first request
+};
+
+// Per-route share of a multi-route scenario run (native generator only).
+struct RouteResult {
+    std::string name;
+    std::string method;
+    std::string path;
+    int requests = 0;
+    int errors = 0;  // non-2xx/3xx responses and timeouts on this route
+    double requestsPerSecond = 0.0;
+    double avgLatency = 0.0;
+    double p50Latency = 0.0;
+    double p90Latency = 0.0;
+    double p99Latency = 0.0;
+    double p999Latency = 0.0;
+    double maxLatency = 0.0;
+    HdrHistogram latencyHistogram;
+};
+
+struct BenchmarkResult {
+    double requestsPerSecond = 0.0;
+    double avgLatency = 0.0;
+    double maxLatency = 0.0;
+    double p50Latency = 0.0;
+    double p75Latency = 0.0;
+    double p90Latency = 0.0;
+    double p99Latency = 0.0;
+    double p999Latency = 0.0;
+    double p9999Latency = 0.0;
+    double throughput = 0.0;
+    int totalRequests = 0;
+    int errors = 0;
+    int timeouts = 0;
+    int socketErrors = 0;
+    HdrHistogram latencyHistogram;  // microseconds; empty when the backend only reports summary percentiles
+    std::string timelineFile;       // NDJSON timeline written during the run, if any
+    std::string sampleFile;         // per-request binary archive (sample_archive.h), if any
+    SteadyState steadyState;
+    int warmupMs = 0;
+    bool warmupConverged = false;
+    StartupTiming startup;
+    ProcessStats serverResources;
+    ServerRuntimeStats serverRuntime;
+    std::vector<LatencyBucket> latencyBuckets;  // native runs with a timeline
+    ConnectionStats connectionSetup;
+    LatencyPhases latencyPhases;
+    ClientLoad client;
+    std::vector<RouteResult> routes;  // empty for single-route scenarios
+    int sequence = 0;          // position in the run schedule, from 1
+    double startedAt = 0.0;    // wall clock when the run started, Unix seconds
+    double hostSpeed = 0.0;    // calibration score just before the run; 0 = not calibrated
+    double driftFactor = 1.0;  // median host speed / hostSpeed
+    double connectRttMs = 0.0; // median TCP connect time to the server just before the run
+    std::string rawOutput;
+};
+
+// One row of the latency-vs-offered-load table (constant-rate runs).
+struct LoadPoint {
+    double offeredRps = 0.0;
+    double achievedRps = 0.0;
+    double p50Latency = 0.0;
+    double p90Latency = 0.0;
+    double p99Latency = 0.0;
+    double p999Latency = 0.0;
+    double maxLatency = 0.0;
+    int errors = 0;
+    double errorRate = 0.0;
+    bool withinSlo = false;
+};
+
+struct SaturationResult {
+    double sloP99Ms = 0.0;
+    double maxErrorRate = 0.0;
+    double maxRpsAtSlo = 0.0;  // highest achieved rate among probes that met the SLO
+    double offeredAtMax = 0.0;
+    double p99AtMax = 0.0;
+    std::vector<LoadPoint> curve;  // every probe, sorted by offered load
+};
+
+// How the load reached the server.
+struct NetworkPath {
+    std::string mode = "loopback";
+    std::string profile;        // empty = host sysctls left as found
+    std::string serverAddress;
+    double netemDelayMs = 0.0;
+    double connectRttMs = 0.0;  // mean over runs of the per-run median connect time
+};
+
+struct Setup {
+    std::string name;
+    int port;
+    std::string runtime;
+    std::string framework;
+    std::string script;
+    int workers = 1;
+    std::string restart = "per-run";  // "per-run" or "per-setup"
+    int connections = 0;              // set from the matrix when the run plan is expanded
+    std::string transport = "";
+    std::string binary = "";                     // runtime executable; empty = `runtime` from PATH
+    std::vector<std::string> runtimeArgs = {};   // before the script, e.g. "--max-old-space-size=4096"
+    std::vector<std::string> runtimeEnv = {};    // "KEY=value" for the server, e.g. "BUN_JSC_useJIT=0"
+    std::string version = "";                    // `<executable> --version`, filled in before the runs
+};
+
+struct AggregatedResult {
+    std::string environment;
+    std::string runtime;
+    std::string framework;
+    std::string scenario;
+    int workers = 1;
+    std::string restart = "per-run";
+    int connections = 0;
+    std::string transport;
+    std::string runtimeBinary;  // executable the server ran under
+    std::string runtimeVersion;
+    std::vector<std::string> runtimeArgs;
+    std::vector<std::string> runtimeEnv;
+    double scalingEfficiency = 0.0;  // RPS / (workers x 1-worker RPS of the same setup); 0 without a baseline
+    int slot = 0;  // CpuSlot index the setup ran in
+    double requestsPerSecond;
+    double avgLatency;
+    double maxLatency;
+    double p50Latency;
+    double p90Latency;
+    double p99Latency;
+    double p999Latency;
+    double p9999Latency;
+    bool mergedPercentiles;  // percentiles come from the merged histogram rather than a mean of per-run values
+    HdrHistogram latencyHistogram;
+    double throughput;
+    int totalRequests;
+    int errors;
+    int timeouts;
+    double stdRps;
+    double stdLatency;
+    double rpsCiLow = 0.0;   // confidence interval of the mean req/sec at confidenceLevel
+    double rpsCiHigh = 0.0;
+    int runs;
+    std::vector<BenchmarkResult> rawRuns;
+    std::vector<LoadPoint> loadCurve;
+    SaturationResult saturation;
+    SteadyState steadyState;  // mean steady rate across runs; percentiles from the merged steady histograms
+    ProcessStats serverResources;  // per-run means; RSS and threads are maxima
+    ServerRuntimeStats serverRuntime;  // per-run means; maxima stay maxima and spikes are summed
+    ConnectionStats connectionSetup;  // counts are per-run means; setup times come from the merged histogram
+    LatencyPhases latencyPhases;      // percentiles of the merged phase histograms; means weighted by requests
+    ClientLoad client;                // per-run means; peaks and lag are maxima, clientBound if any run was
+    int clientBoundRuns = 0;
+    StartupTiming startup;            // per-run means over runs that started a server
+    std::vector<RouteResult> routes;  // merged across runs
+    double driftCorrectedRps = 0.0;   // mean of per-run req/sec x driftFactor; 0 without calibration
+    NetworkPath network;
+};
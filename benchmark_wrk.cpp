@@ -4,78 +4,101 @@
 #include <map>
 #include <sstream>
 #include <fstream>
-#include <regex>
 #include <chrono>
 #include <thread>
 #include <cstdlib>
 #include <signal.h>
 #include <sys/wait.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
 #include <unistd.h>
 #include <cmath>
 #include <iomanip>
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <mutex>
+#include <cctype>
+#include <filesystem>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <set>
 #include <curl/curl.h>
 
-struct BenchmarkConfig {
-    int connections = 100;
-    int threads = 12;
-    std::string duration = "30s";
-    std::string timeout = "10s";
-    int warmupTime = 3000;
-    int cooldownTime = 2000;
-    int runs = 3;
-    bool latencyStats = true;
-};
-
-struct BenchmarkResult {
-    double requestsPerSecond = 0.0;
-    double avgLatency = 0.0;
-    double maxLatency = 0.0;
-    double p50Latency = 0.0;
-    double p75Latency = 0.0;
-    double p90Latency = 0.0;
-    double p99Latency = 0.0;
-    double throughput = 0.0;
-    int totalRequests = 0;
-    int errors = 0;
-    int timeouts = 0;
-    int socketErrors = 0;
-    std::string rawOutput;
-};
-
-struct Setup {
-    std::string name;
-    int port;
-    std::string runtime;
-    std::string framework;
-    std::string script;
-};
-
-struct AggregatedResult {
-    std::string environment;
-    std::string runtime;
-    std::string framework;
-    double requestsPerSecond;
-    double avgLatency;
-    double p50Latency;
-    double p90Latency;
-    double p99Latency;
-    double throughput;
-    int totalRequests;
-    int errors;
-    int timeouts;
-    double stdRps;
-    double stdLatency;
-    int runs;
-    std::vector<BenchmarkResult> rawRuns;
-};
+#include "arrival.h"
+#include "benchmark_types.h"
+#include "calibration.h"
+#include "cold_start.h"
+#include "cpu_topology.h"
+#include "distributed.h"
+#include "echo_server.h"
+#include "host_network.h"
+#include "interrupt.h"
+#include "json_value.h"
+#include "live_metrics.h"
+#include "load_generator.h"
+#include "matrix_config.h"
+#include "process_sampler.h"
+#include "profiler.h"
+#include "readiness.h"
+#include "report.h"
+#include "results_store.h"
+#include "sample_archive.h"
+#include "scenarios.h"
+#include "server_instrumentation.h"
+#include "soak.h"
+#include "timeline.h"
+#include "tls_cert.h"
+#include "wrk_parser.h"
 
 class BenchmarkOrchestrator {
 private:
     BenchmarkConfig config;
     std::vector<Setup> setups;
+    std::vector<Scenario> scenarios;
     std::vector<AggregatedResult> results;
+    std::vector<ColdStartResult> coldStartResults;
+    std::vector<SoakResult> soakResults;
+    std::vector<ProfileResult> profileResults;
+    LiveMetrics liveMetrics;
+    std::unique_ptr<MetricsServer> metricsServer;
+    std::mutex liveViewMutex;
+    std::mutex resultsMutex;
+    CpuTopology topology;
+    std::vector<CpuSlot> slots;
+    // One setup/scenario pair of the expanded matrix, after --filter and --resume.
+    struct Cell {
+        Setup setup;
+        const Scenario* scenario;
+    };
+    std::vector<Cell> plan;
+    std::vector<std::string> filters;
+    bool resume = false;
+    bool planOnly = false;
+    StoredResult runIdentity;                // commit, host and versions of this invocation
+    std::vector<StoredResult> priorHistory;  // the results store as it was before this invocation
+    std::vector<StoredResult> storedRecords; // appended by this invocation, one per finished cell
+    std::string tlsCertPath;
+    std::string tlsKeyPath;
+    std::string nodeVersion;
+    std::string bunVersion;
+    int regressions = 0;
+    std::atomic<int> runSequence{0};
+    unsigned scheduleSeed = 0;
+    double medianHostSpeed = 0.0;
+    HarnessCeiling harnessCeiling;
+    double minHostSpeed = 0.0;
+    double maxHostSpeed = 0.0;
+    std::string serverHost = "localhost";    // where the servers are reached from this host
+    std::vector<SysctlValue> hostSysctls;    // in effect during the runs
+    std::vector<SysctlValue> serverSysctls;  // inside the namespace in "netns" mode
+    std::vector<SysctlValue> changedSysctls; // previous values of what the profile changed
+    std::unique_ptr<NetworkNamespace> networkNamespace;
+    // Server groups started and not yet stopped, for the destructor when a run is interrupted.
+    std::mutex serversMutex;
+    std::set<pid_t> liveServers;
     
     static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
         (void)contents;  // Suppress unused parameter warning
@@ -83,15 +106,23 @@ private:
         return size * nmemb;
     }
     
-    bool checkServerHealth(int port) {
+    // One GET against the server; `latencyMs` receives the round trip when it succeeds.
+    bool checkServerHealth(int port, const TransportMode& transport, double* latencyMs = nullptr) {
         CURL* curl;
         CURLcode res;
         bool healthy = false;
         
         curl = curl_easy_init();
         if(curl) {
-            std::string url = "http://localhost:" + std::to_string(port);
+            std::string url = serverUrl(serverHost, port, transport.tls);
             curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            if (transport.tls) {
+                curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);  // self-signed
+                curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+            }
+            if (transport.h2) {
+                curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+            }
             curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
             curl_easy_setopt(curl, CURLOPT_TIMEOUT, 1L);
             curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 1L);
@@ -101,6 +132,10 @@ private:
             res = curl_easy_perform(curl);
             if(res == CURLE_OK) {
                 healthy = true;
+                double seconds = 0;
+                if (latencyMs && curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &seconds) == CURLE_OK) {
+                    *latencyMs = seconds * 1000.0;
+                }
             }
             curl_easy_cleanup(curl);
         }
@@ -108,14 +143,48 @@ private:
         return healthy;
     }
     
-    bool waitForServer(int port, int maxAttempts = 20) {
-        for(int i = 0; i < maxAttempts; i++) {
-            if(checkServerHealth(port)) {
-                return true;
+    static std::string serverUrl(const std::string& host, int port, bool tls) {
+        return (tls ? "https://" : "http://") + host + ":" + std::to_string(port);
+    }
+    
+    // Uses tlsCertFile/tlsKeyFile when both are set, otherwise a self-signed pair
+    // generated once per run of the orchestrator.
+    void prepareTlsCertificate() {
+        if (!config.tlsCertFile.empty() || !config.tlsKeyFile.empty()) {
+            if (!std::filesystem::exists(config.tlsCertFile) || !std::filesystem::exists(config.tlsKeyFile)) {
+                throw std::runtime_error("tlsCertFile and tlsKeyFile must both name existing PEM files");
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            tlsCertPath = config.tlsCertFile;
+            tlsKeyPath = config.tlsKeyFile;
+            return;
         }
-        return false;
+        std::filesystem::path dir = std::filesystem::temp_directory_path() / "benchmark_wrk_tls";
+        std::filesystem::create_directories(dir);
+        tlsCertPath = (dir / "cert.pem").string();
+        tlsKeyPath = (dir / "key.pem").string();
+        writeSelfSignedCertificate(tlsCertPath, tlsKeyPath, config.targetHost);
+    }
+    
+    // Waits for the port to accept connections, then for a successful response, and
+    // records both times from `spawned`. Gives up after 10s, or as soon as a process
+    // in the group exits.
+    bool waitForServer(const Setup& setup, pid_t group, std::chrono::steady_clock::time_point spawned,
+                       StartupTiming& startup) {
+        using Clock = std::chrono::steady_clock;
+        const int port = setup.port;
+        const TransportMode transport = parseTransport(setup.transport);
+        auto deadline = spawned + std::chrono::seconds(10);
+        auto alive = [&]() { return serverGroupAlive(group); };
+        auto sinceSpawn = [&]() { return std::chrono::duration<double, std::milli>(Clock::now() - spawned).count(); };
+        
+        if (!waitForListen(serverHost, port, deadline, alive)) return false;
+        startup.listenMs = sinceSpawn();
+        if (!pollWithBackoff([&]() { return checkServerHealth(port, transport, &startup.firstResponseLatencyMs); }, deadline, alive)) {
+            return false;
+        }
+        startup.firstResponseMs = sinceSpawn();
+        startup.valid = true;
+        return true;
     }
     
     std::string executeCommand(const std::string& command) {
@@ -134,120 +203,972 @@ private:
         return result;
     }
     
-    double parseLatencyValue(const std::string& value, const std::string& unit) {
-        double val = std::stod(value);
-        if (unit == "us") return val / 1000.0; // microseconds to milliseconds
-        if (unit == "ms") return val;
-        if (unit == "s") return val * 1000.0;
-        return val;
+    // Anything but a plain GET / is sent through a generated Lua script.
+    BenchmarkResult runWrkBenchmark(const BenchmarkConfig& runConfig, const std::string& url, const Scenario& scenario) {
+        std::stringstream cmd;
+        cmd << "wrk -c " << runConfig.connections 
+            << " -t " << runConfig.threads 
+            << " -d " << runConfig.duration 
+            << " --timeout " << runConfig.timeout;
+        
+        if (runConfig.latencyStats) {
+            cmd << " --latency";
+        }
+        
+        if (runConfig.rate > 0) {
+            cmd << " -R " << static_cast<long long>(runConfig.rate);  // requires wrk2
+        }
+        
+        // One script per run: parallel slots may run the same scenario at the same time.
+        static std::atomic<int> scripts{0};
+        const ScenarioRoute& first = scenario.routes.front();
+        std::filesystem::path script;
+        if (scenario.routes.size() > 1 || first.method != "GET" || first.path != "/" || first.bodyBytes > 0) {
+            script = std::filesystem::temp_directory_path() /
+                     ("benchmark_wrk_" + std::to_string(getpid()) + "_" + std::to_string(scripts++) + "_" +
+                      fileSlug(scenario.name) + ".lua");
+            std::ofstream(script) << wrkScenarioScript(scenario);
+            cmd << " -s " << script.string();
+        }
+        
+        cmd << " " << url;
+        
+        std::string output = executeCommand(cmd.str());
+        if (!script.empty()) {
+            std::error_code ignored;
+            std::filesystem::remove(script, ignored);
+        }
+        return parseWrkOutput(output, false);
     }
     
-    BenchmarkResult parseWrkOutput(const std::string& output) {
-        BenchmarkResult result;
-        std::istringstream iss(output);
-        std::string line;
+    // "Hono on Bun [hello] run 1" -> "hono-on-bun-hello-run-1"
+    static std::string fileSlug(const std::string& label) {
+        std::string slug;
+        for (char c : label) {
+            if (std::isalnum(static_cast<unsigned char>(c))) {
+                slug += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            } else if (!slug.empty() && slug.back() != '-') {
+                slug += '-';
+            }
+        }
+        while (!slug.empty() && slug.back() == '-') slug.pop_back();
+        return slug;
+    }
+    
+    // One directory per server port, so that concurrent slots never read each other's rings.
+    std::string instrumentDirFor(int port) const {
+        return config.instrumentDir + "/benchwrk-" + std::to_string(getpid()) + "-" + std::to_string(port);
+    }
+    
+    std::string timelinePath(const std::string& label) {
+        return config.timelineDir + "/" + fileSlug(label) + ".ndjson";
+    }
+    
+    // Empty when archiving is off.
+    std::string sampleArchivePath(const std::string& label) {
+        if (config.sampleArchiveDir.empty()) return "";
+        std::error_code ec;
+        std::filesystem::create_directories(config.sampleArchiveDir, ec);
+        return config.sampleArchiveDir + "/" + fileSlug(label) + ".samples";
+    }
+    
+    // What a measured run does with its timeline buckets, whether they come from the
+    // generator here or merged from the agents: the NDJSON timeline, whose
+    // steady-state summary is computed once the run ends, and the per-bucket P99 on
+    // the servers' clock, for lining spikes up with what they report.
+    struct RunTimeline {
+        std::unique_ptr<TimelineWriter> writer;
+        std::string path;
+        bool instrumented = false;
+        std::vector<LatencyBucket> latencyBuckets;
+        
+        int bucketMs(const BenchmarkConfig& runConfig) const {
+            if (!writer && !instrumented) return 0;
+            return runConfig.timelineIntervalMs > 0 ? runConfig.timelineIntervalMs : 1000;
+        }
+        
+        void add(const TimelineBucket& bucket) {
+            if (writer) writer->write(bucket);
+            if (instrumented && bucket.latency && bucket.latency->totalCount() > 0) {
+                double startSec = bucket.monotonicStartSec;
+                latencyBuckets.push_back({startSec, startSec + (bucket.endSec - bucket.startSec),
+                                          bucket.latency->valueAtPercentile(99) / 1000.0});
+            }
+        }
+        
+        void finish(BenchmarkResult& result, double steadyStateTolerance) {
+            result.latencyBuckets = std::move(latencyBuckets);
+            if (!writer) return;
+            writer.reset();
+            result.timelineFile = path;
+            result.steadyState = analyzeTimeline(path, steadyStateTolerance);
+        }
+    };
+    
+    // Only measured runs, those with a timelineLabel, get a timeline file.
+    RunTimeline openTimeline(const BenchmarkConfig& runConfig, const std::string& timelineLabel) {
+        RunTimeline timeline;
+        timeline.instrumented = runConfig.instrumentIntervalMs > 0;
+        if (timelineLabel.empty() || runConfig.timelineIntervalMs <= 0) return timeline;
+        std::error_code ec;
+        std::filesystem::create_directories(runConfig.timelineDir, ec);
+        timeline.path = timelinePath(timelineLabel);
+        timeline.writer = std::make_unique<TimelineWriter>(timeline.path, timelineLabel, runConfig.timelineIntervalMs,
+                                                           runConfig.rate);
+        if (!timeline.writer->ok()) {
+            std::cerr << "Cannot write timeline " << timeline.path << std::endl;
+            timeline.writer.reset();
+        }
+        return timeline;
+    }
+    
+    BenchmarkResult runNativeBenchmark(const BenchmarkConfig& runConfig, const std::string& host, int port,
+                                       const Scenario& scenario, const std::string& timelineLabel,
+                                       const std::string& environment) {
+        LoadTarget target;
+        target.host = host;
+        target.port = port;
+        target.routes = scenario.routes;
+        LoadGenerator generator(runConfig, target);
+        if (!environment.empty()) {
+            generator.setProgressCallback([&](const LoadProgress& progress) {
+                reportLiveProgress(environment, scenario.name, progress);
+            });
+        }
         
-        std::regex rpsRegex(R"(Requests/sec:\s+([0-9.]+))");
-        std::regex transferRegex(R"(Transfer/sec:\s+([0-9.]+)(KB|MB|GB))");
-        std::regex totalRegex(R"((\d+) requests in)");
-        std::regex latencyRegex(R"(Latency\s+([0-9.]+)(\w+)\s+([0-9.]+)(\w+)\s+([0-9.]+)(\w+)\s+([0-9.]+)%)");
-        std::regex percentileRegex(R"(\s+(\d+)%\s+([0-9.]+)(\w+))");
-        std::regex socketErrorRegex(R"(Socket errors: connect (\d+), read (\d+), write (\d+), timeout (\d+))");
-        std::regex nonErrorRegex(R"(Non-2xx or 3xx responses: (\d+))");
+        RunTimeline timeline = openTimeline(runConfig, timelineLabel);
+        if (int bucketMs = timeline.bucketMs(runConfig)) {
+            generator.setTimelineCallback([&](const TimelineBucket& bucket) { timeline.add(bucket); }, bucketMs);
+        }
         
-        std::smatch match;
+        // Like the timeline, only measured runs are archived.
+        if (!timelineLabel.empty()) generator.setSampleArchive(sampleArchivePath(timelineLabel), timelineLabel);
         
-        while (std::getline(iss, line)) {
-            if (std::regex_search(line, match, rpsRegex)) {
-                result.requestsPerSecond = std::stod(match[1]);
+        BenchmarkResult result = generator.run();
+        timeline.finish(result, runConfig.steadyStateTolerance);
+        return result;
+    }
+    
+    // Feeds the metrics endpoint and, with liveView, redraws the run's status line.
+    void reportLiveProgress(const std::string& environment, const std::string& scenario, const LoadProgress& progress) {
+        liveMetrics.update(environment, scenario, progress);
+        if (!config.liveView) return;
+        std::lock_guard<std::mutex> lock(liveViewMutex);
+        if (isatty(STDERR_FILENO)) {
+            std::cerr << "\r\033[K" << liveMetrics.statusLine(environment, scenario) << std::flush;
+        } else {
+            std::cerr << liveMetrics.statusLine(environment, scenario) << std::endl;
+        }
+    }
+    
+    // Drives the configured agents instead of generating load here; the server still
+    // runs locally and agents reach it at config.targetHost.
+    BenchmarkResult runDistributedBenchmark(const BenchmarkConfig& runConfig, int port, const Scenario& scenario,
+                                            std::ostream& out, const std::string& timelineLabel,
+                                            const std::string& environment) {
+        std::vector<AgentEndpoint> agents;
+        for (const auto& spec : runConfig.agents) {
+            agents.push_back(parseAgentEndpoint(spec));
+        }
+        LoadTarget target;
+        target.host = runConfig.targetHost;
+        target.port = port;
+        target.routes = scenario.routes;
+        // Ticks only carry counters, so live metrics from agents carry no latency.
+        LoadProgress progress;
+        RunTimeline timeline = openTimeline(runConfig, timelineLabel);
+        int bucketMs = timeline.bucketMs(runConfig);
+        std::function<void(const TimelineBucket&)> onBucket;
+        if (bucketMs > 0) onBucket = [&](const TimelineBucket& bucket) { timeline.add(bucket); };
+        BenchmarkResult result = runDistributed(runConfig, target, agents, [&](const DistributedTick& tick) {
+            out << "  [" << std::setw(3) << tick.second << "s] " << tick.completed << " req/s, "
+                << tick.errors << " errors (" << tick.agentsReporting << " agents)" << std::endl;
+            if (environment.empty()) return;
+            progress.elapsedSec = tick.second;
+            progress.completed += tick.completed;
+            progress.errors += tick.errors;
+            reportLiveProgress(environment, scenario.name, progress);
+        }, onBucket, bucketMs);
+        timeline.finish(result, runConfig.steadyStateTolerance);
+        return result;
+    }
+    
+    // Local load generator threads inherit the slot thread's CPU mask, so cap them at
+    // the slot's load CPUs rather than oversubscribing a few cores.
+    // Measured runs pass their setup's name as `environment`, which puts them on the
+    // live metrics endpoint.
+    BenchmarkResult runLoadTest(BenchmarkConfig runConfig, const CpuSlot& slot, int port, const Scenario& scenario,
+                                std::ostream& out, const std::string& timelineLabel = "",
+                                const std::string& environment = "") {
+        BenchmarkResult result;
+        if (!runConfig.agents.empty()) {
+            result = runDistributedBenchmark(runConfig, port, scenario, out, timelineLabel, environment);
+        } else {
+            if (!slot.loadCpus.empty()) {
+                runConfig.threads = std::min(runConfig.threads, static_cast<int>(slot.loadCpus.size()));
             }
-            
-            if (std::regex_search(line, match, transferRegex)) {
-                double bytes = std::stod(match[1]);
-                std::string unit = match[2];
-                if (unit == "KB") bytes *= 1024;
-                else if (unit == "MB") bytes *= 1024 * 1024;
-                else if (unit == "GB") bytes *= 1024 * 1024 * 1024;
-                result.throughput = bytes;
+            if (runConfig.loadGenerator == "wrk") {
+                result = runWrkBenchmark(runConfig, serverUrl(serverHost, port, parseTransport(runConfig.transport).tls),
+                                         scenario);
+            } else {
+                result = runNativeBenchmark(runConfig, serverHost, port, scenario, timelineLabel, environment);
             }
+        }
+        // A test cut short by Ctrl-C is not a measurement.
+        throwIfInterrupted();
+        return result;
+    }
+    
+    static std::string runtimeExecutable(const Setup& setup) {
+        return setup.binary.empty() ? setup.runtime : setup.binary;
+    }
+    
+    // Args and environment on top of the plain runtime, e.g. "--jitless BUN_JSC_useJIT=0".
+    static std::string runtimeFlags(const std::vector<std::string>& args, const std::vector<std::string>& env) {
+        std::string flags;
+        for (const auto& part : args) flags += (flags.empty() ? "" : " ") + part;
+        for (const auto& part : env) flags += (flags.empty() ? "" : " ") + part;
+        return flags;
+    }
+    
+    // "<executable> --version", or "" when it cannot be run.
+    std::string runtimeVersion(const std::string& executable) {
+        std::string quoted = "'";
+        for (char c : executable) quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+        quoted += "'";
+        try {
+            return trimmed(executeCommand(quoted + " --version 2>/dev/null"));
+        } catch (...) {
+            return "";
+        }
+    }
+    
+    // One `--version` per distinct executable, recorded on every planned setup, so
+    // that variants of a runtime (other binaries, same name) are told apart.
+    void detectRuntimeVersions() {
+        std::cout << "\n=== Runtime Versions ===" << std::endl;
+        std::map<std::string, std::string> versions;
+        auto show = [&](const std::string& executable, const std::string& label) {
+            std::string version = runtimeVersion(executable);
+            versions[executable] = version;
+            std::cout << label << ": " << (version.empty() ? "Not available" : version) << std::endl;
+        };
+        show("node", "Node.js");
+        show("bun", "Bun");
+        for (auto& cell : plan) {
+            std::string executable = runtimeExecutable(cell.setup);
+            if (versions.count(executable) == 0) show(executable, executable);
+            cell.setup.version = versions[executable];
+        }
+        nodeVersion = versions["node"];
+        bunVersion = versions["bun"];
+    }
+    
+    // Starts the server in a process group of its own and returns the group id.
+    // With several workers, "reuseport" mode forks one copy per worker into that
+    // group (each binds the port with SO_REUSEPORT); "cluster" mode starts one copy
+    // that forks node:cluster workers itself. Workers inherit the group, so the
+    // whole set is signalled and sampled together.
+    pid_t startServer(const Setup& setup, const CpuSlot& slot) {
+        const TransportMode transport = parseTransport(setup.transport);
+        int copies = 1;
+        std::vector<std::string> envStrings = {"NODE_ENV=production", "PORT=" + std::to_string(setup.port),
+                                               std::string("SERVER_TRANSPORT=") + (transport.h2 ? "h2" : transport.tls ? "https" : "http")};
+        if (transport.tls) {
+            envStrings.push_back("TLS_CERT_FILE=" + tlsCertPath);
+            envStrings.push_back("TLS_KEY_FILE=" + tlsKeyPath);
+        }
+        if (setup.workers > 1 && config.workerMode == "cluster") {
+            envStrings.push_back("CLUSTER_WORKERS=" + std::to_string(setup.workers));
+        } else if (setup.workers > 1) {
+            envStrings.push_back("REUSE_PORT=1");
+            copies = setup.workers;
+        }
+        if (config.instrumentIntervalMs > 0) {
+            resetInstrumentationDir(instrumentDirFor(setup.port));
+            envStrings.push_back("BENCH_INSTRUMENT_DIR=" + instrumentDirFor(setup.port));
+            envStrings.push_back("BENCH_INSTRUMENT_INTERVAL_MS=" + std::to_string(config.instrumentIntervalMs));
+        }
+        // The setup's own variables win over ours, ours over the inherited ones.
+        auto keyOf = [](const std::string& entry) { return entry.substr(0, entry.find('=') + 1); };
+        for (const auto& entry : setup.runtimeEnv) {
+            std::string key = keyOf(entry);
+            envStrings.erase(std::remove_if(envStrings.begin(), envStrings.end(),
+                                            [&](const std::string& own) { return own.rfind(key, 0) == 0; }),
+                             envStrings.end());
+            envStrings.push_back(entry);
+        }
+        
+        // Build the child's environment and arguments before forking: other slots keep
+        // running threads, so the child must not allocate before exec.
+        std::vector<std::string> overridden;
+        for (const auto& entry : envStrings) overridden.push_back(keyOf(entry));
+        for (char** env = environ; *env != nullptr; env++) {
+            std::string entry = *env;
+            bool keep = std::none_of(overridden.begin(), overridden.end(),
+                                     [&entry](const std::string& prefix) { return entry.rfind(prefix, 0) == 0; });
+            if (keep) envStrings.push_back(entry);
+        }
+        std::vector<char*> envp;
+        for (auto& entry : envStrings) envp.push_back(&entry[0]);
+        envp.push_back(nullptr);
+        // `ip netns exec` execs the runtime in place, so the pid and process group stay the server's.
+        std::vector<std::string> argStrings;
+        if (networkNamespace) argStrings = {"ip", "netns", "exec", networkNamespace->name()};
+        argStrings.push_back(runtimeExecutable(setup));
+        argStrings.insert(argStrings.end(), setup.runtimeArgs.begin(), setup.runtimeArgs.end());
+        argStrings.push_back(setup.script);
+        std::vector<char*> argv;
+        for (auto& arg : argStrings) argv.push_back(&arg[0]);
+        argv.push_back(nullptr);
+        
+        pid_t group = 0;
+        for (int i = 0; i < copies; i++) {
+            pid_t pid = fork();
             
-            if (std::regex_search(line, match, totalRegex)) {
-                result.totalRequests = std::stoi(match[1]);
+            if (pid == 0) {
+                // Child process
+                setpgid(0, group);
+#ifdef __linux__
+                prctl(PR_SET_PDEATHSIG, SIGTERM);  // no orphaned servers if the orchestrator dies
+#endif
+                if (!slot.serverCpus.empty()) {
+                    pinCurrentThread(slot.serverCpus);
+                }
+                environ = envp.data();
+                execvp(argv[0], argv.data());
+                _exit(1);
+            } else if (pid > 0) {
+                // Parent process; also set the group here so it is in place before we signal it
+                setpgid(pid, group);
+                if (group == 0) group = pid;
+            } else {
+                // Fork failed
+                if (group > 0) stopServer(group);
+                return -1;
             }
-            
-            if (std::regex_search(line, match, latencyRegex)) {
-                result.avgLatency = parseLatencyValue(match[1], match[2]);
-                result.maxLatency = parseLatencyValue(match[5], match[6]);
+        }
+        std::lock_guard<std::mutex> lock(serversMutex);
+        liveServers.insert(group);
+        return group;
+    }
+    
+    // SIGTERM to the whole group, SIGKILL for anything still running after a grace period.
+    void stopServer(pid_t group) {
+        if (group <= 0) return;
+        kill(-group, SIGTERM);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        for (;;) {
+            int status;
+            pid_t pid = waitpid(-group, &status, WNOHANG);
+            if (pid < 0) break;  // ECHILD: all of our children in the group are gone
+            if (pid > 0) continue;
+            if (std::chrono::steady_clock::now() >= deadline) {
+                kill(-group, SIGKILL);
+                deadline = std::chrono::steady_clock::time_point::max();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        kill(-group, SIGKILL);  // cluster workers are the primary's children, not ours
+        std::lock_guard<std::mutex> lock(serversMutex);
+        liveServers.erase(group);
+    }
+    
+    // False once any process we started in the group has exited, e.g. a reuseport
+    // copy that could not bind on a runtime without SO_REUSEPORT support.
+    bool serverGroupAlive(pid_t group) {
+        // WNOWAIT leaves an exited process for stopServer to reap, so repeated checks agree.
+        siginfo_t info{};
+        return waitid(P_PGID, group, &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid == 0;
+    }
+    
+    // Sends real load until rolling throughput and P99 settle: the last warmupWindows
+    // windows of warmupWindowMs must each have a coefficient of variation under its
+    // threshold, or warmupMaxTime runs out. JIT tiering then happens before, not
+    // inside, the measured window.
+    WarmupOutcome runAdaptiveWarmup(const Setup& setup, const Scenario& scenario, const CpuSlot& slot, std::ostream& out) {
+        BenchmarkConfig warmConfig = configFor(setup);
+        warmConfig.duration = std::to_string(config.warmupMaxTime) + "ms";
+        // A shaped rate would never settle; warm up at the base rate.
+        warmConfig.rateProfile.clear();
+        if (!slot.loadCpus.empty()) {
+            warmConfig.threads = std::min(warmConfig.threads, static_cast<int>(slot.loadCpus.size()));
+        }
+        LoadTarget target;
+        target.host = serverHost;
+        target.port = setup.port;
+        target.routes = scenario.routes;
+        LoadGenerator generator(warmConfig, target);
+        
+        WarmupOutcome outcome;
+        std::vector<double> rpsWindow, p99Window, windowStarts;
+        double rpsCov = 0, p99Cov = 0;
+        size_t windows = static_cast<size_t>(std::max(config.warmupWindows, 2));
+        generator.setTimelineCallback([&](const TimelineBucket& bucket) {
+            if (outcome.converged) return;
+            double span = std::max(bucket.endSec - bucket.startSec, 1e-9);
+            rpsWindow.push_back(bucket.completed / span);
+            p99Window.push_back(bucket.latency->valueAtPercentile(99) / 1000.0);
+            windowStarts.push_back(bucket.startSec);
+            if (rpsWindow.size() > windows) {
+                rpsWindow.erase(rpsWindow.begin());
+                p99Window.erase(p99Window.begin());
+                windowStarts.erase(windowStarts.begin());
             }
+            if (rpsWindow.size() < windows) return;
             
-            if (std::regex_search(line, match, percentileRegex)) {
-                int percentile = std::stoi(match[1]);
-                double value = parseLatencyValue(match[2], match[3]);
+            rpsCov = coefficientOfVariation(rpsWindow);
+            p99Cov = coefficientOfVariation(p99Window);
+            if (rpsCov <= config.warmupCovThreshold && p99Cov <= config.warmupP99CovThreshold) {
+                outcome.converged = true;
+                outcome.settledFromMs = static_cast<int>(windowStarts.front() * 1000);
+                generator.stop();
+            }
+        }, config.warmupWindowMs);
+        
+        auto started = std::chrono::steady_clock::now();
+        try {
+            generator.run();
+        } catch (const std::exception& e) {
+            std::cerr << "Warmup load for " << setup.name << " failed: " << e.what() << std::endl;
+        }
+        throwIfInterrupted();
+        outcome.ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started).count());
+        
+        out << "  Warmup: " << outcome.ms << "ms, " << (outcome.converged ? "stable" : "hit warmupMaxTime")
+            << " (CoV req/s " << std::fixed << std::setprecision(3) << rpsCov << ", P99 " << p99Cov << ")" << std::endl;
+        return outcome;
+    }
+    
+    // Stops the whole group if any of its processes has exited.
+    bool checkServerGroup(const Setup& setup, pid_t group) {
+        if (serverGroupAlive(group)) return true;
+        std::cerr << "A server process for " << setup.name << " exited during startup";
+        if (setup.workers > 1 && config.workerMode != "cluster") {
+            std::cerr << " (does " << setup.runtime << " support listen({ reusePort })?)";
+        }
+        std::cerr << std::endl;
+        stopServer(group);
+        return false;
+    }
+    
+    // Starts the server for a setup, waits until it answers and warms it up;
+    // returns -1 on failure.
+    pid_t launchServer(const Setup& setup, const Scenario& scenario, const CpuSlot& slot, std::ostream& out,
+                       WarmupOutcome* warmup = nullptr, StartupTiming* startup = nullptr) {
+        auto spawned = std::chrono::steady_clock::now();
+        pid_t serverPid = startServer(setup, slot);
+        if (serverPid == -1) {
+            std::cerr << "Failed to start server for " << setup.name << std::endl;
+            return -1;
+        }
+        
+        // Wait until the server answers; a fixed warmup only starts after that
+        StartupTiming timing;
+        if (!waitForServer(setup, serverPid, spawned, timing)) {
+            if (!checkServerGroup(setup, serverPid)) return -1;
+            std::cerr << "Server " << setup.name << " failed to start on port " << setup.port << std::endl;
+            stopServer(serverPid);
+            return -1;
+        }
+        out << "  Startup: listening after " << std::fixed << std::setprecision(1) << timing.listenMs
+            << "ms, first response after " << timing.firstResponseMs << "ms (" << timing.firstResponseLatencyMs
+            << "ms round trip)" << std::setprecision(2) << std::endl;
+        if (startup) *startup = timing;
+        if (!config.adaptiveWarmup) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(config.warmupTime));
+        }
+        
+        // The first worker to bind answers the probe; give the others a moment to fail.
+        if (setup.workers > 1) std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        if (!checkServerGroup(setup, serverPid)) return -1;
+        
+        WarmupOutcome outcome;
+        if (config.adaptiveWarmup) {
+            outcome = runAdaptiveWarmup(setup, scenario, slot, out);
+        } else {
+            outcome.ms = config.warmupTime;
+        }
+        if (warmup) *warmup = outcome;
+        
+        if (!checkServerGroup(setup, serverPid)) return -1;
+        return serverPid;
+    }
+    
+    LoadPoint toLoadPoint(double offeredRps, const BenchmarkResult& level) {
+        LoadPoint point;
+        point.offeredRps = offeredRps;
+        point.achievedRps = level.requestsPerSecond;
+        point.p50Latency = level.p50Latency;
+        point.p90Latency = level.p90Latency;
+        point.p99Latency = level.p99Latency;
+        point.p999Latency = level.p999Latency;
+        point.maxLatency = level.maxLatency;
+        point.errors = level.errors;
+        point.errorRate = level.totalRequests > 0 ? static_cast<double>(level.errors) / level.totalRequests
+                                                  : (level.errors > 0 ? 1.0 : 0.0);
+        point.withinSlo = level.totalRequests > 0
+            && level.p99Latency <= config.sloP99Ms
+            && point.errorRate <= config.maxErrorRate
+            && level.requestsPerSecond >= offeredRps * 0.95;
+        return point;
+    }
+    
+    // Runs one constant-rate window per entry in config.offeredLoads against a single
+    // server instance, producing the latency-vs-offered-load curve for a setup.
+    std::vector<LoadPoint> measureLoadCurve(const Setup& setup, const Scenario& scenario, const CpuSlot& slot,
+                                            std::ostream& out) {
+        std::vector<LoadPoint> curve;
+        out << "\n--- Offered load sweep for " << describe(setup, scenario) << " ---" << std::endl;
+        
+        pid_t serverPid = launchServer(setup, scenario, slot, out);
+        if (serverPid == -1) {
+            return curve;
+        }
+        
+        for (double load : config.offeredLoads) {
+            BenchmarkConfig levelConfig = configFor(setup);
+            levelConfig.rate = load;
+            levelConfig.rateProfile.clear();
+            try {
+                BenchmarkResult level = runLoadTest(levelConfig, slot, setup.port, scenario, out);
+                curve.push_back(toLoadPoint(load, level));
                 
-                if (percentile == 50) result.p50Latency = value;
-                else if (percentile == 75) result.p75Latency = value;
-                else if (percentile == 90) result.p90Latency = value;
-                else if (percentile == 99) result.p99Latency = value;
+                out << "  " << std::fixed << std::setprecision(0) << load << " req/s offered -> "
+                          << level.requestsPerSecond << " req/s, P99 " << std::setprecision(2)
+                          << level.p99Latency << "ms" << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "Error at offered load " << load << " for " << setup.name << ": " << e.what() << std::endl;
             }
-            
-            if (std::regex_search(line, match, socketErrorRegex)) {
-                result.socketErrors = std::stoi(match[1]) + std::stoi(match[2]) + std::stoi(match[3]);
-                result.timeouts = std::stoi(match[4]);
-                result.errors = result.socketErrors + result.timeouts;
+        }
+        
+        stopServer(serverPid);
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.cooldownTime));
+        return curve;
+    }
+    
+    // Finds the highest constant request rate a setup sustains with P99 under
+    // config.sloP99Ms and errors under config.maxErrorRate: the offered load doubles
+    // from config.searchStartRate until a probe fails, then the gap between the last
+    // passing and first failing rate is bisected config.searchIterations times.
+    SaturationResult findSaturation(const Setup& setup, const Scenario& scenario, const CpuSlot& slot, std::ostream& out) {
+        SaturationResult saturation;
+        saturation.sloP99Ms = config.sloP99Ms;
+        saturation.maxErrorRate = config.maxErrorRate;
+        out << "\n--- Saturation search for " << describe(setup, scenario) << " (P99 <= " << config.sloP99Ms
+                  << "ms, errors <= " << (config.maxErrorRate * 100) << "%) ---" << std::endl;
+        
+        pid_t serverPid = launchServer(setup, scenario, slot, out);
+        if (serverPid == -1) {
+            return saturation;
+        }
+        
+        auto probe = [&](double rate) {
+            BenchmarkConfig probeConfig = configFor(setup);
+            probeConfig.rate = rate;
+            probeConfig.rateProfile.clear();
+            probeConfig.duration = config.searchDuration;
+            LoadPoint point;
+            try {
+                point = toLoadPoint(rate, runLoadTest(probeConfig, slot, setup.port, scenario, out));
+            } catch (const std::exception& e) {
+                std::cerr << "Error probing " << rate << " req/s for " << setup.name << ": " << e.what() << std::endl;
+                point.offeredRps = rate;
+            }
+            saturation.curve.push_back(point);
+            if (point.withinSlo && point.achievedRps > saturation.maxRpsAtSlo) {
+                saturation.maxRpsAtSlo = point.achievedRps;
+                saturation.offeredAtMax = rate;
+                saturation.p99AtMax = point.p99Latency;
             }
             
-            if (std::regex_search(line, match, nonErrorRegex)) {
-                result.errors += std::stoi(match[1]);
+            out << "  " << std::fixed << std::setprecision(0) << rate << " req/s offered -> "
+                      << point.achievedRps << " req/s, P99 " << std::setprecision(2) << point.p99Latency
+                      << "ms, errors " << (point.errorRate * 100) << "% " << (point.withinSlo ? "[pass]" : "[fail]")
+                      << std::endl;
+            return point.withinSlo;
+        };
+        
+        double good = 0;
+        double bad = 0;
+        double rate = std::max(config.searchStartRate, 1.0);
+        for (int step = 0; step < 20; step++) {
+            if (!probe(rate)) {
+                bad = rate;
+                break;
             }
+            good = rate;
+            rate *= 2;
         }
         
-        result.rawOutput = output;
-        return result;
+        if (bad > 0) {
+            for (int i = 0; i < config.searchIterations && bad - good > 1; i++) {
+                double mid = (good + bad) / 2;
+                if (probe(mid)) {
+                    good = mid;
+                } else {
+                    bad = mid;
+                }
+            }
+        }
+        
+        std::sort(saturation.curve.begin(), saturation.curve.end(),
+                  [](const LoadPoint& a, const LoadPoint& b) { return a.offeredRps < b.offeredRps; });
+        out << "  Max RPS at SLO: " << std::fixed << std::setprecision(2) << saturation.maxRpsAtSlo << std::endl;
+        
+        stopServer(serverPid);
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.cooldownTime));
+        return saturation;
     }
     
-    BenchmarkResult runWrkBenchmark(const std::string& url) {
-        std::stringstream cmd;
-        cmd << "wrk -c " << config.connections 
-            << " -t " << config.threads 
-            << " -d " << config.duration 
-            << " --timeout " << config.timeout;
-        
-        if (config.latencyStats) {
-            cmd << " --latency";
+    // Mean steady rate over runs that produced a timeline; percentiles come from the
+    // merged steady-state histograms, matching how whole-run percentiles are merged.
+    SteadyState aggregateSteadyState(const std::vector<BenchmarkResult>& runs) {
+        SteadyState steady;
+        int count = 0;
+        for (const auto& run : runs) {
+            if (!run.steadyState.valid) continue;
+            count++;
+            steady.requestsPerSecond += run.steadyState.requestsPerSecond;
+            steady.startSec += run.steadyState.startSec;
+            steady.endSec += run.steadyState.endSec;
+            steady.buckets += run.steadyState.buckets;
+            steady.errors += run.steadyState.errors;
+            steady.latencyHistogram.merge(run.steadyState.latencyHistogram);
         }
+        if (count == 0) return steady;
         
-        cmd << " " << url;
+        steady.valid = true;
+        steady.requestsPerSecond /= count;
+        steady.startSec /= count;
+        steady.endSec /= count;
+        const HdrHistogram& latency = steady.latencyHistogram;
+        steady.p50Latency = latency.valueAtPercentile(50) / 1000.0;
+        steady.p90Latency = latency.valueAtPercentile(90) / 1000.0;
+        steady.p99Latency = latency.valueAtPercentile(99) / 1000.0;
+        steady.p999Latency = latency.valueAtPercentile(99.9) / 1000.0;
+        steady.maxLatency = latency.max() / 1000.0;
+        return steady;
+    }
+    
+    void deriveEfficiency(ProcessStats& stats, double requests, int connections) {
+        if (!stats.valid) return;
+        double cpuSec = stats.cpuUserSec + stats.cpuSysSec;
+        stats.requestsPerCpuSecond = cpuSec > 0 ? requests / cpuSec : 0.0;
+        stats.rssBytesPerConnection = connections > 0 ? stats.maxRssKb * 1024.0 / connections : 0.0;
+    }
+    
+    // CPU time and context switches are averaged per run; RSS and thread count are
+    // the worst seen in any run. Requests per CPU-second comes from the totals.
+    ProcessStats aggregateServerResources(const std::vector<BenchmarkResult>& runs, int connections) {
+        ProcessStats stats;
+        int count = 0;
+        double requests = 0;
+        for (const auto& run : runs) {
+            const ProcessStats& r = run.serverResources;
+            if (!r.valid) continue;
+            count++;
+            requests += run.totalRequests;
+            stats.samples += r.samples;
+            stats.wallSec += r.wallSec;
+            stats.cpuUserSec += r.cpuUserSec;
+            stats.cpuSysSec += r.cpuSysSec;
+            stats.avgRssKb += r.avgRssKb;
+            stats.voluntarySwitches += r.voluntarySwitches;
+            stats.involuntarySwitches += r.involuntarySwitches;
+            stats.maxRssKb = std::max(stats.maxRssKb, r.maxRssKb);
+            stats.hwmSumKb = std::max(stats.hwmSumKb, r.hwmSumKb);
+            stats.maxThreads = std::max(stats.maxThreads, r.maxThreads);
+        }
+        if (count == 0) return stats;
         
-        std::string output = executeCommand(cmd.str());
-        return parseWrkOutput(output);
+        double cpuSec = stats.cpuUserSec + stats.cpuSysSec;
+        stats.valid = true;
+        stats.cpuCores = stats.wallSec > 0 ? cpuSec / stats.wallSec : 0.0;
+        stats.requestsPerCpuSecond = cpuSec > 0 ? requests / cpuSec : 0.0;
+        stats.rssBytesPerConnection = connections > 0 ? stats.maxRssKb * 1024.0 / connections : 0.0;
+        stats.wallSec /= count;
+        stats.cpuUserSec /= count;
+        stats.cpuSysSec /= count;
+        stats.avgRssKb /= count;
+        stats.voluntarySwitches /= count;
+        stats.involuntarySwitches /= count;
+        return stats;
     }
     
-    pid_t startServer(const Setup& setup) {
-        pid_t pid = fork();
+    // Means per run, except that maxima stay the worst seen and spikes are counted over all runs.
+    ServerRuntimeStats aggregateServerRuntime(const std::vector<BenchmarkResult>& runs) {
+        ServerRuntimeStats stats;
+        int count = 0;
+        for (const auto& run : runs) {
+            const ServerRuntimeStats& r = run.serverRuntime;
+            if (!r.valid) continue;
+            count++;
+            stats.runtime = r.runtime;
+            stats.gcObserved = stats.gcObserved || r.gcObserved;
+            stats.processes = std::max(stats.processes, r.processes);
+            stats.samples += r.samples;
+            stats.loopDelayMeanMs += r.loopDelayMeanMs;
+            stats.loopUtilization += r.loopUtilization;
+            stats.gcCount += r.gcCount;
+            stats.gcPauseMs += r.gcPauseMs;
+            stats.gcPauseShare += r.gcPauseShare;
+            stats.loopDelayP99Ms = std::max(stats.loopDelayP99Ms, r.loopDelayP99Ms);
+            stats.loopDelayMaxMs = std::max(stats.loopDelayMaxMs, r.loopDelayMaxMs);
+            stats.gcMaxPauseMs = std::max(stats.gcMaxPauseMs, r.gcMaxPauseMs);
+            stats.maxActiveHandles = std::max(stats.maxActiveHandles, r.maxActiveHandles);
+            stats.maxHeapUsedMb = std::max(stats.maxHeapUsedMb, r.maxHeapUsedMb);
+            stats.p99Spikes += r.p99Spikes;
+            stats.spikesWithGc += r.spikesWithGc;
+            stats.spikesWithLoopStall += r.spikesWithLoopStall;
+        }
+        if (count == 0) return stats;
         
-        if (pid == 0) {
-            // Child process
-            setenv("NODE_ENV", "production", 1);
-            execlp(setup.runtime.c_str(), setup.runtime.c_str(), setup.script.c_str(), nullptr);
-            exit(1);
-        } else if (pid > 0) {
-            // Parent process
-            return pid;
-        } else {
-            // Fork failed
-            return -1;
+        stats.valid = true;
+        stats.loopDelayMeanMs /= count;
+        stats.loopUtilization /= count;
+        stats.gcCount /= count;
+        stats.gcPauseMs /= count;
+        stats.gcPauseShare /= count;
+        return stats;
+    }
+    
+    // Counts are per-run means. Setup times come from the histogram merged across runs,
+    // and the average is weighted by the connections each run opened.
+    ConnectionStats aggregateConnectionSetup(const std::vector<BenchmarkResult>& runs) {
+        ConnectionStats stats;
+        int count = 0;
+        double weightedSetup = 0.0;
+        for (const auto& run : runs) {
+            const ConnectionStats& r = run.connectionSetup;
+            if (!r.valid) continue;
+            count++;
+            stats.opened += r.opened;
+            stats.tlsHandshakes += r.tlsHandshakes;
+            stats.tlsResumed += r.tlsResumed;
+            weightedSetup += r.avgSetupMs * r.opened;
+            stats.setupLatency.merge(r.setupLatency);
         }
+        if (count == 0) return stats;
+        stats.valid = true;
+        if (stats.opened > 0) stats.avgSetupMs = weightedSetup / stats.opened;
+        stats.p50SetupMs = stats.setupLatency.valueAtPercentile(50) / 1000.0;
+        stats.p99SetupMs = stats.setupLatency.valueAtPercentile(99) / 1000.0;
+        stats.maxSetupMs = stats.setupLatency.max() / 1000.0;
+        stats.opened /= count;
+        stats.tlsHandshakes /= count;
+        stats.tlsResumed /= count;
+        return stats;
     }
     
-    void stopServer(pid_t pid) {
-        if (pid > 0) {
-            kill(pid, SIGTERM);
-            int status;
-            waitpid(pid, &status, 0);
+    // Percentiles of each phase come from its histogram merged across runs, and the
+    // mean is weighted by the requests each run timed, as for the run latency itself.
+    LatencyPhases aggregateLatencyPhases(const std::vector<BenchmarkResult>& runs) {
+        LatencyPhases phases;
+        int count = 0;
+        long timed = 0;
+        auto add = [](PhaseLatency& into, const PhaseLatency& phase, int requests) {
+            into.avgMs += phase.avgMs * requests;
+            into.latency.merge(phase.latency);
+        };
+        for (const auto& run : runs) {
+            const LatencyPhases& r = run.latencyPhases;
+            if (!r.valid) continue;
+            count++;
+            timed += r.requests;
+            add(phases.wait, r.wait, r.requests);
+            add(phases.write, r.write, r.requests);
+            add(phases.firstByte, r.firstByte, r.requests);
+            add(phases.transfer, r.transfer, r.requests);
+        }
+        if (count == 0 || timed == 0) return phases;
+        auto summarize = [timed](PhaseLatency& phase) {
+            phase.avgMs /= timed;
+            phase.p50Ms = phase.latency.valueAtPercentile(50) / 1000.0;
+            phase.p90Ms = phase.latency.valueAtPercentile(90) / 1000.0;
+            phase.p99Ms = phase.latency.valueAtPercentile(99) / 1000.0;
+            phase.maxMs = phase.latency.max() / 1000.0;
+        };
+        phases.valid = true;
+        phases.requests = static_cast<int>(timed / count);
+        summarize(phases.wait);
+        summarize(phases.write);
+        summarize(phases.firstByte);
+        summarize(phases.transfer);
+        return phases;
+    }
+    
+    // Cores are the per-run mean, counts add up, the rest are maxima.
+    ClientLoad aggregateClientLoad(const std::vector<BenchmarkResult>& runs, int& clientBoundRuns) {
+        ClientLoad client;
+        clientBoundRuns = 0;
+        int count = 0;
+        for (const auto& run : runs) {
+            const ClientLoad& r = run.client;
+            if (!r.valid) continue;
+            count++;
+            client.threads = std::max(client.threads, r.threads);
+            client.cpuCores += r.cpuCores;
+            client.busiestThread = std::max(client.busiestThread, r.busiestThread);
+            client.pacedSends += r.pacedSends;
+            client.lateSends += r.lateSends;
+            client.backlogPeak = std::max(client.backlogPeak, r.backlogPeak);
+            client.sendLagP99Ms = std::max(client.sendLagP99Ms, r.sendLagP99Ms);
+            client.sendLagMaxMs = std::max(client.sendLagMaxMs, r.sendLagMaxMs);
+            if (r.clientBound) {
+                if (clientBoundRuns++ == 0) client.reason = r.reason;
+                client.clientBound = true;
+            }
+        }
+        if (count == 0) return client;
+        client.valid = true;
+        client.cpuCores /= count;
+        return client;
+    }
+
+    // A run the load generator may have capped: its busiest thread was saturated,
+    // paced requests went out late on free connections, or it came close to what
+    // the harness manages against the echo server at all.
+    void judgeClientLoad(BenchmarkResult& result) {
+        ClientLoad& client = result.client;
+        if (!client.valid) return;
+        std::ostringstream reason;
+        reason << std::fixed << std::setprecision(0);
+        if (client.busiestThread >= config.clientCpuLimit) {
+            reason << "busiest thread " << client.busiestThread * 100 << "% CPU";
+        } else if (client.pacedSends > 0 && client.sendLagP99Ms > config.clientLagLimitMs) {
+            reason << std::setprecision(2) << "send lag P99 " << client.sendLagP99Ms << "ms";
+        } else if (harnessCeiling.valid && config.agents.empty() &&
+                   result.requestsPerSecond >= config.clientCeilingShare * harnessCeiling.requestsPerSecond) {
+            // The ceiling was measured with this host's generator; agents are not bound by it.
+            reason << result.requestsPerSecond / harnessCeiling.requestsPerSecond * 100 << "% of the harness ceiling";
+        }
+        client.reason = reason.str();
+        client.clientBound = !client.reason.empty();
+    }
+
+    void printClientLoad(std::ostream& out, const ClientLoad& client) {
+        if (!client.valid) return;
+        out << "  Client: " << client.threads << " threads, " << std::fixed << std::setprecision(2) << client.cpuCores
+            << " cores, busiest " << std::setprecision(0) << client.busiestThread * 100 << "% CPU";
+        if (client.pacedSends > 0) {
+            out << std::setprecision(3) << ", send lag P99 " << client.sendLagP99Ms << "ms, max " << client.sendLagMaxMs
+                << "ms, " << client.lateSends << "/" << client.pacedSends << " late, backlog peak " << client.backlogPeak;
+        }
+        if (client.clientBound) out << " - CLIENT-BOUND (" << client.reason << ")";
+        out << std::setprecision(2) << std::endl;
+    }
+
+    // Means over the runs that started their own server.
+    StartupTiming aggregateStartup(const std::vector<BenchmarkResult>& runs) {
+        StartupTiming startup;
+        int count = 0;
+        for (const auto& run : runs) {
+            if (!run.startup.valid) continue;
+            count++;
+            startup.listenMs += run.startup.listenMs;
+            startup.firstResponseMs += run.startup.firstResponseMs;
+            startup.firstResponseLatencyMs += run.startup.firstResponseLatencyMs;
+        }
+        if (count == 0) return startup;
+        startup.valid = true;
+        startup.listenMs /= count;
+        startup.firstResponseMs /= count;
+        startup.firstResponseLatencyMs /= count;
+        return startup;
+    }
+    
+    // Only interesting when connections are TLS or opened per request.
+    void printConnectionSetup(std::ostream& out, const ConnectionStats& stats, const std::string& transportName) {
+        TransportMode transport = parseTransport(transportName);
+        if (!stats.valid || (!transport.tls && !transport.closeEach)) return;
+        out << "  Connections: " << stats.opened << " opened";
+        if (stats.tlsHandshakes > 0) {
+            out << ", " << stats.tlsResumed << "/" << stats.tlsHandshakes << " TLS sessions resumed";
+        }
+        out << "; setup avg " << std::fixed << std::setprecision(3) << stats.avgSetupMs << "ms, P50 "
+            << stats.p50SetupMs << "ms, P99 " << stats.p99SetupMs << "ms, max " << stats.maxSetupMs << "ms"
+            << std::setprecision(2) << std::endl;
+    }
+    
+    void printLatencyPhases(std::ostream& out, const LatencyPhases& phases) {
+        if (!phases.valid) return;
+        out << "  Latency phases (avg/P99): wait " << std::fixed << std::setprecision(3) << phases.wait.avgMs << "/"
+            << phases.wait.p99Ms << "ms, write " << phases.write.avgMs << "/" << phases.write.p99Ms
+            << "ms, first byte " << phases.firstByte.avgMs << "/" << phases.firstByte.p99Ms << "ms, transfer "
+            << phases.transfer.avgMs << "/" << phases.transfer.p99Ms << "ms" << std::setprecision(2) << std::endl;
+    }
+    
+    // Route counts and histograms add up across runs; req/sec is the per-run mean.
+    std::vector<RouteResult> aggregateRoutes(const std::vector<BenchmarkResult>& runs) {
+        std::vector<RouteResult> routes;
+        int count = 0;
+        for (const auto& run : runs) {
+            if (run.routes.empty()) continue;
+            count++;
+            if (routes.size() < run.routes.size()) routes.resize(run.routes.size());
+            for (size_t r = 0; r < run.routes.size(); r++) {
+                const RouteResult& part = run.routes[r];
+                RouteResult& route = routes[r];
+                double weighted = route.avgLatency * route.requests + part.avgLatency * part.requests;
+                route.name = part.name;
+                route.method = part.method;
+                route.path = part.path;
+                route.requests += part.requests;
+                route.errors += part.errors;
+                route.requestsPerSecond += part.requestsPerSecond;
+                route.avgLatency = route.requests > 0 ? weighted / route.requests : 0.0;
+                route.latencyHistogram.merge(part.latencyHistogram);
+            }
+        }
+        for (auto& route : routes) {
+            route.requestsPerSecond /= count;
+            summarizeRoute(route);
+        }
+        return routes;
+    }
+    
+    void printServerResources(std::ostream& out, const ProcessStats& stats) {
+        if (!stats.valid) return;
+        out << "  Server CPU: " << std::fixed << std::setprecision(2) << stats.cpuCores << " cores ("
+            << stats.cpuUserSec << "s user, " << stats.cpuSysSec << "s sys), "
+            << std::setprecision(0) << stats.requestsPerCpuSecond << " req/CPU-s" << std::endl;
+        out << "  Server RSS: " << std::setprecision(1) << stats.avgRssKb / 1024.0 << "MB avg, "
+            << stats.maxRssKb / 1024.0 << "MB max, " << stats.hwmSumKb / 1024.0 << "MB summed VmHWM, "
+            << stats.rssBytesPerConnection / 1024.0 << "KB/conn" << std::endl;
+        out << "  Server context switches: " << stats.voluntarySwitches << " voluntary, "
+            << stats.involuntarySwitches << " involuntary; threads " << stats.maxThreads << std::endl;
+        out << std::setprecision(2);
+    }
+    
+    void printServerRuntime(std::ostream& out, const ServerRuntimeStats& stats) {
+        if (!stats.valid) return;
+        out << "  Server event loop: " << std::fixed << std::setprecision(2) << stats.loopDelayMeanMs << "ms mean delay, "
+            << stats.loopDelayP99Ms << "ms P99, " << stats.loopDelayMaxMs << "ms max; utilization "
+            << std::setprecision(0) << stats.loopUtilization * 100 << "%, handles " << stats.maxActiveHandles << std::endl;
+        if (stats.gcObserved) {
+            out << "  Server GC: " << stats.gcCount << " pauses, " << std::setprecision(1) << stats.gcPauseMs
+                << "ms total (" << std::setprecision(2) << stats.gcPauseShare * 100 << "% of the window), "
+                << stats.gcMaxPauseMs << "ms longest; heap " << std::setprecision(1) << stats.maxHeapUsedMb << "MB" << std::endl;
+        } else {
+            out << "  Server GC: not reported by " << stats.runtime << std::endl;
+        }
+        if (stats.p99Spikes > 0) {
+            out << "  P99 spikes: " << stats.p99Spikes << " (" << stats.spikesWithGc << " with a GC pause, "
+                << stats.spikesWithLoopStall << " with another loop stall)" << std::endl;
         }
+        out << std::setprecision(2);
+    }
+    
+    double coefficientOfVariation(const std::vector<double>& values) {
+        double mean = calculateMean(values);
+        if (mean <= 0) return INFINITY;
+        return calculateStdDev(values, mean) / mean;
     }
     
     double calculateMean(const std::vector<double>& values) {
+        if (values.empty()) return 0.0;
         double sum = 0.0;
         for (double val : values) {
             sum += val;
@@ -256,6 +1177,7 @@ private:
     }
     
     double calculateStdDev(const std::vector<double>& values, double mean) {
+        if (values.empty()) return 0.0;
         double sum = 0.0;
         for (double val : values) {
             sum += (val - mean) * (val - mean);
@@ -264,8 +1186,11 @@ private:
     }
     
 public:
-    BenchmarkOrchestrator() {
+    explicit BenchmarkOrchestrator(const CommandLine& commandLine)
+        : config(commandLine.config), setups(commandLine.setups), filters(commandLine.filters),
+          resume(commandLine.resume), planOnly(commandLine.planOnly) {
         curl_global_init(CURL_GLOBAL_DEFAULT);
+        if (!setups.empty()) return;
         
         setups = {
             {"Express on Node.js", 3000, "node", "express", "express_server.js"},
@@ -278,63 +1203,247 @@ public:
     }
     
     ~BenchmarkOrchestrator() {
+        if (config.instrumentIntervalMs > 0) {
+            std::error_code ec;
+            std::string prefix = "benchwrk-" + std::to_string(getpid()) + "-";
+            std::vector<std::filesystem::path> dirs;
+            for (const auto& entry : std::filesystem::directory_iterator(config.instrumentDir, ec)) {
+                if (entry.path().filename().string().rfind(prefix, 0) == 0) dirs.push_back(entry.path());
+            }
+            for (const auto& dir : dirs) std::filesystem::remove_all(dir, ec);
+        }
+        // Only left running when a signal unwound a run.
+        std::set<pid_t> running;
+        {
+            std::lock_guard<std::mutex> lock(serversMutex);
+            running = liveServers;
+        }
+        for (pid_t group : running) stopServer(group);
+        networkNamespace.reset();  // takes its own sysctls with it
+        restoreSysctls(changedSysctls);
         curl_global_cleanup();
     }
     
-    void runBenchmark(const Setup& setup) {
-        std::cout << "\n=== Starting " << setup.name << " ===" << std::endl;
+    void runBenchmark(const Setup& setup, const Scenario& scenario, const CpuSlot& slot, std::ostream& out) {
+        out << "\n=== Starting " << describe(setup, scenario) << " ===" << std::endl;
         
         std::vector<BenchmarkResult> runs;
+        if (setup.restart == "per-setup") {
+            measureWarmRuns(setup, scenario, slot, out, runs);
+        } else {
+            for (int run = 1; run <= config.runs; run++) {
+                measureRun(setup, scenario, slot, out, run, runs);
+            }
+        }
+        finishBenchmark(setup, scenario, slot, out, runs);
+        // The warm copy of restartPolicy "both" runs the same code; profile it once.
+        if (!config.profileMode.empty() && (config.restartPolicy != "both" || setup.restart == "per-run")) {
+            profileSetup(setup, scenario, slot, out);
+        }
+    }
+    
+    // One more window on a fresh, warmed-up server with the profiler attached. Its
+    // numbers are not recorded: the point is where the time goes, not how much of it.
+    void profileSetup(const Setup& setup, const Scenario& scenario, const CpuSlot& slot, std::ostream& out) {
+        const std::string label = describe(setup, scenario);
+        out << "\n--- Profiling " << label << " (" << config.profileMode << ", " << config.profileDuration
+            << ") ---" << std::endl;
+        ServerProfiler profiler(config.profileMode, config.profileDir + "/" + fileSlug(label), config.perfFrequency);
+        Setup profiled = setup;
+        profiler.prepare(profiled);
+        WarmupOutcome warmup;
+        StartupTiming startup;
+        pid_t serverPid = launchServer(profiled, scenario, slot, out, &warmup, &startup);
+        if (serverPid == -1) return;
+        
+        BenchmarkConfig profileConfig = configFor(setup);
+        profileConfig.duration = config.profileDuration;
+        std::string failure;
+        try {
+            profiler.start(serverPid);
+            BenchmarkResult result = runLoadTest(profileConfig, slot, setup.port, scenario, out);
+            profiler.stop();
+            out << "  Profiled window: " << std::fixed << std::setprecision(2) << result.requestsPerSecond
+                << " req/sec (not recorded)" << std::endl;
+        } catch (const std::exception& e) {
+            failure = e.what();
+        }
+        // cpu-prof writes its profile as the server exits.
+        stopServer(serverPid);
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.cooldownTime));
+        
+        ProfileResult profile = profiler.finish();
+        profile.environment = setup.name;
+        profile.scenario = scenario.name;
+        if (!failure.empty()) profile.error = failure;
+        if (!profile.error.empty()) {
+            std::cerr << "Profiling " << label << " failed: " << profile.error << std::endl;
+        } else {
+            out << "  Profile: " << profile.samples << " samples, collapsed stacks in " << profile.foldedFile << std::endl;
+        }
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        profileResults.push_back(profile);
+    }
+    
+    // Calibrates the host and measures one run. Before a fresh server is started the
+    // host is idle; on a reused server it runs while the server has no load.
+    double calibrateHost(const CpuSlot& slot, std::ostream& out) {
+        if (config.calibrationMs <= 0) return 0.0;
+        double hostSpeed = measureHostSpeed(config.calibrationMs, slot.serverCpus);
+        out << "  Host calibration: " << std::fixed << std::setprecision(0) << hostSpeed << " units/sec"
+            << std::setprecision(2) << std::endl;
+        return hostSpeed;
+    }
+    
+    // One measured run on a freshly started server, appended to `runs` on success.
+    void measureRun(const Setup& setup, const Scenario& scenario, const CpuSlot& slot, std::ostream& out, int run,
+                    std::vector<BenchmarkResult>& runs) {
+        throwIfInterrupted();
+        int sequence = ++runSequence;
+        out << "\n--- Run " << run << "/" << config.runs << " for " << describe(setup, scenario) << " (#" << sequence
+            << " in schedule) ---" << std::endl;
+        double hostSpeed = calibrateHost(slot, out);
+        
+        // Start server
+        WarmupOutcome warmup;
+        StartupTiming startup;
+        pid_t serverPid = launchServer(setup, scenario, slot, out, &warmup, &startup);
+        if (serverPid == -1) {
+            return;
+        }
+        measureWindow(setup, scenario, slot, out, run, serverPid, warmup, startup, sequence, hostSpeed, runs);
         
+        // Stop server and cleanup
+        stopServer(serverPid);
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.cooldownTime));
+    }
+    
+    // Every run of a "per-setup" setup on one server: it is started and warmed up
+    // once, then measured in config.runs back-to-back windows.
+    void measureWarmRuns(const Setup& setup, const Scenario& scenario, const CpuSlot& slot, std::ostream& out,
+                         std::vector<BenchmarkResult>& runs) {
+        const std::string label = describe(setup, scenario);
+        out << "\n--- Runs 1-" << config.runs << " for " << label << " on one server ---" << std::endl;
+        WarmupOutcome warmup;
+        StartupTiming startup;
+        pid_t serverPid = launchServer(setup, scenario, slot, out, &warmup, &startup);
+        if (serverPid == -1) {
+            runSequence += config.runs;
+            return;
+        }
         for (int run = 1; run <= config.runs; run++) {
-            std::cout << "\n--- Run " << run << "/" << config.runs << " for " << setup.name << " ---" << std::endl;
-            
-            // Start server
-            pid_t serverPid = startServer(setup);
-            if (serverPid == -1) {
-                std::cerr << "Failed to start server for " << setup.name << std::endl;
-                continue;
+            if (!serverGroupAlive(serverPid)) {
+                std::cerr << "Server for " << label << " exited after run " << run - 1 << std::endl;
+                break;
             }
-            
-            // Wait for server to start
-            std::this_thread::sleep_for(std::chrono::milliseconds(config.warmupTime));
-            
-            // Verify server is running
-            if (!waitForServer(setup.port)) {
-                std::cerr << "Server " << setup.name << " failed to start on port " << setup.port << std::endl;
-                stopServer(serverPid);
-                continue;
+            int sequence = ++runSequence;
+            out << "\n--- Run " << run << "/" << config.runs << " for " << label << " (#" << sequence
+                << " in schedule, same server) ---" << std::endl;
+            double hostSpeed = calibrateHost(slot, out);
+            measureWindow(setup, scenario, slot, out, run, serverPid, warmup, startup, sequence, hostSpeed, runs);
+            // Only the first window follows startup and warmup; later ones follow the previous window.
+            warmup.ms = 0;
+            startup = StartupTiming{};
+        }
+        stopServer(serverPid);
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.cooldownTime));
+    }
+    
+    // Measures one window against a running server group.
+    void measureWindow(const Setup& setup, const Scenario& scenario, const CpuSlot& slot, std::ostream& out, int run,
+                       pid_t serverPid, const WarmupOutcome& warmup, const StartupTiming& startup, int sequence,
+                       double hostSpeed, std::vector<BenchmarkResult>& runs) {
+        const std::string label = describe(setup, scenario);
+        double startedAt = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+        double connectRttMs = config.agents.empty() ? measureConnectRtt(serverHost, setup.port, 20) : 0.0;
+        try {
+            ProcessSampler sampler(serverPid, config.resourceSampleMs);
+            if (config.resourceSampleMs > 0) sampler.start();
+            RuntimeMonitor monitor(instrumentDirFor(setup.port), config.instrumentIntervalMs);
+            if (config.instrumentIntervalMs > 0) monitor.start();
+            liveMetrics.beginRun(setup.name, scenario.name, label + " run " + std::to_string(run));
+            BenchmarkResult result = runLoadTest(configFor(setup), slot, setup.port, scenario, out,
+                                                 label + " run " + std::to_string(run), setup.name);
+            liveMetrics.endRun(setup.name, scenario.name);
+            if (config.liveView) {
+                std::lock_guard<std::mutex> lock(liveViewMutex);
+                if (isatty(STDERR_FILENO)) std::cerr << "\r\033[K" << std::flush;
             }
+            if (config.resourceSampleMs > 0) {
+                result.serverResources = sampler.stop();
+                deriveEfficiency(result.serverResources, result.totalRequests, setup.connections);
+            }
+            if (config.instrumentIntervalMs > 0) {
+                result.serverRuntime = summarizeRuntime(monitor.stop(), result.latencyBuckets);
+            }
+            result.warmupMs = warmup.ms;
+            result.warmupConverged = warmup.converged;
+            result.startup = startup;
+            result.sequence = sequence;
+            result.startedAt = startedAt;
+            result.hostSpeed = hostSpeed;
+            result.connectRttMs = connectRttMs;
+            judgeClientLoad(result);
+            runs.push_back(result);
             
-            try {
-                std::string url = "http://localhost:" + std::to_string(setup.port);
-                BenchmarkResult result = runWrkBenchmark(url);
-                runs.push_back(result);
-                
-                std::cout << "Run " << run << " Results:" << std::endl;
-                std::cout << "  Requests/sec: " << std::fixed << std::setprecision(2) << result.requestsPerSecond << std::endl;
-                std::cout << "  Avg Latency: " << result.avgLatency << "ms" << std::endl;
-                std::cout << "  P50 Latency: " << result.p50Latency << "ms" << std::endl;
-                std::cout << "  P90 Latency: " << result.p90Latency << "ms" << std::endl;
-                std::cout << "  P99 Latency: " << result.p99Latency << "ms" << std::endl;
-                std::cout << "  Throughput: " << (result.throughput / 1024 / 1024) << "MB/sec" << std::endl;
-                std::cout << "  Total Requests: " << result.totalRequests << std::endl;
-                std::cout << "  Errors: " << result.errors << std::endl;
-                std::cout << "  Timeouts: " << result.timeouts << std::endl;
-                
-            } catch (const std::exception& e) {
-                std::cerr << "Error in run " << run << " for " << setup.name << ": " << e.what() << std::endl;
+            out << "Run " << run << " Results:" << std::endl;
+            out << "  Requests/sec: " << std::fixed << std::setprecision(2) << result.requestsPerSecond << std::endl;
+            out << "  Avg Latency: " << result.avgLatency << "ms" << std::endl;
+            out << "  P50 Latency: " << result.p50Latency << "ms" << std::endl;
+            out << "  P90 Latency: " << result.p90Latency << "ms" << std::endl;
+            out << "  P99 Latency: " << result.p99Latency << "ms" << std::endl;
+            if (result.latencyHistogram.totalCount() > 0) {
+                out << "  P99.9 Latency: " << result.p999Latency << "ms" << std::endl;
+                out << "  Max Latency: " << result.maxLatency << "ms" << std::endl;
+            }
+            out << "  Throughput: " << (result.throughput / 1024 / 1024) << "MB/sec" << std::endl;
+            out << "  Total Requests: " << result.totalRequests << std::endl;
+            out << "  Errors: " << result.errors << std::endl;
+            out << "  Timeouts: " << result.timeouts << std::endl;
+            if (result.steadyState.valid) {
+                out << "  Steady state (" << result.steadyState.startSec << "s-" << result.steadyState.endSec
+                    << "s): " << result.steadyState.requestsPerSecond << " req/sec, P99 "
+                    << result.steadyState.p99Latency << "ms" << std::endl;
+            }
+            printServerResources(out, result.serverResources);
+            printServerRuntime(out, result.serverRuntime);
+            printConnectionSetup(out, result.connectionSetup, setup.transport);
+            printLatencyPhases(out, result.latencyPhases);
+            printClientLoad(out, result.client);
+            for (const auto& route : result.routes) {
+                out << "  Route " << route.name << ": " << route.requestsPerSecond << " req/sec, P50 "
+                    << route.p50Latency << "ms, P99 " << route.p99Latency << "ms, errors " << route.errors << std::endl;
             }
             
-            // Stop server and cleanup
-            stopServer(serverPid);
-            std::this_thread::sleep_for(std::chrono::milliseconds(config.cooldownTime));
+        } catch (const std::exception& e) {
+            std::cerr << "Error in run " << run << " for " << label << ": " << e.what() << std::endl;
+        }
+    }
+    
+    // Load curve and saturation search, then the setup's aggregate over its runs.
+    void finishBenchmark(const Setup& setup, const Scenario& scenario, const CpuSlot& slot, std::ostream& out,
+                         const std::vector<BenchmarkResult>& runs) {
+        const std::string label = describe(setup, scenario);
+        // With restartPolicy "both" the load curve and saturation search, which start their
+        // own servers anyway, are measured once, on the cold copy.
+        bool curves = config.restartPolicy != "both" || setup.restart == "per-run";
+        std::vector<LoadPoint> loadCurve;
+        if (!config.offeredLoads.empty() && curves) {
+            loadCurve = measureLoadCurve(setup, scenario, slot, out);
         }
         
-        if (!runs.empty()) {
+        SaturationResult saturation;
+        if (config.saturationSearch && curves) {
+            saturation = findSaturation(setup, scenario, slot, out);
+        }
+        
+        if (!runs.empty() || !loadCurve.empty() || !saturation.curve.empty()) {
             // Calculate statistics
             std::vector<double> rpsValues, latencyValues, p50Values, p90Values, p99Values;
             double totalThroughput = 0, totalRequests = 0, totalErrors = 0, totalTimeouts = 0;
+            double weightedLatency = 0, maxLatency = 0;
+            HdrHistogram mergedLatency;
+            bool allHistograms = true;
             
             for (const auto& run : runs) {
                 rpsValues.push_back(run.requestsPerSecond);
@@ -346,6 +1455,13 @@ public:
                 totalRequests += run.totalRequests;
                 totalErrors += run.errors;
                 totalTimeouts += run.timeouts;
+                weightedLatency += run.avgLatency * run.totalRequests;
+                maxLatency = std::max(maxLatency, run.maxLatency);
+                if (run.latencyHistogram.totalCount() > 0) {
+                    mergedLatency.merge(run.latencyHistogram);
+                } else if (run.totalRequests > 0) {
+                    allHistograms = false;
+                }
             }
             
             double avgRps = calculateMean(rpsValues);
@@ -353,79 +1469,905 @@ public:
             double avgP50 = calculateMean(p50Values);
             double avgP90 = calculateMean(p90Values);
             double avgP99 = calculateMean(p99Values);
+            double avgP999 = 0, avgP9999 = 0;
             
             double stdRps = calculateStdDev(rpsValues, avgRps);
+            ConfidenceInterval rpsInterval = meanConfidenceInterval(rpsValues, 1.0 - config.confidenceLevel);
             double stdLatency = calculateStdDev(latencyValues, avgLatency);
             
+            // Percentiles do not average: when every run kept its histogram, report the
+            // percentiles of the merged distribution instead of the mean of per-run values.
+            bool mergedPercentiles = allHistograms && mergedLatency.totalCount() > 0;
+            if (mergedPercentiles) {
+                avgLatency = totalRequests > 0 ? weightedLatency / totalRequests : avgLatency;
+                avgP50 = mergedLatency.valueAtPercentile(50) / 1000.0;
+                avgP90 = mergedLatency.valueAtPercentile(90) / 1000.0;
+                avgP99 = mergedLatency.valueAtPercentile(99) / 1000.0;
+                avgP999 = mergedLatency.valueAtPercentile(99.9) / 1000.0;
+                avgP9999 = mergedLatency.valueAtPercentile(99.99) / 1000.0;
+                maxLatency = mergedLatency.max() / 1000.0;
+            }
+            
             AggregatedResult result;
             result.environment = setup.name;
             result.runtime = setup.runtime;
             result.framework = setup.framework;
+            result.scenario = scenario.name;
+            result.workers = setup.workers;
+            result.restart = setup.restart;
+            result.connections = setup.connections;
+            result.transport = setup.transport;
+            result.runtimeBinary = runtimeExecutable(setup);
+            result.runtimeVersion = setup.version;
+            result.runtimeArgs = setup.runtimeArgs;
+            result.runtimeEnv = setup.runtimeEnv;
+            result.slot = slot.index;
             result.requestsPerSecond = avgRps;
             result.avgLatency = avgLatency;
+            result.maxLatency = maxLatency;
             result.p50Latency = avgP50;
             result.p90Latency = avgP90;
             result.p99Latency = avgP99;
-            result.throughput = totalThroughput / runs.size();
+            result.p999Latency = avgP999;
+            result.p9999Latency = avgP9999;
+            result.mergedPercentiles = mergedPercentiles;
+            result.latencyHistogram = mergedLatency;
+            result.throughput = runs.empty() ? 0.0 : totalThroughput / runs.size();
             result.totalRequests = totalRequests;
             result.errors = totalErrors;
             result.timeouts = totalTimeouts;
             result.stdRps = stdRps;
             result.stdLatency = stdLatency;
+            result.rpsCiLow = rpsInterval.low;
+            result.rpsCiHigh = rpsInterval.high;
             result.runs = runs.size();
             result.rawRuns = runs;
             
-            results.push_back(result);
+            result.loadCurve = loadCurve;
+            result.saturation = saturation;
+            result.steadyState = aggregateSteadyState(runs);
+            result.serverResources = aggregateServerResources(runs, setup.connections);
+            result.serverRuntime = aggregateServerRuntime(runs);
+            result.connectionSetup = aggregateConnectionSetup(runs);
+            result.latencyPhases = aggregateLatencyPhases(runs);
+            result.client = aggregateClientLoad(runs, result.clientBoundRuns);
+            result.startup = aggregateStartup(runs);
+            result.routes = aggregateRoutes(runs);
+            result.network = networkPath(runs);
             
-            std::cout << "\n" << setup.name << " - Average Results (" << runs.size() << " runs):" << std::endl;
-            std::cout << "  Requests/sec: " << std::fixed << std::setprecision(2) << avgRps << " (±" << stdRps << ")" << std::endl;
-            std::cout << "  Avg Latency: " << avgLatency << "ms (±" << stdLatency << ")" << std::endl;
-            std::cout << "  P50 Latency: " << avgP50 << "ms" << std::endl;
-            std::cout << "  P90 Latency: " << avgP90 << "ms" << std::endl;
-            std::cout << "  P99 Latency: " << avgP99 << "ms" << std::endl;
-            std::cout << "  Throughput: " << (result.throughput / 1024 / 1024) << "MB/sec" << std::endl;
-            std::cout << "  Total Requests: " << totalRequests << std::endl;
-            std::cout << "  Total Errors: " << totalErrors << std::endl;
-            std::cout << "  Total Timeouts: " << totalTimeouts << std::endl;
+            {
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                results.push_back(result);
+                storeResult(result);
+            }
+            if (runs.empty()) return;
+            
+            out << "\n" << label << " - Average Results (" << runs.size() << " runs):" << std::endl;
+            out << "  Requests/sec: " << std::fixed << std::setprecision(2) << avgRps << " (±" << stdRps << ")" << std::endl;
+            out << "  Avg Latency: " << avgLatency << "ms (±" << stdLatency << ")" << std::endl;
+            out << "  P50 Latency: " << avgP50 << "ms" << std::endl;
+            out << "  P90 Latency: " << avgP90 << "ms" << std::endl;
+            out << "  P99 Latency: " << avgP99 << "ms" << std::endl;
+            if (mergedPercentiles) {
+                out << "  P99.9 Latency: " << avgP999 << "ms" << std::endl;
+                out << "  P99.99 Latency: " << avgP9999 << "ms" << std::endl;
+                out << "  Max Latency: " << maxLatency << "ms" << std::endl;
+            } else {
+                out << "  (percentiles are means of per-run values; no histograms available)" << std::endl;
+            }
+            out << "  Throughput: " << (result.throughput / 1024 / 1024) << "MB/sec" << std::endl;
+            out << "  Total Requests: " << totalRequests << std::endl;
+            out << "  Total Errors: " << totalErrors << std::endl;
+            out << "  Total Timeouts: " << totalTimeouts << std::endl;
+            if (result.steadyState.valid) {
+                out << "  Steady state: " << result.steadyState.requestsPerSecond << " req/sec, P50 "
+                    << result.steadyState.p50Latency << "ms, P99 " << result.steadyState.p99Latency
+                    << "ms (from " << result.steadyState.startSec << "s)" << std::endl;
+            }
+            printServerResources(out, result.serverResources);
+            printServerRuntime(out, result.serverRuntime);
+            printConnectionSetup(out, result.connectionSetup, setup.transport);
+            printLatencyPhases(out, result.latencyPhases);
+            printClientLoad(out, result.client);
+            if (result.clientBoundRuns > 0) {
+                out << "  Client-bound runs: " << result.clientBoundRuns << " of " << runs.size()
+                    << "; the load generator, not the server, may have set these numbers" << std::endl;
+            }
+            if (result.network.connectRttMs > 0) {
+                out << "  Connect RTT: " << std::setprecision(3) << result.network.connectRttMs << "ms"
+                    << std::setprecision(2) << std::endl;
+            }
+        }
+    }
+    
+    NetworkPath networkPath(const std::vector<BenchmarkResult>& runs) {
+        NetworkPath path;
+        path.mode = config.networkMode;
+        path.profile = config.networkProfile;
+        path.serverAddress = serverHost;
+        path.netemDelayMs = config.netemDelayMs;
+        std::vector<double> rtts;
+        for (const auto& run : runs) {
+            if (run.connectRttMs > 0) rtts.push_back(run.connectRttMs);
+        }
+        path.connectRttMs = calculateMean(rtts);
+        return path;
+    }
+    
+    // Expands config.serverWorkers; 0 stands for 1, 2, 4, ... up to the CPU count
+    // (plus the CPU count itself when it is not a power of two).
+    std::vector<int> workerCounts() const {
+        int cpus = std::max(static_cast<int>(topology.cpus.size()), 1);
+        std::vector<int> counts;
+        for (int count : config.serverWorkers) {
+            if (count > 0) {
+                counts.push_back(count);
+                continue;
+            }
+            for (int n = 1; n <= cpus; n *= 2) counts.push_back(n);
+            counts.push_back(cpus);
+        }
+        if (counts.empty()) counts.push_back(1);
+        std::sort(counts.begin(), counts.end());
+        counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+        return counts;
+    }
+    
+    // Every setup runs once per worker count; multi-worker copies are named after the count.
+    void expandWorkerCounts() {
+        if (config.workerMode != "reuseport" && config.workerMode != "cluster") {
+            throw std::runtime_error("workerMode must be \"reuseport\" or \"cluster\", got \"" + config.workerMode + "\"");
+        }
+        std::vector<int> counts = workerCounts();
+        if (counts.size() == 1 && counts.front() == 1) return;
+        std::vector<Setup> expanded;
+        for (const auto& setup : setups) {
+            for (int count : counts) {
+                Setup copy = setup;
+                copy.workers = count;
+                if (count > 1) copy.name += " x" + std::to_string(count);
+                expanded.push_back(copy);
+            }
+        }
+        setups = expanded;
+    }
+    
+    std::vector<int> connectionAxis() const {
+        return config.connectionCounts.empty() ? std::vector<int>{config.connections} : config.connectionCounts;
+    }
+    
+    std::vector<std::string> transportAxis() const {
+        return config.transports.empty() ? std::vector<std::string>{config.transport} : config.transports;
+    }
+    
+    // The connections and transport of one matrix cell on top of the shared settings.
+    BenchmarkConfig configFor(const Setup& setup) const {
+        BenchmarkConfig cellConfig = config;
+        cellConfig.connections = setup.connections;
+        cellConfig.transport = setup.transport;
+        return cellConfig;
+    }
+    
+    // Every setup runs at each connection count over each transport; when an axis has
+    // more than one value, the copies are named after it ("Hono on Bun c200 h2").
+    void expandMatrixAxes() {
+        std::vector<int> counts = connectionAxis();
+        std::vector<std::string> transports = transportAxis();
+        for (int count : counts) {
+            if (count <= 0) throw std::runtime_error("connections must be positive, got " + std::to_string(count));
+        }
+        for (const auto& name : transports) parseTransport(name);
+        std::vector<Setup> expanded;
+        for (const auto& setup : setups) {
+            for (int count : counts) {
+                for (const auto& name : transports) {
+                    Setup copy = setup;
+                    copy.connections = count;
+                    copy.transport = name;
+                    if (counts.size() > 1) copy.name += " c" + std::to_string(count);
+                    if (transports.size() > 1) copy.name += " " + name;
+                    expanded.push_back(copy);
+                }
+            }
+        }
+        setups = expanded;
+    }
+    
+    // "both" runs every setup twice, as a cold copy (fresh server per run) and a warm one
+    // (one server for all runs), named after the policy.
+    void expandRestartPolicies() {
+        const std::string& policy = config.restartPolicy;
+        if (policy != "per-run" && policy != "per-setup" && policy != "both") {
+            throw std::runtime_error("restartPolicy must be \"per-run\", \"per-setup\" or \"both\", got \"" + policy + "\"");
+        }
+        std::vector<Setup> expanded;
+        for (const auto& setup : setups) {
+            Setup copy = setup;
+            if (policy != "both") {
+                copy.restart = policy;
+                expanded.push_back(copy);
+                continue;
+            }
+            copy.restart = "per-run";
+            copy.name = setup.name + " (cold)";
+            expanded.push_back(copy);
+            copy.restart = "per-setup";
+            copy.name = setup.name + " (warm)";
+            expanded.push_back(copy);
+        }
+        setups = expanded;
+    }
+    
+    // Each multi-worker result against the 1-worker result of the same runtime,
+    // framework and scenario: RPS(N) / (N x RPS(1)).
+    // Two results measure the same cell at different worker counts: everything but the
+    // workers matches, including the runtime variant (binary, version, flags and env).
+    static bool sameScalingCell(const AggregatedResult& a, const AggregatedResult& b) {
+        return a.runtime == b.runtime && a.framework == b.framework && a.scenario == b.scenario &&
+               a.restart == b.restart && a.connections == b.connections && a.transport == b.transport &&
+               a.runtimeBinary == b.runtimeBinary && a.runtimeVersion == b.runtimeVersion &&
+               a.runtimeArgs == b.runtimeArgs && a.runtimeEnv == b.runtimeEnv;
+    }
+    
+    void computeScalingEfficiency() {
+        for (auto& result : results) {
+            result.scalingEfficiency = 0.0;
+            for (const auto& base : results) {
+                if (base.workers == 1 && sameScalingCell(base, result) && base.requestsPerSecond > 0) {
+                    result.scalingEfficiency = result.requestsPerSecond / (result.workers * base.requestsPerSecond);
+                }
+            }
+        }
+    }
+    
+    // setups x scenarios, minus the cells --filter excludes and, with --resume, those
+    // the results store already has from this commit and host with config.runs samples.
+    void buildPlan() {
+        describeCurrentRun(runIdentity);
+        if (!config.resultsStore.empty()) priorHistory = loadResults(config.resultsStore);
+        size_t cells = 0, filtered = 0, resumed = 0;
+        for (const auto& setup : setups) {
+            for (const auto& scenario : scenarios) {
+                cells++;
+                if (!matchesFilters(filters, setup, scenario.name)) {
+                    filtered++;
+                } else if (resume && alreadyRecorded(setup, scenario)) {
+                    resumed++;
+                } else {
+                    plan.push_back({setup, &scenario});
+                }
+            }
+        }
+        std::cout << "- Run plan: " << plan.size() << " of " << cells << " cells";
+        if (filtered > 0) std::cout << ", " << filtered << " filtered out";
+        if (resume) {
+            std::cout << ", " << resumed << " already recorded for commit " << runIdentity.commit.substr(0, 12);
+            if (runIdentity.dirty) std::cout << " (uncommitted changes are not told apart)";
+        }
+        std::cout << std::endl;
+        if (resume && config.resultsStore.empty()) {
+            throw std::runtime_error("--resume needs a resultsStore");
+        }
+    }
+    
+    bool alreadyRecorded(const Setup& setup, const Scenario& scenario) const {
+        std::string key = historyKey(setup.name, scenario.name, setup.transport, setup.connections, setup.restart);
+        return std::any_of(priorHistory.begin(), priorHistory.end(), [&](const StoredResult& record) {
+            return record.key == key && record.host == runIdentity.host && record.commit == runIdentity.commit &&
+                   static_cast<int>(record.rps.size()) >= config.runs;
+        });
+    }
+    
+    void printPlan() {
+        std::cout << "\n=== Run Plan ===" << std::endl;
+        std::cout << std::left << std::setw(6) << "#"
+                  << std::setw(40) << "Setup"
+                  << std::setw(14) << "Scenario"
+                  << std::setw(8) << "Conns"
+                  << std::setw(13) << "Transport"
+                  << std::setw(9) << "Workers"
+                  << "Restart" << std::endl;
+        std::cout << std::string(100, '-') << std::endl;
+        for (size_t i = 0; i < plan.size(); i++) {
+            const Setup& setup = plan[i].setup;
+            std::cout << std::left << std::setw(6) << i + 1
+                      << std::setw(40) << setup.name
+                      << std::setw(14) << plan[i].scenario->name
+                      << std::setw(8) << setup.connections
+                      << std::setw(13) << setup.transport
+                      << std::setw(9) << setup.workers
+                      << setup.restart << std::endl;
+        }
+        std::cout << plan.size() * static_cast<size_t>(std::max(config.runs, 0)) << " measured runs of " << config.duration
+                  << std::endl;
+    }
+    
+    // The scenario is only named when it is not the default single hello-world route.
+    std::string describe(const Setup& setup, const Scenario& scenario) const {
+        if (scenarios.size() <= 1 && scenario.name == "hello") return setup.name;
+        return setup.name + " [" + scenario.name + "]";
+    }
+    
+    Setup offsetSetup(const Setup& setup, const CpuSlot& slot) {
+        Setup shifted = setup;
+        shifted.port += slot.portOffset;
+        return shifted;
+    }
+    
+    // Each slot thread pins itself to its load CPUs and pulls the next setup/scenario
+    // pair off a shared counter. Per-setup output is buffered and printed once the setup ends
+    // so concurrent setups do not interleave their logs.
+    void runParallel() {
+        std::atomic<size_t> next{0};
+        std::mutex outputMutex;
+        std::vector<std::thread> workers;
+        
+        for (const auto& slot : slots) {
+            workers.emplace_back([&, slot]() {
+                if (!pinCurrentThread(slot.loadCpus)) {
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    std::cerr << "Warning: could not pin slot " << slot.index << " to CPUs "
+                              << formatCpuList(slot.loadCpus) << std::endl;
+                }
+                for (size_t i = next++; i < plan.size(); i = next++) {
+                    std::ostringstream log;
+                    log << "\n[slot " << slot.index << "]";
+                    try {
+                        runBenchmark(offsetSetup(plan[i].setup, slot), *plan[i].scenario, slot, log);
+                    } catch (const BenchmarkInterrupted&) {
+                        break;  // rethrown on the main thread once every slot has stopped
+                    }
+                    
+                    std::lock_guard<std::mutex> lock(outputMutex);
+                    std::cout << log.str() << std::flush;
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        throwIfInterrupted();
+    }
+    
+    // Every setup/scenario pair runs once per round, in the same order each round
+    // ("round-robin") or reshuffled ("random"), so slow drift in the host is spread
+    // over all setups instead of landing on whichever happened to run last.
+    void runInterleaved(const CpuSlot& slot) {
+        struct Pending {
+            Setup setup;
+            const Scenario* scenario;
+            std::vector<BenchmarkResult> runs;
+        };
+        std::vector<Pending> pending;
+        for (const auto& cell : plan) {
+            pending.push_back({offsetSetup(cell.setup, slot), cell.scenario, {}});
+        }
+        
+        // A "per-setup" pair keeps one server for all its runs, so it cannot be split across
+        // rounds; instead its whole block runs inside one round, and the blocks are spread
+        // over the rounds.
+        std::mt19937 rng(scheduleSeed);
+        std::vector<size_t> order, warm;
+        for (size_t i = 0; i < pending.size(); i++) {
+            (pending[i].setup.restart == "per-setup" ? warm : order).push_back(i);
+        }
+        if (config.schedule == "random") std::shuffle(warm.begin(), warm.end(), rng);
+        for (int run = 1; run <= config.runs; run++) {
+            if (config.schedule == "random") std::shuffle(order.begin(), order.end(), rng);
+            std::cout << "\n=== Round " << run << "/" << config.runs << " ===" << std::endl;
+            for (size_t i : order) {
+                measureRun(pending[i].setup, *pending[i].scenario, slot, std::cout, run, pending[i].runs);
+            }
+            for (size_t j = run - 1; j < warm.size(); j += config.runs) {
+                measureWarmRuns(pending[warm[j]].setup, *pending[warm[j]].scenario, slot, std::cout, pending[warm[j]].runs);
+            }
+        }
+        for (const auto& entry : pending) {
+            std::cout << "\n=== Finishing " << describe(entry.setup, *entry.scenario) << " ===" << std::endl;
+            finishBenchmark(entry.setup, *entry.scenario, slot, std::cout, entry.runs);
+        }
+    }
+    
+    // Spawns every setup config.coldStarts times, interleaving setups so that host
+    // drift affects them alike. With coldStartSteady each spawn is then loaded until
+    // throughput settles by the adaptive warmup criteria.
+    void runColdStartSuite(const CpuSlot& slot) {
+        std::vector<Setup> targets;
+        for (const auto& cell : plan) {
+            const Setup& setup = cell.setup;
+            // The warm copy of restartPolicy "both" would spawn the same server again.
+            if (config.restartPolicy == "both" && setup.restart != "per-run") continue;
+            bool planned = std::any_of(targets.begin(), targets.end(),
+                                       [&](const Setup& target) { return target.name == setup.name; });
+            if (planned) continue;
+            targets.push_back(offsetSetup(setup, slot));
+            coldStartResults.push_back({setup.name, setup.runtime, setup.framework, {}});
+        }
+        std::cout << "\n=== Cold Start Suite (" << config.coldStarts << " spawns per setup) ===" << std::endl;
+        for (int spawn = 1; spawn <= config.coldStarts; spawn++) {
+            for (size_t i = 0; i < targets.size(); i++) {
+                throwIfInterrupted();
+                ColdStartSample sample = measureColdStart(targets[i], scenarios.front(), slot);
+                coldStartResults[i].samples.push_back(sample);
+                
+                std::cout << "  [" << spawn << "/" << config.coldStarts << "] " << targets[i].name << ": ";
+                if (!sample.ok) {
+                    std::cout << "failed to start" << std::endl;
+                    continue;
+                }
+                std::cout << std::fixed << std::setprecision(1) << "listening " << sample.listenMs
+                          << "ms, first response " << sample.firstResponseMs << "ms";
+                if (config.coldStartSteady) {
+                    std::cout << ", steady ";
+                    if (sample.steadyMs >= 0) std::cout << sample.steadyMs << "ms";
+                    else std::cout << "not reached";
+                }
+                std::cout << std::setprecision(2) << std::endl;
+            }
+        }
+    }
+    
+    // One spawn, timed from just before fork.
+    ColdStartSample measureColdStart(const Setup& setup, const Scenario& scenario, const CpuSlot& slot) {
+        ColdStartSample sample;
+        auto spawned = std::chrono::steady_clock::now();
+        pid_t group = startServer(setup, slot);
+        if (group == -1) return sample;
+        
+        StartupTiming timing;
+        if (waitForServer(setup, group, spawned, timing)) {
+            sample.ok = true;
+            sample.listenMs = timing.listenMs;
+            sample.firstResponseMs = timing.firstResponseMs;
+            sample.firstResponseLatencyMs = timing.firstResponseLatencyMs;
+            if (config.coldStartSteady) {
+                double loadStartMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - spawned).count();
+                std::ostringstream discarded;
+                WarmupOutcome settled = runAdaptiveWarmup(setup, scenario, slot, discarded);
+                if (settled.converged) sample.steadyMs = loadStartMs + settled.settledFromMs;
+            }
+        }
+        stopServer(group);
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.cooldownTime));
+        return sample;
+    }
+    
+    SoakOptions soakOptions() const {
+        SoakOptions options;
+        options.alpha = config.regressionAlpha;
+        options.rssGrowthLimit = config.soakRssGrowthLimit;
+        options.p99GrowthLimit = config.soakP99GrowthLimit;
+        return options;
+    }
+    
+    // One soakDuration run against one server, summarised per soakWindowSec window.
+    // Always uses the local load generator; the window histograms go to the timeline
+    // file rather than memory, and server RSS is read at each window boundary.
+    void runSoak(const Setup& setup, const Scenario& scenario, const CpuSlot& slot) {
+        const std::string label = describe(setup, scenario);
+        std::cout << "\n=== Soak " << label << " for " << config.soakDuration << " ===" << std::endl;
+        SoakResult soak;
+        soak.environment = setup.name;
+        soak.scenario = scenario.name;
+        pid_t serverPid = launchServer(setup, scenario, slot, std::cout);
+        if (serverPid == -1) {
+            soak.serverExited = true;
+            soakResults.push_back(soak);
+            return;
+        }
+        
+        BenchmarkConfig soakConfig = configFor(setup);
+        soakConfig.duration = config.soakDuration;
+        if (!slot.loadCpus.empty()) {
+            soakConfig.threads = std::min(soakConfig.threads, static_cast<int>(slot.loadCpus.size()));
+        }
+        LoadTarget target;
+        target.host = serverHost;
+        target.port = setup.port;
+        target.routes = scenario.routes;
+        LoadGenerator generator(soakConfig, target);
+        
+        std::unique_ptr<TimelineWriter> timeline;
+        std::error_code ec;
+        std::filesystem::create_directories(config.timelineDir, ec);
+        std::string path = timelinePath(label + " soak");
+        timeline = std::make_unique<TimelineWriter>(path, label + " soak", config.soakWindowSec * 1000, config.rate);
+        if (!timeline->ok()) {
+            std::cerr << "Cannot write timeline " << path << std::endl;
+            timeline.reset();
+        }
+        
+        ProcessSampler sampler(serverPid, 1000);
+        sampler.start();
+        generator.setTimelineCallback([&](const TimelineBucket& bucket) {
+            if (timeline) timeline->write(bucket);
+            SoakWindow window;
+            window.startSec = bucket.startSec;
+            window.endSec = bucket.endSec;
+            window.requestsPerSecond = bucket.completed / std::max(bucket.endSec - bucket.startSec, 1e-9);
+            window.p50Latency = bucket.latency->valueAtPercentile(50) / 1000.0;
+            window.p99Latency = bucket.latency->valueAtPercentile(99) / 1000.0;
+            window.p999Latency = bucket.latency->valueAtPercentile(99.9) / 1000.0;
+            window.errors = static_cast<int>(bucket.errors);
+            window.rssMb = sampler.latestRssKb() / 1024.0;
+            soak.windows.push_back(window);
+            std::cout << "  [" << std::fixed << std::setprecision(1) << std::setw(7) << bucket.endSec / 60.0 << "m] "
+                      << std::setprecision(0) << window.requestsPerSecond << " req/s, P99 " << std::setprecision(2)
+                      << window.p99Latency << "ms, RSS " << std::setprecision(1) << window.rssMb << "MB, "
+                      << window.errors << " errors" << std::setprecision(2) << std::endl;
+            if (!serverGroupAlive(serverPid)) {
+                soak.serverExited = true;
+                generator.stop();
+            }
+        }, config.soakWindowSec * 1000);
+        generator.setProgressCallback([&](const LoadProgress& progress) {
+            reportLiveProgress(setup.name, scenario.name, progress);
+        });
+        generator.setSampleArchive(sampleArchivePath(label + " soak"), label + " soak");
+        
+        liveMetrics.beginRun(setup.name, scenario.name, label + " soak");
+        try {
+            soak.sampleFile = generator.run().sampleFile;
+        } catch (const std::exception& e) {
+            std::cerr << "Soak for " << label << " failed: " << e.what() << std::endl;
+        }
+        liveMetrics.endRun(setup.name, scenario.name);
+        sampler.stop();
+        if (soak.serverExited) {
+            std::cerr << "Server for " << label << " exited during the soak" << std::endl;
+        }
+        stopServer(serverPid);
+        throwIfInterrupted();
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.cooldownTime));
+        
+        soak.durationSec = soak.windows.empty() ? 0.0 : soak.windows.back().endSec;
+        analyzeSoak(soak, soakOptions());
+        soakResults.push_back(soak);
+    }
+    
+    // Scales each run by median host speed / host speed just before it, so a run
+    // measured while the host was 5% slow counts 5% higher. This only corrects
+    // CPU- and memory-bound drift, so the raw numbers stay the headline results.
+    void applyDriftCorrection() {
+        std::vector<double> speeds;
+        for (const auto& result : results) {
+            for (const auto& run : result.rawRuns) {
+                if (run.hostSpeed > 0) speeds.push_back(run.hostSpeed);
+            }
+        }
+        if (speeds.empty()) return;
+        std::sort(speeds.begin(), speeds.end());
+        size_t middle = speeds.size() / 2;
+        medianHostSpeed = speeds.size() % 2 == 1 ? speeds[middle] : (speeds[middle - 1] + speeds[middle]) / 2.0;
+        minHostSpeed = speeds.front();
+        maxHostSpeed = speeds.back();
+        
+        for (auto& result : results) {
+            double sum = 0.0;
+            int count = 0;
+            for (auto& run : result.rawRuns) {
+                if (run.hostSpeed <= 0) continue;
+                run.driftFactor = medianHostSpeed / run.hostSpeed;
+                sum += run.requestsPerSecond * run.driftFactor;
+                count++;
+            }
+            result.driftCorrectedRps = count > 0 ? sum / count : 0.0;
+        }
+    }
+    
+    // Records the host's network sysctls, applies networkProfile and, in "netns" mode,
+    // creates the namespace the servers run in. The destructor undoes both.
+    void prepareNetwork() {
+        if (config.networkMode != "loopback" && config.networkMode != "netns") {
+            throw std::runtime_error("networkMode must be \"loopback\" or \"netns\", got \"" + config.networkMode + "\"");
+        }
+        if (config.networkMode == "netns" && !config.agents.empty()) {
+            throw std::runtime_error("networkMode \"netns\" runs the load here and cannot be combined with agents");
+        }
+        if (!config.sampleArchiveDir.empty() && !config.agents.empty()) {
+            throw std::runtime_error("sampleArchiveDir archives requests sent from this host and cannot be combined with agents");
+        }
+        if (config.netemDelayMs > 0 && config.networkMode != "netns") {
+            throw std::runtime_error("netemDelayMs needs networkMode \"netns\"");
+        }
+        if (!config.networkProfile.empty()) changedSysctls = applyNetworkProfile(config.networkProfile);
+        hostSysctls = readNetworkSysctls();
+        if (config.networkMode == "netns") {
+            // A fixed name, so a namespace left behind by a killed run is replaced rather than piling up;
+            // concurrent invocations would collide on the server ports anyway.
+            networkNamespace = std::make_unique<NetworkNamespace>("benchwrk", config.netemDelayMs);
+            // Most TCP sysctls are per namespace, and the servers' listen backlog is set by the one they run in.
+            if (!config.networkProfile.empty()) applyNetworkProfile(config.networkProfile, networkNamespace->name());
+            serverSysctls = readNetworkSysctls(networkNamespace->name());
+            serverHost = networkNamespace->serverAddress();
+        }
+        if (!config.serverAddress.empty()) serverHost = config.serverAddress;
+        
+        std::cout << "- Network: " << config.networkMode;
+        if (networkNamespace) {
+            std::cout << " (namespace " << networkNamespace->name() << " behind a veth pair, netem RTT "
+                      << config.netemDelayMs << "ms)";
+        }
+        std::cout << ", servers at " << serverHost << ", profile "
+                  << (config.networkProfile.empty() ? "none (host as found)" : config.networkProfile);
+        std::cout << std::endl;
+        for (const auto& current : hostSysctls) {
+            for (const auto& previous : changedSysctls) {
+                if (previous.name != current.name) continue;
+                std::cout << "    " << current.name << " = " << current.value << " (was " << previous.value << ")" << std::endl;
+            }
+        }
+    }
+    
+    // Closed-loop HTTP/1.1 from the native generator to the in-process echo server,
+    // with the configured threads and the largest connection count: how fast this
+    // host's harness can go at all, before any real server is involved.
+    void measureHarnessCeiling() {
+        if (config.harnessCheckMs <= 0 || config.loadGenerator != "native" || !config.agents.empty()) return;
+        BenchmarkConfig checkConfig = config;
+        checkConfig.duration = std::to_string(config.harnessCheckMs) + "ms";
+        std::vector<int> counts = connectionAxis();
+        checkConfig.connections = *std::max_element(counts.begin(), counts.end());
+        checkConfig.transport = "http1";
+        checkConfig.rate = 0;
+        checkConfig.rateProfile.clear();
+        try {
+            int echoThreads = std::min(std::max(config.threads, 1),
+                                       static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+            EchoServer echo(echoThreads);
+            LoadTarget target;
+            target.host = "127.0.0.1";
+            target.port = echo.port();
+            LoadGenerator generator(checkConfig, target);
+            BenchmarkResult result = generator.run();
+            throwIfInterrupted();
+            if (result.totalRequests == 0 || result.errors > 0) {
+                throw std::runtime_error(std::to_string(result.errors) + " errors in " +
+                                         std::to_string(result.totalRequests) + " requests");
+            }
+            harnessCeiling.valid = true;
+            harnessCeiling.requestsPerSecond = result.requestsPerSecond;
+            harnessCeiling.p99Latency = result.p99Latency;
+            harnessCeiling.connections = checkConfig.connections;
+            harnessCeiling.threads = result.client.threads;
+            harnessCeiling.busiestThread = result.client.busiestThread;
+            std::cout << "- Harness ceiling: " << std::fixed << std::setprecision(0) << result.requestsPerSecond
+                      << " req/sec against the built-in echo server (" << harnessCeiling.connections << " connections, "
+                      << harnessCeiling.threads << " threads, busiest " << harnessCeiling.busiestThread * 100 << "% CPU"
+                      << (harnessCeiling.busiestThread < config.clientCpuLimit ? "; the echo server or the host set it"
+                                                                               : "")
+                      << ")" << std::setprecision(2) << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: harness self-check failed: " << e.what() << std::endl;
         }
     }
     
     void runAllBenchmarks() {
-        std::cout << "Starting WRK-based Framework Benchmark (C++)\n" << std::endl;
+        std::cout << "Starting Framework Benchmark (C++)\n" << std::endl;
         std::cout << "Configuration:" << std::endl;
-        std::cout << "- Connections: " << config.connections << std::endl;
+        std::cout << "- Load generator: " << config.loadGenerator << std::endl;
+        std::cout << "- Connections:";
+        for (int count : connectionAxis()) std::cout << " " << count;
+        std::cout << std::endl;
         std::cout << "- Threads: " << config.threads << std::endl;
         std::cout << "- Duration: " << config.duration << std::endl;
         std::cout << "- Timeout: " << config.timeout << std::endl;
         std::cout << "- Runs per setup: " << config.runs << std::endl;
-        std::cout << "- Warmup time: " << config.warmupTime << "ms" << std::endl;
+        scenarios.clear();
+        for (const auto& name : config.scenarios) {
+            scenarios.push_back(findScenario(name));
+        }
+        if (scenarios.empty()) {
+            scenarios.push_back(findScenario("hello"));
+        }
+        std::cout << "- Scenarios:";
+        for (const auto& scenario : scenarios) {
+            std::cout << " " << scenario.name;
+        }
+        std::cout << std::endl;
+        bool anyTls = false, anyH2 = false;
+        for (const auto& name : transportAxis()) {
+            TransportMode mode = parseTransport(name);
+            if (config.loadGenerator == "wrk" && (mode.h2 || mode.closeEach)) {
+                throw std::runtime_error("wrk only supports the http1 and https transports, not " + name);
+            }
+            anyTls = anyTls || mode.tls;
+            anyH2 = anyH2 || mode.h2;
+        }
+        if (config.schedule != "sequential" && config.schedule != "round-robin" && config.schedule != "random") {
+            throw std::runtime_error("schedule must be \"sequential\", \"round-robin\" or \"random\", got \"" +
+                                     config.schedule + "\"");
+        }
+        if (!(config.confidenceLevel > 0 && config.confidenceLevel < 1)) {
+            throw std::runtime_error("confidenceLevel must be between 0 and 1, got " + std::to_string(config.confidenceLevel));
+        }
+        scheduleSeed = config.scheduleSeed != 0 ? config.scheduleSeed : std::random_device{}();
+        std::cout << "- Schedule: " << config.schedule;
+        if (config.schedule == "random") std::cout << " (seed " << scheduleSeed << ")";
+        if (config.calibrationMs > 0) std::cout << ", " << config.calibrationMs << "ms host calibration before each run";
+        std::cout << std::endl;
+        std::cout << "- Transport:";
+        for (const auto& name : transportAxis()) std::cout << " " << name;
+        if (anyH2) std::cout << ", " << config.h2Streams << " streams per connection";
+        if (anyTls) std::cout << ", TLS session resumption " << (config.tlsSessionResumption ? "on" : "off");
+        std::cout << std::endl;
+        if (config.adaptiveWarmup) {
+            std::cout << "- Warmup: adaptive, until CoV of req/s <= " << config.warmupCovThreshold << " and P99 <= "
+                      << config.warmupP99CovThreshold << " over " << config.warmupWindows << "x"
+                      << config.warmupWindowMs << "ms (max " << config.warmupMaxTime << "ms)" << std::endl;
+        } else {
+            std::cout << "- Warmup time: " << config.warmupTime << "ms" << std::endl;
+        }
         std::cout << "- Cooldown time: " << config.cooldownTime << "ms" << std::endl;
         std::cout << "- Latency statistics: " << (config.latencyStats ? "true" : "false") << std::endl;
+        bool poisson = isPoissonArrival(config.arrivalProcess);
+        if (config.loadGenerator == "wrk" && (poisson || !config.rateProfile.empty())) {
+            throw std::runtime_error("wrk paces at a constant rate; rateProfile and Poisson arrivals need the native generator");
+        }
+        if (config.rate > 0) {
+            // Parsed up front so a bad profile or a missing trace fails before any server starts.
+            buildRateProfile(config.rateProfile, config.rate, parseDurationMs(config.duration) / 1000.0);
+            std::cout << "- Target rate: " << config.rate << " req/sec";
+            if (config.rateProfile.empty()) {
+                std::cout << " (constant throughput)";
+            } else {
+                std::cout << " shaped by " << config.rateProfile;
+            }
+            std::cout << std::endl;
+        } else if (!config.rateProfile.empty()) {
+            throw std::runtime_error("rateProfile needs a target rate");
+        }
+        if (poisson) std::cout << "- Arrivals: Poisson (seed " << config.arrivalSeed << ")" << std::endl;
+        if (config.timelineIntervalMs > 0) {
+            std::cout << "- Timeline: " << config.timelineIntervalMs << "ms buckets in " << config.timelineDir << "/" << std::endl;
+        }
+        if (!config.sampleArchiveDir.empty()) {
+            std::cout << "- Sample archive: every request of measured native runs in " << config.sampleArchiveDir << "/"
+                      << std::endl;
+        }
+        if (!config.offeredLoads.empty()) {
+            std::cout << "- Offered load levels: " << config.offeredLoads.size() << std::endl;
+        }
+        if (!config.agents.empty()) {
+            std::cout << "- Load generator agents: " << config.agents.size() << " (target host " << config.targetHost << ")" << std::endl;
+            for (const auto& agent : config.agents) {
+                std::cout << "    " << agent << std::endl;
+            }
+        }
+        if (config.saturationSearch) {
+            std::cout << "- Saturation search: P99 <= " << config.sloP99Ms << "ms, errors <= "
+                      << (config.maxErrorRate * 100) << "%, " << config.searchDuration << " probes" << std::endl;
+        }
         
-        // Get versions
-        std::cout << "\n=== Runtime Versions ===" << std::endl;
-        try {
-            std::cout << "Node.js: " << executeCommand("node --version") << std::endl;
-        } catch (...) {
-            std::cout << "Node.js: Not available" << std::endl;
+        topology = detectCpuTopology();
+        expandWorkerCounts();
+        expandMatrixAxes();
+        expandRestartPolicies();
+        buildPlan();
+        if (planOnly) {
+            printPlan();
+            return;
+        }
+        if (plan.empty()) {
+            std::cout << "\nNothing to run" << std::endl;
+            return;
+        }
+        prepareNetwork();
+        if (anyTls) {
+            prepareTlsCertificate();
+            std::cout << "- TLS certificate: " << tlsCertPath << std::endl;
+        }
+        if (config.metricsPort > 0) {
+            metricsServer = std::make_unique<MetricsServer>(liveMetrics, config.metricsPort);
+            std::cout << "- Live metrics: http://0.0.0.0:" << config.metricsPort << "/metrics" << std::endl;
+        }
+        if (!config.soakDuration.empty()) {
+            if (parseDurationMs(config.soakDuration) < 1000LL * config.soakWindowSec || config.soakWindowSec <= 0) {
+                throw std::runtime_error("soakDuration must cover at least one soakWindowSec window");
+            }
+            std::cout << "- Soak: " << config.soakDuration << " per setup in " << config.soakWindowSec
+                      << "s windows, flag RSS > " << config.soakRssGrowthLimit * 100 << "%/h or P99 > "
+                      << config.soakP99GrowthLimit * 100 << "%/h" << std::endl;
+        }
+        if (!config.profileMode.empty()) {
+            if (config.profileMode != "perf" && config.profileMode != "cpu-prof") {
+                throw std::runtime_error("profileMode must be \"perf\" or \"cpu-prof\", got \"" + config.profileMode + "\"");
+            }
+            if (config.profileMode == "perf" && !perfAvailable()) {
+                throw std::runtime_error("profileMode \"perf\" needs perf (linux-tools) on PATH");
+            }
+            for (const auto& cell : plan) {
+                if (config.profileMode == "cpu-prof" && cell.setup.runtime != "node") {
+                    throw std::runtime_error("profileMode \"cpu-prof\" needs Node.js, but " + cell.setup.name +
+                                             " runs on " + cell.setup.runtime + "; use \"perf\" or --filter runtime=node");
+                }
+            }
+            std::cout << "- Profiling: " << config.profileMode << ", one extra " << config.profileDuration
+                      << " window per setup after its measured runs, into " << config.profileDir << "/" << std::endl;
+        }
+        if (config.instrumentIntervalMs > 0) {
+            std::cout << "- Server runtime instrumentation: every " << config.instrumentIntervalMs << "ms via "
+                      << config.instrumentDir << std::endl;
+        }
+        if (config.coldStarts > 0) {
+            std::cout << "- Cold start suite: " << config.coldStarts << " spawns per setup"
+                      << (config.coldStartSteady ? ", each loaded until throughput settles" : "") << std::endl;
+        }
+        if (config.restartPolicy != "per-run") {
+            std::cout << "- Restart policy: " << config.restartPolicy;
+            if (config.restartPolicy == "both") std::cout << " (cold: fresh server per run, warm: one server per setup)";
+            std::cout << std::endl;
+        }
+        if (setups.size() > 0 && setups.back().workers > 1) {
+            std::cout << "- Server workers: " << (config.workerMode == "cluster" ? "node:cluster" : "SO_REUSEPORT processes")
+                      << ", counts";
+            for (int count : workerCounts()) std::cout << " " << count;
+            std::cout << std::endl;
+        }
+        if (config.parallelSlots > 1 && !config.agents.empty()) {
+            std::cout << "- Parallel slots disabled: agents serve one coordinator at a time" << std::endl;
+        } else if (config.parallelSlots > 1) {
+            slots = partitionCpuSlots(topology,
+                                      std::min(config.parallelSlots, static_cast<int>(plan.size())),
+                                      config.portStride);
+        }
+        std::cout << "- CPU topology: " << topology.cpus.size() << " CPUs (" << formatCpuList(topology.cpus)
+                  << "), " << topology.numaNodes << " NUMA node(s)" << std::endl;
+        if (slots.size() > 1) {
+            std::cout << "- Parallel slots: " << slots.size() << std::endl;
+            for (const auto& slot : slots) {
+                std::cout << "    slot " << slot.index << ": node " << slot.numaNode
+                          << ", server CPUs " << formatCpuList(slot.serverCpus)
+                          << ", load CPUs " << formatCpuList(slot.loadCpus)
+                          << ", port offset +" << slot.portOffset << std::endl;
+            }
         }
         
-        try {
-            std::cout << "Bun: " << executeCommand("bun --version") << std::endl;
-        } catch (...) {
-            std::cout << "Bun: Not available" << std::endl;
+        detectRuntimeVersions();
+        runIdentity.nodeVersion = nodeVersion;
+        runIdentity.bunVersion = bunVersion;
+        
+        if (config.loadGenerator == "wrk") {
+            try {
+                std::cout << "WRK: " << executeCommand("wrk --version 2>&1 | head -1") << std::endl;
+            } catch (...) {
+                std::cout << "WRK: Not available" << std::endl;
+            }
         }
         
-        try {
-            std::cout << "WRK: " << executeCommand("wrk --version 2>&1 | head -1") << std::endl;
-        } catch (...) {
-            std::cout << "WRK: Not available" << std::endl;
+        measureHarnessCeiling();
+        
+        if (config.coldStarts > 0) {
+            runColdStartSuite(slots.empty() ? CpuSlot{} : slots.front());
         }
         
-        for (const auto& setup : setups) {
-            runBenchmark(setup);
+        if (slots.size() <= 1) {
+            CpuSlot slot = slots.empty() ? CpuSlot{} : slots.front();
+            if (config.schedule == "sequential") {
+                for (const auto& cell : plan) {
+                    runBenchmark(offsetSetup(cell.setup, slot), *cell.scenario, slot, std::cout);
+                }
+            } else {
+                runInterleaved(slot);
+            }
+        } else {
+            if (config.schedule != "sequential") {
+                std::cout << "Note: parallel slots run each setup's runs back to back; schedule \""
+                          << config.schedule << "\" only applies with parallelSlots = 1" << std::endl;
+            }
+            runParallel();
         }
         
+        if (!config.soakDuration.empty()) {
+            CpuSlot slot = slots.empty() ? CpuSlot{} : slots.front();
+            for (const auto& cell : plan) {
+                // The warm copy of restartPolicy "both" is the same kind of long-lived server.
+                if (config.restartPolicy == "both" && cell.setup.restart != "per-run") continue;
+                runSoak(offsetSetup(cell.setup, slot), *cell.scenario, slot);
+            }
+        }
+        
+        if (config.calibrationMs > 0) applyDriftCorrection();
         generateReport();
     }
     
@@ -438,63 +2380,832 @@ public:
                       return a.requestsPerSecond > b.requestsPerSecond;
                   });
         
-        std::cout << "\nRanking by Requests/Second:" << std::endl;
-        for (size_t i = 0; i < results.size(); i++) {
-            const auto& result = results[i];
-            std::cout << (i + 1) << ". " << result.environment << ": " 
-                      << std::fixed << std::setprecision(2) << result.requestsPerSecond 
-                      << " req/sec (±" << result.stdRps << ")" << std::endl;
-        }
-        
-        std::cout << "\nDetailed Comparison:" << std::endl;
-        std::cout << std::left << std::setw(30) << "Environment" 
-                  << std::setw(12) << "Req/sec" 
-                  << std::setw(12) << "Avg Lat(ms)" 
-                  << std::setw(12) << "P90 Lat(ms)" 
-                  << std::setw(12) << "P99 Lat(ms)" 
-                  << std::setw(16) << "Throughput(MB/s)" 
-                  << "Errors" << std::endl;
-        std::cout << std::string(120, '-') << std::endl;
+        // Rankings only compare setups within the same scenario.
+        for (const auto& scenario : scenarios) {
+            std::string suffix = scenarios.size() > 1 ? " [" + scenario.name + "]" : "";
+            std::cout << "\nRanking by Requests/Second" << suffix << ":" << std::endl;
+            int rank = 0;
+            for (const auto& result : results) {
+                if (result.scenario != scenario.name) continue;
+                std::cout << (++rank) << ". " << result.environment << ": " 
+                          << std::fixed << std::setprecision(2) << result.requestsPerSecond 
+                          << " req/sec (±" << result.stdRps;
+                if (result.runs > 1) {
+                    std::cout << ", " << std::setprecision(0) << config.confidenceLevel * 100 << "% CI "
+                              << std::setprecision(2) << result.rpsCiLow << "-" << result.rpsCiHigh;
+                }
+                std::cout << ")" << std::endl;
+            }
+            
+            std::cout << "\nDetailed Comparison" << suffix << ":" << std::endl;
+            std::cout << std::left << std::setw(30) << "Environment" 
+                      << std::setw(12) << "Req/sec" 
+                      << std::setw(12) << "Avg Lat(ms)" 
+                      << std::setw(12) << "P90 Lat(ms)" 
+                      << std::setw(12) << "P99 Lat(ms)" 
+                      << std::setw(16) << "Throughput(MB/s)" 
+                      << "Errors" << std::endl;
+            std::cout << std::string(120, '-') << std::endl;
+            
+            for (const auto& result : results) {
+                if (result.scenario != scenario.name) continue;
+                double throughputMB = result.throughput / 1024 / 1024;
+                std::cout << std::left << std::setw(30) << result.environment
+                          << std::setw(12) << std::fixed << std::setprecision(2) << result.requestsPerSecond
+                          << std::setw(12) << result.avgLatency
+                          << std::setw(12) << result.p90Latency
+                          << std::setw(12) << result.p99Latency
+                          << std::setw(16) << throughputMB
+                          << result.errors << std::endl;
+            }
+        }
+        
+        // Per-route latency for multi-route scenarios
+        for (const auto& result : results) {
+            if (result.routes.empty()) continue;
+            std::cout << "\nPer-Route Latency - " << result.environment << " [" << result.scenario << "]:" << std::endl;
+            printRoutes(result.routes);
+        }
         
+        // Latency vs offered load
         for (const auto& result : results) {
-            double throughputMB = result.throughput / 1024 / 1024;
-            std::cout << std::left << std::setw(30) << result.environment
-                      << std::setw(12) << std::fixed << std::setprecision(2) << result.requestsPerSecond
-                      << std::setw(12) << result.avgLatency
-                      << std::setw(12) << result.p90Latency
-                      << std::setw(12) << result.p99Latency
-                      << std::setw(16) << throughputMB
-                      << result.errors << std::endl;
+            if (result.loadCurve.empty()) continue;
+            std::cout << "\nLatency vs Offered Load - " << reportLabel(result) << ":" << std::endl;
+            printLoadCurve(result.loadCurve, false);
+        }
+        
+        // Saturation search
+        bool anySaturation = std::any_of(results.begin(), results.end(),
+                                         [](const AggregatedResult& r) { return !r.saturation.curve.empty(); });
+        if (anySaturation) {
+            std::cout << "\nMax Sustainable RPS at SLO (P99 <= " << std::fixed << std::setprecision(2)
+                      << config.sloP99Ms << "ms, errors <= " << (config.maxErrorRate * 100) << "%):" << std::endl;
+            std::cout << std::left << std::setw(30) << "Environment"
+                      << std::setw(14) << "Max RPS"
+                      << std::setw(14) << "Offered(r/s)"
+                      << "P99(ms)" << std::endl;
+            std::cout << std::string(70, '-') << std::endl;
+            for (const auto& result : results) {
+                if (result.saturation.curve.empty()) continue;
+                std::cout << std::left << std::setw(30) << reportLabel(result)
+                          << std::setw(14) << result.saturation.maxRpsAtSlo
+                          << std::setw(14) << result.saturation.offeredAtMax
+                          << result.saturation.p99AtMax << std::endl;
+            }
+            for (const auto& result : results) {
+                if (result.saturation.curve.empty()) continue;
+                std::cout << "\nSaturation Probes - " << reportLabel(result) << ":" << std::endl;
+                printLoadCurve(result.saturation.curve, true);
+            }
+        }
+        
+        // Multi-core scaling
+        computeScalingEfficiency();
+        bool anyScaling = std::any_of(results.begin(), results.end(),
+                                      [](const AggregatedResult& r) { return r.workers > 1; });
+        if (anyScaling) {
+            std::vector<const AggregatedResult*> bases;
+            for (const auto& result : results) {
+                if (result.workers == 1) bases.push_back(&result);
+            }
+            std::sort(bases.begin(), bases.end(), [](const AggregatedResult* a, const AggregatedResult* b) {
+                return a->environment < b->environment;
+            });
+            std::cout << "\nScaling Efficiency (RPS at N workers / (N x 1-worker RPS)):" << std::endl;
+            std::cout << std::left << std::setw(34) << "Environment"
+                      << std::setw(10) << "Workers"
+                      << std::setw(14) << "Req/sec"
+                      << std::setw(10) << "Speedup"
+                      << "Efficiency" << std::endl;
+            std::cout << std::string(80, '-') << std::endl;
+            for (const AggregatedResult* base : bases) {
+                std::vector<const AggregatedResult*> rows;
+                for (const auto& result : results) {
+                    if (sameScalingCell(result, *base)) rows.push_back(&result);
+                }
+                std::sort(rows.begin(), rows.end(), [](const AggregatedResult* a, const AggregatedResult* b) {
+                    return a->workers < b->workers;
+                });
+                for (const AggregatedResult* row : rows) {
+                    std::ostringstream efficiency;
+                    efficiency << std::fixed << std::setprecision(1) << row->scalingEfficiency * 100 << "%";
+                    std::cout << std::left << std::setw(34) << (row == rows.front() ? reportLabel(*base) : "")
+                              << std::setw(10) << row->workers
+                              << std::setw(14) << std::fixed << std::setprecision(2) << row->requestsPerSecond
+                              << std::setw(10) << row->scalingEfficiency * row->workers
+                              << efficiency.str() << std::endl;
+                }
+            }
+        }
+        
+        // Host drift measured by the calibration workload
+        if (medianHostSpeed > 0) {
+            std::cout << "\nHost Drift (" << config.calibrationMs << "ms calibration before each run, "
+                      << config.schedule << " schedule):" << std::endl;
+            std::cout << "Host speed " << std::fixed << std::setprecision(0) << medianHostSpeed
+                      << " units/sec median, range " << std::showpos << std::setprecision(1)
+                      << (minHostSpeed / medianHostSpeed - 1) * 100 << "% to "
+                      << (maxHostSpeed / medianHostSpeed - 1) * 100 << "%" << std::noshowpos << std::endl;
+            std::cout << std::left << std::setw(30) << "Environment"
+                      << std::setw(14) << "Req/sec"
+                      << std::setw(16) << "Drift-corrected"
+                      << std::setw(10) << "Change"
+                      << "Schedule positions" << std::endl;
+            std::cout << std::string(100, '-') << std::endl;
+            for (const auto& result : results) {
+                if (result.driftCorrectedRps <= 0) continue;
+                std::ostringstream positions;
+                for (size_t r = 0; r < result.rawRuns.size(); r++) {
+                    positions << (r > 0 ? "," : "") << result.rawRuns[r].sequence;
+                }
+                std::ostringstream change;
+                change << std::showpos << std::fixed << std::setprecision(1)
+                       << (result.driftCorrectedRps / result.requestsPerSecond - 1) * 100 << "%";
+                std::cout << std::left << std::setw(30) << reportLabel(result)
+                          << std::setw(14) << std::setprecision(2) << result.requestsPerSecond
+                          << std::setw(16) << result.driftCorrectedRps
+                          << std::setw(10) << change.str()
+                          << positions.str() << std::endl;
+            }
+        }
+        
+        // What the load crossed on its way to the server, when it was more than loopback
+        if (config.networkMode != "loopback" || !config.serverAddress.empty()) {
+            std::cout << "\nNetwork Path (" << config.networkMode << ", servers at " << serverHost;
+            if (config.networkMode == "netns") std::cout << ", netem RTT " << config.netemDelayMs << "ms";
+            std::cout << ", profile " << (config.networkProfile.empty() ? "none" : config.networkProfile) << "):" << std::endl;
+            std::cout << std::left << std::setw(30) << "Environment"
+                      << std::setw(16) << "Connect RTT(ms)"
+                      << std::setw(14) << "Req/sec"
+                      << std::setw(12) << "P50(ms)"
+                      << "P99(ms)" << std::endl;
+            std::cout << std::string(84, '-') << std::endl;
+            for (const auto& result : results) {
+                std::cout << std::left << std::setw(30) << reportLabel(result)
+                          << std::setw(16) << std::fixed << std::setprecision(3) << result.network.connectRttMs
+                          << std::setw(14) << std::setprecision(2) << result.requestsPerSecond
+                          << std::setw(12) << result.p50Latency
+                          << result.p99Latency << std::endl;
+            }
+        }
+        
+        // Cold (fresh server per run) against warm (one server for every run) copies
+        if (config.restartPolicy == "both") {
+            std::cout << "\nCold vs Warm Servers (warm = one server for all " << config.runs << " runs):" << std::endl;
+            std::cout << std::left << std::setw(30) << "Environment"
+                      << std::setw(12) << "Cold rps"
+                      << std::setw(12) << "Warm rps"
+                      << std::setw(10) << "Change"
+                      << std::setw(12) << "Cold P99"
+                      << std::setw(12) << "Warm P99"
+                      << std::setw(10) << "Change"
+                      << "Warm last/first" << std::endl;
+            std::cout << std::string(110, '-') << std::endl;
+            auto percent = [](double value) {
+                std::ostringstream text;
+                text << std::showpos << std::fixed << std::setprecision(1) << value * 100 << "%";
+                return text.str();
+            };
+            const std::string coldSuffix = " (cold)";
+            for (const auto& cold : results) {
+                if (cold.restart != "per-run" || cold.rawRuns.empty()) continue;
+                std::string base = cold.environment.substr(0, cold.environment.size() - coldSuffix.size());
+                for (const auto& warm : results) {
+                    if (warm.environment != base + " (warm)" || warm.scenario != cold.scenario || warm.rawRuns.empty()) {
+                        continue;
+                    }
+                    // Throughput of the last window on the warm server relative to its first
+                    // shows whether the process keeps getting faster (JIT) or slower (leaks).
+                    double first = warm.rawRuns.front().requestsPerSecond;
+                    double last = warm.rawRuns.back().requestsPerSecond;
+                    std::string label = scenarios.size() <= 1 && cold.scenario == "hello"
+                                            ? base : base + " [" + cold.scenario + "]";
+                    std::cout << std::left << std::setw(30) << label
+                              << std::setw(12) << std::fixed << std::setprecision(2) << cold.requestsPerSecond
+                              << std::setw(12) << warm.requestsPerSecond
+                              << std::setw(10) << percent(warm.requestsPerSecond / cold.requestsPerSecond - 1)
+                              << std::setw(12) << cold.p99Latency
+                              << std::setw(12) << warm.p99Latency
+                              << std::setw(10) << (cold.p99Latency > 0 ? percent(warm.p99Latency / cold.p99Latency - 1) : "-")
+                              << (first > 0 && warm.rawRuns.size() > 1 ? percent(last / first - 1) : "-") << std::endl;
+                }
+            }
+        }
+        
+        // Spawn to listening and to the first successful response, per server start
+        bool anyStartup = std::any_of(results.begin(), results.end(),
+                                      [](const AggregatedResult& r) { return r.startup.valid; });
+        if (anyStartup) {
+            std::cout << "\nServer Startup (from spawn, mean over measured runs):" << std::endl;
+            std::cout << std::left << std::setw(30) << "Environment"
+                      << std::setw(10) << "Runtime"
+                      << std::setw(14) << "Listen (ms)"
+                      << std::setw(16) << "First OK (ms)"
+                      << std::setw(18) << "Min-Max (ms)"
+                      << std::setw(16) << "First req (ms)"
+                      << "Starts" << std::endl;
+            std::cout << std::string(110, '-') << std::endl;
+            for (const auto& result : results) {
+                if (!result.startup.valid) continue;
+                double fastest = 0, slowest = 0;
+                int starts = 0;
+                for (const auto& run : result.rawRuns) {
+                    if (!run.startup.valid) continue;
+                    fastest = starts == 0 ? run.startup.firstResponseMs : std::min(fastest, run.startup.firstResponseMs);
+                    slowest = std::max(slowest, run.startup.firstResponseMs);
+                    starts++;
+                }
+                std::ostringstream range;
+                range << std::fixed << std::setprecision(1) << fastest << "-" << slowest;
+                std::cout << std::left << std::setw(30) << reportLabel(result)
+                          << std::setw(10) << result.runtime
+                          << std::setw(14) << std::fixed << std::setprecision(1) << result.startup.listenMs
+                          << std::setw(16) << result.startup.firstResponseMs
+                          << std::setw(18) << range.str()
+                          << std::setw(16) << std::setprecision(2) << result.startup.firstResponseLatencyMs
+                          << starts << std::endl;
+            }
+        }
+        
+        printColdStartReport(std::cout, coldStartResults);
+        printSoakReport(std::cout, soakResults, soakOptions());
+        printProfileReport(std::cout, profileResults);
+        
+        // Connection setup cost (TLS handshakes, new connection per request)
+        auto measuresSetup = [](const AggregatedResult& r) {
+            TransportMode mode = parseTransport(r.transport);
+            return r.connectionSetup.valid && (mode.tls || mode.closeEach);
+        };
+        if (std::any_of(results.begin(), results.end(), measuresSetup)) {
+            std::cout << "\nConnection Setup (";
+            if (transportAxis().size() == 1) std::cout << config.transport << ", ";
+            std::cout << "per run):" << std::endl;
+            std::cout << std::left << std::setw(30) << "Environment"
+                      << std::setw(14) << "Connections"
+                      << std::setw(14) << "Conns/sec"
+                      << std::setw(12) << "Avg (ms)"
+                      << std::setw(12) << "P50 (ms)"
+                      << std::setw(12) << "P99 (ms)"
+                      << "TLS resumed" << std::endl;
+            std::cout << std::string(110, '-') << std::endl;
+            double durationSec = parseDurationMs(config.duration) / 1000.0;
+            for (const auto& result : results) {
+                const ConnectionStats& stats = result.connectionSetup;
+                if (!measuresSetup(result)) continue;
+                std::ostringstream resumed;
+                if (stats.tlsHandshakes > 0) {
+                    resumed << std::fixed << std::setprecision(1) << 100.0 * stats.tlsResumed / stats.tlsHandshakes << "%";
+                } else {
+                    resumed << "-";
+                }
+                std::cout << std::left << std::setw(30) << reportLabel(result)
+                          << std::setw(14) << stats.opened
+                          << std::setw(14) << std::fixed << std::setprecision(0) << stats.opened / durationSec
+                          << std::setw(12) << std::setprecision(3) << stats.avgSetupMs
+                          << std::setw(12) << stats.p50SetupMs
+                          << std::setw(12) << stats.p99SetupMs
+                          << resumed.str() << std::endl;
+            }
+        }
+        
+        // Server resource efficiency
+        bool anyResources = std::any_of(results.begin(), results.end(),
+                                        [](const AggregatedResult& r) { return r.serverResources.valid; });
+        if (anyResources) {
+            std::cout << "\nServer Resource Efficiency:" << std::endl;
+            std::cout << std::left << std::setw(30) << "Environment"
+                      << std::setw(12) << "CPU cores"
+                      << std::setw(14) << "Req/CPU-s"
+                      << std::setw(12) << "Max RSS MB"
+                      << std::setw(14) << "RSS/conn KB"
+                      << std::setw(18) << "Ctx vol/invol"
+                      << "Threads" << std::endl;
+            std::cout << std::string(110, '-') << std::endl;
+            for (const auto& result : results) {
+                const ProcessStats& stats = result.serverResources;
+                if (!stats.valid) continue;
+                std::cout << std::left << std::setw(30) << reportLabel(result)
+                          << std::setw(12) << std::fixed << std::setprecision(2) << stats.cpuCores
+                          << std::setw(14) << std::setprecision(0) << stats.requestsPerCpuSecond
+                          << std::setw(12) << std::setprecision(1) << stats.maxRssKb / 1024.0
+                          << std::setw(14) << stats.rssBytesPerConnection / 1024.0
+                          << std::setw(18) << (std::to_string(stats.voluntarySwitches) + "/" +
+                                               std::to_string(stats.involuntarySwitches))
+                          << stats.maxThreads << std::endl;
+            }
+        }
+        
+        bool anyPhases = std::any_of(results.begin(), results.end(),
+                                     [](const AggregatedResult& r) { return r.latencyPhases.valid; });
+        if (anyPhases) {
+            std::cout << "\nLatency Phases (avg / P99 ms):" << std::endl;
+            std::cout << std::left << std::setw(30) << "Environment"
+                      << std::setw(20) << "Wait"
+                      << std::setw(20) << "Write"
+                      << std::setw(20) << "First byte"
+                      << "Transfer" << std::endl;
+            std::cout << std::string(110, '-') << std::endl;
+            auto cell = [](const PhaseLatency& phase) {
+                std::ostringstream text;
+                text << std::fixed << std::setprecision(3) << phase.avgMs << " / " << phase.p99Ms;
+                return text.str();
+            };
+            for (const auto& result : results) {
+                const LatencyPhases& phases = result.latencyPhases;
+                if (!phases.valid) continue;
+                std::cout << std::left << std::setw(30) << reportLabel(result)
+                          << std::setw(20) << cell(phases.wait)
+                          << std::setw(20) << cell(phases.write)
+                          << std::setw(20) << cell(phases.firstByte)
+                          << cell(phases.transfer) << std::endl;
+            }
+        }
+        
+        bool anyClient = std::any_of(results.begin(), results.end(),
+                                     [](const AggregatedResult& r) { return r.client.valid; });
+        if (anyClient) {
+            std::cout << "\nLoad Generator Self-Check:" << std::endl;
+            if (harnessCeiling.valid) {
+                std::cout << "Harness ceiling " << std::fixed << std::setprecision(0) << harnessCeiling.requestsPerSecond
+                          << " req/sec (" << harnessCeiling.connections << " connections, echo server)" << std::endl;
+            }
+            std::cout << std::left << std::setw(30) << "Environment"
+                      << std::setw(8) << "Cores"
+                      << std::setw(10) << "Busiest"
+                      << std::setw(14) << "Lag P99 ms"
+                      << std::setw(12) << "Late"
+                      << std::setw(11) << "Ceiling"
+                      << "Client-bound" << std::endl;
+            std::cout << std::string(100, '-') << std::endl;
+            for (const auto& result : results) {
+                const ClientLoad& client = result.client;
+                if (!client.valid) continue;
+                std::ostringstream busiest, lag, ceiling, bound;
+                busiest << std::fixed << std::setprecision(0) << client.busiestThread * 100 << "%";
+                lag << std::fixed << std::setprecision(3) << client.sendLagP99Ms;
+                if (harnessCeiling.valid) {
+                    ceiling << std::fixed << std::setprecision(0)
+                            << result.requestsPerSecond / harnessCeiling.requestsPerSecond * 100 << "%";
+                }
+                bound << result.clientBoundRuns << "/" << result.runs;
+                if (client.clientBound) bound << " (" << client.reason << ")";
+                std::cout << std::left << std::setw(30) << reportLabel(result)
+                          << std::setw(8) << std::fixed << std::setprecision(2) << client.cpuCores
+                          << std::setw(10) << busiest.str()
+                          << std::setw(14) << (client.pacedSends > 0 ? lag.str() : "-")
+                          << std::setw(12) << (client.pacedSends > 0 ? std::to_string(client.lateSends) : "-")
+                          << std::setw(11) << (harnessCeiling.valid ? ceiling.str() : "-")
+                          << bound.str() << std::endl;
+            }
+        }
+        
+        bool anyRuntime = std::any_of(results.begin(), results.end(),
+                                      [](const AggregatedResult& r) { return r.serverRuntime.valid; });
+        if (anyRuntime) {
+            std::cout << "\nServer Runtime:" << std::endl;
+            std::cout << std::left << std::setw(30) << "Environment"
+                      << std::setw(16) << "Loop mean ms"
+                      << std::setw(14) << "Loop P99 ms"
+                      << std::setw(8) << "ELU %"
+                      << std::setw(12) << "GC pauses"
+                      << std::setw(10) << "GC %"
+                      << std::setw(14) << "GC max ms"
+                      << "P99 spikes (GC/loop)" << std::endl;
+            std::cout << std::string(124, '-') << std::endl;
+            for (const auto& result : results) {
+                const ServerRuntimeStats& stats = result.serverRuntime;
+                if (!stats.valid) continue;
+                std::cout << std::left << std::setw(30) << reportLabel(result)
+                          << std::setw(16) << std::fixed << std::setprecision(2) << stats.loopDelayMeanMs
+                          << std::setw(14) << stats.loopDelayP99Ms
+                          << std::setw(8) << std::setprecision(0) << stats.loopUtilization * 100;
+                if (stats.gcObserved) {
+                    std::cout << std::setw(12) << stats.gcCount
+                              << std::setw(10) << std::setprecision(2) << stats.gcPauseShare * 100
+                              << std::setw(14) << stats.gcMaxPauseMs;
+                } else {
+                    std::cout << std::setw(12) << "n/a" << std::setw(10) << "n/a" << std::setw(14) << "n/a";
+                }
+                std::cout << stats.p99Spikes << " (" << stats.spikesWithGc << "/" << stats.spikesWithLoopStall << ")"
+                          << std::endl;
+            }
         }
         
         // Node.js vs Bun comparison
         std::cout << "\n=== Node.js vs Bun Comparison ===" << std::endl;
-        std::map<std::string, std::map<std::string, AggregatedResult>> frameworkGroups;
+        std::map<std::string, std::vector<const AggregatedResult*>> frameworkGroups;
         
         for (const auto& result : results) {
-            frameworkGroups[result.framework][result.runtime] = result;
+            std::string group = result.framework + (scenarios.size() > 1 ? " [" + result.scenario + "]" : "") +
+                                (result.workers > 1 ? " x" + std::to_string(result.workers) : "") +
+                                (connectionAxis().size() > 1 ? " c" + std::to_string(result.connections) : "") +
+                                (transportAxis().size() > 1 ? " " + result.transport : "") +
+                                (result.restart != "per-run" && config.restartPolicy == "both" ? " (warm)" : "");
+            frameworkGroups[group].push_back(&result);
         }
         
-        for (const auto& [framework, group] : frameworkGroups) {
-            if (group.find("node") != group.end() && group.find("bun") != group.end()) {
-                const auto& nodeResult = group.at("node");
-                const auto& bunResult = group.at("bun");
-                
+        // Several variants of one runtime (binaries, flags) are each compared with the
+        // oldest version of that runtime; Bun vs Node.js compares the newest of each.
+        for (auto& [framework, group] : frameworkGroups) {
+            std::sort(group.begin(), group.end(), [](const AggregatedResult* a, const AggregatedResult* b) {
+                if (a->runtime != b->runtime) return a->runtime > b->runtime;  // node before bun
+                if (a->runtimeVersion != b->runtimeVersion) return versionLess(a->runtimeVersion, b->runtimeVersion);
+                return runtimeFlags(a->runtimeArgs, a->runtimeEnv) < runtimeFlags(b->runtimeArgs, b->runtimeEnv);
+            });
+            const AggregatedResult* newestNode = nullptr;
+            const AggregatedResult* newestBun = nullptr;
+            int nodeVariants = 0, bunVariants = 0;
+            for (const AggregatedResult* result : group) {
+                if (result->runtime == "node") {
+                    newestNode = result;
+                    nodeVariants++;
+                } else if (result->runtime == "bun") {
+                    newestBun = result;
+                    bunVariants++;
+                }
+            }
+            bool crossRuntime = newestNode != nullptr && newestBun != nullptr;
+            if (!crossRuntime && nodeVariants < 2 && bunVariants < 2) continue;
+            
+            std::cout << "\n" << framework << " (uppercase):" << std::endl;
+            const AggregatedResult* baseline = nullptr;
+            for (const AggregatedResult* result : group) {
+                if (baseline == nullptr || baseline->runtime != result->runtime) baseline = result;
+                std::cout << "  " << runtimeLabel(*result) << ": " << std::fixed << std::setprecision(2)
+                          << result->requestsPerSecond << " req/sec, " << result->avgLatency << "ms avg latency";
+                if (result != baseline && baseline->requestsPerSecond > 0) {
+                    double change = (result->requestsPerSecond - baseline->requestsPerSecond) / baseline->requestsPerSecond;
+                    std::cout << " (" << std::showpos << std::setprecision(1) << change * 100 << std::noshowpos
+                              << "% req/sec vs " << runtimeLabel(*baseline) << ")";
+                }
+                std::cout << std::endl;
+            }
+            if (crossRuntime) {
+                const AggregatedResult& nodeResult = *newestNode;
+                const AggregatedResult& bunResult = *newestBun;
                 double rpsImprovement = ((bunResult.requestsPerSecond - nodeResult.requestsPerSecond) / nodeResult.requestsPerSecond) * 100;
                 double latencyImprovement = ((nodeResult.avgLatency - bunResult.avgLatency) / nodeResult.avgLatency) * 100;
-                
-                std::cout << "\n" << framework << " (uppercase):" << std::endl;
-                std::cout << "  Node.js: " << std::fixed << std::setprecision(2) << nodeResult.requestsPerSecond 
-                          << " req/sec, " << nodeResult.avgLatency << "ms avg latency" << std::endl;
-                std::cout << "  Bun: " << bunResult.requestsPerSecond 
-                          << " req/sec, " << bunResult.avgLatency << "ms avg latency" << std::endl;
-                std::cout << "  RPS Improvement: " << std::setprecision(1) << rpsImprovement << "%" << std::endl;
-                std::cout << "  Latency Improvement: " << latencyImprovement << "%" << std::endl;
+                std::string versus = nodeVariants > 1 || bunVariants > 1
+                    ? " (" + runtimeLabel(bunResult) + " vs " + runtimeLabel(nodeResult) + ")"
+                    : "";
+                std::cout << "  RPS Improvement" << versus << ": " << std::setprecision(1) << rpsImprovement << "%" << std::endl;
+                std::cout << "  Latency Improvement" << versus << ": " << latencyImprovement << "%" << std::endl;
             }
         }
         
         // Save results to JSON file
         saveResults();
+        try {
+            writeBenchmarkReport("benchmark_results_wrk.json", ReportOptions());
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: no report: " << e.what() << std::endl;
+        }
+        recordHistory();
+    }
+    
+    int regressionCount() const { return regressions; }
+    
+    int soakFlagCount() const {
+        return static_cast<int>(std::count_if(soakResults.begin(), soakResults.end(),
+                                              [](const SoakResult& soak) { return soak.flagged(); }));
+    }
+    
+    // "Node.js v22.3.0 --max-old-space-size=4096"
+    static std::string runtimeLabel(const AggregatedResult& result) {
+        std::string label = result.runtime == "node" ? "Node.js" : result.runtime == "bun" ? "Bun" : result.runtime;
+        if (!result.runtimeVersion.empty()) label += " " + result.runtimeVersion;
+        std::string flags = runtimeFlags(result.runtimeArgs, result.runtimeEnv);
+        if (!flags.empty()) label += " " + flags;
+        return label;
+    }
+    
+    // Compares the numbers in two version strings in order ("v20.19.5" < "v22.3.0").
+    static bool versionLess(const std::string& a, const std::string& b) {
+        auto numbers = [](const std::string& version) {
+            std::vector<long> parts;
+            for (size_t i = 0; i < version.size();) {
+                if (!std::isdigit(static_cast<unsigned char>(version[i]))) {
+                    i++;
+                    continue;
+                }
+                size_t end = i;
+                while (end < version.size() && std::isdigit(static_cast<unsigned char>(version[end]))) end++;
+                parts.push_back(std::stol(version.substr(i, std::min<size_t>(end - i, 18))));
+                i = end;
+            }
+            return parts;
+        };
+        std::vector<long> left = numbers(a), right = numbers(b);
+        if (left != right) return left < right;
+        return a < b;
+    }
+    
+    static std::string trimmed(std::string text) {
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.pop_back();
+        return text;
+    }
+    
+    // What must match for two stored records to be comparable.
+    std::string historyKey(const std::string& environment, const std::string& scenario, const std::string& transportName,
+                           int connections, const std::string& restart) const {
+        std::ostringstream key;
+        key << environment << "|" << scenario << "|" << transportName << "|c" << connections << "|r" << config.rate
+            << "|" << config.loadGenerator;
+        // Shaped or Poisson traffic is not comparable with the evenly paced kind.
+        if (config.rate > 0 && !config.rateProfile.empty()) key << "|" << config.rateProfile;
+        if (config.rate > 0 && config.arrivalProcess != "uniform") key << "|" << config.arrivalProcess;
+        // A warm server is a different measurement; per-run keys stay as they were.
+        if (restart != "per-run") key << "|" << restart;
+        // Likewise a tuned host or a different network path.
+        if (!config.networkProfile.empty()) key << "|net-" << config.networkProfile;
+        if (config.networkMode != "loopback") key << "|" << config.networkMode << config.netemDelayMs << "ms";
+        if (!config.serverAddress.empty()) key << "|@" << config.serverAddress;
+        return key.str();
+    }
+    
+    // Appends one finished cell's per-run samples to the results store straight away,
+    // so that --resume can pick up an interrupted matrix. Called with resultsMutex held.
+    void storeResult(const AggregatedResult& result) {
+        if (config.resultsStore.empty() || result.rawRuns.empty()) return;
+        StoredResult record = runIdentity;
+        record.recordedAt = static_cast<long>(std::time(nullptr));
+        record.key = historyKey(result.environment, result.scenario, result.transport, result.connections, result.restart);
+        record.environment = result.environment;
+        record.scenario = result.scenario;
+        record.runtime = result.runtime;
+        if (result.runtime == "node") record.nodeVersion = result.runtimeVersion;
+        if (result.runtime == "bun") record.bunVersion = result.runtimeVersion;
+        for (const auto& run : result.rawRuns) {
+            record.rps.push_back(run.requestsPerSecond);
+            record.avgLatency.push_back(run.avgLatency);
+            record.p50.push_back(run.p50Latency);
+            record.p99.push_back(run.p99Latency);
+        }
+        try {
+            appendResults(config.resultsStore, {record});
+            storedRecords.push_back(record);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << std::endl;
+        }
+    }
+    
+    // Reports what this invocation added to the results store, then compares it with
+    // compareBaseline if one is set.
+    void recordHistory() {
+        if (storedRecords.empty()) return;
+        std::cout << "Run history appended to " << config.resultsStore << " (commit "
+                  << runIdentity.commit.substr(0, 12) << (runIdentity.dirty ? "+dirty" : "") << ", host " << runIdentity.host << ")"
+                  << std::endl;
+        if (config.compareBaseline.empty()) return;
+        
+        std::vector<StoredResult> baseline = config.compareBaseline == "previous"
+            ? previousRecords(priorHistory, storedRecords)
+            : recordsForCommit(priorHistory, config.compareBaseline);
+        std::cout << "\n=== Comparison vs Baseline (" << config.compareBaseline << ") ===" << std::endl;
+        if (baseline.empty()) {
+            std::cout << "No baseline results in " << config.resultsStore << "; nothing to compare" << std::endl;
+            return;
+        }
+        CompareOptions options;
+        options.alpha = config.regressionAlpha;
+        options.threshold = config.regressionThreshold;
+        regressions = printComparison(std::cout, compareResults(baseline, storedRecords, options), storedRecords,
+                                     options);
+    }
+    
+    std::string reportLabel(const AggregatedResult& result) const {
+        if (scenarios.size() <= 1) return result.environment;
+        return result.environment + " [" + result.scenario + "]";
+    }
+    
+    void printRoutes(const std::vector<RouteResult>& routes) {
+        int total = 0;
+        for (const auto& route : routes) total += route.requests;
+        std::cout << std::left << std::setw(14) << "Route"
+                  << std::setw(36) << "Request"
+                  << std::setw(8) << "Share"
+                  << std::setw(12) << "Req/sec"
+                  << std::setw(10) << "P50(ms)"
+                  << std::setw(10) << "P90(ms)"
+                  << std::setw(10) << "P99(ms)"
+                  << std::setw(11) << "P99.9(ms)"
+                  << std::setw(10) << "Max(ms)"
+                  << "Errors" << std::endl;
+        std::cout << std::string(128, '-') << std::endl;
+        for (const auto& route : routes) {
+            std::string request = route.method + " " + route.path;
+            if (request.size() > 34) request = request.substr(0, 31) + "...";
+            std::ostringstream share;
+            share << std::fixed << std::setprecision(1) << (total > 0 ? 100.0 * route.requests / total : 0.0) << "%";
+            std::cout << std::left << std::setw(14) << route.name
+                      << std::setw(36) << request
+                      << std::setw(8) << share.str()
+                      << std::setw(12) << std::fixed << std::setprecision(2) << route.requestsPerSecond
+                      << std::setw(10) << route.p50Latency
+                      << std::setw(10) << route.p90Latency
+                      << std::setw(10) << route.p99Latency
+                      << std::setw(11) << route.p999Latency
+                      << std::setw(10) << route.maxLatency
+                      << route.errors << std::endl;
+        }
+    }
+    
+    void printLoadCurve(const std::vector<LoadPoint>& curve, bool showSlo) {
+        std::cout << std::left << std::setw(14) << "Offered(r/s)"
+                  << std::setw(14) << "Achieved(r/s)"
+                  << std::setw(12) << "P50(ms)"
+                  << std::setw(12) << "P90(ms)"
+                  << std::setw(12) << "P99(ms)"
+                  << std::setw(12) << "P99.9(ms)"
+                  << std::setw(12) << "Max(ms)"
+                  << std::setw(10) << "Errors"
+                  << (showSlo ? "SLO" : "") << std::endl;
+        std::cout << std::string(showSlo ? 110 : 100, '-') << std::endl;
+        for (const auto& point : curve) {
+            std::cout << std::left << std::setw(14) << std::fixed << std::setprecision(0) << point.offeredRps
+                      << std::setw(14) << point.achievedRps
+                      << std::setprecision(2)
+                      << std::setw(12) << point.p50Latency
+                      << std::setw(12) << point.p90Latency
+                      << std::setw(12) << point.p99Latency
+                      << std::setw(12) << point.p999Latency
+                      << std::setw(12) << point.maxLatency
+                      << std::setw(10) << point.errors
+                      << (showSlo ? (point.withinSlo ? "pass" : "fail") : "") << std::endl;
+        }
+    }
+    
+    void writeLoadCurve(std::ofstream& jsonFile, const std::vector<LoadPoint>& curve) {
+        jsonFile << "[";
+        for (size_t p = 0; p < curve.size(); p++) {
+            const auto& point = curve[p];
+            if (p > 0) jsonFile << ", ";
+            jsonFile << "{\"offeredRps\": " << point.offeredRps
+                     << ", \"achievedRps\": " << point.achievedRps
+                     << ", \"p50Latency\": " << point.p50Latency
+                     << ", \"p90Latency\": " << point.p90Latency
+                     << ", \"p99Latency\": " << point.p99Latency
+                     << ", \"p999Latency\": " << point.p999Latency
+                     << ", \"maxLatency\": " << point.maxLatency
+                     << ", \"errors\": " << point.errors
+                     << ", \"errorRate\": " << point.errorRate
+                     << ", \"withinSlo\": " << (point.withinSlo ? "true" : "false") << "}";
+        }
+        jsonFile << "]";
+    }
+    
+    void writeSteadyState(std::ofstream& jsonFile, const SteadyState& steady) {
+        if (!steady.valid) {
+            jsonFile << "null";
+            return;
+        }
+        jsonFile << "{\"startSec\": " << steady.startSec
+                 << ", \"endSec\": " << steady.endSec
+                 << ", \"buckets\": " << steady.buckets
+                 << ", \"requestsPerSecond\": " << steady.requestsPerSecond
+                 << ", \"p50Latency\": " << steady.p50Latency
+                 << ", \"p90Latency\": " << steady.p90Latency
+                 << ", \"p99Latency\": " << steady.p99Latency
+                 << ", \"p999Latency\": " << steady.p999Latency
+                 << ", \"maxLatency\": " << steady.maxLatency
+                 << ", \"errors\": " << steady.errors << "}";
+    }
+    
+    void writeRoutes(std::ofstream& jsonFile, const std::vector<RouteResult>& routes) {
+        jsonFile << "[";
+        for (size_t r = 0; r < routes.size(); r++) {
+            const auto& route = routes[r];
+            if (r > 0) jsonFile << ", ";
+            jsonFile << "{\"name\": " << jsonString(route.name)
+                     << ", \"method\": " << jsonString(route.method)
+                     << ", \"path\": " << jsonString(route.path)
+                     << ", \"requests\": " << route.requests
+                     << ", \"errors\": " << route.errors
+                     << ", \"requestsPerSecond\": " << route.requestsPerSecond
+                     << ", \"avgLatency\": " << route.avgLatency
+                     << ", \"p50Latency\": " << route.p50Latency
+                     << ", \"p90Latency\": " << route.p90Latency
+                     << ", \"p99Latency\": " << route.p99Latency
+                     << ", \"p999Latency\": " << route.p999Latency
+                     << ", \"maxLatency\": " << route.maxLatency
+                     << ", \"latencyHistogram\": \"" << route.latencyHistogram.serialize() << "\"}";
+        }
+        jsonFile << "]";
+    }
+    
+    void writeServerResources(std::ofstream& jsonFile, const ProcessStats& stats) {
+        if (!stats.valid) {
+            jsonFile << "null";
+            return;
+        }
+        jsonFile << "{\"samples\": " << stats.samples
+                 << ", \"wallSec\": " << stats.wallSec
+                 << ", \"cpuUserSec\": " << stats.cpuUserSec
+                 << ", \"cpuSysSec\": " << stats.cpuSysSec
+                 << ", \"cpuCores\": " << stats.cpuCores
+                 << ", \"requestsPerCpuSecond\": " << stats.requestsPerCpuSecond
+                 << ", \"avgRssKb\": " << stats.avgRssKb
+                 << ", \"maxRssKb\": " << stats.maxRssKb
+                 << ", \"hwmSumKb\": " << stats.hwmSumKb
+                 << ", \"rssBytesPerConnection\": " << stats.rssBytesPerConnection
+                 << ", \"voluntarySwitches\": " << stats.voluntarySwitches
+                 << ", \"involuntarySwitches\": " << stats.involuntarySwitches
+                 << ", \"maxThreads\": " << stats.maxThreads << "}";
+    }
+    
+    void writeServerRuntime(std::ofstream& jsonFile, const ServerRuntimeStats& stats) {
+        if (!stats.valid) {
+            jsonFile << "null";
+            return;
+        }
+        jsonFile << "{\"runtime\": " << jsonString(stats.runtime)
+                 << ", \"processes\": " << stats.processes
+                 << ", \"samples\": " << stats.samples
+                 << ", \"loopDelayMeanMs\": " << stats.loopDelayMeanMs
+                 << ", \"loopDelayP99Ms\": " << stats.loopDelayP99Ms
+                 << ", \"loopDelayMaxMs\": " << stats.loopDelayMaxMs
+                 << ", \"loopUtilization\": " << stats.loopUtilization
+                 << ", \"maxActiveHandles\": " << stats.maxActiveHandles
+                 << ", \"maxHeapUsedMb\": " << stats.maxHeapUsedMb
+                 << ", \"gcObserved\": " << (stats.gcObserved ? "true" : "false");
+        if (stats.gcObserved) {
+            jsonFile << ", \"gcCount\": " << stats.gcCount
+                     << ", \"gcPauseMs\": " << stats.gcPauseMs
+                     << ", \"gcMaxPauseMs\": " << stats.gcMaxPauseMs
+                     << ", \"gcPauseShare\": " << stats.gcPauseShare;
+        }
+        jsonFile << ", \"p99Spikes\": " << stats.p99Spikes
+                 << ", \"spikesWithGc\": " << stats.spikesWithGc
+                 << ", \"spikesWithLoopStall\": " << stats.spikesWithLoopStall << "}";
+    }
+    
+    void writeLatencyPhases(std::ofstream& jsonFile, const LatencyPhases& phases) {
+        if (!phases.valid) {
+            jsonFile << "null";
+            return;
+        }
+        auto writePhase = [&jsonFile](const char* name, const PhaseLatency& phase) {
+            jsonFile << ", \"" << name << "\": {\"avgMs\": " << phase.avgMs << ", \"p50Ms\": " << phase.p50Ms
+                     << ", \"p90Ms\": " << phase.p90Ms << ", \"p99Ms\": " << phase.p99Ms
+                     << ", \"maxMs\": " << phase.maxMs << "}";
+        };
+        jsonFile << "{\"requests\": " << phases.requests;
+        writePhase("wait", phases.wait);
+        writePhase("write", phases.write);
+        writePhase("firstByte", phases.firstByte);
+        writePhase("transfer", phases.transfer);
+        jsonFile << "}";
+    }
+    
+    void writeClientLoad(std::ofstream& jsonFile, const ClientLoad& client) {
+        if (!client.valid) {
+            jsonFile << "null";
+            return;
+        }
+        jsonFile << "{\"threads\": " << client.threads
+                 << ", \"cpuCores\": " << client.cpuCores
+                 << ", \"busiestThread\": " << client.busiestThread
+                 << ", \"pacedSends\": " << client.pacedSends
+                 << ", \"lateSends\": " << client.lateSends
+                 << ", \"backlogPeak\": " << client.backlogPeak
+                 << ", \"sendLagP99Ms\": " << client.sendLagP99Ms
+                 << ", \"sendLagMaxMs\": " << client.sendLagMaxMs
+                 << ", \"clientBound\": " << (client.clientBound ? "true" : "false")
+                 << ", \"reason\": " << (client.clientBound ? jsonString(client.reason) : "null") << "}";
+    }
+    
+    void writeConnectionSetup(std::ofstream& jsonFile, const ConnectionStats& stats) {
+        if (!stats.valid) {
+            jsonFile << "null";
+            return;
+        }
+        jsonFile << "{\"opened\": " << stats.opened
+                 << ", \"tlsHandshakes\": " << stats.tlsHandshakes
+                 << ", \"tlsResumed\": " << stats.tlsResumed
+                 << ", \"avgSetupMs\": " << stats.avgSetupMs
+                 << ", \"p50SetupMs\": " << stats.p50SetupMs
+                 << ", \"p99SetupMs\": " << stats.p99SetupMs
+                 << ", \"maxSetupMs\": " << stats.maxSetupMs << "}";
+    }
+    
+    void writeStartup(std::ofstream& jsonFile, const StartupTiming& startup) {
+        if (!startup.valid) {
+            jsonFile << "null";
+            return;
+        }
+        jsonFile << "{\"listenMs\": " << startup.listenMs
+                 << ", \"firstResponseMs\": " << startup.firstResponseMs
+                 << ", \"firstResponseLatencyMs\": " << startup.firstResponseLatencyMs << "}";
+    }
+    
+    // {"net.core.somaxconn": "4096", ...}; unavailable sysctls are null.
+    static void writeSysctls(std::ostream& out, const std::vector<SysctlValue>& values) {
+        out << "{";
+        for (size_t i = 0; i < values.size(); i++) {
+            out << (i > 0 ? ", " : "") << jsonString(values[i].name) << ": "
+                << (values[i].value.empty() ? "null" : jsonString(values[i].value));
+        }
+        out << "}";
     }
     
     void saveResults() {
@@ -504,21 +3215,240 @@ public:
         // Simple JSON output
         jsonFile << "{\n";
         jsonFile << "  \"timestamp\": \"" << std::time(nullptr) << "\",\n";
-        jsonFile << "  \"benchmarkTool\": \"wrk\",\n";
+        jsonFile << "  \"benchmarkTool\": " << jsonString(config.loadGenerator) << ",\n";
+        jsonFile << "  \"workerMode\": " << jsonString(config.workerMode) << ",\n";
+        jsonFile << "  \"restartPolicy\": " << jsonString(config.restartPolicy) << ",\n";
+        jsonFile << "  \"confidenceLevel\": " << config.confidenceLevel << ",\n";
+        jsonFile << "  \"schedule\": {\"mode\": " << jsonString(config.schedule)
+                 << ", \"seed\": " << scheduleSeed
+                 << ", \"calibrationMs\": " << config.calibrationMs
+                 << ", \"medianHostSpeed\": " << medianHostSpeed << "},\n";
+        if (harnessCeiling.valid) {
+            jsonFile << "  \"harnessCeiling\": {\"requestsPerSecond\": " << harnessCeiling.requestsPerSecond
+                     << ", \"p99Latency\": " << harnessCeiling.p99Latency
+                     << ", \"connections\": " << harnessCeiling.connections
+                     << ", \"threads\": " << harnessCeiling.threads
+                     << ", \"busiestThread\": " << harnessCeiling.busiestThread << "},\n";
+        } else {
+            jsonFile << "  \"harnessCeiling\": null,\n";
+        }
+        jsonFile << "  \"coldStart\": ";
+        writeColdStartJson(jsonFile, coldStartResults, "  ");
+        jsonFile << ",\n";
+        jsonFile << "  \"soak\": ";
+        writeSoakJson(jsonFile, soakResults, "  ");
+        jsonFile << ",\n";
+        jsonFile << "  \"profiles\": ";
+        writeProfileJson(jsonFile, profileResults, "  ");
+        jsonFile << ",\n";
+        bool anyTls = false, anyH2 = false;
+        std::vector<int> connectionCounts = connectionAxis();
+        std::vector<std::string> transports = transportAxis();
+        jsonFile << "  \"connections\": [";
+        for (size_t i = 0; i < connectionCounts.size(); i++) {
+            jsonFile << (i > 0 ? ", " : "") << connectionCounts[i];
+        }
+        jsonFile << "],\n";
+        jsonFile << "  \"transport\": {\"name\": " << jsonString(config.transport) << ", \"matrix\": [";
+        for (size_t i = 0; i < transports.size(); i++) {
+            const std::string& name = transports[i];
+            anyTls = anyTls || parseTransport(name).tls;
+            anyH2 = anyH2 || parseTransport(name).h2;
+            jsonFile << (i > 0 ? ", " : "") << jsonString(name);
+        }
+        jsonFile << "]"
+                 << ", \"h2Streams\": " << (anyH2 ? config.h2Streams : 0)
+                 << ", \"tlsSessionResumption\": " << (anyTls && config.tlsSessionResumption ? "true" : "false") << "},\n";
+        jsonFile << "  \"network\": {\"mode\": " << jsonString(config.networkMode) << ", \"profile\": "
+                 << jsonString(config.networkProfile) << ", \"serverAddress\": " << jsonString(serverHost)
+                 << ", \"netemDelayMs\": " << config.netemDelayMs << ", \"sysctls\": ";
+        writeSysctls(jsonFile, hostSysctls);
+        jsonFile << ", \"previous\": ";
+        writeSysctls(jsonFile, changedSysctls);
+        jsonFile << ", \"serverSysctls\": ";
+        writeSysctls(jsonFile, serverSysctls);
+        jsonFile << "},\n";
+        jsonFile << "  \"agents\": [";
+        for (size_t i = 0; i < config.agents.size(); i++) {
+            if (i > 0) jsonFile << ", ";
+            jsonFile << jsonString(config.agents[i]);
+        }
+        jsonFile << "],\n";
+        jsonFile << "  \"topology\": {\"cpus\": \"" << formatCpuList(topology.cpus) << "\""
+                 << ", \"cpuCount\": " << topology.cpus.size()
+                 << ", \"numaNodes\": " << topology.numaNodes
+                 << ", \"parallelSlots\": " << std::max<size_t>(slots.size(), 1)
+                 << ", \"slots\": [";
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (i > 0) jsonFile << ", ";
+            jsonFile << "{\"index\": " << slots[i].index
+                     << ", \"numaNode\": " << slots[i].numaNode
+                     << ", \"serverCpus\": \"" << formatCpuList(slots[i].serverCpus) << "\""
+                     << ", \"loadCpus\": \"" << formatCpuList(slots[i].loadCpus) << "\""
+                     << ", \"portOffset\": " << slots[i].portOffset << "}";
+        }
+        jsonFile << "]},\n";
         jsonFile << "  \"results\": [\n";
         
         for (size_t i = 0; i < results.size(); i++) {
             const auto& result = results[i];
             jsonFile << "    {\n";
-            jsonFile << "      \"environment\": \"" << result.environment << "\",\n";
-            jsonFile << "      \"runtime\": \"" << result.runtime << "\",\n";
-            jsonFile << "      \"framework\": \"" << result.framework << "\",\n";
+            jsonFile << "      \"environment\": " << jsonString(result.environment) << ",\n";
+            jsonFile << "      \"runtime\": " << jsonString(result.runtime) << ",\n";
+            jsonFile << "      \"framework\": " << jsonString(result.framework) << ",\n";
+            jsonFile << "      \"runtimeBinary\": " << jsonString(result.runtimeBinary) << ",\n";
+            jsonFile << "      \"runtimeVersion\": " << jsonString(result.runtimeVersion) << ",\n";
+            jsonFile << "      \"runtimeArgs\": [";
+            for (size_t j = 0; j < result.runtimeArgs.size(); j++) {
+                jsonFile << (j > 0 ? ", " : "") << jsonString(result.runtimeArgs[j]);
+            }
+            jsonFile << "],\n";
+            jsonFile << "      \"runtimeEnv\": [";
+            for (size_t j = 0; j < result.runtimeEnv.size(); j++) {
+                jsonFile << (j > 0 ? ", " : "") << jsonString(result.runtimeEnv[j]);
+            }
+            jsonFile << "],\n";
+            jsonFile << "      \"scenario\": " << jsonString(result.scenario) << ",\n";
+            jsonFile << "      \"workers\": " << result.workers << ",\n";
+            jsonFile << "      \"restart\": " << jsonString(result.restart) << ",\n";
+            jsonFile << "      \"connections\": " << result.connections << ",\n";
+            jsonFile << "      \"transport\": " << jsonString(result.transport) << ",\n";
+            jsonFile << "      \"network\": {\"mode\": " << jsonString(result.network.mode) << ", \"profile\": "
+                     << jsonString(result.network.profile) << ", \"serverAddress\": "
+                     << jsonString(result.network.serverAddress) << ", \"netemDelayMs\": " << result.network.netemDelayMs
+                     << ", \"connectRttMs\": " << result.network.connectRttMs << "},\n";
+            jsonFile << "      \"scalingEfficiency\": " << result.scalingEfficiency << ",\n";
+            jsonFile << "      \"slot\": " << result.slot << ",\n";
             jsonFile << "      \"requestsPerSecond\": " << result.requestsPerSecond << ",\n";
             jsonFile << "      \"avgLatency\": " << result.avgLatency << ",\n";
+            jsonFile << "      \"p50Latency\": " << result.p50Latency << ",\n";
             jsonFile << "      \"p90Latency\": " << result.p90Latency << ",\n";
             jsonFile << "      \"p99Latency\": " << result.p99Latency << ",\n";
+            jsonFile << "      \"p999Latency\": " << result.p999Latency << ",\n";
+            jsonFile << "      \"p9999Latency\": " << result.p9999Latency << ",\n";
+            jsonFile << "      \"maxLatency\": " << result.maxLatency << ",\n";
+            jsonFile << "      \"mergedPercentiles\": " << (result.mergedPercentiles ? "true" : "false") << ",\n";
             jsonFile << "      \"throughput\": " << result.throughput << ",\n";
-            jsonFile << "      \"errors\": " << result.errors << "\n";
+            jsonFile << "      \"errors\": " << result.errors << ",\n";
+            jsonFile << "      \"stdRps\": " << result.stdRps << ",\n";
+            jsonFile << "      \"driftCorrectedRps\": " << result.driftCorrectedRps << ",\n";
+            jsonFile << "      \"stdLatency\": " << result.stdLatency << ",\n";
+            jsonFile << "      \"rpsConfidence\": {\"low\": " << result.rpsCiLow << ", \"high\": " << result.rpsCiHigh << "},\n";
+            jsonFile << "      \"runs\": [";
+            for (size_t r = 0; r < result.rawRuns.size(); r++) {
+                const BenchmarkResult& run = result.rawRuns[r];
+                if (r > 0) jsonFile << ", ";
+                jsonFile << "{\"requestsPerSecond\": " << run.requestsPerSecond
+                         << ", \"avgLatency\": " << run.avgLatency
+                         << ", \"p50Latency\": " << run.p50Latency
+                         << ", \"p90Latency\": " << run.p90Latency
+                         << ", \"p99Latency\": " << run.p99Latency
+                         << ", \"maxLatency\": " << run.maxLatency
+                         << ", \"totalRequests\": " << run.totalRequests
+                         << ", \"errors\": " << run.errors
+                         << ", \"sequence\": " << run.sequence
+                         << ", \"startedAt\": " << std::fixed << std::setprecision(3) << run.startedAt
+                         << std::defaultfloat << std::setprecision(6)
+                         << ", \"hostSpeed\": " << run.hostSpeed
+                         << ", \"driftFactor\": " << run.driftFactor
+                         << ", \"connectRttMs\": " << run.connectRttMs << ", \"startup\": ";
+                writeStartup(jsonFile, run.startup);
+                jsonFile << "}";
+            }
+            jsonFile << "],\n";
+            jsonFile << "      \"latencyHistogram\": \"" << result.latencyHistogram.serialize() << "\",\n";
+            jsonFile << "      \"runHistograms\": [";
+            for (size_t r = 0; r < result.rawRuns.size(); r++) {
+                if (r > 0) jsonFile << ", ";
+                jsonFile << "\"" << result.rawRuns[r].latencyHistogram.serialize() << "\"";
+            }
+            jsonFile << "],\n";
+            jsonFile << "      \"runWarmups\": [";
+            for (size_t r = 0; r < result.rawRuns.size(); r++) {
+                if (r > 0) jsonFile << ", ";
+                jsonFile << "{\"warmupMs\": " << result.rawRuns[r].warmupMs
+                         << ", \"converged\": " << (result.rawRuns[r].warmupConverged ? "true" : "false") << "}";
+            }
+            jsonFile << "],\n";
+            jsonFile << "      \"timelines\": [";
+            for (size_t r = 0; r < result.rawRuns.size(); r++) {
+                if (r > 0) jsonFile << ", ";
+                jsonFile << jsonString(result.rawRuns[r].timelineFile);
+            }
+            jsonFile << "],\n";
+            if (!config.sampleArchiveDir.empty()) {
+                jsonFile << "      \"sampleFiles\": [";
+                for (size_t r = 0; r < result.rawRuns.size(); r++) {
+                    if (r > 0) jsonFile << ", ";
+                    jsonFile << jsonString(result.rawRuns[r].sampleFile);
+                }
+                jsonFile << "],\n";
+            }
+            jsonFile << "      \"steadyState\": ";
+            writeSteadyState(jsonFile, result.steadyState);
+            jsonFile << ",\n";
+            jsonFile << "      \"runSteadyStates\": [";
+            for (size_t r = 0; r < result.rawRuns.size(); r++) {
+                if (r > 0) jsonFile << ", ";
+                writeSteadyState(jsonFile, result.rawRuns[r].steadyState);
+            }
+            jsonFile << "],\n";
+            jsonFile << "      \"serverResources\": ";
+            writeServerResources(jsonFile, result.serverResources);
+            jsonFile << ",\n";
+            jsonFile << "      \"runServerResources\": [";
+            for (size_t r = 0; r < result.rawRuns.size(); r++) {
+                if (r > 0) jsonFile << ", ";
+                writeServerResources(jsonFile, result.rawRuns[r].serverResources);
+            }
+            jsonFile << "],\n";
+            jsonFile << "      \"serverRuntime\": ";
+            writeServerRuntime(jsonFile, result.serverRuntime);
+            jsonFile << ",\n";
+            jsonFile << "      \"runServerRuntime\": [";
+            for (size_t r = 0; r < result.rawRuns.size(); r++) {
+                if (r > 0) jsonFile << ", ";
+                writeServerRuntime(jsonFile, result.rawRuns[r].serverRuntime);
+            }
+            jsonFile << "],\n";
+            jsonFile << "      \"connectionSetup\": ";
+            writeConnectionSetup(jsonFile, result.connectionSetup);
+            jsonFile << ",\n";
+            jsonFile << "      \"latencyPhases\": ";
+            writeLatencyPhases(jsonFile, result.latencyPhases);
+            jsonFile << ",\n";
+            jsonFile << "      \"client\": ";
+            writeClientLoad(jsonFile, result.client);
+            jsonFile << ",\n";
+            jsonFile << "      \"clientBoundRuns\": " << result.clientBoundRuns << ",\n";
+            jsonFile << "      \"runClient\": [";
+            for (size_t r = 0; r < result.rawRuns.size(); r++) {
+                if (r > 0) jsonFile << ", ";
+                writeClientLoad(jsonFile, result.rawRuns[r].client);
+            }
+            jsonFile << "],\n";
+            jsonFile << "      \"startup\": ";
+            writeStartup(jsonFile, result.startup);
+            jsonFile << ",\n";
+            jsonFile << "      \"routes\": ";
+            writeRoutes(jsonFile, result.routes);
+            jsonFile << ",\n";
+            jsonFile << "      \"loadCurve\": ";
+            writeLoadCurve(jsonFile, result.loadCurve);
+            jsonFile << ",\n";
+            jsonFile << "      \"saturation\": ";
+            if (result.saturation.curve.empty()) {
+                jsonFile << "null\n";
+            } else {
+                jsonFile << "{\"sloP99Ms\": " << result.saturation.sloP99Ms
+                         << ", \"maxErrorRate\": " << result.saturation.maxErrorRate
+                         << ", \"maxRpsAtSlo\": " << result.saturation.maxRpsAtSlo
+                         << ", \"offeredAtMax\": " << result.saturation.offeredAtMax
+                         << ", \"p99AtMax\": " << result.saturation.p99AtMax
+                         << ", \"probes\": ";
+                writeLoadCurve(jsonFile, result.saturation.curve);
+                jsonFile << "}\n";
+            }
             jsonFile << "    }";
             if (i < results.size() - 1) jsonFile << ",";
             jsonFile << "\n";
@@ -527,12 +3457,17 @@ public:
         jsonFile << "}\n";
         
         // CSV output
-        csvFile << "Environment,Runtime,Framework,Requests/sec,Avg Latency(ms),P50 Latency(ms),P90 Latency(ms),P99 Latency(ms),Throughput(MB/s),Total Requests,Errors,Timeouts,RPS StdDev,Latency StdDev\n";
+        csvFile << "Environment,Runtime,Framework,Scenario,Requests/sec,Avg Latency(ms),P50 Latency(ms),P90 Latency(ms),P99 Latency(ms),Throughput(MB/s),Total Requests,Errors,Timeouts,RPS StdDev,Latency StdDev\n";
         
         for (const auto& result : results) {
-            csvFile << "\"" << result.environment << "\","
+            std::string environment = result.environment;
+            for (size_t q = environment.find('"'); q != std::string::npos; q = environment.find('"', q + 2)) {
+                environment.insert(q, 1, '"');
+            }
+            csvFile << "\"" << environment << "\","
                    << result.runtime << ","
                    << result.framework << ","
+                   << result.scenario << ","
                    << std::fixed << std::setprecision(2) << result.requestsPerSecond << ","
                    << result.avgLatency << ","
                    << result.p50Latency << ","
@@ -551,8 +3486,82 @@ public:
     }
 };
 
-int main() {
-    BenchmarkOrchestrator orchestrator;
-    orchestrator.runAllBenchmarks();
+int main(int argc, char* argv[]) {
+    // benchmark_wrk --agent [port]: serve as a remote load generator for a coordinator.
+    if (argc > 1 && std::string(argv[1]) == "--agent") {
+        return runAgent(argc > 2 ? std::atoi(argv[2]) : kDefaultAgentPort);
+    }
+    
+    // benchmark_wrk --parse-wrk <dir> [csv]: re-parse saved wrk outputs into a results table.
+    if (argc > 2 && std::string(argv[1]) == "--parse-wrk") {
+        return parseWrkDirectory(argv[2], argc > 3 ? argv[3] : "benchmark_results_batch.csv") == 0 ? 0 : 1;
+    }
+    
+    // benchmark_wrk --analyze-samples <file> [window] [from] [to|end] [route]: windows and
+    // percentiles from a sample archive; times are durations ("10s", "500ms").
+    if (argc > 2 && std::string(argv[1]) == "--analyze-samples") {
+        try {
+            SampleAnalysisOptions options;
+            if (argc > 3) options.windowSec = parseDurationMs(argv[3]) / 1000.0;
+            if (argc > 4) options.fromSec = parseDurationMs(argv[4]) / 1000.0;
+            if (argc > 5 && std::string(argv[5]) != "end") options.toSec = parseDurationMs(argv[5]) / 1000.0;
+            if (argc > 6) options.route = argv[6];
+            return analyzeSampleArchive(argv[2], options);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    
+    // benchmark_wrk --report [results] [html] [markdown] [readme]: HTML and Markdown reports
+    // from saved results; a readme gets the table between its results markers.
+    if (argc > 1 && std::string(argv[1]) == "--report") {
+        try {
+            ReportOptions options;
+            if (argc > 3) options.htmlPath = argv[3];
+            if (argc > 4) options.markdownPath = argv[4];
+            if (argc > 5) options.readmePath = argv[5];
+            writeBenchmarkReport(argc > 2 ? argv[2] : "benchmark_results_wrk.json", options);
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    
+    // benchmark_wrk --compare <baseline> [candidate] [store]: Welch's t-test between two
+    // commits in the results store; exits 2 on a significant regression.
+    if (argc > 2 && std::string(argv[1]) == "--compare") {
+        BenchmarkConfig defaults;
+        CompareOptions options;
+        options.alpha = defaults.regressionAlpha;
+        options.threshold = defaults.regressionThreshold;
+        try {
+            return compareStoredResults(argc > 4 ? argv[4] : defaults.resultsStore, argv[2],
+                                        argc > 3 ? argv[3] : "latest", options);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    
+    try {
+        CommandLine commandLine = parseCommandLine(argc, argv);
+        if (commandLine.help) {
+            printUsage(std::cout);
+            return 0;
+        }
+        installInterruptHandler();
+        BenchmarkOrchestrator orchestrator(commandLine);
+        orchestrator.runAllBenchmarks();
+        if (orchestrator.regressionCount() > 0 || orchestrator.soakFlagCount() > 0) return 2;
+    } catch (const BenchmarkInterrupted& e) {
+        // The orchestrator is gone by now: servers stopped, sysctls and namespace restored.
+        std::cerr << "Interrupted; no results were written" << std::endl;
+        return 128 + e.signal;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
     return 0;
 }
\ No newline at end of file
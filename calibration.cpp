@@ -0,0 +1,51 @@
+#include "calibration.h"
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "cpu_topology.h"
+
+namespace {
+
+constexpr size_t kBufferWords = 16 * 1024 * 1024 / sizeof(uint64_t);
+constexpr size_t kBlockWords = 64 * 1024 / sizeof(uint64_t);
+
+double runWorkload(int durationMs) {
+    std::vector<uint64_t> buffer(kBufferWords);
+    for (size_t i = 0; i < buffer.size(); i++) buffer[i] = i * 0x9e3779b97f4a7c15ULL;
+
+    using Clock = std::chrono::steady_clock;
+    const auto started = Clock::now();
+    const auto deadline = started + std::chrono::milliseconds(durationMs);
+    uint64_t hash = 1469598103934665603ULL;
+    uint64_t units = 0;
+    auto now = started;
+    while (now < deadline) {
+        // Checking the clock every 16 blocks keeps its cost out of the score.
+        for (int i = 0; i < 16; i++, units++) {
+            const uint64_t* block = buffer.data() + (units * kBlockWords) % kBufferWords;
+            for (size_t w = 0; w < kBlockWords; w++) {
+                hash = (hash ^ block[w]) * 1099511628211ULL;
+            }
+        }
+        now = Clock::now();
+    }
+    // Keep the hash observable so the loop is not optimised away.
+    volatile uint64_t sink = hash;
+    (void)sink;
+    double seconds = std::chrono::duration<double>(now - started).count();
+    return seconds > 0 ? units / seconds : 0.0;
+}
+
+}  // namespace
+
+double measureHostSpeed(int durationMs, const std::vector<int>& cpus) {
+    double score = 0.0;
+    std::thread worker([&]() {
+        if (!cpus.empty()) pinCurrentThread(cpus);
+        score = runWorkload(durationMs);
+    });
+    worker.join();
+    return score;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <vector>
+
+// Fixed CPU and memory workload that measures how fast the host is right now, so
+// runs can be corrected for turbo, thermal and noisy-neighbour drift. Each work
+// unit hashes one 64KB block of a 16MB buffer (larger than most per-core caches),
+// so the score follows both core clock and available memory bandwidth. Runs on a
+// thread pinned to `cpus` (unpinned when empty) and returns units per second.
+double measureHostSpeed(int durationMs, const std::vector<int>& cpus);
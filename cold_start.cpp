@@ -0,0 +1,142 @@
+#include "cold_start.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+
+#include "json_value.h"
+
+namespace {
+
+struct Metric {
+    const char* name;
+    const char* label;
+    std::function<bool(const ColdStartSample&)> present;
+    std::function<double(const ColdStartSample&)> value;
+};
+
+const std::vector<Metric>& metrics() {
+    static const std::vector<Metric> all = {
+        {"listenMs", "Spawn to listening", [](const ColdStartSample& s) { return s.ok; },
+         [](const ColdStartSample& s) { return s.listenMs; }},
+        {"firstResponseMs", "Spawn to first response", [](const ColdStartSample& s) { return s.ok; },
+         [](const ColdStartSample& s) { return s.firstResponseMs; }},
+        {"firstResponseLatencyMs", "First request round trip", [](const ColdStartSample& s) { return s.ok; },
+         [](const ColdStartSample& s) { return s.firstResponseLatencyMs; }},
+        {"steadyMs", "Spawn to steady throughput", [](const ColdStartSample& s) { return s.ok && s.steadyMs >= 0; },
+         [](const ColdStartSample& s) { return s.steadyMs; }},
+    };
+    return all;
+}
+
+std::vector<double> collect(const ColdStartResult& result, const Metric& metric) {
+    std::vector<double> values;
+    for (const auto& sample : result.samples) {
+        if (metric.present(sample)) values.push_back(metric.value(sample));
+    }
+    return values;
+}
+
+int failures(const ColdStartResult& result) {
+    return static_cast<int>(std::count_if(result.samples.begin(), result.samples.end(),
+                                          [](const ColdStartSample& s) { return !s.ok; }));
+}
+
+double interpolate(const std::vector<double>& sorted, double percentile) {
+    double rank = percentile / 100.0 * (sorted.size() - 1);
+    size_t lower = static_cast<size_t>(rank);
+    size_t upper = std::min(lower + 1, sorted.size() - 1);
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - lower);
+}
+
+}  // namespace
+
+Distribution summarizeDistribution(std::vector<double> values) {
+    Distribution dist;
+    if (values.empty()) return dist;
+    std::sort(values.begin(), values.end());
+    dist.count = static_cast<int>(values.size());
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    dist.mean = sum / values.size();
+    double squares = 0.0;
+    for (double v : values) squares += (v - dist.mean) * (v - dist.mean);
+    dist.stdDev = values.size() > 1 ? std::sqrt(squares / (values.size() - 1)) : 0.0;
+    dist.min = values.front();
+    dist.p50 = interpolate(values, 50);
+    dist.p90 = interpolate(values, 90);
+    dist.p99 = interpolate(values, 99);
+    dist.max = values.back();
+    return dist;
+}
+
+void printColdStartReport(std::ostream& out, const std::vector<ColdStartResult>& results) {
+    if (results.empty()) return;
+    out << "\nCold Start (" << results.front().samples.size() << " spawns per setup, from fork/exec, ms):" << std::endl;
+    for (const auto& metric : metrics()) {
+        bool any = std::any_of(results.begin(), results.end(),
+                               [&](const ColdStartResult& r) { return !collect(r, metric).empty(); });
+        if (!any) continue;
+        out << "\n" << metric.label << ":" << std::endl;
+        out << std::left << std::setw(30) << "Environment"
+            << std::setw(10) << "Mean"
+            << std::setw(10) << "Std"
+            << std::setw(10) << "Min"
+            << std::setw(10) << "P50"
+            << std::setw(10) << "P90"
+            << std::setw(10) << "P99"
+            << std::setw(10) << "Max"
+            << "Samples" << std::endl;
+        out << std::string(110, '-') << std::endl;
+        for (const auto& result : results) {
+            Distribution dist = summarizeDistribution(collect(result, metric));
+            out << std::left << std::setw(30) << result.environment;
+            if (dist.count == 0) {
+                out << "-" << std::endl;
+                continue;
+            }
+            out << std::setw(10) << std::fixed << std::setprecision(2) << dist.mean
+                << std::setw(10) << dist.stdDev
+                << std::setw(10) << dist.min
+                << std::setw(10) << dist.p50
+                << std::setw(10) << dist.p90
+                << std::setw(10) << dist.p99
+                << std::setw(10) << dist.max
+                << dist.count;
+            int failed = failures(result);
+            if (failed > 0) out << " (" << failed << " failed to start)";
+            out << std::endl;
+        }
+    }
+}
+
+void writeColdStartJson(std::ostream& out, const std::vector<ColdStartResult>& results, const std::string& indent) {
+    out << "[";
+    for (size_t i = 0; i < results.size(); i++) {
+        const ColdStartResult& result = results[i];
+        out << (i > 0 ? "," : "") << "\n" << indent << "  {\"environment\": " << jsonString(result.environment)
+            << ", \"runtime\": " << jsonString(result.runtime)
+            << ", \"framework\": " << jsonString(result.framework)
+            << ", \"spawns\": " << result.samples.size()
+            << ", \"failures\": " << failures(result);
+        for (const auto& metric : metrics()) {
+            std::vector<double> values = collect(result, metric);
+            Distribution dist = summarizeDistribution(values);
+            out << ",\n" << indent << "   \"" << metric.name << "\": {\"mean\": " << dist.mean
+                << ", \"stdDev\": " << dist.stdDev
+                << ", \"min\": " << dist.min
+                << ", \"p50\": " << dist.p50
+                << ", \"p90\": " << dist.p90
+                << ", \"p99\": " << dist.p99
+                << ", \"max\": " << dist.max
+                << ", \"samples\": [";
+            for (size_t v = 0; v < values.size(); v++) {
+                out << (v > 0 ? ", " : "") << values[v];
+            }
+            out << "]}";
+        }
+        out << "}";
+    }
+    out << (results.empty() ? "" : "\n" + indent) << "]";
+}
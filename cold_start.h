@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Cold-start suite: each setup is spawned coldStarts times through the normal
+// server start path, and every start is timed from fork/exec. The results are
+// reported as distributions, since a single cold start says little about a runtime.
+
+// One spawn of a server.
+struct ColdStartSample {
+    bool ok = false;                      // the server answered before the readiness timeout
+    double listenMs = 0.0;                // spawn until the port accepted a TCP connection
+    double firstResponseMs = 0.0;         // spawn until the first successful response
+    double firstResponseLatencyMs = 0.0;  // round trip of that first request
+    double steadyMs = -1.0;               // spawn until throughput settled; -1 = not measured or never settled
+};
+
+struct Distribution {
+    int count = 0;
+    double mean = 0.0;
+    double stdDev = 0.0;
+    double min = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// Percentiles interpolate linearly between the sorted samples.
+Distribution summarizeDistribution(std::vector<double> values);
+
+struct ColdStartResult {
+    std::string environment;
+    std::string runtime;
+    std::string framework;
+    std::vector<ColdStartSample> samples;
+};
+
+// A table per metric with one row per setup.
+void printColdStartReport(std::ostream& out, const std::vector<ColdStartResult>& results);
+
+// JSON array of per-setup summaries with the raw samples; `indent` prefixes every line.
+void writeColdStartJson(std::ostream& out, const std::vector<ColdStartResult>& results, const std::string& indent);
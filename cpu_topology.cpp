@@ -0,0 +1,145 @@
+#include "cpu_topology.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.find_first_of("0123456789") == std::string::npos) continue;
+        size_t dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+std::string formatCpuList(const std::vector<int>& cpus) {
+    std::ostringstream out;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) j++;
+        if (i > 0) out << ",";
+        out << cpus[i];
+        if (j > i) out << "-" << cpus[j];
+        i = j + 1;
+    }
+    return out.str();
+}
+
+CpuTopology detectCpuTopology() {
+    CpuTopology topology;
+
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &mask)) topology.cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (topology.cpus.empty()) {
+        int count = std::max(1u, std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < count; cpu++) topology.cpus.push_back(cpu);
+    }
+
+    std::map<int, int> nodeOf;
+    int nodes = 0;
+    for (int node = 0; node < 1024; node++) {
+        std::ifstream list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!list) {
+            if (node > 0 && nodes > 0) break;
+            continue;
+        }
+        std::string text;
+        std::getline(list, text);
+        for (int cpu : parseCpuList(text)) nodeOf[cpu] = node;
+        nodes = node + 1;
+    }
+
+    for (int cpu : topology.cpus) {
+        auto it = nodeOf.find(cpu);
+        topology.cpuNode.push_back(it == nodeOf.end() ? 0 : it->second);
+    }
+    topology.numaNodes = std::max(nodes, 1);
+    return topology;
+}
+
+std::vector<CpuSlot> partitionCpuSlots(const CpuTopology& topology, int count, int portStride) {
+    std::map<int, std::vector<int>> byNode;
+    for (size_t i = 0; i < topology.cpus.size(); i++) {
+        byNode[topology.cpuNode[i]].push_back(topology.cpus[i]);
+    }
+
+    count = std::max(1, std::min(count, static_cast<int>(topology.cpus.size())));
+    std::vector<std::pair<int, std::vector<int>>> nodes(byNode.begin(), byNode.end());
+
+    // Too few slots to use every node: one slot per node, biggest nodes first.
+    if (count < static_cast<int>(nodes.size())) {
+        std::stable_sort(nodes.begin(), nodes.end(),
+                         [](const auto& a, const auto& b) { return a.second.size() > b.second.size(); });
+        nodes.resize(count);
+    }
+
+    // Deal slots round-robin over the nodes that still have a free CPU.
+    std::vector<int> slotsPerNode(nodes.size(), 0);
+    for (int assigned = 0; assigned < count;) {
+        for (size_t n = 0; n < nodes.size() && assigned < count; n++) {
+            if (slotsPerNode[n] < static_cast<int>(nodes[n].second.size())) {
+                slotsPerNode[n]++;
+                assigned++;
+            }
+        }
+    }
+
+    std::vector<CpuSlot> slots;
+    for (size_t n = 0; n < nodes.size(); n++) {
+        const std::vector<int>& cpus = nodes[n].second;
+        size_t begin = 0;
+        for (int s = 0; s < slotsPerNode[n]; s++) {
+            size_t size = cpus.size() / slotsPerNode[n] + (static_cast<size_t>(s) < cpus.size() % slotsPerNode[n] ? 1 : 0);
+            std::vector<int> chunk(cpus.begin() + begin, cpus.begin() + begin + size);
+            begin += size;
+
+            CpuSlot slot;
+            slot.index = static_cast<int>(slots.size());
+            slot.numaNode = nodes[n].first;
+            slot.portOffset = slot.index * portStride;
+            if (chunk.size() == 1) {
+                slot.serverCpus = chunk;
+                slot.loadCpus = chunk;
+            } else {
+                size_t half = chunk.size() / 2;
+                slot.serverCpus.assign(chunk.begin(), chunk.begin() + half);
+                slot.loadCpus.assign(chunk.begin() + half, chunk.end());
+            }
+            slots.push_back(slot);
+        }
+    }
+    return slots;
+}
+
+bool pinCurrentThread(const std::vector<int>& cpus) {
+#ifdef __linux__
+    if (cpus.empty()) return false;
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int cpu : cpus) CPU_SET(cpu, &mask);
+    return sched_setaffinity(0, sizeof(mask), &mask) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
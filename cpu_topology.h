@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// CPUs this process may run on, with the NUMA node of each (parallel vectors).
+struct CpuTopology {
+    std::vector<int> cpus;
+    std::vector<int> cpuNode;
+    int numaNodes = 1;
+};
+
+// An isolated execution slot: the server is pinned to serverCpus and the load
+// generator to loadCpus, and every port the slot uses is shifted by portOffset so
+// slots can run the same setup side by side. Empty CPU lists mean "not pinned".
+struct CpuSlot {
+    int index = 0;
+    int numaNode = -1;
+    std::vector<int> serverCpus;
+    std::vector<int> loadCpus;
+    int portOffset = 0;
+};
+
+CpuTopology detectCpuTopology();
+
+// Splits the topology into up to `count` slots. Slots never span NUMA nodes unless
+// there are fewer CPUs than nodes; each slot's CPUs are halved between server and
+// load generator (a single-CPU slot shares it).
+std::vector<CpuSlot> partitionCpuSlots(const CpuTopology& topology, int count, int portStride);
+
+// Pins the calling thread (and every thread or process it creates afterwards).
+// Returns false when pinning is unsupported or the kernel rejects the mask.
+bool pinCurrentThread(const std::vector<int>& cpus);
+
+// "0-3,8,10-11" style lists, as used by /sys/devices/system/node/*/cpulist.
+std::vector<int> parseCpuList(const std::string& text);
+std::string formatCpuList(const std::vector<int>& cpus);
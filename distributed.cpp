@@ -0,0 +1,804 @@
+#include "distributed.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "arrival.h"
+
+namespace {
+
+constexpr int kProtocolVersion = 6;
+constexpr int kSyncSamples = 8;
+constexpr int kHandshakeTimeoutMs = 10000;
+constexpr uint64_t kStartLeadNs = 500ULL * 1000000ULL;
+
+// Buffered newline-delimited reader/writer over a connected socket.
+class LineChannel {
+public:
+    explicit LineChannel(int fd) : fd(fd) {}
+    ~LineChannel() {
+        if (fd >= 0) close(fd);
+    }
+    LineChannel(const LineChannel&) = delete;
+    LineChannel& operator=(const LineChannel&) = delete;
+
+    int descriptor() const { return fd; }
+
+    void send(const std::string& line) {
+        std::string data = line + "\n";
+        size_t sent = 0;
+        while (sent < data.size()) {
+#if defined(MSG_NOSIGNAL)
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#else
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, 0);
+#endif
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("send failed: ") + std::strerror(errno));
+            }
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+    // Moves the next complete line out of the buffer, if there is one.
+    bool takeLine(std::string& line) {
+        size_t newline = buffer.find('\n');
+        if (newline == std::string::npos) return false;
+        line = buffer.substr(0, newline);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        buffer.erase(0, newline + 1);
+        return true;
+    }
+
+    // One recv into the buffer; false on EOF or error.
+    bool fill() {
+        char chunk[4096];
+        for (;;) {
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buffer.append(chunk, static_cast<size_t>(n));
+            return true;
+        }
+    }
+
+    // Blocks for a line; false on EOF. timeoutMs < 0 waits forever, otherwise throws when it expires.
+    bool readLine(std::string& line, int timeoutMs) {
+        while (!takeLine(line)) {
+            if (timeoutMs >= 0) {
+                pollfd pfd{fd, POLLIN, 0};
+                int rc = poll(&pfd, 1, timeoutMs);
+                if (rc == 0) throw std::runtime_error("timed out waiting for agent reply");
+                if (rc < 0 && errno != EINTR) return false;
+                if (rc < 0) continue;
+            }
+            if (!fill()) return false;
+        }
+        return true;
+    }
+
+private:
+    int fd;
+    std::string buffer;
+};
+
+std::vector<std::string> splitWords(const std::string& line) {
+    std::istringstream in(line);
+    std::vector<std::string> words;
+    std::string word;
+    while (in >> word) words.push_back(word);
+    return words;
+}
+
+std::map<std::string, std::string> parseFields(const std::vector<std::string>& words, size_t first) {
+    std::map<std::string, std::string> fields;
+    for (size_t i = first; i < words.size(); i++) {
+        size_t eq = words[i].find('=');
+        if (eq != std::string::npos) fields[words[i].substr(0, eq)] = words[i].substr(eq + 1);
+    }
+    return fields;
+}
+
+std::string field(const std::map<std::string, std::string>& fields, const std::string& key) {
+    auto it = fields.find(key);
+    if (it == fields.end()) throw std::runtime_error("missing field " + key);
+    return it->second;
+}
+
+// The latency phases under their RESULT key prefix, e.g. "firstByteAvg" and "firstByteHist".
+const std::array<std::pair<const char*, PhaseLatency LatencyPhases::*>, 4> kPhases = {{
+    {"wait", &LatencyPhases::wait},
+    {"write", &LatencyPhases::write},
+    {"firstByte", &LatencyPhases::firstByte},
+    {"transfer", &LatencyPhases::transfer},
+}};
+
+std::string localHostname() {
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0) return "unknown";
+    return name;
+}
+
+void handleRun(LineChannel& channel, const std::vector<std::string>& words) {
+    auto fields = parseFields(words, 1);
+
+    BenchmarkConfig config;
+    config.connections = std::stoi(field(fields, "connections"));
+    config.threads = std::stoi(field(fields, "threads"));
+    config.duration = field(fields, "duration");
+    config.timeout = field(fields, "timeout");
+    config.rate = std::stod(field(fields, "rate"));
+    config.rateProfile = field(fields, "rateProfile");
+    config.arrivalProcess = field(fields, "arrival");
+    config.arrivalSeed = static_cast<unsigned>(std::stoul(field(fields, "arrivalSeed")));
+    config.transport = field(fields, "transport");
+    config.h2Streams = std::stoi(field(fields, "h2Streams"));
+    config.tlsSessionResumption = field(fields, "tlsResume") == "1";
+    int timelineMs = std::stoi(field(fields, "timelineMs"));
+
+    LoadTarget target;
+    target.host = field(fields, "host");
+    target.port = std::stoi(field(fields, "port"));
+    target.path = field(fields, "path");
+    // route<i>=<method>,<bodyBytes>,<weight>,<name>,<path>; the path goes last so it may contain commas.
+    int routeCount = fields.count("routes") ? std::stoi(field(fields, "routes")) : 0;
+    for (int i = 0; i < routeCount; i++) {
+        std::istringstream spec(field(fields, "route" + std::to_string(i)));
+        ScenarioRoute route;
+        std::string bodyBytes, weight;
+        if (!std::getline(spec, route.method, ',') || !std::getline(spec, bodyBytes, ',') ||
+            !std::getline(spec, weight, ',') || !std::getline(spec, route.name, ',') || !std::getline(spec, route.path)) {
+            throw std::runtime_error("malformed route" + std::to_string(i));
+        }
+        route.bodyBytes = static_cast<size_t>(std::stoull(bodyBytes));
+        route.weight = std::stoi(weight);
+        target.routes.push_back(route);
+    }
+
+    LoadGenerator generator(config, target);
+    generator.setStartTime(std::stoull(field(fields, "start")));
+    generator.setProgressCallback([&channel](const LoadProgress& progress) {
+        channel.send("TICK " + std::to_string(static_cast<int>(progress.elapsedSec + 0.5)) + " " +
+                     std::to_string(progress.completed) + " " + std::to_string(progress.errors));
+    });
+    if (timelineMs > 0) {
+        generator.setTimelineCallback([&channel](const TimelineBucket& bucket) {
+            std::ostringstream line;
+            line << "BUCKET " << bucket.index
+                 << " requests=" << bucket.completed
+                 << " errors=" << bucket.errors
+                 << " bytes=" << bucket.bytesRead
+                 << " hist=" << bucket.latency->serialize();
+            channel.send(line.str());
+        }, timelineMs);
+    }
+    BenchmarkResult result = generator.run();
+
+    std::ostringstream line;
+    line << "RESULT requests=" << result.totalRequests
+         << " errors=" << result.errors
+         << " timeouts=" << result.timeouts
+         << " socketErrors=" << result.socketErrors
+         << " rps=" << result.requestsPerSecond
+         << " throughput=" << result.throughput
+         << " avgLatency=" << result.avgLatency
+         << " maxLatency=" << result.maxLatency
+         << " p50=" << result.p50Latency
+         << " p75=" << result.p75Latency
+         << " p90=" << result.p90Latency
+         << " p99=" << result.p99Latency;
+    const ConnectionStats& setup = result.connectionSetup;
+    if (setup.valid) {
+        line << " connOpened=" << setup.opened
+             << " tlsHandshakes=" << setup.tlsHandshakes
+             << " tlsResumed=" << setup.tlsResumed
+             << " setupAvg=" << setup.avgSetupMs
+             << " setupP50=" << setup.p50SetupMs
+             << " setupP99=" << setup.p99SetupMs
+             << " setupMax=" << setup.maxSetupMs
+             << " setupHist=" << setup.setupLatency.serialize();
+    }
+    if (result.latencyPhases.valid) {
+        line << " phaseRequests=" << result.latencyPhases.requests;
+        for (const auto& [name, member] : kPhases) {
+            const PhaseLatency& phase = result.latencyPhases.*member;
+            line << " " << name << "Avg=" << phase.avgMs << " " << name << "Hist=" << phase.latency.serialize();
+        }
+    }
+    const ClientLoad& client = result.client;
+    if (client.valid) {
+        line << " clientThreads=" << client.threads
+             << " clientCores=" << client.cpuCores
+             << " busiestThread=" << client.busiestThread
+             << " pacedSends=" << client.pacedSends
+             << " lateSends=" << client.lateSends
+             << " backlogPeak=" << client.backlogPeak
+             << " sendLagP99=" << client.sendLagP99Ms
+             << " sendLagMax=" << client.sendLagMaxMs;
+    }
+    channel.send(line.str());
+    channel.send("HIST " + result.latencyHistogram.serialize());
+    for (size_t i = 0; i < result.routes.size(); i++) {
+        const RouteResult& route = result.routes[i];
+        std::ostringstream routeLine;
+        routeLine << "ROUTE " << i
+                  << " requests=" << route.requests
+                  << " errors=" << route.errors
+                  << " rps=" << route.requestsPerSecond
+                  << " avgLatency=" << route.avgLatency
+                  << " hist=" << route.latencyHistogram.serialize();
+        channel.send(routeLine.str());
+    }
+    channel.send("END");
+}
+
+// Answers one coordinator until it says BYE or disconnects.
+void serveSession(int fd) {
+    LineChannel channel(fd);
+    std::string line;
+    try {
+        while (channel.readLine(line, -1)) {
+            std::vector<std::string> words = splitWords(line);
+            if (words.empty()) continue;
+            const std::string& command = words[0];
+
+            if (command == "HELLO") {
+                if (words.size() < 2 || std::atoi(words[1].c_str()) != kProtocolVersion) {
+                    channel.send("ERROR unsupported protocol version");
+                    return;
+                }
+                channel.send("READY " + localHostname());
+            } else if (command == "SYNC" && words.size() >= 2) {
+                channel.send("SYNC " + words[1] + " " + std::to_string(monotonicNowNs()));
+            } else if (command == "RUN") {
+                try {
+                    handleRun(channel, words);
+                } catch (const std::exception& e) {
+                    channel.send(std::string("ERROR ") + e.what());
+                }
+            } else if (command == "BYE") {
+                return;
+            } else {
+                channel.send("ERROR unknown command " + command);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Agent session ended: " << e.what() << std::endl;
+    }
+}
+
+int connectTo(const AgentEndpoint& endpoint) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* resolved = nullptr;
+    std::string port = std::to_string(endpoint.port);
+    int rc = getaddrinfo(endpoint.host.c_str(), port.c_str(), &hints, &resolved);
+    if (rc != 0 || resolved == nullptr) {
+        throw std::runtime_error("Failed to resolve agent " + endpoint.host + ": " + gai_strerror(rc));
+    }
+
+    int fd = -1;
+    for (const addrinfo* ai = resolved; ai != nullptr && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, SOCK_STREAM, 0);
+        if (fd < 0) continue;
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(resolved);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to connect to agent " + endpoint.host + ":" + port);
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+struct AgentSession {
+    std::string name;
+    std::unique_ptr<LineChannel> channel;
+    std::thread localThread;
+    int64_t clockOffsetNs = 0;  // agent clock minus coordinator clock
+    uint64_t rttNs = 0;
+    uint64_t lastCompleted = 0;
+    uint64_t lastErrors = 0;
+    bool finished = false;
+    BenchmarkResult result;
+
+    ~AgentSession() {
+        if (channel) {
+            try {
+                channel->send("BYE");
+            } catch (...) {
+            }
+        }
+        channel.reset();
+        if (localThread.joinable()) localThread.join();
+    }
+};
+
+std::unique_ptr<AgentSession> openSession(const AgentEndpoint& endpoint) {
+    auto session = std::make_unique<AgentSession>();
+    if (endpoint.local) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            throw std::runtime_error(std::string("socketpair failed: ") + std::strerror(errno));
+        }
+        session->name = "local";
+        session->channel = std::make_unique<LineChannel>(fds[0]);
+        session->localThread = std::thread(serveSession, fds[1]);
+    } else {
+        session->name = endpoint.host + ":" + std::to_string(endpoint.port);
+        session->channel = std::make_unique<LineChannel>(connectTo(endpoint));
+    }
+
+    std::string line;
+    session->channel->send("HELLO " + std::to_string(kProtocolVersion));
+    if (!session->channel->readLine(line, kHandshakeTimeoutMs) || line.rfind("READY", 0) != 0) {
+        throw std::runtime_error("Agent " + session->name + " refused handshake: " + line);
+    }
+
+    // NTP-style offset estimate; keep the sample with the smallest round trip.
+    session->rttNs = UINT64_MAX;
+    for (int i = 0; i < kSyncSamples; i++) {
+        uint64_t sent = monotonicNowNs();
+        session->channel->send("SYNC " + std::to_string(sent));
+        if (!session->channel->readLine(line, kHandshakeTimeoutMs)) {
+            throw std::runtime_error("Agent " + session->name + " disconnected during clock sync");
+        }
+        uint64_t received = monotonicNowNs();
+        std::vector<std::string> words = splitWords(line);
+        if (words.size() < 3 || words[0] != "SYNC" || std::stoull(words[1]) != sent) {
+            throw std::runtime_error("Agent " + session->name + " sent a bad SYNC reply: " + line);
+        }
+        uint64_t rtt = received - sent;
+        if (rtt < session->rttNs) {
+            session->rttNs = rtt;
+            int64_t midpoint = static_cast<int64_t>(sent + rtt / 2);
+            session->clockOffsetNs = static_cast<int64_t>(std::stoull(words[2])) - midpoint;
+        }
+    }
+    return session;
+}
+
+void parseResult(AgentSession& session, const std::vector<std::string>& words) {
+    auto fields = parseFields(words, 1);
+    BenchmarkResult& result = session.result;
+    result.totalRequests = std::stoi(field(fields, "requests"));
+    result.errors = std::stoi(field(fields, "errors"));
+    result.timeouts = std::stoi(field(fields, "timeouts"));
+    result.socketErrors = std::stoi(field(fields, "socketErrors"));
+    result.requestsPerSecond = std::stod(field(fields, "rps"));
+    result.throughput = std::stod(field(fields, "throughput"));
+    result.avgLatency = std::stod(field(fields, "avgLatency"));
+    result.maxLatency = std::stod(field(fields, "maxLatency"));
+    result.p50Latency = std::stod(field(fields, "p50"));
+    result.p75Latency = std::stod(field(fields, "p75"));
+    result.p90Latency = std::stod(field(fields, "p90"));
+    result.p99Latency = std::stod(field(fields, "p99"));
+    if (fields.count("connOpened")) {
+        ConnectionStats& setup = result.connectionSetup;
+        setup.valid = true;
+        setup.opened = std::stoi(field(fields, "connOpened"));
+        setup.tlsHandshakes = std::stoi(field(fields, "tlsHandshakes"));
+        setup.tlsResumed = std::stoi(field(fields, "tlsResumed"));
+        setup.avgSetupMs = std::stod(field(fields, "setupAvg"));
+        setup.p50SetupMs = std::stod(field(fields, "setupP50"));
+        setup.p99SetupMs = std::stod(field(fields, "setupP99"));
+        setup.maxSetupMs = std::stod(field(fields, "setupMax"));
+        if (!HdrHistogram::deserialize(field(fields, "setupHist"), setup.setupLatency)) {
+            throw std::runtime_error("Agent " + session.name + " sent an unreadable connection setup histogram");
+        }
+    }
+    if (fields.count("phaseRequests")) {
+        LatencyPhases& phases = result.latencyPhases;
+        phases.valid = true;
+        phases.requests = std::stoi(field(fields, "phaseRequests"));
+        for (const auto& [name, member] : kPhases) {
+            PhaseLatency& phase = phases.*member;
+            phase.avgMs = std::stod(field(fields, std::string(name) + "Avg"));
+            if (!HdrHistogram::deserialize(field(fields, std::string(name) + "Hist"), phase.latency)) {
+                throw std::runtime_error("Agent " + session.name + " sent an unreadable " + name + " phase histogram");
+            }
+        }
+    }
+    if (fields.count("clientThreads")) {
+        ClientLoad& client = result.client;
+        client.valid = true;
+        client.threads = std::stoi(field(fields, "clientThreads"));
+        client.cpuCores = std::stod(field(fields, "clientCores"));
+        client.busiestThread = std::stod(field(fields, "busiestThread"));
+        client.pacedSends = std::stol(field(fields, "pacedSends"));
+        client.lateSends = std::stol(field(fields, "lateSends"));
+        client.backlogPeak = std::stoi(field(fields, "backlogPeak"));
+        client.sendLagP99Ms = std::stod(field(fields, "sendLagP99"));
+        client.sendLagMaxMs = std::stod(field(fields, "sendLagMax"));
+    }
+}
+
+void parseRoute(AgentSession& session, const std::vector<std::string>& words, const std::vector<ScenarioRoute>& routes) {
+    size_t index = static_cast<size_t>(std::stoul(words[1]));
+    if (index >= routes.size()) throw std::runtime_error("Agent " + session.name + " reported an unknown route");
+    auto fields = parseFields(words, 2);
+    std::vector<RouteResult>& results = session.result.routes;
+    if (results.size() < routes.size()) results.resize(routes.size());
+    RouteResult& route = results[index];
+    route.name = routes[index].name;
+    route.method = routes[index].method;
+    route.path = routes[index].path;
+    route.requests = std::stoi(field(fields, "requests"));
+    route.errors = std::stoi(field(fields, "errors"));
+    route.requestsPerSecond = std::stod(field(fields, "rps"));
+    route.avgLatency = std::stod(field(fields, "avgLatency"));
+    if (!HdrHistogram::deserialize(field(fields, "hist"), route.latencyHistogram)) {
+        throw std::runtime_error("Agent " + session.name + " sent an unreadable route histogram");
+    }
+}
+
+}  // namespace
+
+AgentEndpoint parseAgentEndpoint(const std::string& spec) {
+    AgentEndpoint endpoint;
+    if (spec == "local") {
+        endpoint.host = "local";
+        endpoint.local = true;
+        return endpoint;
+    }
+
+    endpoint.host = spec;
+    if (!spec.empty() && spec.front() == '[') {
+        // [v6addr]:port
+        size_t close = spec.find(']');
+        if (close == std::string::npos) throw std::runtime_error("Invalid agent address: " + spec);
+        endpoint.host = spec.substr(1, close - 1);
+        if (close + 1 < spec.size() && spec[close + 1] == ':') endpoint.port = std::atoi(spec.c_str() + close + 2);
+    } else {
+        size_t colon = spec.rfind(':');
+        if (colon != std::string::npos && spec.find(':') == colon) {
+            endpoint.host = spec.substr(0, colon);
+            endpoint.port = std::atoi(spec.c_str() + colon + 1);
+        }
+    }
+    if (endpoint.host.empty() || endpoint.port <= 0) {
+        throw std::runtime_error("Invalid agent address: " + spec);
+    }
+    return endpoint;
+}
+
+int runAgent(int listenPort) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::cerr << "Agent: socket failed: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<uint16_t>(listenPort));
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 4) != 0) {
+        std::cerr << "Agent: cannot listen on port " << listenPort << ": " << std::strerror(errno) << std::endl;
+        close(listener);
+        return 1;
+    }
+
+    std::cout << "Load generator agent listening on port " << listenPort << std::endl;
+    for (;;) {
+        sockaddr_storage peer{};
+        socklen_t peerLen = sizeof(peer);
+        int fd = accept(listener, reinterpret_cast<sockaddr*>(&peer), &peerLen);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Agent: accept failed: " << std::strerror(errno) << std::endl;
+            close(listener);
+            return 1;
+        }
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        char host[NI_MAXHOST] = "?";
+        getnameinfo(reinterpret_cast<sockaddr*>(&peer), peerLen, host, sizeof(host), nullptr, 0, NI_NUMERICHOST);
+        std::cout << "Coordinator connected from " << host << std::endl;
+        serveSession(fd);
+        std::cout << "Coordinator " << host << " disconnected" << std::endl;
+    }
+}
+
+BenchmarkResult runDistributed(const BenchmarkConfig& config, const LoadTarget& target,
+                               const std::vector<AgentEndpoint>& agents,
+                               const std::function<void(const DistributedTick&)>& onTick,
+                               const std::function<void(const TimelineBucket&)>& onBucket, int bucketMs) {
+    int agentCount = std::min(static_cast<int>(agents.size()), std::max(config.connections, 1));
+    if (agentCount == 0) {
+        throw std::runtime_error("No load generator agents configured");
+    }
+
+    std::vector<std::unique_ptr<AgentSession>> sessions;
+    for (int i = 0; i < agentCount; i++) {
+        sessions.push_back(openSession(agents[i]));
+    }
+
+    uint64_t maxRtt = 0;
+    for (const auto& session : sessions) maxRtt = std::max(maxRtt, session->rttNs);
+    uint64_t start = monotonicNowNs() + kStartLeadNs + 2 * maxRtt;
+
+    int connections = std::max(config.connections, 1);
+    std::string rateProfile = portableRateProfile(config.rateProfile);
+    for (int i = 0; i < agentCount; i++) {
+        int share = connections / agentCount + (i < connections % agentCount ? 1 : 0);
+        std::ostringstream run;
+        run << "RUN start=" << static_cast<uint64_t>(static_cast<int64_t>(start) + sessions[i]->clockOffsetNs)
+            << " connections=" << share
+            << " threads=" << std::max(1, std::min(config.threads, share))
+            << " duration=" << config.duration
+            << " timeout=" << config.timeout
+            << " rate=" << (config.rate * share / connections)
+            << " rateProfile=" << rateProfile
+            << " arrival=" << config.arrivalProcess
+            // Agents draw different Poisson arrivals from one another.
+            << " arrivalSeed=" << (config.arrivalSeed + 7919u * static_cast<unsigned>(i))
+            << " transport=" << config.transport
+            << " h2Streams=" << config.h2Streams
+            << " tlsResume=" << (config.tlsSessionResumption ? 1 : 0)
+            << " timelineMs=" << (onBucket ? bucketMs : 0)
+            << " host=" << target.host
+            << " port=" << target.port
+            << " path=" << target.path;
+        if (!target.routes.empty()) {
+            run << " routes=" << target.routes.size();
+            for (size_t r = 0; r < target.routes.size(); r++) {
+                const ScenarioRoute& route = target.routes[r];
+                run << " route" << r << "=" << route.method << "," << route.bodyBytes << "," << route.weight
+                    << "," << route.name << "," << route.path;
+            }
+        }
+        sessions[i]->channel->send(run.str());
+    }
+
+    // Stream TICK lines until every agent has sent END; a second is reported once
+    // all agents still running have delivered it.
+    uint64_t deadline = start + static_cast<uint64_t>(parseDurationMs(config.duration) + parseDurationMs(config.timeout)) * 1000000ULL +
+                        30ULL * 1000000000ULL;
+    std::map<int, DistributedTick> pendingTicks;
+    int running = agentCount;
+    auto flushTicks = [&](bool all) {
+        while (!pendingTicks.empty()) {
+            auto it = pendingTicks.begin();
+            if (!all && it->second.agentsReporting < running) break;
+            if (onTick) onTick(it->second);
+            pendingTicks.erase(it);
+        }
+    };
+
+    // A bucket goes out once every agent has sent its share, or when the test ends.
+    struct PendingBucket {
+        int agents = 0;
+        uint64_t completed = 0;
+        uint64_t errors = 0;
+        uint64_t bytesRead = 0;
+        HdrHistogram latency;
+    };
+    std::map<int, PendingBucket> pendingBuckets;
+    const int64_t durationMs = parseDurationMs(config.duration);
+    auto flushBuckets = [&](bool all) {
+        while (!pendingBuckets.empty()) {
+            auto it = pendingBuckets.begin();
+            if (!all && it->second.agents < agentCount) break;
+            TimelineBucket bucket;
+            bucket.index = it->first;
+            bucket.startSec = static_cast<double>(it->first) * bucketMs / 1000.0;
+            bucket.endSec = std::min(static_cast<int64_t>(it->first + 1) * bucketMs, durationMs) / 1000.0;
+            // On the coordinator's clock, which the servers it started share.
+            bucket.monotonicStartSec = start / 1e9 + bucket.startSec;
+            bucket.completed = it->second.completed;
+            bucket.errors = it->second.errors;
+            bucket.bytesRead = it->second.bytesRead;
+            bucket.latency = &it->second.latency;
+            onBucket(bucket);
+            pendingBuckets.erase(it);
+        }
+    };
+
+    while (running > 0) {
+        std::vector<pollfd> fds;
+        std::vector<AgentSession*> polled;
+        for (auto& session : sessions) {
+            if (session->finished) continue;
+            fds.push_back({session->channel->descriptor(), POLLIN, 0});
+            polled.push_back(session.get());
+        }
+        uint64_t now = monotonicNowNs();
+        if (now >= deadline) throw std::runtime_error("Timed out waiting for agent results");
+        int rc = poll(fds.data(), fds.size(), static_cast<int>((deadline - now) / 1000000ULL) + 1);
+        if (rc < 0 && errno == EINTR) continue;
+        if (rc < 0) throw std::runtime_error(std::string("poll failed: ") + std::strerror(errno));
+
+        for (size_t i = 0; i < fds.size(); i++) {
+            if (fds[i].revents == 0) continue;
+            AgentSession& session = *polled[i];
+            if (!session.channel->fill()) {
+                throw std::runtime_error("Agent " + session.name + " disconnected during the test");
+            }
+
+            std::string line;
+            while (!session.finished && session.channel->takeLine(line)) {
+                std::vector<std::string> words = splitWords(line);
+                if (words.empty()) continue;
+                if (words[0] == "TICK" && words.size() >= 4) {
+                    uint64_t completed = std::stoull(words[2]);
+                    uint64_t errors = std::stoull(words[3]);
+                    DistributedTick& tick = pendingTicks[std::stoi(words[1])];
+                    tick.second = std::stoi(words[1]);
+                    tick.completed += completed - session.lastCompleted;
+                    tick.errors += errors - session.lastErrors;
+                    tick.agentsReporting++;
+                    session.lastCompleted = completed;
+                    session.lastErrors = errors;
+                } else if (words[0] == "BUCKET" && words.size() >= 2 && onBucket) {
+                    auto fields = parseFields(words, 2);
+                    PendingBucket& bucket = pendingBuckets[std::stoi(words[1])];
+                    HdrHistogram part;
+                    if (!HdrHistogram::deserialize(field(fields, "hist"), part)) {
+                        throw std::runtime_error("Agent " + session.name + " sent an unreadable timeline bucket");
+                    }
+                    bucket.agents++;
+                    bucket.completed += std::stoull(field(fields, "requests"));
+                    bucket.errors += std::stoull(field(fields, "errors"));
+                    bucket.bytesRead += std::stoull(field(fields, "bytes"));
+                    bucket.latency.merge(part);
+                } else if (words[0] == "RESULT") {
+                    parseResult(session, words);
+                } else if (words[0] == "HIST" && words.size() >= 2) {
+                    if (!HdrHistogram::deserialize(words[1], session.result.latencyHistogram)) {
+                        throw std::runtime_error("Agent " + session.name + " sent an unreadable histogram");
+                    }
+                } else if (words[0] == "ROUTE" && words.size() >= 2) {
+                    parseRoute(session, words, target.routes);
+                } else if (words[0] == "END") {
+                    session.finished = true;
+                    running--;
+                } else if (words[0] == "ERROR") {
+                    throw std::runtime_error("Agent " + session.name + ": " + line.substr(6));
+                }
+            }
+        }
+        flushTicks(false);
+        flushBuckets(false);
+    }
+    flushTicks(true);
+    flushBuckets(true);
+
+    BenchmarkResult merged;
+    double weightedLatency = 0;
+    double weightedSetup = 0;
+    bool allHistograms = true;
+    for (const auto& session : sessions) {
+        const BenchmarkResult& part = session->result;
+        merged.requestsPerSecond += part.requestsPerSecond;
+        merged.throughput += part.throughput;
+        merged.totalRequests += part.totalRequests;
+        merged.errors += part.errors;
+        merged.timeouts += part.timeouts;
+        merged.socketErrors += part.socketErrors;
+        merged.maxLatency = std::max(merged.maxLatency, part.maxLatency);
+        weightedLatency += part.avgLatency * part.totalRequests;
+        if (part.connectionSetup.valid) {
+            ConnectionStats& setup = merged.connectionSetup;
+            setup.valid = true;
+            setup.opened += part.connectionSetup.opened;
+            setup.tlsHandshakes += part.connectionSetup.tlsHandshakes;
+            setup.tlsResumed += part.connectionSetup.tlsResumed;
+            weightedSetup += part.connectionSetup.avgSetupMs * part.connectionSetup.opened;
+            setup.setupLatency.merge(part.connectionSetup.setupLatency);
+        }
+        if (part.latencyPhases.valid) {
+            LatencyPhases& phases = merged.latencyPhases;
+            phases.valid = true;
+            phases.requests += part.latencyPhases.requests;
+            for (const auto& named : kPhases) {
+                const PhaseLatency& from = part.latencyPhases.*named.second;
+                PhaseLatency& into = phases.*named.second;
+                into.avgMs += from.avgMs * part.latencyPhases.requests;
+                into.latency.merge(from.latency);
+            }
+        }
+        // Client work adds up across agents; the busiest thread and send lag are the
+        // worst agent's, since one saturated agent already caps the load.
+        if (part.client.valid) {
+            ClientLoad& client = merged.client;
+            client.valid = true;
+            client.threads += part.client.threads;
+            client.cpuCores += part.client.cpuCores;
+            client.busiestThread = std::max(client.busiestThread, part.client.busiestThread);
+            client.pacedSends += part.client.pacedSends;
+            client.lateSends += part.client.lateSends;
+            client.backlogPeak = std::max(client.backlogPeak, part.client.backlogPeak);
+            client.sendLagP99Ms = std::max(client.sendLagP99Ms, part.client.sendLagP99Ms);
+            client.sendLagMaxMs = std::max(client.sendLagMaxMs, part.client.sendLagMaxMs);
+        }
+        merged.p50Latency = std::max(merged.p50Latency, part.p50Latency);
+        merged.p75Latency = std::max(merged.p75Latency, part.p75Latency);
+        merged.p90Latency = std::max(merged.p90Latency, part.p90Latency);
+        merged.p99Latency = std::max(merged.p99Latency, part.p99Latency);
+        if (part.latencyHistogram.totalCount() > 0) {
+            merged.latencyHistogram.merge(part.latencyHistogram);
+        } else if (part.totalRequests > 0) {
+            allHistograms = false;
+        }
+        merged.rawOutput += session->name + ": " + std::to_string(part.requestsPerSecond) + " req/s, clock offset " +
+                            std::to_string(session->clockOffsetNs / 1000) + "us, rtt " +
+                            std::to_string(session->rttNs / 1000) + "us\n";
+    }
+    if (merged.totalRequests > 0) merged.avgLatency = weightedLatency / merged.totalRequests;
+    if (merged.connectionSetup.opened > 0) {
+        ConnectionStats& setup = merged.connectionSetup;
+        setup.avgSetupMs = weightedSetup / setup.opened;
+        setup.p50SetupMs = setup.setupLatency.valueAtPercentile(50) / 1000.0;
+        setup.p99SetupMs = setup.setupLatency.valueAtPercentile(99) / 1000.0;
+        setup.maxSetupMs = setup.setupLatency.max() / 1000.0;
+    }
+    if (merged.latencyPhases.requests > 0) {
+        for (const auto& named : kPhases) {
+            PhaseLatency& phase = merged.latencyPhases.*named.second;
+            phase.avgMs /= merged.latencyPhases.requests;
+            phase.p50Ms = phase.latency.valueAtPercentile(50) / 1000.0;
+            phase.p90Ms = phase.latency.valueAtPercentile(90) / 1000.0;
+            phase.p99Ms = phase.latency.valueAtPercentile(99) / 1000.0;
+            phase.maxMs = phase.latency.max() / 1000.0;
+        }
+    }
+
+    for (const auto& session : sessions) {
+        const std::vector<RouteResult>& parts = session->result.routes;
+        if (merged.routes.size() < parts.size()) merged.routes.resize(parts.size());
+        for (size_t r = 0; r < parts.size(); r++) {
+            RouteResult& route = merged.routes[r];
+            double weighted = route.avgLatency * route.requests + parts[r].avgLatency * parts[r].requests;
+            route.name = parts[r].name;
+            route.method = parts[r].method;
+            route.path = parts[r].path;
+            route.requests += parts[r].requests;
+            route.errors += parts[r].errors;
+            route.requestsPerSecond += parts[r].requestsPerSecond;
+            route.avgLatency = route.requests > 0 ? weighted / route.requests : 0.0;
+            route.latencyHistogram.merge(parts[r].latencyHistogram);
+        }
+    }
+    for (auto& route : merged.routes) summarizeRoute(route);
+
+    const HdrHistogram& histogram = merged.latencyHistogram;
+    if (allHistograms && histogram.totalCount() > 0) {
+        merged.maxLatency = histogram.max() / 1000.0;
+        merged.p50Latency = histogram.valueAtPercentile(50) / 1000.0;
+        merged.p75Latency = histogram.valueAtPercentile(75) / 1000.0;
+        merged.p90Latency = histogram.valueAtPercentile(90) / 1000.0;
+        merged.p99Latency = histogram.valueAtPercentile(99) / 1000.0;
+        merged.p999Latency = histogram.valueAtPercentile(99.9) / 1000.0;
+        merged.p9999Latency = histogram.valueAtPercentile(99.99) / 1000.0;
+    } else {
+        // Without every agent's histogram the percentiles above are per-agent maxima,
+        // an upper bound; drop the partial histogram so it is not mistaken for the whole.
+        merged.latencyHistogram.reset();
+    }
+    return merged;
+}
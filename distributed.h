@@ -0,0 +1,65 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "benchmark_types.h"
+#include "load_generator.h"
+
+// Coordinator/agent protocol for generating load from several machines at once.
+// Newline-delimited text over TCP, one request/reply exchange at a time:
+//
+//   coordinator                         agent
+//   HELLO 6                        ->   READY <hostname>
+//   SYNC <coordNs>                 ->   SYNC <coordNs> <agentNs>          (repeated)
+//   RUN start=<agentNs> key=value  ->   TICK <sec> <completed> <errors>   (every second)
+//                                       BUCKET <i> key=value ... hist=... (per timeline bucket)
+//                                       RESULT key=value ...
+//                                       HIST <serialized histogram>
+//                                       ROUTE <i> key=value ... hist=...  (per route, mixes only)
+//                                       END
+//   BYE
+//
+// Start times are sent in each agent's own monotonic clock, using the offset from
+// the lowest-RTT SYNC sample, so every agent begins within about half an RTT.
+// RUN carries the transport (see parseTransport); agents connect with it directly
+// and add connection setup fields to RESULT when they measured any. RESULT also
+// carries the latency phase histograms and the agent's client load, and with
+// timelineMs > 0 in RUN the agent streams its timeline buckets.
+// It also carries the rate profile, with a trace already expanded into steps, and
+// the arrival process and seed (see arrival.h).
+// Any failure on the agent side is reported as "ERROR <message>".
+
+constexpr int kDefaultAgentPort = 9100;
+
+// "host:port" (port defaults to kDefaultAgentPort). "local" drives an in-process
+// agent over a socketpair, so the local generator speaks the same protocol.
+struct AgentEndpoint {
+    std::string host;
+    int port = kDefaultAgentPort;
+    bool local = false;
+};
+
+AgentEndpoint parseAgentEndpoint(const std::string& spec);
+
+// Serves coordinators one at a time on listenPort; only returns on a listen error.
+int runAgent(int listenPort);
+
+// Per-second totals across all agents while a distributed test runs.
+struct DistributedTick {
+    int second = 0;
+    uint64_t completed = 0;   // requests completed during this second, all agents
+    uint64_t errors = 0;
+    int agentsReporting = 0;
+};
+
+// Splits config.connections and config.rate evenly across agents, starts them
+// together, and merges their results and histograms. With onBucket set, agents
+// also stream bucketMs timeline buckets, which onBucket gets merged across agents
+// and in order, timed on this host's monotonic clock. Throws std::runtime_error on
+// connection, protocol or agent failures.
+BenchmarkResult runDistributed(const BenchmarkConfig& config, const LoadTarget& target,
+                               const std::vector<AgentEndpoint>& agents,
+                               const std::function<void(const DistributedTick&)>& onTick,
+                               const std::function<void(const TimelineBucket&)>& onBucket = {}, int bucketMs = 0);
@@ -0,0 +1,154 @@
+#include "echo_server.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "poller.h"
+
+namespace {
+
+constexpr std::string_view kResponse =
+    "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 13\r\n\r\nHello, World!";
+
+struct Client {
+    int fd = -1;
+    int matched = 0;  // how much of "\r\n\r\n" the bytes so far end with
+    std::string out;
+    size_t sent = 0;
+};
+
+void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+// Sends what is queued; false when the connection failed.
+bool flush(Client& client) {
+    while (client.sent < client.out.size()) {
+#if defined(MSG_NOSIGNAL)
+        ssize_t n = send(client.fd, client.out.data() + client.sent, client.out.size() - client.sent, MSG_NOSIGNAL);
+#else
+        ssize_t n = send(client.fd, client.out.data() + client.sent, client.out.size() - client.sent, 0);
+#endif
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+        client.sent += static_cast<size_t>(n);
+    }
+    client.out.clear();
+    client.sent = 0;
+    return true;
+}
+
+}  // namespace
+
+EchoServer::EchoServer(int threadCount) {
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) throw std::runtime_error(std::string("Echo server: socket failed: ") + std::strerror(errno));
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFd, 4096) != 0 ||
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        std::string error = std::strerror(errno);
+        close(listenFd);
+        throw std::runtime_error("Echo server: cannot listen: " + error);
+    }
+    listenPort = ntohs(address.sin_port);
+    setNonBlocking(listenFd);
+    // Every loop watches the one listener; whichever wakes first accepts.
+    for (int i = 0; i < std::max(threadCount, 1); i++) threads.emplace_back([this]() { serve(); });
+}
+
+EchoServer::~EchoServer() {
+    stopping = true;
+    for (auto& thread : threads) thread.join();
+    close(listenFd);
+}
+
+void EchoServer::serve() {
+    Poller poller;
+    poller.add(listenFd, nullptr);
+    std::vector<std::unique_ptr<Client>> clients;
+    std::array<PollEvent, 256> events;
+    std::array<char, 65536> buffer;
+
+    while (!stopping.load(std::memory_order_relaxed)) {
+        int n = poller.wait(events.data(), static_cast<int>(events.size()), 100000);
+        bool closedAny = false;
+        for (int i = 0; i < n; i++) {
+            if (!events[i].ptr) {
+                int fd;
+                while ((fd = accept(listenFd, nullptr, nullptr)) >= 0) {
+                    setNonBlocking(fd);
+                    int one = 1;
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#if defined(SO_NOSIGPIPE)
+                    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+                    auto client = std::make_unique<Client>();
+                    client->fd = fd;
+                    if (poller.add(fd, client.get())) {
+                        clients.push_back(std::move(client));
+                    } else {
+                        close(fd);
+                    }
+                }
+                continue;
+            }
+            Client& client = *static_cast<Client*>(events[i].ptr);
+            if (client.fd < 0) continue;
+            bool open = true;
+            if (events[i].readable) {
+                for (;;) {
+                    ssize_t got = read(client.fd, buffer.data(), buffer.size());
+                    if (got > 0) {
+                        for (ssize_t b = 0; b < got; b++) {
+                            char c = buffer[b];
+                            if (c == "\r\n\r\n"[client.matched]) {
+                                if (++client.matched == 4) {
+                                    client.out.append(kResponse);
+                                    client.matched = 0;
+                                }
+                            } else {
+                                client.matched = c == '\r' ? 1 : 0;
+                            }
+                        }
+                        continue;
+                    }
+                    if (got < 0 && errno == EINTR) continue;
+                    open = got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+                    break;
+                }
+            }
+            if (open) open = flush(client);
+            if (!open) {
+                close(client.fd);
+                client.fd = -1;
+                closedAny = true;
+            }
+        }
+        if (closedAny) {
+            clients.erase(std::remove_if(clients.begin(), clients.end(), [](const auto& c) { return c->fd < 0; }),
+                          clients.end());
+        }
+    }
+    for (const auto& client : clients) {
+        if (client->fd >= 0) close(client->fd);
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// A minimal keep-alive HTTP/1.1 server that answers every request with a fixed
+// "Hello, World!", so the load generator can be measured against something that
+// costs next to nothing per request. It only understands requests without a body
+// (everything up to the blank line is one request), which is what the harness
+// self-check sends.
+class EchoServer {
+public:
+    // Listens on an ephemeral loopback port, served by `threads` event loops.
+    // Throws std::runtime_error when the socket cannot be set up.
+    explicit EchoServer(int threads);
+    ~EchoServer();
+    EchoServer(const EchoServer&) = delete;
+    EchoServer& operator=(const EchoServer&) = delete;
+
+    int port() const { return listenPort; }
+
+private:
+    void serve();
+
+    int listenFd = -1;
+    int listenPort = 0;
+    std::atomic<bool> stopping{false};
+    std::vector<std::thread> threads;
+};
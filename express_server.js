@@ -1,28 +1,62 @@
+require("./server_instrumentation");
+const http = require("node:http");
+const https = require("node:https");
 const express = require("express");
+const routes = require("./scenario_routes");
+const { runWorkers } = require("./server_workers");
+const { transport, tlsOptions } = require("./server_transport");
 const app = express();
+const port = Number(process.env.PORT) || 3000;
 
 app.get("/", (req, res) => {
   res.json({ message: "Hello from Express!", timestamp: Date.now() });
 });
 
-const server = app.listen(3000, "0.0.0.0", () => {
-  console.log("Express server listening on port 3000");
+app.get("/users/:id", (req, res) => {
+  res.json(routes.user(req.params.id));
 });
 
-// Graceful shutdown
-const gracefulShutdown = (signal) => {
-  console.log(`Received ${signal}, shutting down gracefully`);
-  server.close(() => {
-    console.log("Express server closed");
-    process.exit(0);
-  });
-};
+app.get("/search", (req, res) => {
+  res.json(routes.search(req.query));
+});
+
+app.post("/echo", express.json({ limit: "2mb" }), (req, res) => {
+  const result = routes.echo(req.body);
+  if (!result) return res.status(400).json({ error: "invalid body" });
+  res.json(result);
+});
 
-process.on("SIGTERM", () => gracefulShutdown("SIGTERM"));
-process.on("SIGINT", () => gracefulShutdown("SIGINT"));
+app.get("/payload/:kb", (req, res) => {
+  res.json(routes.payload(req.params.kb));
+});
 
-// Handle server errors
-server.on("error", (err) => {
-  console.error("Express server error:", err);
+// Express 4 is built on the http1 request/response objects and cannot serve h2.
+if (transport === "h2") {
+  console.error("Express does not support HTTP/2; use the http1 or https transport");
   process.exit(1);
+}
+
+runWorkers(({ reusePort }) => {
+  const server = transport === "https" ? https.createServer(tlsOptions(), app) : http.createServer(app);
+  server.listen({ port, host: "0.0.0.0", reusePort }, () => {
+    console.log(`Express server listening on port ${port} over ${transport} (pid ${process.pid})`);
+  });
+
+  // Graceful shutdown
+  const gracefulShutdown = (signal) => {
+    console.log(`Received ${signal}, shutting down gracefully`);
+    server.close(() => {
+      console.log("Express server closed");
+      process.exit(0);
+    });
+  };
+
+  process.on("SIGTERM", () => gracefulShutdown("SIGTERM"));
+  process.on("SIGINT", () => gracefulShutdown("SIGINT"));
+
+  // Handle server errors
+  server.on("error", (err) => {
+    console.error("Express server error:", err);
+    process.exit(1);
+  });
 });
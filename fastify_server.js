@@ -1,17 +1,46 @@
-const fastify = require("fastify")({ logger: false });
+require("./server_instrumentation");
+const { transport, tlsOptions } = require("./server_transport");
+const serverOptions =
+  transport === "h2" ? { http2: true, https: { ...tlsOptions(), allowHTTP1: true } } :
+  transport === "https" ? { https: tlsOptions() } : {};
+const fastify = require("fastify")({ logger: false, bodyLimit: 2 * 1024 * 1024, ...serverOptions });
+const routes = require("./scenario_routes");
+const { runWorkers } = require("./server_workers");
+const port = Number(process.env.PORT) || 3001;
 
 fastify.get("/", async (request, reply) => {
   return { message: "Hello from Fastify!", timestamp: Date.now() };
 });
 
-const start = async () => {
+fastify.get("/users/:id", async (request, reply) => {
+  return routes.user(request.params.id);
+});
+
+fastify.get("/search", async (request, reply) => {
+  return routes.search(request.query);
+});
+
+fastify.post("/echo", async (request, reply) => {
+  const result = routes.echo(request.body);
+  if (!result) return reply.code(400).send({ error: "invalid body" });
+  return result;
+});
+
+fastify.get("/payload/:kb", async (request, reply) => {
+  return routes.payload(request.params.kb);
+});
+
+const start = async ({ reusePort }) => {
   try {
-    await fastify.listen({ port: 3001, host: "0.0.0.0" });
-    console.log("Fastify server listening on port 3001");
+    await fastify.listen({ port, host: "0.0.0.0", reusePort });
+    console.log(`Fastify server listening on port ${port} over ${transport} (pid ${process.pid})`);
   } catch (err) {
     console.error("Failed to start Fastify server:", err);
     process.exit(1);
   }
+
+  process.on("SIGTERM", () => gracefulShutdown("SIGTERM"));
+  process.on("SIGINT", () => gracefulShutdown("SIGINT"));
 };
 
 // Graceful shutdown
@@ -27,7 +56,4 @@ const gracefulShutdown = async (signal) => {
   }
 };
 
-process.on("SIGTERM", () => gracefulShutdown("SIGTERM"));
-process.on("SIGINT", () => gracefulShutdown("SIGINT"));
-
-start();
+runWorkers(start);
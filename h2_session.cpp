@@ -0,0 +1,473 @@
+#include "h2_session.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t kData = 0x0;
+constexpr uint8_t kHeaders = 0x1;
+constexpr uint8_t kRstStream = 0x3;
+constexpr uint8_t kSettings = 0x4;
+constexpr uint8_t kPushPromise = 0x5;
+constexpr uint8_t kPing = 0x6;
+constexpr uint8_t kGoaway = 0x7;
+constexpr uint8_t kWindowUpdate = 0x8;
+constexpr uint8_t kContinuation = 0x9;
+
+constexpr uint8_t kFlagEndStream = 0x1;
+constexpr uint8_t kFlagAck = 0x1;
+constexpr uint8_t kFlagEndHeaders = 0x4;
+constexpr uint8_t kFlagPadded = 0x8;
+constexpr uint8_t kFlagPriority = 0x20;
+
+constexpr uint32_t kCancel = 0x8;
+constexpr size_t kMaxFrameSize = 16384;  // never raised, so the server may not exceed it
+constexpr int64_t kMaxWindow = 0x7fffffff;
+constexpr uint32_t kMaxStreamId = 0x7fffffff;
+
+const char kPreface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+uint32_t read32(const char* p) {
+    const auto* u = reinterpret_cast<const unsigned char*>(p);
+    return (static_cast<uint32_t>(u[0]) << 24) | (static_cast<uint32_t>(u[1]) << 16) |
+           (static_cast<uint32_t>(u[2]) << 8) | static_cast<uint32_t>(u[3]);
+}
+
+void append32(std::string& out, uint32_t value) {
+    out.push_back(static_cast<char>(value >> 24));
+    out.push_back(static_cast<char>(value >> 16));
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value));
+}
+
+// HPACK integer with an N-bit prefix (RFC 7541 section 5.1).
+void encodeInteger(std::string& out, uint64_t value, int prefixBits, uint8_t pattern) {
+    uint64_t limit = (1u << prefixBits) - 1;
+    if (value < limit) {
+        out.push_back(static_cast<char>(pattern | value));
+        return;
+    }
+    out.push_back(static_cast<char>(pattern | limit));
+    value -= limit;
+    while (value >= 128) {
+        out.push_back(static_cast<char>(value % 128 + 128));
+        value /= 128;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool decodeInteger(const uint8_t*& p, const uint8_t* end, int prefixBits, uint64_t& value) {
+    if (p == end) return false;
+    uint64_t limit = (1u << prefixBits) - 1;
+    value = *p++ & limit;
+    if (value < limit) return true;
+    for (int shift = 0; shift < 56; shift += 7) {
+        if (p == end) return false;
+        uint8_t byte = *p++;
+        value += static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+// Literal header field without indexing, name from the static table.
+void literal(std::string& out, uint64_t nameIndex, const std::string& value) {
+    encodeInteger(out, nameIndex, 4, 0x00);
+    encodeInteger(out, value.size(), 7, 0x00);
+    out += value;
+}
+
+// A Huffman-coded :status only contains digits: '0'-'2' are the 5-bit codes 0-2 and
+// '3'-'9' the 6-bit codes 0x19-0x1f (RFC 7541 Appendix B); the rest is EOS padding.
+int huffmanStatus(const uint8_t* p, size_t len) {
+    if (len > 7) return -1;
+    uint64_t bits = 0;
+    int count = 0;
+    for (size_t i = 0; i < len; i++) {
+        bits = bits << 8 | p[i];
+        count += 8;
+    }
+    int status = 0;
+    int digits = 0;
+    while (count >= 5) {
+        uint64_t five = (bits >> (count - 5)) & 0x1f;
+        if (five <= 2) {
+            status = status * 10 + static_cast<int>(five);
+            count -= 5;
+            digits++;
+            continue;
+        }
+        uint64_t ones = (1ULL << count) - 1;
+        if (count < 8 && (bits & ones) == ones) break;
+        if (count < 6) return -1;
+        uint64_t six = (bits >> (count - 6)) & 0x3f;
+        if (six < 0x19 || six > 0x1f) return -1;
+        status = status * 10 + static_cast<int>(six - 0x19 + 3);
+        count -= 6;
+        digits++;
+    }
+    uint64_t ones = (1ULL << count) - 1;
+    if ((bits & ones) != ones) return -1;
+    return digits == 3 ? status : -1;
+}
+
+// :status of a response header block with no dynamic table; 0 when the block has
+// none (trailers), -1 when it cannot be decoded.
+int decodeStatus(const std::string& block) {
+    static const int kIndexedStatus[] = {200, 204, 206, 304, 400, 404, 500};  // static table 8-14
+    const auto* p = reinterpret_cast<const uint8_t*>(block.data());
+    const uint8_t* end = p + block.size();
+    int status = 0;
+    while (p < end) {
+        uint8_t first = *p;
+        uint64_t index = 0;
+        if (first & 0x80) {
+            if (!decodeInteger(p, end, 7, index) || index == 0 || index > 61) return -1;
+            if (index >= 8 && index <= 14) status = kIndexedStatus[index - 8];
+            continue;
+        }
+        if ((first & 0xe0) == 0x20) {  // dynamic table size update
+            if (!decodeInteger(p, end, 5, index)) return -1;
+            continue;
+        }
+        if (!decodeInteger(p, end, (first & 0x40) ? 6 : 4, index) || index > 61) return -1;
+        for (int part = index == 0 ? 0 : 1; part < 2; part++) {
+            if (p == end) return -1;
+            bool huffman = (*p & 0x80) != 0;
+            uint64_t length = 0;
+            if (!decodeInteger(p, end, 7, length) || length > static_cast<uint64_t>(end - p)) return -1;
+            if (part == 1 && index == 8) {
+                if (huffman) {
+                    status = huffmanStatus(p, length);
+                } else {
+                    status = 0;
+                    for (uint64_t i = 0; i < length; i++) {
+                        if (p[i] < '0' || p[i] > '9') return -1;
+                        status = status * 10 + (p[i] - '0');
+                    }
+                }
+                if (status < 0) return -1;
+            }
+            p += length;
+        }
+    }
+    return status;
+}
+
+}  // namespace
+
+H2Request makeH2Request(const std::string& method, const std::string& path, const std::string& authority,
+                        const std::string& body) {
+    H2Request request;
+    std::string& block = request.headerBlock;
+    if (method == "GET") {
+        block.push_back(static_cast<char>(0x82));
+    } else if (method == "POST") {
+        block.push_back(static_cast<char>(0x83));
+    } else {
+        literal(block, 2, method);
+    }
+    block.push_back(static_cast<char>(0x87));  // :scheme https
+    if (path == "/") {
+        block.push_back(static_cast<char>(0x84));
+    } else {
+        literal(block, 4, path);
+    }
+    literal(block, 1, authority);
+    literal(block, 58, "benchmark_wrk");  // user-agent
+    literal(block, 19, "*/*");            // accept
+    if (!body.empty()) {
+        literal(block, 31, "application/json");
+        literal(block, 28, std::to_string(body.size()));
+    }
+    request.body = body;
+    return request;
+}
+
+H2Session::H2Session(const std::vector<H2Request>& requests, int maxStreams)
+    : requests(requests), streams(static_cast<size_t>(std::max(maxStreams, 1))) {
+    out.append(kPreface, sizeof(kPreface) - 1);
+    frameHeader(18, kSettings, 0, 0);
+    const std::pair<uint16_t, uint32_t> settings[] = {
+        {0x1, 0},                                   // HEADER_TABLE_SIZE
+        {0x2, 0},                                   // ENABLE_PUSH
+        {0x4, static_cast<uint32_t>(kMaxWindow)},  // INITIAL_WINDOW_SIZE
+    };
+    for (const auto& setting : settings) {
+        out.push_back(static_cast<char>(setting.first >> 8));
+        out.push_back(static_cast<char>(setting.first));
+        append32(out, setting.second);
+    }
+    frameHeader(4, kWindowUpdate, 0, 0);
+    append32(out, static_cast<uint32_t>(kMaxWindow - connectionRecvWindow));
+    connectionRecvWindow = kMaxWindow;
+}
+
+bool H2Session::canStart() const {
+    size_t limit = std::min<size_t>(streams.size(), peerMaxStreams);
+    return peerSettings && !goaway && active < limit && nextStreamId <= kMaxStreamId;
+}
+
+void H2Session::startRequest(uint32_t route, uint64_t start) {
+    auto slot = std::find_if(streams.begin(), streams.end(), [](const Stream& s) { return s.id == 0; });
+    if (slot == streams.end()) return;
+    slot->id = nextStreamId;
+    slot->route = route;
+    slot->requestStart = start;
+    slot->status = 0;
+    slot->bodySent = 0;
+    slot->bodyReceived = 0;
+    slot->sendWindow = peerInitialWindow;
+    nextStreamId += 2;
+    active++;
+
+    const H2Request& request = requests[route];
+    const std::string& block = request.headerBlock;
+    uint8_t endStream = request.body.empty() ? kFlagEndStream : 0;
+    size_t first = std::min(block.size(), kMaxFrameSize);
+    frameHeader(first, kHeaders, endStream | (first == block.size() ? kFlagEndHeaders : 0), slot->id);
+    out.append(block, 0, first);
+    for (size_t offset = first; offset < block.size(); offset += kMaxFrameSize) {
+        size_t chunk = std::min(block.size() - offset, kMaxFrameSize);
+        frameHeader(chunk, kContinuation, offset + chunk == block.size() ? kFlagEndHeaders : 0, slot->id);
+        out.append(block, offset, chunk);
+    }
+    if (!request.body.empty()) sendData();
+}
+
+void H2Session::consume(size_t n) {
+    outPos += n;
+    if (outPos == out.size()) {
+        out.clear();
+        outPos = 0;
+    } else if (outPos > 65536 && outPos * 2 > out.size()) {
+        out.erase(0, outPos);
+        outPos = 0;
+    }
+}
+
+H2Session::Stream* H2Session::findStream(uint32_t id) {
+    if (id == 0) return nullptr;
+    for (auto& stream : streams) {
+        if (stream.id == id) return &stream;
+    }
+    return nullptr;
+}
+
+void H2Session::finish(Stream& stream, bool reset, std::vector<H2Response>& done) {
+    // The server answered before taking the whole body; stop sending the rest.
+    if (!reset && stream.bodySent < requests[stream.route].body.size()) {
+        frameHeader(4, kRstStream, 0, stream.id);
+        append32(out, kCancel);
+    }
+    H2Response response;
+    response.route = stream.route;
+    response.requestStart = stream.requestStart;
+    response.status = stream.status;
+    response.reset = reset;
+    response.bytes = stream.bodyReceived;
+    done.push_back(response);
+    stream.id = 0;
+    active--;
+}
+
+void H2Session::expire(uint64_t cutoff, std::vector<H2Response>& expired) {
+    for (auto& stream : streams) {
+        if (stream.id == 0 || stream.requestStart >= cutoff) continue;
+        frameHeader(4, kRstStream, 0, stream.id);
+        append32(out, kCancel);
+        finish(stream, true, expired);
+    }
+}
+
+void H2Session::frameHeader(size_t length, uint8_t type, uint8_t flags, uint32_t streamId) {
+    out.push_back(static_cast<char>(length >> 16));
+    out.push_back(static_cast<char>(length >> 8));
+    out.push_back(static_cast<char>(length));
+    out.push_back(static_cast<char>(type));
+    out.push_back(static_cast<char>(flags));
+    append32(out, streamId);
+}
+
+// Sends body DATA round-robin across streams, 16KB at a time, as far as the
+// connection and stream windows allow.
+void H2Session::sendData() {
+    bool progress = true;
+    while (progress && connectionSendWindow > 0) {
+        progress = false;
+        for (auto& stream : streams) {
+            if (stream.id == 0) continue;
+            const std::string& body = requests[stream.route].body;
+            if (stream.bodySent >= body.size()) continue;
+            int64_t chunk = std::min<int64_t>({static_cast<int64_t>(kMaxFrameSize),
+                                               static_cast<int64_t>(body.size() - stream.bodySent),
+                                               connectionSendWindow, stream.sendWindow});
+            if (chunk <= 0) continue;
+            bool last = stream.bodySent + static_cast<size_t>(chunk) == body.size();
+            frameHeader(static_cast<size_t>(chunk), kData, last ? kFlagEndStream : 0, stream.id);
+            out.append(body, stream.bodySent, static_cast<size_t>(chunk));
+            stream.bodySent += static_cast<size_t>(chunk);
+            stream.sendWindow -= chunk;
+            connectionSendWindow -= chunk;
+            progress = true;
+        }
+    }
+}
+
+// DATA payloads are counted and skipped without being buffered; every other frame
+// is collected whole before it is handled.
+bool H2Session::feed(const char* data, size_t len, std::vector<H2Response>& done) {
+    size_t pos = 0;
+    for (;;) {
+        if (dataRemaining > 0) {
+            size_t take = std::min(dataRemaining, len - pos);
+            pos += take;
+            dataRemaining -= take;
+            if (dataRemaining > 0) return true;
+            endData(done);
+            continue;
+        }
+        if (in.size() < 9) {
+            size_t take = std::min(9 - in.size(), len - pos);
+            in.append(data + pos, take);
+            pos += take;
+            if (in.size() < 9) return true;
+            const auto* header = reinterpret_cast<const unsigned char*>(in.data());
+            frameLength = (static_cast<size_t>(header[0]) << 16) | (static_cast<size_t>(header[1]) << 8) | header[2];
+            frameType = header[3];
+            frameFlags = header[4];
+            frameStream = read32(in.data() + 5) & kMaxStreamId;
+            if (frameLength > kMaxFrameSize) return false;
+            if (frameType == kData) {
+                in.clear();
+                if (!beginData()) return false;
+                if (dataRemaining == 0) endData(done);
+                continue;
+            }
+        }
+        size_t take = std::min(9 + frameLength - in.size(), len - pos);
+        in.append(data + pos, take);
+        pos += take;
+        if (in.size() < 9 + frameLength) return true;
+        bool ok = onFrame(frameType, frameFlags, frameStream, in.data() + 9, frameLength, done);
+        in.clear();
+        if (!ok) return false;
+    }
+}
+
+bool H2Session::beginData() {
+    if (frameStream == 0 || headerStream != 0) return false;
+    dataRemaining = frameLength;
+    if (Stream* stream = findStream(frameStream)) stream->bodyReceived += frameLength;
+    connectionRecvWindow -= static_cast<int64_t>(frameLength);
+    if (connectionRecvWindow < kMaxWindow / 2) {
+        frameHeader(4, kWindowUpdate, 0, 0);
+        append32(out, static_cast<uint32_t>(kMaxWindow - connectionRecvWindow));
+        connectionRecvWindow = kMaxWindow;
+    }
+    return true;
+}
+
+void H2Session::endData(std::vector<H2Response>& done) {
+    if ((frameFlags & kFlagEndStream) == 0) return;
+    if (Stream* stream = findStream(frameStream)) finish(*stream, false, done);
+}
+
+bool H2Session::onFrame(uint8_t type, uint8_t flags, uint32_t streamId, const char* payload, size_t length,
+                        std::vector<H2Response>& done) {
+    if (headerStream != 0 && (type != kContinuation || streamId != headerStream)) return false;
+    switch (type) {
+        case kHeaders: {
+            size_t offset = 0;
+            size_t padding = 0;
+            if (flags & kFlagPadded) {
+                if (length < 1) return false;
+                padding = static_cast<unsigned char>(payload[0]);
+                offset = 1;
+            }
+            if (flags & kFlagPriority) offset += 5;
+            if (streamId == 0 || offset + padding > length) return false;
+            headerBlock.assign(payload + offset, length - offset - padding);
+            headerStream = streamId;
+            headerEndStream = (flags & kFlagEndStream) != 0;
+            if (flags & kFlagEndHeaders) return onHeaders(done);
+            return true;
+        }
+        case kContinuation:
+            if (headerStream == 0) return false;
+            headerBlock.append(payload, length);
+            if (flags & kFlagEndHeaders) return onHeaders(done);
+            return true;
+        case kRstStream:
+            if (length != 4) return false;
+            if (Stream* stream = findStream(streamId)) finish(*stream, true, done);
+            return true;
+        case kSettings: {
+            if (flags & kFlagAck) return true;
+            if (length % 6 != 0 || streamId != 0) return false;
+            for (size_t i = 0; i < length; i += 6) {
+                uint16_t id = static_cast<uint16_t>((static_cast<unsigned char>(payload[i]) << 8) |
+                                                    static_cast<unsigned char>(payload[i + 1]));
+                uint32_t value = read32(payload + i + 2);
+                if (id == 0x3) {
+                    peerMaxStreams = value;
+                } else if (id == 0x4) {
+                    if (value > static_cast<uint32_t>(kMaxWindow)) return false;
+                    int64_t delta = static_cast<int64_t>(value) - peerInitialWindow;
+                    for (auto& stream : streams) {
+                        if (stream.id != 0) stream.sendWindow += delta;
+                    }
+                    peerInitialWindow = value;
+                }
+            }
+            frameHeader(0, kSettings, kFlagAck, 0);
+            peerSettings = true;
+            sendData();
+            return true;
+        }
+        case kPing:
+            if (length != 8) return false;
+            if ((flags & kFlagAck) == 0) {
+                frameHeader(8, kPing, kFlagAck, 0);
+                out.append(payload, 8);
+            }
+            return true;
+        case kGoaway: {
+            if (length < 8) return false;
+            uint32_t lastStream = read32(payload) & kMaxStreamId;
+            goaway = true;
+            for (auto& stream : streams) {
+                if (stream.id > lastStream) finish(stream, true, done);
+            }
+            return true;
+        }
+        case kWindowUpdate: {
+            if (length != 4) return false;
+            int64_t increment = read32(payload) & kMaxStreamId;
+            if (streamId == 0) {
+                connectionSendWindow += increment;
+            } else if (Stream* stream = findStream(streamId)) {
+                stream->sendWindow += increment;
+            }
+            sendData();
+            return true;
+        }
+        case kPushPromise:
+            return false;  // disabled in our SETTINGS
+        default:
+            return true;  // PRIORITY and unknown frame types are ignored
+    }
+}
+
+bool H2Session::onHeaders(std::vector<H2Response>& done) {
+    int status = decodeStatus(headerBlock);
+    uint32_t streamId = headerStream;
+    headerStream = 0;
+    if (status < 0) return false;
+    Stream* stream = findStream(streamId);
+    if (stream == nullptr) return true;  // a stream we already reset
+    if (status >= 200 && stream->status == 0) stream->status = status;
+    if (headerEndStream) finish(*stream, false, done);
+    return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Client side of one HTTP/2 connection (RFC 9113), without any I/O: the load
+// generator feeds it received bytes and sends whatever it queues. Requests are
+// encoded once per route with HPACK literals against the static table, and the
+// dynamic table is disabled (SETTINGS_HEADER_TABLE_SIZE = 0), so decoding a
+// response only has to find :status. Request bodies honour the server's flow
+// control windows; for responses the largest windows are advertised and the
+// connection window is topped up as DATA arrives. Server push is disabled.
+
+// One route's request, serialized once and shared by every stream that sends it.
+struct H2Request {
+    std::string headerBlock;  // HPACK-encoded
+    std::string body;
+};
+
+// Builds the request for one route; `authority` is "host:port".
+H2Request makeH2Request(const std::string& method, const std::string& path, const std::string& authority,
+                        const std::string& body);
+
+struct H2Response {
+    uint32_t route = 0;
+    uint64_t requestStart = 0;
+    int status = 0;      // 0 when the stream was reset before a final status arrived
+    bool reset = false;  // RST_STREAM, GOAWAY, or expired by the client
+    uint64_t bytes = 0;  // DATA payload received
+};
+
+class H2Session {
+public:
+    // Queues the connection preface and SETTINGS. At most maxStreams requests are
+    // in flight at once (fewer if the server's MAX_CONCURRENT_STREAMS is lower).
+    H2Session(const std::vector<H2Request>& requests, int maxStreams);
+
+    // A stream slot is free, the server's SETTINGS have arrived and it has not sent GOAWAY.
+    bool canStart() const;
+    size_t activeStreams() const { return active; }
+    // The server sent GOAWAY; finish what it accepted, then reconnect.
+    bool goingAway() const { return goaway; }
+
+    void startRequest(uint32_t route, uint64_t start);
+
+    // Consumes received bytes; finished and reset streams are appended to `done`.
+    // Returns false on a protocol error (the connection must be dropped).
+    bool feed(const char* data, size_t len, std::vector<H2Response>& done);
+
+    // Resets every stream started before `cutoff` and appends it to `expired`.
+    void expire(uint64_t cutoff, std::vector<H2Response>& expired);
+
+    // Bytes waiting to be written; report how many were sent with consume().
+    const char* pending() const { return out.data() + outPos; }
+    size_t pendingSize() const { return out.size() - outPos; }
+    void consume(size_t n);
+
+private:
+    struct Stream {
+        uint32_t id = 0;  // 0 = free slot
+        uint32_t route = 0;
+        uint64_t requestStart = 0;
+        int status = 0;
+        size_t bodySent = 0;
+        uint64_t bodyReceived = 0;
+        int64_t sendWindow = 0;
+    };
+
+    Stream* findStream(uint32_t id);
+    void finish(Stream& stream, bool reset, std::vector<H2Response>& done);
+    void frameHeader(size_t length, uint8_t type, uint8_t flags, uint32_t streamId);
+    void sendData();
+    bool beginData();
+    void endData(std::vector<H2Response>& done);
+    bool onFrame(uint8_t type, uint8_t flags, uint32_t streamId, const char* payload, size_t length,
+                 std::vector<H2Response>& done);
+    bool onHeaders(std::vector<H2Response>& done);
+
+    const std::vector<H2Request>& requests;
+    std::vector<Stream> streams;
+    size_t active = 0;
+    uint32_t nextStreamId = 1;
+    uint32_t peerMaxStreams = UINT32_MAX;
+    int64_t peerInitialWindow = 65535;
+    int64_t connectionSendWindow = 65535;
+    int64_t connectionRecvWindow = 65535;
+    bool peerSettings = false;
+    bool goaway = false;
+
+    // The frame being received: its header and (except for DATA) payload are in `in`.
+    std::string in;
+    size_t frameLength = 0;
+    uint8_t frameType = 0;
+    uint8_t frameFlags = 0;
+    uint32_t frameStream = 0;
+    size_t dataRemaining = 0;
+
+    std::string out;
+    size_t outPos = 0;
+
+    // A header block split across HEADERS and CONTINUATION frames.
+    std::string headerBlock;
+    uint32_t headerStream = 0;
+    bool headerEndStream = false;
+};
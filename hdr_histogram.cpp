@@ -0,0 +1,190 @@
+#include "hdr_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+HdrHistogram::HdrHistogram(int64_t lowest, int64_t highest, int significantFigures)
+    : lowest(std::max<int64_t>(lowest, 1)),
+      highest(std::max<int64_t>(highest, 2 * std::max<int64_t>(lowest, 1))),
+      significantFigures(std::min(std::max(significantFigures, 1), 5)) {
+    int64_t largestSingleUnitResolution = 2 * static_cast<int64_t>(std::pow(10, this->significantFigures));
+    int subBucketCountMagnitude = static_cast<int>(std::ceil(std::log2(static_cast<double>(largestSingleUnitResolution))));
+    subBucketHalfCountMagnitude = std::max(subBucketCountMagnitude, 1) - 1;
+    unitMagnitude = static_cast<int>(std::floor(std::log2(static_cast<double>(this->lowest))));
+
+    int64_t subBucketCount = 1LL << (subBucketHalfCountMagnitude + 1);
+    subBucketHalfCount = subBucketCount / 2;
+    subBucketMask = (subBucketCount - 1) << unitMagnitude;
+
+    int64_t smallestUntrackable = subBucketCount << unitMagnitude;
+    int bucketsNeeded = 1;
+    while (smallestUntrackable <= this->highest) {
+        if (smallestUntrackable > INT64_MAX / 2) {
+            bucketsNeeded++;
+            break;
+        }
+        smallestUntrackable <<= 1;
+        bucketsNeeded++;
+    }
+    counts.assign(static_cast<size_t>(bucketsNeeded + 1) << subBucketHalfCountMagnitude, 0);
+}
+
+int HdrHistogram::bucketIndex(int64_t value) const {
+    int pow2Ceiling = 64 - __builtin_clzll(static_cast<uint64_t>(value | subBucketMask));
+    return pow2Ceiling - unitMagnitude - (subBucketHalfCountMagnitude + 1);
+}
+
+int HdrHistogram::countsIndex(int64_t value) const {
+    int bucket = bucketIndex(value);
+    int64_t subBucket = value >> (bucket + unitMagnitude);
+    return static_cast<int>(((static_cast<int64_t>(bucket) + 1) << subBucketHalfCountMagnitude) +
+                            (subBucket - subBucketHalfCount));
+}
+
+int64_t HdrHistogram::valueAtIndex(int index) const {
+    int bucket = (index >> subBucketHalfCountMagnitude) - 1;
+    int64_t subBucket = (index & (subBucketHalfCount - 1)) + subBucketHalfCount;
+    if (bucket < 0) {
+        subBucket -= subBucketHalfCount;
+        bucket = 0;
+    }
+    return subBucket << (bucket + unitMagnitude);
+}
+
+int64_t HdrHistogram::highestEquivalentValue(int64_t value) const {
+    int bucket = bucketIndex(value);
+    int64_t subBucket = value >> (bucket + unitMagnitude);
+    int adjustedBucket = subBucket >= 2 * subBucketHalfCount ? bucket + 1 : bucket;
+    int64_t lowestEquivalent = subBucket << (bucket + unitMagnitude);
+    return lowestEquivalent + (1LL << (unitMagnitude + adjustedBucket)) - 1;
+}
+
+int64_t HdrHistogram::medianEquivalentValue(int64_t value) const {
+    int bucket = bucketIndex(value);
+    int64_t subBucket = value >> (bucket + unitMagnitude);
+    int adjustedBucket = subBucket >= 2 * subBucketHalfCount ? bucket + 1 : bucket;
+    int64_t lowestEquivalent = subBucket << (bucket + unitMagnitude);
+    return lowestEquivalent + ((1LL << (unitMagnitude + adjustedBucket)) >> 1);
+}
+
+void HdrHistogram::recordCount(int64_t value, uint64_t count) {
+    value = std::min(std::max<int64_t>(value, 0), highest);
+    counts[static_cast<size_t>(countsIndex(value))] += count;
+    total += count;
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+}
+
+void HdrHistogram::merge(const HdrHistogram& other) {
+    if (other.total == 0) return;
+    if (lowest == other.lowest && highest == other.highest && significantFigures == other.significantFigures) {
+        for (size_t i = 0; i < counts.size(); i++) counts[i] += other.counts[i];
+        total += other.total;
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+        return;
+    }
+    for (size_t i = 0; i < other.counts.size(); i++) {
+        if (other.counts[i] != 0) recordCount(other.valueAtIndex(static_cast<int>(i)), other.counts[i]);
+    }
+    maxValue = std::max(maxValue, std::min(other.maxValue, highest));
+}
+
+void HdrHistogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    minValue = INT64_MAX;
+    maxValue = 0;
+}
+
+double HdrHistogram::mean() const {
+    if (total == 0) return 0.0;
+    double sum = 0.0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        if (counts[i] != 0) {
+            sum += static_cast<double>(counts[i]) *
+                   static_cast<double>(medianEquivalentValue(valueAtIndex(static_cast<int>(i))));
+        }
+    }
+    return sum / static_cast<double>(total);
+}
+
+int64_t HdrHistogram::valueAtPercentile(double percentile) const {
+    if (total == 0) return 0;
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    uint64_t countAtPercentile = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+    countAtPercentile = std::max<uint64_t>(countAtPercentile, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= countAtPercentile) {
+            return std::min(highestEquivalentValue(valueAtIndex(static_cast<int>(i))), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+uint64_t HdrHistogram::countAtOrBelow(int64_t value) const {
+    if (total == 0 || value < 0) return 0;
+    size_t last = std::min(static_cast<size_t>(countsIndex(std::min(value, highest))), counts.size() - 1);
+    uint64_t count = 0;
+    for (size_t i = 0; i <= last; i++) count += counts[i];
+    return count;
+}
+
+std::string HdrHistogram::serialize() const {
+    std::ostringstream out;
+    out << "HDR1," << lowest << "," << highest << "," << significantFigures << "," << min() << "," << maxValue;
+
+    size_t last = counts.size();
+    while (last > 0 && counts[last - 1] == 0) last--;
+
+    uint64_t zeros = 0;
+    for (size_t i = 0; i < last; i++) {
+        if (counts[i] == 0) {
+            zeros++;
+            continue;
+        }
+        if (zeros > 0) out << ",-" << zeros;
+        zeros = 0;
+        out << "," << counts[i];
+    }
+    return out.str();
+}
+
+bool HdrHistogram::deserialize(const std::string& text, HdrHistogram& out) {
+    if (text.compare(0, 5, "HDR1,") != 0) return false;
+
+    std::vector<long long> fields;
+    const char* p = text.c_str() + 5;
+    while (*p != '\0') {
+        char* end = nullptr;
+        long long value = std::strtoll(p, &end, 10);
+        if (end == p) return false;
+        fields.push_back(value);
+        p = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return false;
+    }
+    if (fields.size() < 5) return false;
+
+    HdrHistogram parsed(fields[0], fields[1], static_cast<int>(fields[2]));
+    size_t index = 0;
+    for (size_t i = 5; i < fields.size(); i++) {
+        if (fields[i] < 0) {
+            index += static_cast<size_t>(-fields[i]);
+            continue;
+        }
+        if (index >= parsed.counts.size()) return false;
+        parsed.counts[index++] = static_cast<uint64_t>(fields[i]);
+        parsed.total += static_cast<uint64_t>(fields[i]);
+    }
+    if (parsed.total > 0) {
+        parsed.minValue = fields[3];
+        parsed.maxValue = fields[4];
+    }
+    out = std::move(parsed);
+    return true;
+}
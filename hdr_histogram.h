@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// HDR-style histogram: log-linear buckets that keep every value within the
+// configured number of significant figures over [lowest, highest]. Layouts with
+// the same parameters merge by adding counts, so per-thread histograms can be
+// combined after the threads join and per-run histograms across runs/machines.
+// The orchestrator records latencies in microseconds.
+class HdrHistogram {
+public:
+    static constexpr int64_t kDefaultHighest = 3600LL * 1000 * 1000;  // 1 hour in microseconds
+
+    explicit HdrHistogram(int64_t lowest = 1, int64_t highest = kDefaultHighest, int significantFigures = 3);
+
+    void record(int64_t value) { recordCount(value, 1); }
+    void recordCount(int64_t value, uint64_t count);
+    void merge(const HdrHistogram& other);
+    void reset();
+
+    uint64_t totalCount() const { return total; }
+    int64_t min() const { return total == 0 ? 0 : minValue; }
+    int64_t max() const { return maxValue; }
+    double mean() const;
+    int64_t valueAtPercentile(double percentile) const;
+    // Values in the same bucket as `value` count as at or below it.
+    uint64_t countAtOrBelow(int64_t value) const;
+
+    // Compact text form: "HDR1,<lowest>,<highest>,<sigfigs>,<min>,<max>,<counts...>" where
+    // a run of n empty buckets is written as "-<n>" and trailing empty buckets are dropped.
+    std::string serialize() const;
+    static bool deserialize(const std::string& text, HdrHistogram& out);
+
+private:
+    int bucketIndex(int64_t value) const;
+    int countsIndex(int64_t value) const;
+    int64_t valueAtIndex(int index) const;
+    int64_t highestEquivalentValue(int64_t value) const;
+    int64_t medianEquivalentValue(int64_t value) const;
+
+    int64_t lowest;
+    int64_t highest;
+    int significantFigures;
+    int unitMagnitude;
+    int subBucketHalfCountMagnitude;
+    int64_t subBucketHalfCount;
+    int64_t subBucketMask;
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    int64_t minValue = INT64_MAX;
+    int64_t maxValue = 0;
+};
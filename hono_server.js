@@ -1,5 +1,11 @@
+require("./server_instrumentation");
+const http2 = require("node:http2");
+const https = require("node:https");
 const { Hono } = require("hono");
-const { serve } = require("@hono/node-server");
+const { createAdaptorServer } = require("@hono/node-server");
+const routes = require("./scenario_routes");
+const { runWorkers } = require("./server_workers");
+const { transport, tlsOptions } = require("./server_transport");
 
 const app = new Hono();
 
@@ -7,32 +13,59 @@ app.get("/", (c) => {
   return c.json({ message: "Hello from Hono!", timestamp: Date.now() });
 });
 
-const port = 3002;
+app.get("/users/:id", (c) => {
+  return c.json(routes.user(c.req.param("id")));
+});
+
+app.get("/search", (c) => {
+  return c.json(routes.search(c.req.query()));
+});
+
+app.post("/echo", async (c) => {
+  let body = null;
+  try {
+    body = await c.req.json();
+  } catch (err) {
+    body = null;
+  }
+  const result = routes.echo(body);
+  if (!result) return c.json({ error: "invalid body" }, 400);
+  return c.json(result);
+});
 
-const server = serve({
-  fetch: app.fetch,
-  port,
-  hostname: "0.0.0.0",
+app.get("/payload/:kb", (c) => {
+  return c.json(routes.payload(c.req.param("kb")));
 });
 
-console.log(`Hono server listening on port ${port}`);
+const port = Number(process.env.PORT) || 3002;
+
+runWorkers(({ reusePort }) => {
+  // createAdaptorServer + listen(), rather than serve(), so reusePort reaches listen.
+  const options = { fetch: app.fetch };
+  if (transport === "https") {
+    options.createServer = https.createServer;
+    options.serverOptions = tlsOptions();
+  } else if (transport === "h2") {
+    options.createServer = http2.createSecureServer;
+    options.serverOptions = { ...tlsOptions(), allowHTTP1: true };
+  }
+  const server = createAdaptorServer(options);
+  server.listen({ port, host: "0.0.0.0", reusePort }, () => {
+    console.log(`Hono server listening on port ${port} over ${transport} (pid ${process.pid})`);
+  });
 
-// Graceful shutdown
-const gracefulShutdown = (signal) => {
-  console.log(`Received ${signal}, shutting down gracefully`);
-  if (server && server.close) {
+  // Graceful shutdown
+  const gracefulShutdown = (signal) => {
+    console.log(`Received ${signal}, shutting down gracefully`);
     server.close(() => {
       console.log("Hono server closed");
       process.exit(0);
     });
-  } else {
-    console.log("Hono server closed");
-    process.exit(0);
-  }
-};
+  };
 
-process.on("SIGTERM", () => gracefulShutdown("SIGTERM"));
-process.on("SIGINT", () => gracefulShutdown("SIGINT"));
+  process.on("SIGTERM", () => gracefulShutdown("SIGTERM"));
+  process.on("SIGINT", () => gracefulShutdown("SIGINT"));
+});
 
 // Handle uncaught exceptions
 process.on("uncaughtException", (err) => {
@@ -0,0 +1,195 @@
+#include "host_network.h"
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+struct Profile {
+    const char* name;
+    std::vector<SysctlValue> values;
+};
+
+// Deep accept queues, fast reuse of TIME_WAIT ports and the widest ephemeral
+// range, so that tens of thousands of connections (or one per request with the
+// *-close transports) do not hit host limits before the server's own.
+const std::vector<SysctlValue> kThroughput = {
+    {"net.core.somaxconn", "65535"},
+    {"net.ipv4.tcp_max_syn_backlog", "65535"},
+    {"net.core.netdev_max_backlog", "65536"},
+    {"net.ipv4.tcp_tw_reuse", "1"},
+    {"net.ipv4.ip_local_port_range", "1024 65535"},
+    {"net.ipv4.tcp_fin_timeout", "10"},
+};
+
+const std::vector<Profile>& profiles() {
+    static const std::vector<Profile> known = [] {
+        std::vector<Profile> list = {{"throughput", kThroughput}, {"low-latency", kThroughput}};
+        // Busy polling trades CPU for lower wakeup latency on sockets with little traffic.
+        list[1].values.push_back({"net.core.busy_poll", "50"});
+        list[1].values.push_back({"net.core.busy_read", "50"});
+        return list;
+    }();
+    return known;
+}
+
+// What is recorded with every benchmark, whether or not a profile is applied.
+const std::vector<std::string> kRecorded = {
+    "net.core.somaxconn",
+    "net.ipv4.tcp_max_syn_backlog",
+    "net.core.netdev_max_backlog",
+    "net.ipv4.tcp_tw_reuse",
+    "net.ipv4.ip_local_port_range",
+    "net.ipv4.tcp_fin_timeout",
+    "net.core.busy_poll",
+    "net.core.busy_read",
+    "net.ipv4.tcp_congestion_control",
+    "net.core.default_qdisc",
+    "net.core.rmem_max",
+    "net.core.wmem_max",
+};
+
+std::string procPath(const std::string& name) {
+    std::string path = "/proc/sys/" + name;
+    for (size_t i = 10; i < path.size(); i++) {
+        if (path[i] == '.') path[i] = '/';
+    }
+    return path;
+}
+
+std::string commandOutput(const std::string& command) {
+    std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(command.c_str(), "r"), pclose);
+    if (!pipe) return "";
+    std::array<char, 256> buffer;
+    std::string output;
+    while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) output += buffer.data();
+    return output;
+}
+
+// Multi-value sysctls come back tab-separated; they are written space-separated.
+std::string normalized(std::string value) {
+    while (!value.empty() && (value.back() == '\n' || value.back() == ' ')) value.pop_back();
+    for (char& c : value) {
+        if (c == '\t') c = ' ';
+    }
+    return value;
+}
+
+std::string readSysctl(const std::string& name, const std::string& netns) {
+    if (!netns.empty()) {
+        return normalized(commandOutput("ip netns exec " + netns + " cat " + procPath(name) + " 2>/dev/null"));
+    }
+    std::ifstream in(procPath(name));
+    std::string value;
+    std::getline(in, value);
+    return normalized(value);
+}
+
+bool writeSysctl(const std::string& name, const std::string& value, const std::string& netns) {
+    if (!netns.empty()) {
+        return std::system(("ip netns exec " + netns + " sysctl -q -w '" + name + "=" + value + "' >/dev/null 2>&1").c_str()) == 0;
+    }
+    std::ofstream out(procPath(name));
+    out << value << std::endl;
+    return static_cast<bool>(out);
+}
+
+// Runs an iproute2/tc command and throws with the command line when it fails.
+void run(const std::string& command) {
+    if (std::system((command + " >/dev/null 2>&1").c_str()) != 0) {
+        throw std::runtime_error("Network namespace setup failed (needs root and iproute2): " + command);
+    }
+}
+
+}  // namespace
+
+const std::vector<std::string>& networkProfiles() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> list;
+        for (const auto& profile : profiles()) list.push_back(profile.name);
+        return list;
+    }();
+    return names;
+}
+
+std::vector<SysctlValue> readNetworkSysctls(const std::string& netns) {
+    std::vector<SysctlValue> values;
+    for (const auto& name : kRecorded) values.push_back({name, readSysctl(name, netns)});
+    return values;
+}
+
+std::vector<SysctlValue> applyNetworkProfile(const std::string& profile, const std::string& netns) {
+    const Profile* chosen = nullptr;
+    for (const auto& known : profiles()) {
+        if (profile == known.name) chosen = &known;
+    }
+    if (chosen == nullptr) {
+        std::string names;
+        for (const auto& name : networkProfiles()) names += (names.empty() ? "" : ", ") + name;
+        throw std::runtime_error("Unknown networkProfile \"" + profile + "\" (known: " + names + ")");
+    }
+    std::vector<SysctlValue> previous;
+    for (const auto& setting : chosen->values) {
+        std::string current = readSysctl(setting.name, netns);
+        if (current.empty()) continue;  // not on this kernel (busy_poll without CONFIG_NET_RX_BUSY_POLL)
+        if (current == setting.value) continue;
+        if (!writeSysctl(setting.name, setting.value, netns)) {
+            restoreSysctls(previous, netns);
+            throw std::runtime_error("Cannot set " + setting.name + " = " + setting.value + " for networkProfile \"" +
+                                     profile + "\" (needs root)");
+        }
+        previous.push_back({setting.name, current});
+    }
+    return previous;
+}
+
+void restoreSysctls(const std::vector<SysctlValue>& values, const std::string& netns) {
+    for (const auto& setting : values) {
+        if (!writeSysctl(setting.name, setting.value, netns)) {
+            std::cerr << "Warning: could not restore " << setting.name << " = " << setting.value << std::endl;
+        }
+    }
+}
+
+NetworkNamespace::NetworkNamespace(const std::string& name, double rttMs) : nsName(name) {
+    // Interface names are limited to 15 characters.
+    std::string hostSide = "vh" + name.substr(0, 13);
+    std::string serverSide = "vs" + name.substr(0, 13);
+    std::string inside = "ip netns exec " + name + " ";
+    std::system(("ip netns del " + name + " >/dev/null 2>&1").c_str());  // left over from a killed run
+    run("ip netns add " + name);
+    try {
+        run("ip link add " + hostSide + " type veth peer name " + serverSide);
+        run("ip link set " + serverSide + " netns " + name);
+        run("ip addr add 10.201.0.1/30 dev " + hostSide);
+        run("ip link set " + hostSide + " up");
+        run(inside + "ip addr add 10.201.0.2/30 dev " + serverSide);
+        run(inside + "ip link set " + serverSide + " up");
+        run(inside + "ip link set lo up");
+        if (rttMs > 0) {
+            // netem queues delayed packets; the default limit of 1000 would drop them under load.
+            std::ostringstream delay;
+            delay << "root netem delay " << std::fixed << std::setprecision(3) << rttMs / 2 << "ms limit 1000000";
+            run("tc qdisc add dev " + hostSide + " " + delay.str());
+            run(inside + "tc qdisc add dev " + serverSide + " " + delay.str());
+        }
+    } catch (...) {
+        std::system(("ip link del " + hostSide + " >/dev/null 2>&1").c_str());
+        std::system(("ip netns del " + name + " >/dev/null 2>&1").c_str());
+        throw;
+    }
+}
+
+NetworkNamespace::~NetworkNamespace() {
+    // Deleting the namespace destroys its end of the veth pair, which takes the other end with it.
+    if (std::system(("ip netns del " + nsName + " >/dev/null 2>&1").c_str()) != 0) {
+        std::cerr << "Warning: could not delete network namespace " << nsName << std::endl;
+    }
+}
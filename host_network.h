@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Host network preparation. The sysctls that shape TCP benchmarks are recorded
+// before the runs. A named profile can be applied for the duration of the
+// benchmark and is restored afterwards. Servers can also be moved into a network
+// namespace behind a veth pair with netem delay, so the load crosses a real
+// interface with a chosen round-trip time instead of loopback.
+
+struct SysctlValue {
+    std::string name;   // dotted, e.g. "net.core.somaxconn"
+    std::string value;  // empty = not available on this kernel
+};
+
+// "throughput" and "low-latency"; see host_network.cpp for the values.
+const std::vector<std::string>& networkProfiles();
+
+// Reads the recorded sysctls, in this namespace or, with `netns`, in that one.
+std::vector<SysctlValue> readNetworkSysctls(const std::string& netns = "");
+
+// Applies a profile and returns the previous values of what it changed. Throws
+// std::runtime_error for an unknown profile or when a value cannot be written
+// (this needs root); anything already written is restored first.
+std::vector<SysctlValue> applyNetworkProfile(const std::string& profile, const std::string& netns = "");
+
+// Best effort; failures are reported on stderr.
+void restoreSysctls(const std::vector<SysctlValue>& values, const std::string& netns = "");
+
+// A network namespace joined to this one by a veth pair, 10.201.0.1 on the host
+// side and 10.201.0.2 inside, with netem delaying each direction by half of
+// `rttMs`. Needs root and iproute2; the constructor throws std::runtime_error
+// when a step fails. The namespace (and with it the veth pair) is deleted on
+// destruction.
+class NetworkNamespace {
+public:
+    NetworkNamespace(const std::string& name, double rttMs);
+    ~NetworkNamespace();
+    NetworkNamespace(const NetworkNamespace&) = delete;
+    NetworkNamespace& operator=(const NetworkNamespace&) = delete;
+
+    const std::string& name() const { return nsName; }
+    std::string serverAddress() const { return "10.201.0.2"; }
+
+private:
+    std::string nsName;
+};
@@ -0,0 +1,39 @@
+#include "interrupt.h"
+
+#include <atomic>
+#include <cstring>
+
+#include <signal.h>
+#include <unistd.h>
+
+namespace {
+
+std::atomic<int> received{0};
+static_assert(std::atomic<int>::is_always_lock_free, "set from a signal handler");
+
+void onSignal(int signal) {
+    received.store(signal, std::memory_order_relaxed);
+    const char* message = "\nInterrupted: stopping the run and restoring the host (again to quit at once)\n";
+    ssize_t ignored = write(STDERR_FILENO, message, std::strlen(message));
+    (void)ignored;
+}
+
+}  // namespace
+
+void installInterruptHandler() {
+    struct sigaction action {};
+    action.sa_handler = onSignal;
+    sigemptyset(&action.sa_mask);
+    // SA_RESETHAND: the second signal takes the default action.
+    action.sa_flags = SA_RESTART | SA_RESETHAND;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+
+int interruptSignal() {
+    return received.load(std::memory_order_relaxed);
+}
+
+void throwIfInterrupted() {
+    if (int signal = interruptSignal()) throw BenchmarkInterrupted{signal};
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+// Ctrl-C and SIGTERM for a benchmark run. The first signal only sets a flag:
+// running load tests end early, and the orchestrator throws BenchmarkInterrupted
+// at its next check, so the run unwinds through the destructors that stop the
+// servers, restore the network sysctls and delete the network namespace. A second
+// signal gets the default action and ends the process at once.
+
+// Thrown once a signal has arrived. Deliberately not a std::exception, so the
+// handlers that skip a failed run do not swallow it.
+struct BenchmarkInterrupted {
+    int signal;
+};
+
+void installInterruptHandler();
+
+// The signal received, or 0. Cheap enough to poll from a load test's loop.
+int interruptSignal();
+
+void throwIfInterrupted();
@@ -0,0 +1,235 @@
+#include "json_value.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Recursive descent over one JSON document; errors name the line.
+class Parser {
+public:
+    explicit Parser(const std::string& text) : text(text) {}
+
+    JsonValue document() {
+        JsonValue value = parseValue();
+        skipSpace();
+        if (pos != text.size()) fail("unexpected trailing characters");
+        return value;
+    }
+
+    JsonValue streamDocument(const std::string& key, const std::function<void(JsonValue&&)>& visit) {
+        streamKey = &key;
+        streamVisit = &visit;
+        skipSpace();
+        if (pos >= text.size() || text[pos] != '{') fail("expected an object");
+        return document();
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& message) const {
+        int line = 1;
+        for (size_t i = 0; i < pos && i < text.size(); i++) {
+            if (text[i] == '\n') line++;
+        }
+        throw std::runtime_error("line " + std::to_string(line) + ": " + message);
+    }
+
+    void skipSpace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+            pos++;
+        }
+    }
+
+    void expect(char c) {
+        skipSpace();
+        if (pos >= text.size() || text[pos] != c) fail(std::string("expected '") + c + "'");
+        pos++;
+    }
+
+    // Consumes the comma between two items.
+    bool nextItem() {
+        skipSpace();
+        if (pos >= text.size() || text[pos] != ',') return false;
+        pos++;
+        return true;
+    }
+
+    bool literal(const char* word) {
+        size_t len = std::char_traits<char>::length(word);
+        if (text.compare(pos, len, word) != 0) return false;
+        pos += len;
+        return true;
+    }
+
+    JsonValue parseValue() {
+        skipSpace();
+        if (pos >= text.size()) fail("unexpected end of input");
+        JsonValue value;
+        char c = text[pos];
+        if (c == '{') {
+            value.type = JsonValue::Object;
+            pos++;
+            skipSpace();
+            if (pos < text.size() && text[pos] == '}') {
+                pos++;
+                return value;
+            }
+            Nesting nesting(depth);
+            do {
+                skipSpace();
+                if (pos >= text.size() || text[pos] != '"') fail("expected a quoted key");
+                std::string key = parseString();
+                expect(':');
+                if (depth == 1 && streamKey && key == *streamKey && streamArray()) continue;
+                value.members.emplace_back(key, parseValue());
+            } while (nextItem());
+            expect('}');
+        } else if (c == '[') {
+            value.type = JsonValue::Array;
+            pos++;
+            skipSpace();
+            if (pos < text.size() && text[pos] == ']') {
+                pos++;
+                return value;
+            }
+            Nesting nesting(depth);
+            do {
+                value.items.push_back(parseValue());
+            } while (nextItem());
+            expect(']');
+        } else if (c == '"') {
+            value.type = JsonValue::String;
+            value.text = parseString();
+        } else if (literal("true")) {
+            value.type = JsonValue::Bool;
+            value.boolean = true;
+        } else if (literal("false")) {
+            value.type = JsonValue::Bool;
+        } else if (literal("null")) {
+            value.type = JsonValue::Null;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            const char* start = text.c_str() + pos;
+            char* end = nullptr;
+            value.type = JsonValue::Number;
+            value.number = std::strtod(start, &end);
+            if (end == start) fail("malformed number");
+            value.text.assign(start, end - start);
+            pos += end - start;
+        } else {
+            fail(std::string("unexpected '") + c + "'");
+        }
+        return value;
+    }
+
+    // The streamed member's items go to the visitor one at a time; false when the
+    // member is not an array and is parsed as usual.
+    bool streamArray() {
+        skipSpace();
+        if (pos >= text.size() || text[pos] != '[') return false;
+        pos++;
+        skipSpace();
+        if (pos < text.size() && text[pos] == ']') {
+            pos++;
+            return true;
+        }
+        Nesting nesting(depth);
+        do {
+            (*streamVisit)(parseValue());
+        } while (nextItem());
+        expect(']');
+        return true;
+    }
+
+    struct Nesting {
+        explicit Nesting(int& depth) : depth(depth) { depth++; }
+        ~Nesting() { depth--; }
+        int& depth;
+    };
+
+    std::string parseString() {
+        pos++;  // opening quote
+        std::string out;
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) break;
+            char escaped = text[pos++];
+            switch (escaped) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    if (pos + 4 > text.size()) fail("truncated \\u escape");
+                    std::string digits = text.substr(pos, 4);
+                    char* end = nullptr;
+                    unsigned code = std::strtoul(digits.c_str(), &end, 16);
+                    if (end != digits.c_str() + 4) fail("malformed \\u escape");
+                    pos += 4;
+                    // UTF-8; surrogate pairs are left as two code points.
+                    if (code < 0x80) {
+                        out += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        out += static_cast<char>(0xC0 | (code >> 6));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        out += static_cast<char>(0xE0 | (code >> 12));
+                        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        out += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: out += escaped; break;
+            }
+        }
+        if (pos >= text.size()) fail("unterminated string");
+        pos++;  // closing quote
+        return out;
+    }
+
+    const std::string& text;
+    size_t pos = 0;
+    int depth = 0;
+    const std::string* streamKey = nullptr;
+    const std::function<void(JsonValue&&)>* streamVisit = nullptr;
+};
+
+}  // namespace
+
+JsonValue parseJson(const std::string& text) {
+    return Parser(text).document();
+}
+
+JsonValue parseJsonStreaming(const std::string& text, const std::string& key,
+                             const std::function<void(JsonValue&&)>& visit) {
+    return Parser(text).streamDocument(key, visit);
+}
+
+const JsonValue* findMember(const JsonValue& object, const std::string& key) {
+    for (const auto& [name, value] : object.members) {
+        if (name == key) return &value;
+    }
+    return nullptr;
+}
+
+std::string jsonString(const std::string& text) {
+    std::ostringstream out;
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+    return out.str();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A parsed JSON document, for the matrix config and the profiles runtimes write.
+struct JsonValue {
+    enum Type { Null, Bool, Number, String, Array, Object } type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;  // strings, and the literal of numbers
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+};
+
+// Throws std::runtime_error naming the line of the first error.
+JsonValue parseJson(const std::string& text);
+
+// Parses a document whose top level is an object, handing each item of its array
+// member `key` to `visit` as soon as the item is complete instead of keeping it, so a
+// results file with thousands of entries is never held as one tree. Returns the other
+// members. Throws like parseJson.
+JsonValue parseJsonStreaming(const std::string& text, const std::string& key,
+                             const std::function<void(JsonValue&&)>& visit);
+
+// The member called `key` of an object; nullptr when there is none.
+const JsonValue* findMember(const JsonValue& object, const std::string& key);
+
+// `text` quoted and escaped as a JSON string; flags, paths and frame names may contain quotes.
+std::string jsonString(const std::string& text);
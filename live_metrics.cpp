@@ -0,0 +1,243 @@
+#include "live_metrics.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+
+// Latency histogram bucket bounds in seconds, 100us to 10s.
+const double kLatencyBounds[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+                                 0.05,   0.1,     0.25,   0.5,   1.0,    2.5,   5.0,  10.0};
+
+std::string escapeLabel(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') escaped += '\\';
+        if (c == '\n') {
+            escaped += "\\n";
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+// One metric family: its HELP and TYPE lines. OpenMetrics names a counter family
+// without the _total suffix its samples carry; Prometheus text names it with it.
+void family(std::ostream& out, const std::string& name, const char* type, const char* help, bool openMetrics) {
+    std::string familyName = name;
+    if (std::string(type) == "counter" && !openMetrics) familyName += "_total";
+    out << "# HELP " << familyName << " " << help << "\n";
+    out << "# TYPE " << familyName << " " << type << "\n";
+}
+
+}  // namespace
+
+void LiveMetrics::beginRun(const std::string& setup, const std::string& scenario, const std::string& label) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series& entry = series[{setup, scenario}];
+    // A run that failed without endRun() still counts, so the counters never go back.
+    if (entry.active) finish(entry);
+    entry.label = label;
+    entry.active = true;
+    entry.runs++;
+    entry.current = Totals{};
+    entry.currentLatency.reset();
+    entry.recentLatency.reset();
+    entry.elapsedSec = 0.0;
+    entry.requestsPerSecond = 0.0;
+}
+
+void LiveMetrics::update(const std::string& setup, const std::string& scenario, const LoadProgress& progress) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series& entry = series[{setup, scenario}];
+    double span = progress.elapsedSec - entry.elapsedSec;
+    if (span > 0 && progress.completed >= entry.current.completed) {
+        entry.requestsPerSecond = (progress.completed - entry.current.completed) / span;
+    }
+    entry.elapsedSec = progress.elapsedSec;
+    entry.current.completed = progress.completed;
+    entry.current.errors = progress.errors;
+    entry.current.bytesRead = progress.bytesRead;
+    entry.current.connectionsOpened = progress.connectionsOpened;
+    if (progress.latency) entry.currentLatency = *progress.latency;
+    if (progress.recentLatency) entry.recentLatency = *progress.recentLatency;
+}
+
+void LiveMetrics::endRun(const std::string& setup, const std::string& scenario) {
+    std::lock_guard<std::mutex> lock(mutex);
+    finish(series[{setup, scenario}]);
+}
+
+void LiveMetrics::finish(Series& entry) {
+    entry.finished.completed += entry.current.completed;
+    entry.finished.errors += entry.current.errors;
+    entry.finished.bytesRead += entry.current.bytesRead;
+    entry.finished.connectionsOpened += entry.current.connectionsOpened;
+    entry.finishedLatency.merge(entry.currentLatency);
+    entry.current = Totals{};
+    entry.currentLatency.reset();
+    entry.active = false;
+    entry.requestsPerSecond = 0.0;
+}
+
+std::string LiveMetrics::render(bool openMetrics) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream out;
+    out << std::setprecision(10);
+    auto labels = [](const std::pair<std::string, std::string>& key) {
+        return "setup=\"" + escapeLabel(key.first) + "\",scenario=\"" + escapeLabel(key.second) + "\"";
+    };
+    auto counter = [&](const std::string& name, const char* help, uint64_t Totals::*field) {
+        family(out, name, "counter", help, openMetrics);
+        for (const auto& [key, entry] : series) {
+            out << name << "_total{" << labels(key) << "} " << entry.finished.*field + entry.current.*field << "\n";
+        }
+    };
+    counter("benchmark_requests", "Requests completed by the load generator.", &Totals::completed);
+    counter("benchmark_errors", "Failed requests: non-2xx, socket errors and timeouts.", &Totals::errors);
+    counter("benchmark_received_bytes", "Response bytes received.", &Totals::bytesRead);
+    counter("benchmark_connections_opened", "Connections opened, including reconnects.", &Totals::connectionsOpened);
+
+    family(out, "benchmark_requests_per_second", "gauge", "Throughput over the latest progress interval.", openMetrics);
+    for (const auto& [key, entry] : series) {
+        out << "benchmark_requests_per_second{" << labels(key) << "} " << entry.requestsPerSecond << "\n";
+    }
+    family(out, "benchmark_run_active", "gauge", "1 while a measured run of the setup is in progress.", openMetrics);
+    for (const auto& [key, entry] : series) {
+        out << "benchmark_run_active{" << labels(key) << "} " << (entry.active ? 1 : 0) << "\n";
+    }
+    family(out, "benchmark_runs_started", "counter", "Measured runs started.", openMetrics);
+    for (const auto& [key, entry] : series) {
+        out << "benchmark_runs_started_total{" << labels(key) << "} " << entry.runs << "\n";
+    }
+
+    family(out, "benchmark_latency_seconds", "histogram", "Request latency, every closed interval so far.", openMetrics);
+    for (const auto& [key, entry] : series) {
+        HdrHistogram latency = entry.finishedLatency;
+        latency.merge(entry.currentLatency);
+        for (double bound : kLatencyBounds) {
+            out << "benchmark_latency_seconds_bucket{" << labels(key) << ",le=\"" << bound << "\"} "
+                << latency.countAtOrBelow(static_cast<int64_t>(bound * 1e6)) << "\n";
+        }
+        out << "benchmark_latency_seconds_bucket{" << labels(key) << ",le=\"+Inf\"} " << latency.totalCount() << "\n";
+        out << "benchmark_latency_seconds_count{" << labels(key) << "} " << latency.totalCount() << "\n";
+        out << "benchmark_latency_seconds_sum{" << labels(key) << "} " << latency.mean() * latency.totalCount() / 1e6
+            << "\n";
+    }
+    family(out, "benchmark_recent_latency_seconds", "gauge", "Latency percentiles of the latest closed interval.",
+           openMetrics);
+    for (const auto& [key, entry] : series) {
+        for (double quantile : {0.5, 0.9, 0.99, 0.999}) {
+            out << "benchmark_recent_latency_seconds{" << labels(key) << ",quantile=\"" << quantile << "\"} "
+                << entry.recentLatency.valueAtPercentile(quantile * 100) / 1e6 << "\n";
+        }
+    }
+    if (openMetrics) out << "# EOF\n";
+    return out.str();
+}
+
+std::string LiveMetrics::statusLine(const std::string& setup, const std::string& scenario) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = series.find({setup, scenario});
+    if (it == series.end()) return "";
+    const Series& entry = it->second;
+    std::ostringstream line;
+    line << "[" << entry.label << "] " << std::fixed << std::setprecision(0) << entry.elapsedSec << "s  "
+         << entry.requestsPerSecond << " req/s  P99 ";
+    if (entry.recentLatency.totalCount() > 0) {
+        line << std::setprecision(2) << entry.recentLatency.valueAtPercentile(99) / 1000.0 << "ms  ";
+    } else {
+        line << "-  ";  // agents only stream counters
+    }
+    line << entry.current.errors << " errors";
+    return line.str();
+}
+
+MetricsServer::MetricsServer(const LiveMetrics& metrics, int port) : metrics(metrics) {
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) throw std::runtime_error(std::string("metrics socket failed: ") + std::strerror(errno));
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        std::string error = std::strerror(errno);
+        close(listener);
+        throw std::runtime_error("cannot serve metrics on port " + std::to_string(port) + ": " + error);
+    }
+    thread = std::thread([this]() { loop(); });
+}
+
+MetricsServer::~MetricsServer() {
+    stopping.store(true);
+    if (thread.joinable()) thread.join();
+    close(listener);
+}
+
+void MetricsServer::loop() {
+    while (!stopping.load()) {
+        pollfd waiting{listener, POLLIN, 0};
+        if (poll(&waiting, 1, 200) != 1) continue;
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        serve(fd);
+        close(fd);
+    }
+}
+
+// One request per connection; scrapes are rare enough that serving them inline is fine.
+void MetricsServer::serve(int fd) {
+    timeval timeout{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::string request;
+    char chunk[2048];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 16384) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return;
+        request.append(chunk, static_cast<size_t>(n));
+    }
+
+    std::istringstream firstLine(request.substr(0, request.find("\r\n")));
+    std::string method, path;
+    firstLine >> method >> path;
+    std::string status = "200 OK", contentType = "text/plain; charset=utf-8", body;
+    if (method != "GET") {
+        status = "405 Method Not Allowed";
+        body = "GET only\n";
+    } else if (path == "/metrics") {
+        bool openMetrics = request.find("application/openmetrics-text") != std::string::npos;
+        contentType = openMetrics ? "application/openmetrics-text; version=1.0.0; charset=utf-8"
+                                  : "text/plain; version=0.0.4; charset=utf-8";
+        body = metrics.render(openMetrics);
+    } else if (path == "/") {
+        body = "benchmark_wrk live metrics: /metrics\n";
+    } else {
+        status = "404 Not Found";
+        body = "not found\n";
+    }
+
+    std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: " + contentType +
+                           "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    size_t sent = 0;
+    while (sent < response.size()) {
+#if defined(MSG_NOSIGNAL)
+        ssize_t n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+#else
+        ssize_t n = send(fd, response.data() + sent, response.size() - sent, 0);
+#endif
+        if (n <= 0) return;
+        sent += static_cast<size_t>(n);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "hdr_histogram.h"
+#include "load_generator.h"
+
+// Live state of the load tests, fed by the load generators' progress callbacks
+// once per interval and read by the metrics endpoint and the terminal view. The
+// request loops never touch it: workers publish lock-free counters, and only the
+// progress thread of each run takes the mutex.
+//
+// Series are keyed by setup and scenario and stay monotonic across runs, so
+// Prometheus rate() and histogram_quantile() work over a whole session:
+//
+//   benchmark_requests_total{setup="Hono on Bun",scenario="hello"} 1234567
+//   benchmark_latency_seconds_bucket{setup="Hono on Bun",scenario="hello",le="0.001"} 1200345
+class LiveMetrics {
+public:
+    void beginRun(const std::string& setup, const std::string& scenario, const std::string& label);
+    void update(const std::string& setup, const std::string& scenario, const LoadProgress& progress);
+    void endRun(const std::string& setup, const std::string& scenario);
+
+    // Prometheus text format 0.0.4, or OpenMetrics 1.0 (with "# EOF").
+    std::string render(bool openMetrics) const;
+
+    // "[Hono on Bun run 2] 12s  45123 req/s  P99 1.20ms  0 errors" for the terminal.
+    std::string statusLine(const std::string& setup, const std::string& scenario) const;
+
+private:
+    struct Totals {
+        uint64_t completed = 0;
+        uint64_t errors = 0;
+        uint64_t bytesRead = 0;
+        uint64_t connectionsOpened = 0;
+    };
+    struct Series {
+        std::string label;  // the run in progress
+        bool active = false;
+        int runs = 0;
+        Totals finished;    // runs that have ended
+        Totals current;     // the run in progress
+        HdrHistogram finishedLatency;
+        HdrHistogram currentLatency;
+        HdrHistogram recentLatency;
+        double elapsedSec = 0.0;
+        double requestsPerSecond = 0.0;  // over the latest progress interval
+    };
+
+    void finish(Series& entry);
+
+    mutable std::mutex mutex;
+    std::map<std::pair<std::string, std::string>, Series> series;
+};
+
+// Serves GET /metrics from a LiveMetrics on 0.0.0.0:port on a background thread
+// until destroyed. Answers with OpenMetrics when the scraper asks for it, and with
+// Prometheus text otherwise. Throws std::runtime_error if the port cannot be bound.
+class MetricsServer {
+public:
+    MetricsServer(const LiveMetrics& metrics, int port);
+    ~MetricsServer();
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+private:
+    void loop();
+    void serve(int fd);
+
+    const LiveMetrics& metrics;
+    int listener = -1;
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+};
@@ -0,0 +1,1571 @@
+#include "load_generator.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#include "arrival.h"
+#include "h2_session.h"
+#include "interrupt.h"
+#include "poller.h"
+#include "sample_archive.h"
+
+long long parseDurationMs(const std::string& value) {
+    char* end = nullptr;
+    double amount = std::strtod(value.c_str(), &end);
+    if (end == value.c_str() || amount < 0) {
+        throw std::runtime_error("Invalid duration: " + value);
+    }
+
+    std::string_view unit(end);
+    if (unit.empty() || unit == "s") return static_cast<long long>(amount * 1000.0);
+    if (unit == "ms") return static_cast<long long>(amount);
+    if (unit == "us") return static_cast<long long>(amount / 1000.0);
+    if (unit == "m") return static_cast<long long>(amount * 60.0 * 1000.0);
+    if (unit == "h") return static_cast<long long>(amount * 3600.0 * 1000.0);
+    throw std::runtime_error("Invalid duration unit: " + value);
+}
+
+TransportMode parseTransport(const std::string& name) {
+    TransportMode mode;
+    if (name == "http1") return mode;
+    if (name == "http1-close") {
+        mode.closeEach = true;
+    } else if (name == "https") {
+        mode.tls = true;
+    } else if (name == "https-close") {
+        mode.tls = true;
+        mode.closeEach = true;
+    } else if (name == "h2") {
+        mode.tls = true;
+        mode.h2 = true;
+    } else {
+        throw std::runtime_error("Unknown transport \"" + name + "\" (known: http1, http1-close, https, https-close, h2)");
+    }
+    return mode;
+}
+
+uint64_t monotonicNowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+namespace {
+
+// How long after a timeline boundary the run() thread waits before collecting it.
+constexpr uint64_t kTimelineGraceNs = 20ULL * 1000000ULL;
+// How often the run() thread checks for Ctrl-C between timeline and progress wakeups.
+constexpr uint64_t kInterruptPollNs = 100ULL * 1000000ULL;
+
+uint64_t nowNs() { return monotonicNowNs(); }
+
+uint64_t threadCpuNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Incremental HTTP/1.1 response parser. Only the header block is copied; bodies
+// (Content-Length, chunked or read-until-close) are counted and discarded.
+class ResponseParser {
+public:
+    enum class Status { NeedMore, Complete, Error };
+
+    void reset() {
+        state = State::Headers;
+        headerLen = 0;
+        statusCode = 0;
+        keepAlive = true;
+        remaining = 0;
+        chunkSize = 0;
+        lineEmpty = true;
+    }
+
+    Status feed(const char* data, size_t len) {
+        size_t pos = 0;
+        while (pos < len) {
+            switch (state) {
+                case State::Headers: {
+                    size_t take = std::min(len - pos, header.size() - headerLen);
+                    if (take == 0) return Status::Error;
+                    size_t searchFrom = headerLen >= 3 ? headerLen - 3 : 0;
+                    std::memcpy(header.data() + headerLen, data + pos, take);
+                    headerLen += take;
+
+                    std::string_view view(header.data(), headerLen);
+                    size_t end = view.find("\r\n\r\n", searchFrom);
+                    if (end == std::string_view::npos) {
+                        pos += take;
+                        break;
+                    }
+                    size_t headerBytes = end + 4;
+                    pos += take - (headerLen - headerBytes);
+                    if (!parseHeaders(view.substr(0, headerBytes))) return Status::Error;
+                    if (state == State::Done) return Status::Complete;
+                    break;
+                }
+                case State::Body: {
+                    size_t take = std::min<uint64_t>(len - pos, remaining);
+                    remaining -= take;
+                    pos += take;
+                    if (remaining == 0) {
+                        state = State::Done;
+                        return Status::Complete;
+                    }
+                    break;
+                }
+                case State::ChunkSize: {
+                    char c = data[pos++];
+                    if (c == '\n') {
+                        if (chunkSize == 0) {
+                            state = State::Trailers;
+                            lineEmpty = true;
+                        } else {
+                            remaining = chunkSize;
+                            state = State::ChunkData;
+                        }
+                    } else if (!inChunkExtension) {
+                        int digit = hexValue(c);
+                        if (digit >= 0) {
+                            chunkSize = chunkSize * 16 + static_cast<uint64_t>(digit);
+                        } else if (c == ';' || c == ' ' || c == '\t') {
+                            inChunkExtension = true;
+                        } else if (c != '\r') {
+                            return Status::Error;
+                        }
+                    }
+                    break;
+                }
+                case State::ChunkData: {
+                    size_t take = std::min<uint64_t>(len - pos, remaining);
+                    remaining -= take;
+                    pos += take;
+                    if (remaining == 0) state = State::ChunkDataEnd;
+                    break;
+                }
+                case State::ChunkDataEnd: {
+                    if (data[pos++] == '\n') {
+                        state = State::ChunkSize;
+                        chunkSize = 0;
+                        inChunkExtension = false;
+                    }
+                    break;
+                }
+                case State::Trailers: {
+                    char c = data[pos++];
+                    if (c == '\n') {
+                        if (lineEmpty) {
+                            state = State::Done;
+                            return Status::Complete;
+                        }
+                        lineEmpty = true;
+                    } else if (c != '\r') {
+                        lineEmpty = false;
+                    }
+                    break;
+                }
+                case State::UntilClose:
+                    pos = len;
+                    break;
+                case State::Done:
+                    return Status::Complete;
+            }
+        }
+        return Status::NeedMore;
+    }
+
+    // Called when the peer closes the connection mid-response.
+    Status finishOnClose() const {
+        return state == State::UntilClose ? Status::Complete : Status::Error;
+    }
+
+    int status() const { return statusCode; }
+    bool reusable() const { return keepAlive && state == State::Done; }
+
+private:
+    enum class State { Headers, Body, ChunkSize, ChunkData, ChunkDataEnd, Trailers, UntilClose, Done };
+
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            char x = a[i] >= 'A' && a[i] <= 'Z' ? static_cast<char>(a[i] + 32) : a[i];
+            if (x != b[i]) return false;
+        }
+        return true;
+    }
+
+    static bool containsIgnoreCase(std::string_view haystack, std::string_view needle) {
+        if (needle.size() > haystack.size()) return false;
+        for (size_t i = 0; i + needle.size() <= haystack.size(); i++) {
+            if (equalsIgnoreCase(haystack.substr(i, needle.size()), needle)) return true;
+        }
+        return false;
+    }
+
+    bool parseHeaders(std::string_view block) {
+        // "HTTP/1.1 200 OK"
+        if (block.size() < 12 || block.substr(0, 5) != "HTTP/") return false;
+        bool http10 = block.substr(5, 3) == "1.0";
+        keepAlive = !http10;
+        statusCode = 0;
+        for (size_t i = 9; i < 12; i++) {
+            if (block[i] < '0' || block[i] > '9') return false;
+            statusCode = statusCode * 10 + (block[i] - '0');
+        }
+
+        bool chunked = false;
+        bool hasLength = false;
+        uint64_t contentLength = 0;
+
+        size_t lineStart = block.find("\r\n") + 2;
+        while (lineStart < block.size()) {
+            size_t lineEnd = block.find("\r\n", lineStart);
+            if (lineEnd == std::string_view::npos || lineEnd == lineStart) break;
+            std::string_view line = block.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 2;
+
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos) continue;
+            std::string_view name = line.substr(0, colon);
+            std::string_view value = line.substr(colon + 1);
+            while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+
+            if (equalsIgnoreCase(name, "content-length")) {
+                hasLength = true;
+                contentLength = 0;
+                for (char c : value) {
+                    if (c < '0' || c > '9') break;
+                    contentLength = contentLength * 10 + static_cast<uint64_t>(c - '0');
+                }
+            } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+                chunked = containsIgnoreCase(value, "chunked");
+            } else if (equalsIgnoreCase(name, "connection")) {
+                if (containsIgnoreCase(value, "close")) keepAlive = false;
+                else if (containsIgnoreCase(value, "keep-alive")) keepAlive = true;
+            }
+        }
+
+        if (statusCode == 204 || statusCode == 304 || (statusCode >= 100 && statusCode < 200)) {
+            state = State::Done;
+        } else if (chunked) {
+            state = State::ChunkSize;
+            chunkSize = 0;
+            inChunkExtension = false;
+        } else if (hasLength) {
+            remaining = contentLength;
+            state = contentLength == 0 ? State::Done : State::Body;
+        } else {
+            keepAlive = false;
+            state = State::UntilClose;
+        }
+        return true;
+    }
+
+    State state = State::Headers;
+    std::array<char, 8192> header{};
+    size_t headerLen = 0;
+    int statusCode = 0;
+    bool keepAlive = true;
+    uint64_t remaining = 0;
+    uint64_t chunkSize = 0;
+    bool inChunkExtension = false;
+    bool lineEmpty = true;
+};
+
+// Streaming is an HTTP/2 connection, which carries its requests in `h2` instead.
+struct Connection {
+    enum class State { Closed, Connecting, Handshaking, Idle, Writing, Reading, Streaming };
+
+    int fd = -1;
+    State state = State::Closed;
+    size_t written = 0;
+    uint64_t requestStart = 0;  // intended send time in constant-rate mode
+    uint64_t connectStart = 0;
+    uint64_t pendingStart = 0;  // intended time of the request a paced new-connection-per-request open is for
+    uint64_t sendStart = 0;     // phases of the request in flight; 0 = not reached yet
+    uint64_t writtenAt = 0;
+    uint64_t firstByteAt = 0;
+    uint64_t responseBytes = 0;
+    uint64_t retryAt = 0;
+    bool queuedIdle = false;
+    uint64_t idleSince = 0;  // when it last became free for a paced request
+    uint32_t route = 0;
+    ResponseParser parser;
+
+    // TLS runs over memory BIOs, so every socket read and write stays ours
+    // (MSG_NOSIGNAL, edge-triggered draining).
+    SSL* ssl = nullptr;
+    BIO* tlsIn = nullptr;   // owned by ssl
+    BIO* tlsOut = nullptr;  // owned by ssl
+    std::string cipherOut;
+    size_t cipherSent = 0;
+    SSL_SESSION* session = nullptr;  // offered on the next handshake when resuming
+    std::unique_ptr<H2Session> h2;
+};
+
+// Transport settings and shared, read-only request state for every worker.
+struct WorkerTransport {
+    TransportMode mode;
+    SSL_CTX* tls = nullptr;
+    bool resume = true;
+    std::string serverName;                       // SNI
+    const std::vector<H2Request>* h2Requests = nullptr;
+    int h2Streams = 1;
+};
+
+struct PhaseStats {
+    uint64_t sumUs = 0;
+    HdrHistogram latency;
+
+    void record(uint64_t ns) {
+        sumUs += ns / 1000ULL;
+        latency.record(static_cast<int64_t>(ns / 1000ULL));
+    }
+
+    void merge(const PhaseStats& other) {
+        sumUs += other.sumUs;
+        latency.merge(other.latency);
+    }
+};
+
+struct RouteStats {
+    uint64_t completed = 0;
+    uint64_t errors = 0;
+    uint64_t latencySumUs = 0;
+    HdrHistogram latency;
+};
+
+// Serialized requests and running weight totals, shared read-only by every worker.
+struct RequestMix {
+    std::vector<std::string> requests;
+    std::vector<uint64_t> cumulativeWeights;
+};
+
+struct WorkerStats {
+    uint64_t completed = 0;
+    uint64_t non2xx = 0;
+    uint64_t connectErrors = 0;
+    uint64_t readErrors = 0;
+    uint64_t writeErrors = 0;
+    uint64_t timeouts = 0;
+    uint64_t bytesRead = 0;
+    HdrHistogram latency;
+    uint64_t latencySumUs = 0;
+    std::vector<RouteStats> routes;  // only kept when the mix has several routes
+    uint64_t connectionsOpened = 0;
+    uint64_t tlsHandshakes = 0;
+    uint64_t tlsResumed = 0;
+    uint64_t setupSumUs = 0;
+    HdrHistogram setupLatency;  // connect() until a connection can send
+    PhaseStats waitPhase;       // HTTP/1.1 requests only, see LatencyPhases
+    PhaseStats writePhase;
+    PhaseStats firstBytePhase;
+    PhaseStats transferPhase;
+    uint64_t cpuNs = 0;  // the worker thread's CPU time over run(), see ClientLoad
+    uint64_t wallNs = 0;
+    uint64_t pacedSends = 0;
+    uint64_t lateSends = 0;
+    uint64_t backlogPeak = 0;
+    HdrHistogram sendLag;
+
+    uint64_t errorCount() const { return non2xx + connectErrors + readErrors + writeErrors + timeouts; }
+};
+
+// Running totals a worker publishes for the run() thread to read mid-run. Only the
+// worker writes them, with relaxed stores once per event-loop pass. The block fills
+// its own cache lines, so a reader never contends for a line the request loop writes.
+constexpr size_t kCacheLine = 64;
+struct alignas(kCacheLine) PublishedCounters {
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> bytesRead{0};
+    std::atomic<uint64_t> connectionsOpened{0};
+};
+
+// One worker's share of a timeline interval, handed to the run() thread.
+struct IntervalSample {
+    int index = 0;
+    uint64_t completed = 0;
+    uint64_t errors = 0;
+    uint64_t bytesRead = 0;
+    HdrHistogram latency;
+};
+
+// One event loop driving a fixed set of connections. Without a schedule every
+// connection sends its next request as soon as the previous response arrives
+// (closed loop). Otherwise requests are released when the ArrivalSchedule has them
+// due and each latency is measured from the request's intended send time, so time
+// a request spends queued behind a slow server is counted (coordinated-omission
+// correction).
+class Worker {
+public:
+    Worker(const sockaddr_storage& address, socklen_t addressLen, const RequestMix& mix, const WorkerTransport& transport,
+           uint64_t seed, int connectionCount, uint64_t timeoutNs, std::unique_ptr<ArrivalSchedule> schedule)
+        : address(address), addressLen(addressLen), mix(mix), transport(transport), rng(seed | 1),
+          connections(static_cast<size_t>(connectionCount)), timeoutNs(timeoutNs), schedule(std::move(schedule)) {
+        reconnectQueue.reserve(connections.size());
+        idle.reserve(connections.size());
+        if (mix.requests.size() > 1) stats.routes.resize(mix.requests.size());
+    }
+
+    ~Worker() {
+        for (auto& conn : connections) {
+            if (conn.ssl) SSL_free(conn.ssl);
+            if (conn.session) SSL_SESSION_free(conn.session);
+        }
+    }
+
+    // Every outcome also goes to the archive, in blocks of the writer's.
+    void setArchive(SampleArchiveWriter* archive, uint16_t index) {
+        this->archive = archive;
+        workerIndex = index;
+        if (archive) samples = archive->takeBlock();
+    }
+
+    // Latencies are recorded into an interval histogram that is folded into the run
+    // total at each bucketNs boundary (or once at the end when bucketNs == 0).
+    void setTimelineInterval(uint64_t bucketNs) {
+        this->bucketNs = bucketNs;
+        std::lock_guard<std::mutex> lock(mailboxMutex);
+        spare.resize(2);
+    }
+
+    void run(uint64_t start, uint64_t deadline, const std::atomic<bool>& stop) {
+        scheduleStart = start;
+        if (schedule) advanceSchedule();
+        this->deadline = deadline;
+        nextBoundary = bucketNs > 0 ? start + bucketNs : UINT64_MAX;
+        uint64_t now = nowNs();
+        uint64_t cpuStart = threadCpuNs(), wallStart = now;
+        for (auto& conn : connections) {
+            // Paced new-connection-per-request lanes only connect once a request is due.
+            if (pacedReconnects()) {
+                returnLane(conn);
+            } else {
+                openConnection(conn, now);
+            }
+        }
+
+        std::array<PollEvent, 256> events;
+        uint64_t nextSweep = now + kSweepIntervalNs;
+
+        while (now < deadline && !stop.load(std::memory_order_relaxed)) {
+            uint64_t wakeAt = std::min(std::min(nextSweep, deadline), nextBoundary);
+            if (schedule && !idle.empty()) wakeAt = std::min(wakeAt, nextSendTime());
+            uint64_t timeoutUs = wakeAt > now ? (wakeAt - now) / 1000ULL : 0;
+
+            int n = poller.wait(events.data(), static_cast<int>(events.size()), timeoutUs);
+            if (n < 0 && errno != EINTR) break;
+
+            for (int i = 0; i < n; i++) {
+                auto* conn = static_cast<Connection*>(events[i].ptr);
+                if (conn->fd < 0) continue;
+                if (events[i].writable) onWritable(*conn);
+                if (conn->fd >= 0 && events[i].readable) onReadable(*conn);
+            }
+
+            now = nowNs();
+            // Reopen connections the server closed during this batch; failed ones wait for the sweep.
+            for (Connection* conn : reconnectQueue) {
+                if (conn->fd < 0 && now < deadline) openConnection(*conn, now);
+            }
+            reconnectQueue.clear();
+            if (schedule) dispatchScheduled(std::min(now, deadline));
+            if (now >= nextSweep) {
+                sweep(now);
+                nextSweep = now + kSweepIntervalNs;
+            }
+            while (now >= nextBoundary && now < deadline) {
+                closeInterval();
+                nextBoundary += bucketNs;
+            }
+            publishProgress();
+        }
+        publishProgress();
+        if (bucketNs > 0) {
+            closeInterval();
+        } else {
+            stats.latency.merge(intervalLatency);
+        }
+        if (archive) archive->submit(std::move(samples));
+        stats.cpuNs = threadCpuNs() - cpuStart;
+        stats.wallNs = nowNs() - wallStart;
+
+        for (auto& conn : connections) {
+            if (conn.fd >= 0) close(conn.fd);
+            conn.fd = -1;
+        }
+    }
+
+    const WorkerStats& result() const { return stats; }
+
+    // Snapshot readable from the progress thread while run() is still going.
+    void addProgress(LoadProgress& progress) const {
+        progress.completed += published.completed.load(std::memory_order_relaxed);
+        progress.errors += published.errors.load(std::memory_order_relaxed);
+        progress.bytesRead += published.bytesRead.load(std::memory_order_relaxed);
+        progress.connectionsOpened += published.connectionsOpened.load(std::memory_order_relaxed);
+    }
+
+    // Moves closed intervals out for merging; give their histograms back with recycle().
+    void takeIntervals(std::vector<IntervalSample>& out) {
+        std::lock_guard<std::mutex> lock(mailboxMutex);
+        for (auto& sample : mailbox) out.push_back(std::move(sample));
+        mailbox.clear();
+    }
+
+    void recycle(HdrHistogram&& histogram) {
+        histogram.reset();
+        std::lock_guard<std::mutex> lock(mailboxMutex);
+        spare.push_back(std::move(histogram));
+    }
+
+private:
+    static constexpr uint64_t kSweepIntervalNs = 10ULL * 1000000ULL;
+    static constexpr uint64_t kRetryBackoffNs = 10ULL * 1000000ULL;
+    static constexpr uint64_t kLateSendNs = 1000000ULL;
+
+    uint64_t nextSendTime() const { return nextArrival; }
+
+    void advanceSchedule() {
+        uint64_t offset = schedule->next();
+        nextArrival = offset == UINT64_MAX ? UINT64_MAX : scheduleStart + offset;
+    }
+
+    uint32_t pickRoute() {
+        if (mix.requests.size() == 1) return 0;
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        uint64_t ticket = rng % mix.cumulativeWeights.back();
+        return static_cast<uint32_t>(std::upper_bound(mix.cumulativeWeights.begin(), mix.cumulativeWeights.end(), ticket) -
+                                     mix.cumulativeWeights.begin());
+    }
+
+    void publishProgress() {
+        published.completed.store(stats.completed, std::memory_order_relaxed);
+        published.errors.store(stats.errorCount(), std::memory_order_relaxed);
+        published.bytesRead.store(stats.bytesRead, std::memory_order_relaxed);
+        published.connectionsOpened.store(stats.connectionsOpened, std::memory_order_relaxed);
+    }
+
+    // Hands the current interval to the mailbox and continues with a recycled
+    // histogram, so steady-state recording does not allocate.
+    void closeInterval() {
+        stats.latency.merge(intervalLatency);
+
+        IntervalSample sample;
+        sample.index = intervalIndex++;
+        sample.completed = stats.completed - intervalBase.completed;
+        sample.errors = stats.errorCount() - intervalBase.errors;
+        sample.bytesRead = stats.bytesRead - intervalBase.bytesRead;
+        intervalBase.completed = stats.completed;
+        intervalBase.errors = stats.errorCount();
+        intervalBase.bytesRead = stats.bytesRead;
+
+        std::lock_guard<std::mutex> lock(mailboxMutex);
+        if (!spare.empty()) {
+            sample.latency = std::move(spare.back());
+            spare.pop_back();
+        }
+        std::swap(sample.latency, intervalLatency);
+        mailbox.push_back(std::move(sample));
+    }
+
+    bool pacedReconnects() const { return transport.mode.closeEach && schedule; }
+
+    void openConnection(Connection& conn, uint64_t now) {
+        int fd = socket(address.ss_family, SOCK_STREAM, 0);
+        if (fd < 0) {
+            stats.connectErrors++;
+            conn.retryAt = now + kRetryBackoffNs;
+            return;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#if defined(SO_NOSIGPIPE)
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        if (transport.mode.closeEach) {
+            // Reset rather than FIN on close, so thousands of connections a second do
+            // not pile up in TIME_WAIT and exhaust the ephemeral ports.
+            linger abort{1, 0};
+            setsockopt(fd, SOL_SOCKET, SO_LINGER, &abort, sizeof(abort));
+        }
+
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&address), addressLen) != 0 && errno != EINPROGRESS) {
+            close(fd);
+            stats.connectErrors++;
+            conn.retryAt = now + kRetryBackoffNs;
+            return;
+        }
+
+        conn.fd = fd;
+        conn.state = Connection::State::Connecting;
+        conn.requestStart = now;
+        conn.connectStart = now;
+        if (!poller.add(fd, &conn)) {
+            closeConnection(conn, true);
+            stats.connectErrors++;
+        }
+    }
+
+    void closeConnection(Connection& conn, bool backoff) {
+        if (conn.ssl) {
+            // close_notify first: OpenSSL will not resume a session whose connection
+            // was dropped without one.
+            SSL_shutdown(conn.ssl);
+            ERR_clear_error();
+            flushTls(conn);
+            SSL_SESSION* session = SSL_get1_session(conn.ssl);
+            if (session && transport.resume && SSL_SESSION_is_resumable(session)) {
+                if (conn.session) SSL_SESSION_free(conn.session);
+                conn.session = session;
+            } else if (session) {
+                SSL_SESSION_free(session);
+            }
+            SSL_free(conn.ssl);
+            conn.ssl = nullptr;
+            conn.tlsIn = nullptr;
+            conn.tlsOut = nullptr;
+            conn.cipherOut.clear();
+            conn.cipherSent = 0;
+        }
+        conn.h2.reset();
+        if (conn.fd >= 0) close(conn.fd);
+        conn.fd = -1;
+        conn.state = Connection::State::Closed;
+        if (pacedReconnects()) {
+            returnLane(conn);
+        } else if (backoff) {
+            conn.retryAt = nowNs() + kRetryBackoffNs;
+        } else {
+            conn.retryAt = 0;
+            reconnectQueue.push_back(&conn);
+        }
+    }
+
+    void markIdle(Connection& conn) {
+        conn.state = Connection::State::Idle;
+        queueIdle(conn);
+    }
+
+    void queueIdle(Connection& conn) {
+        if (conn.queuedIdle) return;
+        conn.queuedIdle = true;
+        conn.idleSince = nowNs();
+        idle.push_back(&conn);
+    }
+
+    // A closed connection waiting for its next paced request (new connection per request).
+    void returnLane(Connection& conn) { queueIdle(conn); }
+
+    // An HTTP/2 connection is idle while it has a free stream.
+    void queueStreams(Connection& conn) {
+        if (conn.h2->canStart()) queueIdle(conn);
+    }
+
+    // Releases every request whose scheduled time has passed onto an idle connection.
+    // Requests that are due while all connections are busy stay queued and keep their
+    // original intended start time.
+    void dispatchScheduled(uint64_t now) {
+        uint64_t late = 0;
+        while (!idle.empty() && nextSendTime() <= now) {
+            Connection* conn = idle.back();
+            idle.pop_back();
+            conn->queuedIdle = false;
+            if (pacedReconnects()) {
+                if (conn->state != Connection::State::Closed) continue;
+                conn->pendingStart = nextSendTime();
+                noteSendLag(*conn, conn->pendingStart, now, late);
+                advanceSchedule();
+                openConnection(*conn, now);
+                if (conn->fd < 0) returnLane(*conn);  // counted as a connect error
+                continue;
+            }
+            if (conn->h2) {
+                if (conn->fd < 0 || !conn->h2->canStart()) continue;
+                uint64_t intended = nextSendTime();
+                noteSendLag(*conn, intended, now, late);
+                advanceSchedule();
+                conn->h2->startRequest(pickRoute(), intended);
+                // Its other free streams have been free all along.
+                uint64_t freeSince = conn->idleSince;
+                queueStreams(*conn);
+                conn->idleSince = freeSince;
+                flushStreams(*conn);
+                continue;
+            }
+            if (conn->fd < 0 || conn->state != Connection::State::Idle) continue;
+            uint64_t intended = nextSendTime();
+            noteSendLag(*conn, intended, now, late);
+            advanceSchedule();
+            startRequest(*conn, intended);
+        }
+        stats.backlogPeak = std::max(stats.backlogPeak, late);
+    }
+
+    // A request whose connection was free by its due time can only go out late
+    // because this loop was busy or descheduled: the client's own lag.
+    void noteSendLag(const Connection& conn, uint64_t intended, uint64_t now, uint64_t& late) {
+        if (conn.idleSince > intended) return;
+        uint64_t lagNs = now > intended ? now - intended : 0;
+        stats.pacedSends++;
+        stats.sendLag.record(static_cast<int64_t>(lagNs / 1000ULL));
+        if (lagNs > kLateSendNs) {
+            stats.lateSends++;
+            late++;
+        }
+    }
+
+    void startRequest(Connection& conn, uint64_t start) {
+        conn.state = Connection::State::Writing;
+        conn.written = 0;
+        conn.requestStart = start;
+        conn.sendStart = nowNs();
+        conn.writtenAt = 0;
+        conn.firstByteAt = 0;
+        conn.responseBytes = 0;
+        conn.route = pickRoute();
+        conn.parser.reset();
+        onWritable(conn);
+    }
+
+    // The connection can carry requests: TCP is up and, with TLS, the handshake is done.
+    void connectionReady(Connection& conn) {
+        uint64_t now = nowNs();
+        uint64_t setupUs = (now - conn.connectStart) / 1000ULL;
+        stats.connectionsOpened++;
+        stats.setupSumUs += setupUs;
+        stats.setupLatency.record(static_cast<int64_t>(setupUs));
+
+        if (transport.mode.h2) {
+            // Streams start once the server's SETTINGS arrive (see readStreams).
+            conn.h2 = std::make_unique<H2Session>(*transport.h2Requests, transport.h2Streams);
+            conn.state = Connection::State::Streaming;
+            flushStreams(conn);
+            if (conn.fd >= 0) readStreams(conn);
+            return;
+        }
+        if (transport.mode.closeEach) {
+            // The request's latency includes the connection setup it had to wait for.
+            startRequest(conn, schedule ? conn.pendingStart : conn.connectStart);
+        } else if (schedule) {
+            markIdle(conn);
+        } else {
+            startRequest(conn, now);
+        }
+        // TLS may have buffered bytes past the handshake that no new event will report.
+        if (conn.ssl && conn.fd >= 0) onReadable(conn);
+    }
+
+    void startTls(Connection& conn) {
+        conn.ssl = SSL_new(transport.tls);
+        conn.tlsIn = BIO_new(BIO_s_mem());
+        conn.tlsOut = BIO_new(BIO_s_mem());
+        if (conn.ssl == nullptr || conn.tlsIn == nullptr || conn.tlsOut == nullptr) {
+            if (conn.ssl == nullptr) {
+                BIO_free(conn.tlsIn);
+                BIO_free(conn.tlsOut);
+            }
+            stats.connectErrors++;
+            closeConnection(conn, true);
+            return;
+        }
+        SSL_set_bio(conn.ssl, conn.tlsIn, conn.tlsOut);
+        SSL_set_connect_state(conn.ssl);
+        SSL_set_tlsext_host_name(conn.ssl, transport.serverName.c_str());
+        if (transport.resume && conn.session) SSL_set_session(conn.ssl, conn.session);
+        conn.state = Connection::State::Handshaking;
+        continueHandshake(conn);
+    }
+
+    void continueHandshake(Connection& conn) {
+        for (;;) {
+            int rc = SSL_do_handshake(conn.ssl);
+            if (!flushTls(conn)) {
+                stats.connectErrors++;
+                closeConnection(conn, true);
+                return;
+            }
+            if (rc == 1) break;
+            if (SSL_get_error(conn.ssl, rc) != SSL_ERROR_WANT_READ) {
+                ERR_clear_error();
+                stats.connectErrors++;
+                closeConnection(conn, true);
+                return;
+            }
+            ssize_t n = recv(conn.fd, cipherBuffer.data(), cipherBuffer.size(), 0);
+            if (n > 0) {
+                BIO_write(conn.tlsIn, cipherBuffer.data(), static_cast<int>(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            stats.connectErrors++;
+            closeConnection(conn, true);
+            return;
+        }
+
+        stats.tlsHandshakes++;
+        if (SSL_session_reused(conn.ssl)) stats.tlsResumed++;
+        if (transport.mode.h2) {
+            const unsigned char* protocol = nullptr;
+            unsigned int length = 0;
+            SSL_get0_alpn_selected(conn.ssl, &protocol, &length);
+            if (length != 2 || std::memcmp(protocol, "h2", 2) != 0) {
+                stats.connectErrors++;  // the server did not negotiate HTTP/2
+                closeConnection(conn, true);
+                return;
+            }
+        }
+        connectionReady(conn);
+    }
+
+    // Sends ciphertext the TLS engine has produced; false on a socket error.
+    bool flushTls(Connection& conn) {
+        for (;;) {
+            if (conn.cipherSent == conn.cipherOut.size()) {
+                conn.cipherOut.clear();
+                conn.cipherSent = 0;
+                size_t pending = BIO_ctrl_pending(conn.tlsOut);
+                if (pending == 0) return true;
+                conn.cipherOut.resize(pending);
+                BIO_read(conn.tlsOut, &conn.cipherOut[0], static_cast<int>(pending));
+            }
+            ssize_t n = sendRaw(conn.fd, conn.cipherOut.data() + conn.cipherSent, conn.cipherOut.size() - conn.cipherSent);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+                if (errno == EINTR) continue;
+                return false;
+            }
+            conn.cipherSent += static_cast<size_t>(n);
+        }
+    }
+
+    static ssize_t sendRaw(int fd, const char* data, size_t len) {
+#if defined(MSG_NOSIGNAL)
+        return send(fd, data, len, MSG_NOSIGNAL);
+#else
+        return send(fd, data, len, 0);
+#endif
+    }
+
+    // send()/recv() semantics over the connection, TLS or not. TLS writes are
+    // always taken whole; ciphertext that does not fit the socket waits in cipherOut.
+    ssize_t sendBytes(Connection& conn, const char* data, size_t len) {
+        if (!conn.ssl) return sendRaw(conn.fd, data, len);
+        int n = SSL_write(conn.ssl, data, static_cast<int>(len));
+        if (n <= 0) {
+            ERR_clear_error();
+            errno = EPROTO;
+            return -1;
+        }
+        if (!flushTls(conn)) return -1;
+        return n;
+    }
+
+    ssize_t recvBytes(Connection& conn, char* data, size_t len) {
+        if (!conn.ssl) return recv(conn.fd, data, len, 0);
+        for (;;) {
+            int n = SSL_read(conn.ssl, data, static_cast<int>(len));
+            if (n > 0) return n;
+            int error = SSL_get_error(conn.ssl, n);
+            if (error == SSL_ERROR_ZERO_RETURN) return 0;
+            if (error != SSL_ERROR_WANT_READ) {
+                ERR_clear_error();
+                errno = EPROTO;
+                return -1;
+            }
+            ssize_t raw = recv(conn.fd, cipherBuffer.data(), cipherBuffer.size(), 0);
+            if (raw <= 0) return raw;
+            BIO_write(conn.tlsIn, cipherBuffer.data(), static_cast<int>(raw));
+        }
+    }
+
+    void onWritable(Connection& conn) {
+        if (conn.state == Connection::State::Connecting) {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            if (getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &error, &len) != 0 || error != 0) {
+                stats.connectErrors++;
+                closeConnection(conn, true);
+                return;
+            }
+            if (transport.mode.tls) {
+                startTls(conn);
+            } else {
+                connectionReady(conn);
+            }
+            return;
+        }
+        if (conn.state == Connection::State::Handshaking) {
+            continueHandshake(conn);
+            return;
+        }
+        if (conn.ssl && !flushTls(conn)) {
+            stats.writeErrors++;
+            closeConnection(conn, false);
+            return;
+        }
+        if (conn.h2) {
+            flushStreams(conn);
+            return;
+        }
+
+        const std::string& request = mix.requests[conn.route];
+        while (conn.state == Connection::State::Writing) {
+            ssize_t n = sendBytes(conn, request.data() + conn.written, request.size() - conn.written);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+                if (errno == EINTR) continue;
+                stats.writeErrors++;
+                closeConnection(conn, false);
+                return;
+            }
+            conn.written += static_cast<size_t>(n);
+            if (conn.written == request.size()) {
+                conn.state = Connection::State::Reading;
+                conn.writtenAt = nowNs();
+            }
+        }
+    }
+
+    void onReadable(Connection& conn) {
+        if (conn.state == Connection::State::Handshaking) {
+            continueHandshake(conn);
+            return;
+        }
+        if (conn.h2) {
+            readStreams(conn);
+            return;
+        }
+        while (conn.fd >= 0) {
+            ssize_t n = recvBytes(conn, readBuffer.data(), readBuffer.size());
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+                if (errno == EINTR) continue;
+                stats.readErrors++;
+                closeConnection(conn, true);
+                return;
+            }
+
+            if (n == 0) {
+                if (conn.state == Connection::State::Reading &&
+                    conn.parser.finishOnClose() == ResponseParser::Status::Complete) {
+                    completeRequest(conn, nowNs());
+                } else if (conn.state == Connection::State::Reading || conn.state == Connection::State::Writing) {
+                    stats.readErrors++;
+                }
+                closeConnection(conn, false);
+                return;
+            }
+
+            stats.bytesRead += static_cast<uint64_t>(n);
+            if (conn.state != Connection::State::Reading) continue;
+            if (conn.firstByteAt == 0) conn.firstByteAt = nowNs();
+            conn.responseBytes += static_cast<uint64_t>(n);
+
+            auto status = conn.parser.feed(readBuffer.data(), static_cast<size_t>(n));
+            if (status == ResponseParser::Status::Error) {
+                stats.readErrors++;
+                closeConnection(conn, false);
+                return;
+            }
+            if (status == ResponseParser::Status::Complete) {
+                uint64_t now = nowNs();
+                completeRequest(conn, now);
+                if (!conn.parser.reusable() || transport.mode.closeEach) {
+                    closeConnection(conn, false);
+                    return;
+                }
+                if (schedule) {
+                    markIdle(conn);
+                    return;
+                }
+                if (now >= deadline) return;
+                startRequest(conn, now);
+            }
+        }
+    }
+
+    void flushStreams(Connection& conn) {
+        H2Session& session = *conn.h2;
+        while (session.pendingSize() > 0) {
+            ssize_t n = sendBytes(conn, session.pending(), session.pendingSize());
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+                if (errno == EINTR) continue;
+                stats.writeErrors++;
+                closeConnection(conn, false);
+                return;
+            }
+            session.consume(static_cast<size_t>(n));
+        }
+    }
+
+    // Reads until the socket is drained, recording each stream as it finishes, then
+    // refills free streams (closed loop) or offers them to the schedule.
+    void readStreams(Connection& conn) {
+        while (conn.fd >= 0) {
+            ssize_t n = recvBytes(conn, readBuffer.data(), readBuffer.size());
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                if (errno == EINTR) continue;
+                stats.readErrors += std::max<uint64_t>(conn.h2->activeStreams(), 1);
+                closeConnection(conn, true);
+                return;
+            }
+            if (n == 0) {
+                stats.readErrors += conn.h2->activeStreams();
+                closeConnection(conn, false);
+                return;
+            }
+            stats.bytesRead += static_cast<uint64_t>(n);
+            streamDone.clear();
+            if (!conn.h2->feed(readBuffer.data(), static_cast<size_t>(n), streamDone)) {
+                stats.readErrors += std::max<uint64_t>(conn.h2->activeStreams(), 1);
+                closeConnection(conn, false);
+                return;
+            }
+            if (!streamDone.empty()) finishStreams(nowNs());
+        }
+        if (conn.fd < 0) return;
+        refillStreams(conn);
+    }
+
+    void refillStreams(Connection& conn) {
+        H2Session& session = *conn.h2;
+        if (session.goingAway() && session.activeStreams() == 0) {
+            closeConnection(conn, false);
+            return;
+        }
+        if (schedule) {
+            queueStreams(conn);
+        } else {
+            uint64_t now = nowNs();
+            while (now < deadline && session.canStart()) session.startRequest(pickRoute(), now);
+        }
+        flushStreams(conn);
+    }
+
+    void finishStreams(uint64_t now) {
+        for (const H2Response& response : streamDone) {
+            if (response.reset) {
+                stats.readErrors++;
+                if (!stats.routes.empty()) stats.routes[response.route].errors++;
+                archiveSample(response.route, response.requestStart, 0, response.bytes, kSampleReset, now);
+                continue;
+            }
+            recordResponse(response.route, response.requestStart, response.status, now);
+            archiveSample(response.route, response.requestStart, response.status, response.bytes, 0, now);
+        }
+    }
+
+    void completeRequest(Connection& conn, uint64_t now) {
+        recordResponse(conn.route, conn.requestStart, conn.parser.status(), now);
+        archiveSample(conn.route, conn.requestStart, conn.parser.status(), conn.responseBytes, 0, now);
+        if (conn.writtenAt > 0 && conn.firstByteAt >= conn.writtenAt) {
+            stats.waitPhase.record(conn.sendStart > conn.requestStart ? conn.sendStart - conn.requestStart : 0);
+            stats.writePhase.record(conn.writtenAt - conn.sendStart);
+            stats.firstBytePhase.record(conn.firstByteAt - conn.writtenAt);
+            stats.transferPhase.record(now - conn.firstByteAt);
+        }
+        conn.state = Connection::State::Idle;
+    }
+
+    void recordResponse(uint32_t routeIndex, uint64_t requestStart, int status, uint64_t now) {
+        stats.completed++;
+        if (status < 200 || status > 399) stats.non2xx++;
+        uint64_t latencyUs = (now - requestStart) / 1000ULL;
+        intervalLatency.record(static_cast<int64_t>(latencyUs));
+        stats.latencySumUs += latencyUs;
+        if (!stats.routes.empty()) {
+            RouteStats& route = stats.routes[routeIndex];
+            route.completed++;
+            if (status < 200 || status > 399) route.errors++;
+            route.latency.record(static_cast<int64_t>(latencyUs));
+            route.latencySumUs += latencyUs;
+        }
+    }
+
+    void archiveSample(uint32_t route, uint64_t requestStart, int status, uint64_t bytes, uint16_t flags, uint64_t now) {
+        if (!archive) return;
+        SampleRecord record;
+        record.completedNs = now > scheduleStart ? now - scheduleStart : 0;
+        record.latencyUs = static_cast<uint32_t>(std::min<uint64_t>(now > requestStart ? (now - requestStart) / 1000ULL : 0,
+                                                                    UINT32_MAX));
+        record.bytes = static_cast<uint32_t>(std::min<uint64_t>(bytes, UINT32_MAX));
+        record.status = static_cast<uint16_t>(status);
+        record.route = static_cast<uint16_t>(route);
+        record.worker = workerIndex;
+        record.flags = flags;
+        samples.push_back(record);
+        if (samples.size() >= SampleArchiveWriter::kBlockRecords) {
+            archive->submit(std::move(samples));
+            samples = archive->takeBlock();
+        }
+    }
+
+    void sweep(uint64_t now) {
+        for (auto& conn : connections) {
+            if (conn.state == Connection::State::Closed) {
+                if (conn.fd < 0 && now >= conn.retryAt && !pacedReconnects()) openConnection(conn, now);
+                continue;
+            }
+            if (conn.state == Connection::State::Idle) continue;
+            if (conn.state == Connection::State::Streaming) {
+                // Overdue streams are reset one by one; the connection stays up.
+                streamDone.clear();
+                conn.h2->expire(now > timeoutNs ? now - timeoutNs : 0, streamDone);
+                if (streamDone.empty()) continue;
+                stats.timeouts += streamDone.size();
+                for (const H2Response& response : streamDone) {
+                    if (!stats.routes.empty()) stats.routes[response.route].errors++;
+                    archiveSample(response.route, response.requestStart, 0, response.bytes, kSampleTimeout, now);
+                }
+                refillStreams(conn);
+                continue;
+            }
+            if (now > conn.requestStart && now - conn.requestStart > timeoutNs) {
+                stats.timeouts++;
+                bool requestSent = conn.state == Connection::State::Writing || conn.state == Connection::State::Reading;
+                if (!stats.routes.empty() && requestSent) stats.routes[conn.route].errors++;
+                if (requestSent) archiveSample(conn.route, conn.requestStart, 0, conn.responseBytes, kSampleTimeout, now);
+                closeConnection(conn, false);
+            }
+        }
+    }
+
+    Poller poller;
+    sockaddr_storage address;
+    socklen_t addressLen;
+    const RequestMix& mix;
+    const WorkerTransport& transport;
+    uint64_t rng;
+    std::vector<Connection> connections;
+    std::vector<Connection*> reconnectQueue;
+    std::vector<Connection*> idle;
+    uint64_t timeoutNs;
+    std::unique_ptr<ArrivalSchedule> schedule;  // null = closed loop
+    uint64_t scheduleStart = 0;
+    uint64_t deadline = 0;
+    uint64_t nextArrival = 0;
+    std::array<char, 65536> readBuffer{};
+    std::array<char, 65536> cipherBuffer{};
+    std::vector<H2Response> streamDone;
+    WorkerStats stats;
+    PublishedCounters published;
+
+    HdrHistogram intervalLatency;
+    uint64_t bucketNs = 0;
+    uint64_t nextBoundary = UINT64_MAX;
+    int intervalIndex = 0;
+    IntervalSample intervalBase;  // run totals at the start of the current interval
+    std::mutex mailboxMutex;
+    std::vector<IntervalSample> mailbox;
+    std::vector<HdrHistogram> spare;
+
+    SampleArchiveWriter* archive = nullptr;
+    uint16_t workerIndex = 0;
+    std::vector<SampleRecord> samples;
+};
+
+}  // namespace
+
+LoadGenerator::LoadGenerator(const BenchmarkConfig& config, const LoadTarget& target)
+    : config(config), target(target) {}
+
+void LoadGenerator::setTimelineCallback(std::function<void(const TimelineBucket&)> callback, int intervalMs) {
+    timelineCallback = std::move(callback);
+    timelineIntervalMs = std::max(intervalMs, 1);
+}
+
+void LoadGenerator::setProgressCallback(std::function<void(const LoadProgress&)> callback, int intervalMs) {
+    progressCallback = std::move(callback);
+    progressIntervalMs = std::max(intervalMs, 1);
+}
+
+BenchmarkResult LoadGenerator::run() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* resolved = nullptr;
+    std::string port = std::to_string(target.port);
+    int rc = getaddrinfo(target.host.c_str(), port.c_str(), &hints, &resolved);
+    if (rc != 0 || resolved == nullptr) {
+        throw std::runtime_error("Failed to resolve " + target.host + ": " + gai_strerror(rc));
+    }
+
+    // The servers bind 0.0.0.0, so prefer IPv4 when "localhost" also resolves to ::1.
+    const addrinfo* chosen = resolved;
+    for (const addrinfo* ai = resolved; ai != nullptr; ai = ai->ai_next) {
+        if (ai->ai_family == AF_INET) {
+            chosen = ai;
+            break;
+        }
+    }
+    sockaddr_storage address{};
+    std::memcpy(&address, chosen->ai_addr, chosen->ai_addrlen);
+    socklen_t addressLen = chosen->ai_addrlen;
+    freeaddrinfo(resolved);
+
+    std::vector<ScenarioRoute> routes = target.routes;
+    if (routes.empty()) {
+        ScenarioRoute single;
+        single.path = target.path;
+        routes.push_back(single);
+    }
+    TransportMode mode = parseTransport(config.transport);
+    RequestMix mix;
+    std::vector<H2Request> h2Requests;
+    uint64_t weightTotal = 0;
+    for (const auto& route : routes) {
+        if (mode.h2) {
+            h2Requests.push_back(makeH2Request(route.method, route.path, target.host + ":" + port,
+                                               route.bodyBytes > 0 ? makeJsonBody(route.bodyBytes) : ""));
+        }
+        std::string request = route.method + " " + route.path + " HTTP/1.1\r\n"
+                              "Host: " + target.host + ":" + port + "\r\n"
+                              "User-Agent: benchmark_wrk\r\n"
+                              "Accept: */*\r\n";
+        if (mode.closeEach) request += "Connection: close\r\n";
+        if (route.bodyBytes > 0) {
+            request += "Content-Type: application/json\r\n"
+                       "Content-Length: " + std::to_string(route.bodyBytes) + "\r\n\r\n" +
+                       makeJsonBody(route.bodyBytes);
+        } else {
+            request += "\r\n";
+        }
+        mix.requests.push_back(std::move(request));
+        weightTotal += static_cast<uint64_t>(std::max(route.weight, 1));
+        mix.cumulativeWeights.push_back(weightTotal);
+    }
+
+    std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> tls(nullptr, SSL_CTX_free);
+    WorkerTransport transport;
+    transport.mode = mode;
+    transport.resume = config.tlsSessionResumption;
+    transport.serverName = target.host;
+    transport.h2Requests = &h2Requests;
+    transport.h2Streams = std::max(config.h2Streams, 1);
+    if (mode.tls) {
+        // The servers use a throwaway self-signed certificate, so nothing is verified.
+        tls.reset(SSL_CTX_new(TLS_client_method()));
+        if (!tls) throw std::runtime_error("Failed to create a TLS context");
+        SSL_CTX_set_verify(tls.get(), SSL_VERIFY_NONE, nullptr);
+        static const unsigned char h2Alpn[] = "\x02h2";
+        static const unsigned char http1Alpn[] = "\x08http/1.1";
+        if (mode.h2) {
+            SSL_CTX_set_alpn_protos(tls.get(), h2Alpn, sizeof(h2Alpn) - 1);
+        } else {
+            SSL_CTX_set_alpn_protos(tls.get(), http1Alpn, sizeof(http1Alpn) - 1);
+        }
+        transport.tls = tls.get();
+    }
+
+    int connections = std::max(config.connections, 1);
+    int threadCount = std::max(1, std::min(config.threads, connections));
+    uint64_t durationNs = static_cast<uint64_t>(parseDurationMs(config.duration)) * 1000000ULL;
+    uint64_t timeoutNs = static_cast<uint64_t>(parseDurationMs(config.timeout)) * 1000000ULL;
+
+    std::vector<RateSegment> profile;
+    bool poisson = isPoissonArrival(config.arrivalProcess);
+    if (config.rate > 0) {
+        profile = buildRateProfile(config.rateProfile, config.rate, durationNs / 1e9);
+    } else if (!config.rateProfile.empty()) {
+        throw std::runtime_error("rateProfile needs a target rate");
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < threadCount; i++) {
+        int share = connections / threadCount + (i < connections % threadCount ? 1 : 0);
+        // Each thread paces its share of the target rate in proportion to its connections
+        // (for h2, each connection carries up to h2Streams of those requests at once).
+        uint64_t seed = 0x9E3779B97F4A7C15ULL * static_cast<uint64_t>(i + 1);
+        std::unique_ptr<ArrivalSchedule> schedule;
+        if (config.rate > 0) {
+            uint64_t arrivalSeed = (static_cast<uint64_t>(config.arrivalSeed) << 32) ^ seed;
+            schedule = std::make_unique<ArrivalSchedule>(profile, static_cast<double>(share) / connections, poisson,
+                                                         arrivalSeed);
+        }
+        workers.push_back(std::make_unique<Worker>(address, addressLen, mix, transport, seed, share, timeoutNs,
+                                                   std::move(schedule)));
+    }
+    // Progress callbacks get latency from the intervals, so ship them even without a timeline.
+    uint64_t bucketNs = timelineCallback  ? static_cast<uint64_t>(timelineIntervalMs) * 1000000ULL
+                        : progressCallback ? static_cast<uint64_t>(progressIntervalMs) * 1000000ULL
+                                           : 0;
+    for (auto& worker : workers) {
+        worker->setTimelineInterval(bucketNs);
+    }
+    std::unique_ptr<SampleArchiveWriter> archive;
+    if (!archivePath.empty()) {
+        SampleArchiveInfo info;
+        info.label = archiveLabel;
+        for (const auto& route : routes) info.routes.push_back(route.name);
+        info.durationSec = durationNs / 1e9;
+        info.rate = config.rate;
+        info.connections = connections;
+        archive = std::make_unique<SampleArchiveWriter>(archivePath, info);
+        for (size_t i = 0; i < workers.size(); i++) workers[i]->setArchive(archive.get(), static_cast<uint16_t>(i));
+    }
+
+    if (startAtNs > nowNs()) {
+        uint64_t waitNs = startAtNs - nowNs();
+        std::this_thread::sleep_for(std::chrono::nanoseconds(waitNs));
+        while (nowNs() < startAtNs) {
+        }
+    }
+
+    uint64_t start = nowNs();
+    uint64_t deadline = start + durationNs;
+    if (archive) {
+        archive->recordStart(start, std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+    std::vector<std::thread> threads;
+    for (auto& worker : workers) {
+        threads.emplace_back([this, &worker, start, deadline]() { worker->run(start, deadline, stopRequested); });
+    }
+
+    // Buckets are emitted once every worker has handed in its share, so a worker that
+    // is late to a boundary delays the write rather than splitting the bucket.
+    std::map<int, IntervalSample> pending;
+    std::vector<int> contributors;
+    std::vector<IntervalSample> drained;
+    HdrHistogram liveLatency, recentLatency;
+    auto emitBucket = [&](const IntervalSample& merged) {
+        if (progressCallback) {
+            liveLatency.merge(merged.latency);
+            recentLatency = merged.latency;
+        }
+        if (!timelineCallback) return;
+        TimelineBucket bucket;
+        bucket.index = merged.index;
+        bucket.startSec = static_cast<double>(merged.index) * bucketNs / 1e9;
+        bucket.endSec = std::min(static_cast<double>(merged.index + 1) * bucketNs, static_cast<double>(durationNs)) / 1e9;
+        bucket.monotonicStartSec = start / 1e9 + bucket.startSec;
+        bucket.completed = merged.completed;
+        bucket.errors = merged.errors;
+        bucket.bytesRead = merged.bytesRead;
+        bucket.latency = &merged.latency;
+        timelineCallback(bucket);
+    };
+    auto drainTimeline = [&](bool final) {
+        for (auto& worker : workers) {
+            drained.clear();
+            worker->takeIntervals(drained);
+            for (auto& sample : drained) {
+                IntervalSample& merged = pending[sample.index];
+                merged.index = sample.index;
+                merged.completed += sample.completed;
+                merged.errors += sample.errors;
+                merged.bytesRead += sample.bytesRead;
+                merged.latency.merge(sample.latency);
+                if (static_cast<size_t>(sample.index) >= contributors.size()) contributors.resize(sample.index + 1, 0);
+                contributors[sample.index]++;
+                worker->recycle(std::move(sample.latency));
+            }
+        }
+        while (!pending.empty()) {
+            auto it = pending.begin();
+            if (!final && contributors[it->first] < static_cast<int>(workers.size())) break;
+            emitBucket(it->second);
+            pending.erase(it);
+        }
+    };
+
+    {
+        uint64_t progressNs = static_cast<uint64_t>(progressIntervalMs) * 1000000ULL;
+        // Progress waits out the same grace as the drain, so it sees the interval that just closed.
+        uint64_t progressGraceNs = bucketNs > 0 ? kTimelineGraceNs : 0;
+        uint64_t nextProgress = progressCallback ? start + progressNs + progressGraceNs : UINT64_MAX;
+        uint64_t nextDrain = bucketNs > 0 ? start + bucketNs + kTimelineGraceNs : UINT64_MAX;
+        for (;;) {
+            if (interruptSignal() != 0) stop();
+            if (stopRequested.load(std::memory_order_relaxed)) break;
+            uint64_t wakeAt = std::min(nextProgress, nextDrain);
+            uint64_t now = nowNs();
+            if (wakeAt > deadline + kTimelineGraceNs) {
+                // Nothing left to emit; wait out the workers, still watching for Ctrl-C.
+                if (now >= deadline) break;
+                std::this_thread::sleep_for(std::chrono::nanoseconds(std::min(deadline - now, kInterruptPollNs)));
+                continue;
+            }
+            if (wakeAt > now + kInterruptPollNs) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(kInterruptPollNs));
+                continue;
+            }
+            std::this_thread::sleep_for(std::chrono::nanoseconds(wakeAt - std::min(wakeAt, now)));
+
+            if (wakeAt == nextDrain) {
+                drainTimeline(false);
+                nextDrain += bucketNs;
+            }
+            if (wakeAt == nextProgress) {
+                LoadProgress progress;
+                progress.elapsedSec = static_cast<double>(nextProgress - progressGraceNs - start) / 1e9;
+                for (const auto& worker : workers) {
+                    worker->addProgress(progress);
+                }
+                progress.latency = &liveLatency;
+                progress.recentLatency = &recentLatency;
+                progressCallback(progress);
+                nextProgress += progressNs;
+            }
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (bucketNs > 0) drainTimeline(true);
+    uint64_t finished = stopRequested.load(std::memory_order_relaxed) ? nowNs() : std::max(nowNs(), deadline);
+    double elapsedSec = static_cast<double>(finished - start) / 1e9;
+
+    WorkerStats total;
+    double busiest = 0.0;
+    total.routes.resize(mix.requests.size() > 1 ? mix.requests.size() : 0);
+    for (const auto& worker : workers) {
+        const auto& stats = worker->result();
+        total.completed += stats.completed;
+        total.non2xx += stats.non2xx;
+        total.connectErrors += stats.connectErrors;
+        total.readErrors += stats.readErrors;
+        total.writeErrors += stats.writeErrors;
+        total.timeouts += stats.timeouts;
+        total.bytesRead += stats.bytesRead;
+        total.latency.merge(stats.latency);
+        total.latencySumUs += stats.latencySumUs;
+        total.connectionsOpened += stats.connectionsOpened;
+        total.tlsHandshakes += stats.tlsHandshakes;
+        total.tlsResumed += stats.tlsResumed;
+        total.setupSumUs += stats.setupSumUs;
+        total.setupLatency.merge(stats.setupLatency);
+        total.waitPhase.merge(stats.waitPhase);
+        total.writePhase.merge(stats.writePhase);
+        total.firstBytePhase.merge(stats.firstBytePhase);
+        total.transferPhase.merge(stats.transferPhase);
+        total.cpuNs += stats.cpuNs;
+        total.pacedSends += stats.pacedSends;
+        total.lateSends += stats.lateSends;
+        total.backlogPeak = std::max(total.backlogPeak, stats.backlogPeak);
+        total.sendLag.merge(stats.sendLag);
+        if (stats.wallNs > 0) busiest = std::max(busiest, static_cast<double>(stats.cpuNs) / stats.wallNs);
+        for (size_t r = 0; r < stats.routes.size(); r++) {
+            total.routes[r].completed += stats.routes[r].completed;
+            total.routes[r].errors += stats.routes[r].errors;
+            total.routes[r].latencySumUs += stats.routes[r].latencySumUs;
+            total.routes[r].latency.merge(stats.routes[r].latency);
+        }
+    }
+
+    BenchmarkResult result;
+    result.requestsPerSecond = total.completed / elapsedSec;
+    result.throughput = total.bytesRead / elapsedSec;
+    result.totalRequests = static_cast<int>(total.completed);
+    if (total.latency.totalCount() > 0) {
+        result.avgLatency = static_cast<double>(total.latencySumUs) / total.latency.totalCount() / 1000.0;
+    }
+    result.maxLatency = total.latency.max() / 1000.0;
+    result.p50Latency = total.latency.valueAtPercentile(50) / 1000.0;
+    result.p75Latency = total.latency.valueAtPercentile(75) / 1000.0;
+    result.p90Latency = total.latency.valueAtPercentile(90) / 1000.0;
+    result.p99Latency = total.latency.valueAtPercentile(99) / 1000.0;
+    result.p999Latency = total.latency.valueAtPercentile(99.9) / 1000.0;
+    result.p9999Latency = total.latency.valueAtPercentile(99.99) / 1000.0;
+    result.latencyHistogram = std::move(total.latency);
+    result.socketErrors = static_cast<int>(total.connectErrors + total.readErrors + total.writeErrors);
+    result.timeouts = static_cast<int>(total.timeouts);
+    result.errors = result.socketErrors + result.timeouts + static_cast<int>(total.non2xx);
+    ConnectionStats& setup = result.connectionSetup;
+    setup.valid = total.connectionsOpened > 0;
+    setup.opened = static_cast<int>(total.connectionsOpened);
+    setup.tlsHandshakes = static_cast<int>(total.tlsHandshakes);
+    setup.tlsResumed = static_cast<int>(total.tlsResumed);
+    if (setup.valid) setup.avgSetupMs = static_cast<double>(total.setupSumUs) / total.connectionsOpened / 1000.0;
+    setup.p50SetupMs = total.setupLatency.valueAtPercentile(50) / 1000.0;
+    setup.p99SetupMs = total.setupLatency.valueAtPercentile(99) / 1000.0;
+    setup.maxSetupMs = total.setupLatency.max() / 1000.0;
+    setup.setupLatency = std::move(total.setupLatency);
+    LatencyPhases& phases = result.latencyPhases;
+    uint64_t timed = total.waitPhase.latency.totalCount();
+    phases.valid = timed > 0;
+    phases.requests = static_cast<int>(timed);
+    auto summarizePhase = [timed](PhaseStats& stats, PhaseLatency& phase) {
+        if (timed == 0) return;
+        phase.avgMs = static_cast<double>(stats.sumUs) / timed / 1000.0;
+        phase.p50Ms = stats.latency.valueAtPercentile(50) / 1000.0;
+        phase.p90Ms = stats.latency.valueAtPercentile(90) / 1000.0;
+        phase.p99Ms = stats.latency.valueAtPercentile(99) / 1000.0;
+        phase.maxMs = stats.latency.max() / 1000.0;
+        phase.latency = std::move(stats.latency);
+    };
+    summarizePhase(total.waitPhase, phases.wait);
+    summarizePhase(total.writePhase, phases.write);
+    summarizePhase(total.firstBytePhase, phases.firstByte);
+    summarizePhase(total.transferPhase, phases.transfer);
+    ClientLoad& client = result.client;
+    client.valid = true;
+    client.threads = static_cast<int>(workers.size());
+    client.cpuCores = total.cpuNs / (elapsedSec * 1e9);
+    client.busiestThread = busiest;
+    client.pacedSends = static_cast<long>(total.pacedSends);
+    client.lateSends = static_cast<long>(total.lateSends);
+    client.backlogPeak = static_cast<int>(total.backlogPeak);
+    client.sendLagP99Ms = total.sendLag.valueAtPercentile(99) / 1000.0;
+    client.sendLagMaxMs = total.sendLag.max() / 1000.0;
+    for (size_t r = 0; r < total.routes.size(); r++) {
+        RouteStats& stats = total.routes[r];
+        RouteResult route;
+        route.name = routes[r].name;
+        route.method = routes[r].method;
+        route.path = routes[r].path;
+        route.requests = static_cast<int>(stats.completed);
+        route.errors = static_cast<int>(stats.errors);
+        route.requestsPerSecond = stats.completed / elapsedSec;
+        if (stats.completed > 0) route.avgLatency = static_cast<double>(stats.latencySumUs) / stats.completed / 1000.0;
+        route.latencyHistogram = std::move(stats.latency);
+        summarizeRoute(route);
+        result.routes.push_back(std::move(route));
+    }
+    if (archive) {
+        std::string error;
+        archive->close(error);
+        if (!error.empty()) throw std::runtime_error("Writing " + archivePath + " failed: " + error);
+        result.sampleFile = archivePath;
+    }
+    return result;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "benchmark_types.h"
+#include "scenarios.h"
+
+// Parses wrk-style duration strings ("30s", "500ms", "2m", "1h"); bare numbers are seconds.
+long long parseDurationMs(const std::string& value);
+
+// CLOCK_MONOTONIC in nanoseconds; the clock every load generator timestamp uses.
+uint64_t monotonicNowNs();
+
+// How requests reach the server (BenchmarkConfig::transport).
+struct TransportMode {
+    bool tls = false;
+    bool h2 = false;         // HTTP/2 over TLS (ALPN "h2"), several streams per connection
+    bool closeEach = false;  // a new connection, and handshake, for every request
+};
+
+// Throws std::runtime_error unless name is http1, http1-close, https, https-close or h2.
+TransportMode parseTransport(const std::string& name);
+
+struct LoadTarget {
+    std::string host = "localhost";
+    int port = 80;
+    std::string path = "/";
+    std::vector<ScenarioRoute> routes;  // weighted request mix; empty = GET path
+};
+
+// Running totals handed to the progress callback once per interval. The histograms
+// are only valid during the callback.
+struct LoadProgress {
+    double elapsedSec = 0.0;
+    uint64_t completed = 0;
+    uint64_t errors = 0;
+    uint64_t bytesRead = 0;
+    uint64_t connectionsOpened = 0;
+    const HdrHistogram* latency = nullptr;        // microseconds, every closed interval so far
+    const HdrHistogram* recentLatency = nullptr;  // the latest closed interval
+};
+
+// One timeline interval, merged across all worker threads. The histogram reference
+// is only valid during the callback.
+struct TimelineBucket {
+    int index = 0;
+    double startSec = 0.0;
+    double endSec = 0.0;
+    double monotonicStartSec = 0.0;  // CLOCK_MONOTONIC at startSec
+    uint64_t completed = 0;
+    uint64_t errors = 0;
+    uint64_t bytesRead = 0;
+    const HdrHistogram* latency = nullptr;  // microseconds
+};
+
+// In-process load generator: one event loop per thread, config.connections
+// connections split across config.threads, and request buffers that are serialized
+// once up front so the request loop itself never allocates. Connections are HTTP/1.1
+// keep-alive by default; config.transport adds TLS (with session resumption on
+// reconnect), HTTP/2 with config.h2Streams concurrent streams per connection, or a
+// new connection per request, whose latency then includes the connection setup.
+// With more than one route, each send picks a route by weight and the result
+// carries per-route counts and histograms. HTTP/1.1 requests are also timed in
+// phases (LatencyPhases); HTTP/2 streams share their connection's bytes and are not.
+class LoadGenerator {
+public:
+    LoadGenerator(const BenchmarkConfig& config, const LoadTarget& target);
+
+    // Called on the thread that invoked run(), every intervalMs while the test runs.
+    // Counters are read from the workers without locking; latency arrives with the
+    // timeline intervals (every intervalMs when no timeline is set).
+    void setProgressCallback(std::function<void(const LoadProgress&)> callback, int intervalMs = 1000);
+    // Emits one merged TimelineBucket per intervalMs, in order, on the thread that
+    // invoked run(), shortly after each interval closes.
+    void setTimelineCallback(std::function<void(const TimelineBucket&)> callback, int intervalMs);
+    // Appends a SampleRecord per request to `path` (sample_archive.h); empty = off.
+    // run() throws std::runtime_error if the archive cannot be written.
+    void setSampleArchive(const std::string& path, const std::string& label) {
+        archivePath = path;
+        archiveLabel = label;
+    }
+    // Holds the first request until monotonicNowNs() reaches startNs (0 = start immediately).
+    void setStartTime(uint64_t startNs) { startAtNs = startNs; }
+
+    // Ends a running test early (safe from any thread, including the callbacks);
+    // rates are computed over the time actually run. A SIGINT/SIGTERM caught by
+    // installInterruptHandler() ends it the same way.
+    void stop() { stopRequested.store(true, std::memory_order_relaxed); }
+
+    BenchmarkResult run();
+
+private:
+    BenchmarkConfig config;
+    LoadTarget target;
+    std::function<void(const LoadProgress&)> progressCallback;
+    int progressIntervalMs = 1000;
+    std::function<void(const TimelineBucket&)> timelineCallback;
+    int timelineIntervalMs = 0;
+    uint64_t startAtNs = 0;
+    std::string archivePath;
+    std::string archiveLabel;
+    std::atomic<bool> stopRequested{false};
+};
@@ -0,0 +1,412 @@
+#include "matrix_config.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include <fnmatch.h>
+
+#include "json_value.h"
+
+namespace {
+
+using Value = JsonValue;
+
+void assign(bool& field, const Value& value) {
+    if (value.type != Value::Bool) throw std::runtime_error("expected true or false");
+    field = value.boolean;
+}
+
+void assign(double& field, const Value& value) {
+    if (value.type != Value::Number) throw std::runtime_error("expected a number");
+    field = value.number;
+}
+
+void assign(int& field, const Value& value) {
+    if (value.type != Value::Number || value.number != std::floor(value.number)) {
+        throw std::runtime_error("expected an integer");
+    }
+    field = static_cast<int>(value.number);
+}
+
+void assign(unsigned& field, const Value& value) {
+    if (value.type != Value::Number || value.number < 0 || value.number != std::floor(value.number)) {
+        throw std::runtime_error("expected a non-negative integer");
+    }
+    field = static_cast<unsigned>(value.number);
+}
+
+// Numbers are accepted as their literal so that `--compareBaseline 1234567` works.
+void assign(std::string& field, const Value& value) {
+    if (value.type != Value::String && value.type != Value::Number) throw std::runtime_error("expected a string");
+    field = value.text;
+}
+
+// A single value stands for a list of one.
+template <typename T>
+void assign(std::vector<T>& field, const Value& value) {
+    std::vector<T> items;
+    if (value.type == Value::Array) {
+        for (const auto& item : value.items) {
+            items.emplace_back();
+            assign(items.back(), item);
+        }
+    } else {
+        items.emplace_back();
+        assign(items.back(), value);
+    }
+    field = items;
+}
+
+using Setter = std::function<void(BenchmarkConfig&, const Value&)>;
+
+template <typename T>
+Setter member(T BenchmarkConfig::*field) {
+    return [field](BenchmarkConfig& config, const Value& value) { assign(config.*field, value); };
+}
+
+// A list makes `axis` a matrix axis; a single value clears it.
+template <typename T>
+Setter axis(T BenchmarkConfig::*single, std::vector<T> BenchmarkConfig::*axis) {
+    return [single, axis](BenchmarkConfig& config, const Value& value) {
+        if (value.type == Value::Array) {
+            assign(config.*axis, value);
+            if ((config.*axis).empty()) throw std::runtime_error("expected at least one value");
+            config.*single = (config.*axis).front();
+        } else {
+            assign(config.*single, value);
+            (config.*axis).clear();
+        }
+    };
+}
+
+const std::map<std::string, Setter>& setters() {
+    static const std::map<std::string, Setter> table = {
+        {"connections", axis(&BenchmarkConfig::connections, &BenchmarkConfig::connectionCounts)},
+        {"threads", member(&BenchmarkConfig::threads)},
+        {"duration", member(&BenchmarkConfig::duration)},
+        {"timeout", member(&BenchmarkConfig::timeout)},
+        {"warmupTime", member(&BenchmarkConfig::warmupTime)},
+        {"cooldownTime", member(&BenchmarkConfig::cooldownTime)},
+        {"runs", member(&BenchmarkConfig::runs)},
+        {"latencyStats", member(&BenchmarkConfig::latencyStats)},
+        {"loadGenerator", member(&BenchmarkConfig::loadGenerator)},
+        {"rate", member(&BenchmarkConfig::rate)},
+        {"rateProfile", member(&BenchmarkConfig::rateProfile)},
+        {"arrivalProcess", member(&BenchmarkConfig::arrivalProcess)},
+        {"arrivalSeed", member(&BenchmarkConfig::arrivalSeed)},
+        {"offeredLoads", member(&BenchmarkConfig::offeredLoads)},
+        {"saturationSearch", member(&BenchmarkConfig::saturationSearch)},
+        {"sloP99Ms", member(&BenchmarkConfig::sloP99Ms)},
+        {"maxErrorRate", member(&BenchmarkConfig::maxErrorRate)},
+        {"searchStartRate", member(&BenchmarkConfig::searchStartRate)},
+        {"searchIterations", member(&BenchmarkConfig::searchIterations)},
+        {"searchDuration", member(&BenchmarkConfig::searchDuration)},
+        {"parallelSlots", member(&BenchmarkConfig::parallelSlots)},
+        {"portStride", member(&BenchmarkConfig::portStride)},
+        {"agents", member(&BenchmarkConfig::agents)},
+        {"targetHost", member(&BenchmarkConfig::targetHost)},
+        {"timelineIntervalMs", member(&BenchmarkConfig::timelineIntervalMs)},
+        {"timelineDir", member(&BenchmarkConfig::timelineDir)},
+        {"sampleArchiveDir", member(&BenchmarkConfig::sampleArchiveDir)},
+        {"steadyStateTolerance", member(&BenchmarkConfig::steadyStateTolerance)},
+        {"adaptiveWarmup", member(&BenchmarkConfig::adaptiveWarmup)},
+        {"warmupMaxTime", member(&BenchmarkConfig::warmupMaxTime)},
+        {"warmupWindowMs", member(&BenchmarkConfig::warmupWindowMs)},
+        {"warmupWindows", member(&BenchmarkConfig::warmupWindows)},
+        {"warmupCovThreshold", member(&BenchmarkConfig::warmupCovThreshold)},
+        {"warmupP99CovThreshold", member(&BenchmarkConfig::warmupP99CovThreshold)},
+        {"resourceSampleMs", member(&BenchmarkConfig::resourceSampleMs)},
+        {"scenarios", member(&BenchmarkConfig::scenarios)},
+        {"serverWorkers", member(&BenchmarkConfig::serverWorkers)},
+        {"workerMode", member(&BenchmarkConfig::workerMode)},
+        {"transport", axis(&BenchmarkConfig::transport, &BenchmarkConfig::transports)},
+        {"h2Streams", member(&BenchmarkConfig::h2Streams)},
+        {"tlsSessionResumption", member(&BenchmarkConfig::tlsSessionResumption)},
+        {"tlsCertFile", member(&BenchmarkConfig::tlsCertFile)},
+        {"tlsKeyFile", member(&BenchmarkConfig::tlsKeyFile)},
+        {"resultsStore", member(&BenchmarkConfig::resultsStore)},
+        {"compareBaseline", member(&BenchmarkConfig::compareBaseline)},
+        {"regressionAlpha", member(&BenchmarkConfig::regressionAlpha)},
+        {"regressionThreshold", member(&BenchmarkConfig::regressionThreshold)},
+        {"confidenceLevel", member(&BenchmarkConfig::confidenceLevel)},
+        {"schedule", member(&BenchmarkConfig::schedule)},
+        {"scheduleSeed", member(&BenchmarkConfig::scheduleSeed)},
+        {"calibrationMs", member(&BenchmarkConfig::calibrationMs)},
+        {"harnessCheckMs", member(&BenchmarkConfig::harnessCheckMs)},
+        {"clientCpuLimit", member(&BenchmarkConfig::clientCpuLimit)},
+        {"clientLagLimitMs", member(&BenchmarkConfig::clientLagLimitMs)},
+        {"clientCeilingShare", member(&BenchmarkConfig::clientCeilingShare)},
+        {"restartPolicy", member(&BenchmarkConfig::restartPolicy)},
+        {"coldStarts", member(&BenchmarkConfig::coldStarts)},
+        {"coldStartSteady", member(&BenchmarkConfig::coldStartSteady)},
+        {"metricsPort", member(&BenchmarkConfig::metricsPort)},
+        {"liveView", member(&BenchmarkConfig::liveView)},
+        {"soakDuration", member(&BenchmarkConfig::soakDuration)},
+        {"soakWindowSec", member(&BenchmarkConfig::soakWindowSec)},
+        {"soakRssGrowthLimit", member(&BenchmarkConfig::soakRssGrowthLimit)},
+        {"soakP99GrowthLimit", member(&BenchmarkConfig::soakP99GrowthLimit)},
+        {"networkProfile", member(&BenchmarkConfig::networkProfile)},
+        {"networkMode", member(&BenchmarkConfig::networkMode)},
+        {"netemDelayMs", member(&BenchmarkConfig::netemDelayMs)},
+        {"serverAddress", member(&BenchmarkConfig::serverAddress)},
+        {"profileMode", member(&BenchmarkConfig::profileMode)},
+        {"profileDuration", member(&BenchmarkConfig::profileDuration)},
+        {"profileDir", member(&BenchmarkConfig::profileDir)},
+        {"perfFrequency", member(&BenchmarkConfig::perfFrequency)},
+        {"instrumentIntervalMs", member(&BenchmarkConfig::instrumentIntervalMs)},
+        {"instrumentDir", member(&BenchmarkConfig::instrumentDir)},
+    };
+    return table;
+}
+
+void setValue(BenchmarkConfig& config, const std::string& key, const Value& value) {
+    auto setter = setters().find(key);
+    if (setter == setters().end()) throw std::runtime_error("unknown setting \"" + key + "\"");
+    try {
+        setter->second(config, value);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(key + ": " + e.what());
+    }
+}
+
+// {"KEY": "value", ...} or ["KEY=value", ...].
+std::vector<std::string> parseEnvironment(const Value& value, const std::string& setupName) {
+    std::vector<std::string> env;
+    if (value.type == Value::Object) {
+        for (const auto& [key, member] : value.members) {
+            std::string text;
+            if (member.type == Value::Bool) {
+                text = member.boolean ? "true" : "false";
+            } else {
+                try {
+                    assign(text, member);
+                } catch (const std::runtime_error& e) {
+                    throw std::runtime_error("setups.env." + key + ": " + e.what());
+                }
+            }
+            env.push_back(key + "=" + text);
+        }
+        return env;
+    }
+    try {
+        assign(env, value);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(std::string("setups.env: ") + e.what());
+    }
+    for (const auto& entry : env) {
+        if (entry.find('=') == std::string::npos || entry.front() == '=') {
+            throw std::runtime_error("setups.env: expected KEY=value, got \"" + entry + "\" in " + setupName);
+        }
+    }
+    return env;
+}
+
+Setup parseSetup(const Value& value) {
+    if (value.type != Value::Object) throw std::runtime_error("setups: expected an object per setup");
+    Setup setup;
+    auto field = [&](const char* key, auto& target) {
+        const Value* member = findMember(value, key);
+        if (member == nullptr) throw std::runtime_error(std::string("setups: missing \"") + key + "\"");
+        try {
+            assign(target, *member);
+        } catch (const std::runtime_error& e) {
+            throw std::runtime_error(std::string("setups.") + key + ": " + e.what());
+        }
+    };
+    field("name", setup.name);
+    field("port", setup.port);
+    field("runtime", setup.runtime);
+    field("framework", setup.framework);
+    field("script", setup.script);
+    for (const auto& [key, member] : value.members) {
+        if (key == "binary") {
+            field("binary", setup.binary);
+        } else if (key == "args") {
+            field("args", setup.runtimeArgs);
+        } else if (key == "env") {
+            setup.runtimeEnv = parseEnvironment(member, setup.name);
+        } else if (key != "name" && key != "port" && key != "runtime" && key != "framework" && key != "script") {
+            throw std::runtime_error("setups: unknown field \"" + key + "\" in " + setup.name);
+        }
+    }
+    return setup;
+}
+
+// Splits on commas; every piece is JSON if it parses and a plain string otherwise.
+Value parseCommandLineValue(const std::string& text) {
+    try {
+        return parseJson(text);
+    } catch (const std::runtime_error&) {
+    }
+    auto scalar = [](const std::string& piece) {
+        try {
+            Value value = parseJson(piece);
+            if (value.type != Value::Array && value.type != Value::Object) return value;
+        } catch (const std::runtime_error&) {
+        }
+        Value value;
+        value.type = Value::String;
+        value.text = piece;
+        return value;
+    };
+    if (text.find(',') == std::string::npos) return scalar(text);
+    Value list;
+    list.type = Value::Array;
+    std::istringstream pieces(text);
+    std::string piece;
+    while (std::getline(pieces, piece, ',')) list.items.push_back(scalar(piece));
+    return list;
+}
+
+const char* const kDimensions[] = {"setup", "runtime", "framework", "scenario", "connections", "transport", "workers", "restart"};
+
+// Splits a filter into its dimension and comma-separated globs.
+std::pair<std::string, std::vector<std::string>> splitFilter(const std::string& filter) {
+    std::string dimension = "setup";
+    std::string globs = filter;
+    size_t equals = filter.find('=');
+    if (equals != std::string::npos) {
+        for (const char* known : kDimensions) {
+            if (filter.compare(0, equals, known) == 0) {
+                dimension = known;
+                globs = filter.substr(equals + 1);
+                break;
+            }
+        }
+    }
+    std::vector<std::string> patterns;
+    std::istringstream pieces(globs);
+    std::string piece;
+    while (std::getline(pieces, piece, ',')) {
+        if (!piece.empty()) patterns.push_back(piece);
+    }
+    return {dimension, patterns};
+}
+
+}  // namespace
+
+void loadConfigFile(const std::string& path, BenchmarkConfig& config, std::vector<Setup>& setups) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot read config file " + path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+    try {
+        Value document = parseJson(text);
+        if (document.type != Value::Object) throw std::runtime_error("expected a JSON object");
+        for (const auto& [key, value] : document.members) {
+            if (key == "setups") {
+                if (value.type != Value::Array) throw std::runtime_error("setups: expected a list");
+                setups.clear();
+                for (const auto& item : value.items) setups.push_back(parseSetup(item));
+            } else if (key.rfind("//", 0) != 0) {  // "//" keys are comments
+                setValue(config, key, value);
+            }
+        }
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(path + ": " + e.what());
+    }
+}
+
+void setConfigValue(BenchmarkConfig& config, const std::string& key, const std::string& value) {
+    setValue(config, key, parseCommandLineValue(value));
+}
+
+CommandLine parseCommandLine(int argc, char* argv[]) {
+    CommandLine commandLine;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) throw std::runtime_error("unexpected argument \"" + arg + "\" (see --help)");
+        std::string key = arg.substr(2);
+        std::string value;
+        bool hasValue = false;
+        size_t equals = key.find('=');
+        if (equals != std::string::npos) {
+            value = key.substr(equals + 1);
+            key = key.substr(0, equals);
+            hasValue = true;
+        }
+        if (key == "help") {
+            commandLine.help = true;
+            continue;
+        }
+        if (key == "resume") {
+            commandLine.resume = true;
+            continue;
+        }
+        if (key == "plan") {
+            commandLine.planOnly = true;
+            continue;
+        }
+        if (!hasValue) {
+            if (i + 1 >= argc) throw std::runtime_error(arg + " needs a value");
+            value = argv[++i];
+        }
+        if (key == "config") {
+            loadConfigFile(value, commandLine.config, commandLine.setups);
+        } else if (key == "filter") {
+            if (splitFilter(value).second.empty()) throw std::runtime_error("empty --filter \"" + value + "\"");
+            commandLine.filters.push_back(value);
+        } else {
+            setConfigValue(commandLine.config, key, value);
+        }
+    }
+    return commandLine;
+}
+
+void printUsage(std::ostream& out) {
+    out << "Usage: benchmark_wrk [--config file.json] [--<setting> value ...] [--filter expr ...] [--resume] [--plan]\n"
+        << "       benchmark_wrk --agent [port]\n"
+        << "       benchmark_wrk --parse-wrk <dir> [csv]\n"
+        << "       benchmark_wrk --compare <baseline> [candidate] [store]\n"
+        << "       benchmark_wrk --analyze-samples <file> [window] [from] [to|end] [route]\n"
+        << "       benchmark_wrk --report [results] [html] [markdown] [readme]\n"
+        << "\n"
+        << "  --config file.json   settings and setups (see README); later flags override it\n"
+        << "  --<setting> value    any config setting, e.g. --duration 10s --connections 50,100,200\n"
+        << "                       --transport http1,h2 --serverWorkers 1,2; a list is a matrix axis\n"
+        << "  --filter expr        run only matching cells: [dimension=]glob[,glob...], dimensions\n"
+        << "                       setup (default), runtime, framework, scenario, connections,\n"
+        << "                       transport, workers, restart; repeated filters must all match\n"
+        << "  --resume             skip cells the results store already has for this commit and host\n"
+        << "  --plan               print the expanded run plan and exit\n"
+        << "\nSettings:";
+    int column = 80;
+    for (const auto& entry : setters()) {
+        if (column + entry.first.size() + 1 > 78) {
+            out << "\n ";
+            column = 1;
+        }
+        out << " " << entry.first;
+        column += entry.first.size() + 1;
+    }
+    out << std::endl;
+}
+
+bool matchesFilters(const std::vector<std::string>& filters, const Setup& setup, const std::string& scenario) {
+    for (const auto& filter : filters) {
+        auto [dimension, patterns] = splitFilter(filter);
+        std::string subject = dimension == "runtime"     ? setup.runtime
+                            : dimension == "framework"   ? setup.framework
+                            : dimension == "scenario"    ? scenario
+                            : dimension == "connections" ? std::to_string(setup.connections)
+                            : dimension == "transport"   ? setup.transport
+                            : dimension == "workers"     ? std::to_string(setup.workers)
+                            : dimension == "restart"     ? setup.restart
+                                                         : setup.name;
+        bool matched = false;
+        for (const auto& pattern : patterns) {
+            if (fnmatch(pattern.c_str(), subject.c_str(), 0) == 0) {
+                matched = true;
+                break;
+            }
+        }
+        if (!matched) return false;
+    }
+    return true;
+}
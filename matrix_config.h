@@ -0,0 +1,51 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "benchmark_types.h"
+
+// Declarative benchmark matrix. A JSON file and command-line flags set any
+// BenchmarkConfig field by name, and the file can replace the built-in setups:
+//
+//   {"setups": [{"name": "Hono on Bun", "port": 3002, "runtime": "bun",
+//                "framework": "hono", "script": "hono_server.js"},
+//               {"name": "Hono on Node 22", "port": 3002, "runtime": "node",
+//                "framework": "hono", "script": "hono_server.js",
+//                "binary": "/opt/node-v22/bin/node", "args": ["--max-old-space-size=4096"],
+//                "env": {"UV_THREADPOOL_SIZE": "8"}}],
+//    "duration": "10s", "runs": 5,
+//    "connections": [50, 100, 200], "transport": ["http1", "h2"],
+//    "scenarios": ["hello", "payload-64k"], "serverWorkers": [1, 2]}
+//
+// connections, transport, scenarios and serverWorkers take one value or a list;
+// the lists are the matrix axes, and every setup runs once per combination.
+
+struct CommandLine {
+    BenchmarkConfig config;
+    std::vector<Setup> setups;         // empty = the built-in framework setups
+    std::vector<std::string> filters;  // --filter; a cell runs when all of them match
+    bool resume = false;               // --resume: skip cells the results store has for this commit
+    bool planOnly = false;             // --plan: print the expanded run plan and exit
+    bool help = false;
+};
+
+// Throws std::runtime_error on an unreadable or malformed file, an unknown key or a
+// value of the wrong type.
+void loadConfigFile(const std::string& path, BenchmarkConfig& config, std::vector<Setup>& setups);
+
+// Sets one field from a command-line value: JSON ("5", "true", "[1,2]"), a
+// comma-separated list ("50,100"), or otherwise a plain string ("10s").
+void setConfigValue(BenchmarkConfig& config, const std::string& key, const std::string& value);
+
+// benchmark_wrk [--config file.json] [--<field> value ...] [--filter expr ...] [--resume] [--plan]
+// Flags apply in order, so a field set after --config overrides the file.
+CommandLine parseCommandLine(int argc, char* argv[]);
+
+void printUsage(std::ostream& out);
+
+// A filter is "[dimension=]glob[,glob...]", where dimension is setup (the default),
+// runtime, framework, scenario, connections, transport, workers or restart.
+// Setup names are the expanded ones ("Hono on Bun x2 c200").
+bool matchesFilters(const std::vector<std::string>& filters, const Setup& setup, const std::string& scenario);
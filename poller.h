@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#else
+#include <sys/event.h>
+#endif
+
+struct PollEvent {
+    void* ptr;
+    bool readable;
+    bool writable;
+};
+
+// Edge-triggered readiness notification: epoll on Linux, kqueue elsewhere.
+class Poller {
+public:
+    Poller() {
+#if defined(__linux__)
+        fd = epoll_create1(EPOLL_CLOEXEC);
+#else
+        fd = kqueue();
+#endif
+        if (fd < 0) throw std::runtime_error(std::string("Failed to create poller: ") + std::strerror(errno));
+    }
+
+    ~Poller() { close(fd); }
+
+    Poller(const Poller&) = delete;
+    Poller& operator=(const Poller&) = delete;
+
+    bool add(int socketFd, void* ptr) {
+#if defined(__linux__)
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = ptr;
+        return epoll_ctl(fd, EPOLL_CTL_ADD, socketFd, &ev) == 0;
+#else
+        struct kevent changes[2];
+        EV_SET(&changes[0], socketFd, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, ptr);
+        EV_SET(&changes[1], socketFd, EVFILT_WRITE, EV_ADD | EV_CLEAR, 0, 0, ptr);
+        return kevent(fd, changes, 2, nullptr, 0, nullptr) == 0;
+#endif
+    }
+
+    // Timeout is in microseconds so paced (constant-rate) workers can sleep until
+    // the next scheduled send instead of rounding to whole milliseconds.
+    int wait(PollEvent* out, int maxEvents, uint64_t timeoutUs) {
+        timespec timeout{static_cast<time_t>(timeoutUs / 1000000ULL), static_cast<long>(timeoutUs % 1000000ULL) * 1000L};
+#if defined(__linux__)
+        std::array<epoll_event, 256> events;
+        int capacity = std::min<int>(maxEvents, events.size());
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 35))
+        int n = epoll_pwait2(fd, events.data(), capacity, &timeout, nullptr);
+        if (n < 0 && errno == ENOSYS) {
+            n = epoll_wait(fd, events.data(), capacity, static_cast<int>((timeoutUs + 999) / 1000));
+        }
+#else
+        int n = epoll_wait(fd, events.data(), capacity, static_cast<int>((timeoutUs + 999) / 1000));
+#endif
+        for (int i = 0; i < n; i++) {
+            bool failed = events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP);
+            out[i] = {events[i].data.ptr,
+                      (events[i].events & EPOLLIN) != 0 || failed,
+                      (events[i].events & EPOLLOUT) != 0 || failed};
+        }
+        return n;
+#else
+        std::array<struct kevent, 256> events;
+        int n = kevent(fd, nullptr, 0, events.data(), std::min<int>(maxEvents, events.size()), &timeout);
+        for (int i = 0; i < n; i++) {
+            bool failed = events[i].flags & (EV_EOF | EV_ERROR);
+            out[i] = {events[i].udata,
+                      events[i].filter == EVFILT_READ || failed,
+                      events[i].filter == EVFILT_WRITE || failed};
+        }
+        return n;
+#endif
+    }
+
+private:
+    int fd = -1;
+};
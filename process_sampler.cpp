@@ -0,0 +1,161 @@
+#include "process_sampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+namespace {
+
+double monotonicSec() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long statusField(const std::string& status, const char* key) {
+    size_t pos = status.find(key);
+    if (pos == std::string::npos) return 0;
+    return std::atol(status.c_str() + pos + std::char_traits<char>::length(key));
+}
+
+}  // namespace
+
+ProcessSampler::ProcessSampler(pid_t group, int intervalMs) : group(group), intervalMs(std::max(intervalMs, 1)) {}
+
+ProcessSampler::~ProcessSampler() {
+    running = false;
+    if (thread.joinable()) thread.join();
+}
+
+// Sums every process whose process group is `group`; false if there are none.
+bool ProcessSampler::read(Sample& sample) const {
+#ifdef __linux__
+    bool found = false;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc", ec)) {
+        const std::string pid = entry.path().filename().string();
+        if (pid.empty() || !std::isdigit(static_cast<unsigned char>(pid[0]))) continue;
+        found |= readProcess(pid, sample);
+    }
+    return found;
+#else
+    (void)sample;
+    return false;
+#endif
+}
+
+// Adds one process to the sample if it belongs to the group.
+bool ProcessSampler::readProcess(const std::string& pid, Sample& sample) const {
+    std::string base = "/proc/" + pid;
+
+    std::ifstream statFile(base + "/stat");
+    std::string stat;
+    if (!std::getline(statFile, stat)) return false;
+    // comm (field 2) may contain spaces; fields after it start past the last ')'.
+    size_t close = stat.rfind(')');
+    if (close == std::string::npos) return false;
+    std::istringstream fields(stat.substr(close + 2));
+    std::string field;
+    static const double ticks = static_cast<double>(sysconf(_SC_CLK_TCK));
+    Sample process;
+    for (int index = 3; fields >> field; index++) {
+        if (index == 5 && std::stol(field) != group) return false;
+        if (index == 14) process.userSec = std::stod(field) / ticks;
+        if (index == 15) process.sysSec = std::stod(field) / ticks;
+        if (index == 20) {
+            process.threads = std::stoi(field);
+            break;
+        }
+    }
+
+    std::ifstream statusFile(base + "/status");
+    std::stringstream status;
+    status << statusFile.rdbuf();
+    std::string text = status.str();
+    sample.userSec += process.userSec;
+    sample.sysSec += process.sysSec;
+    sample.threads += process.threads;
+    sample.rssKb += statusField(text, "VmRSS:");
+    sample.hwmSumKb += statusField(text, "VmHWM:");
+
+    // The process's own status counts only the main thread's switches; sum every task.
+    std::error_code ec;
+    for (const auto& task : std::filesystem::directory_iterator(base + "/task", ec)) {
+        std::ifstream taskFile(task.path() / "status");
+        std::stringstream taskStatus;
+        taskStatus << taskFile.rdbuf();
+        std::string taskText = taskStatus.str();
+        sample.voluntarySwitches += statusField(taskText, "\nvoluntary_ctxt_switches:");
+        sample.involuntarySwitches += statusField(taskText, "nonvoluntary_ctxt_switches:");
+    }
+    return true;
+}
+
+void ProcessSampler::start() {
+    running = true;
+    startedSec = monotonicSec();
+    thread = std::thread(&ProcessSampler::loop, this);
+}
+
+void ProcessSampler::loop() {
+    auto next = std::chrono::steady_clock::now();
+    while (running) {
+        Sample sample;
+        if (read(sample)) {
+            if (!haveFirst) {
+                first = sample;
+                haveFirst = true;
+            }
+            last = sample;
+            lastSec = monotonicSec();
+            maxRssKb = std::max(maxRssKb, sample.rssKb);
+            rssKbSum += static_cast<double>(sample.rssKb);
+            maxThreads = std::max(maxThreads, sample.threads);
+            samples++;
+            currentRssKb.store(sample.rssKb, std::memory_order_relaxed);
+        }
+        next += std::chrono::milliseconds(intervalMs);
+        std::this_thread::sleep_until(next);
+    }
+}
+
+ProcessStats ProcessSampler::stop() {
+    running = false;
+    if (thread.joinable()) thread.join();
+
+    // One last reading so CPU covers the whole window, not just up to the last tick.
+    Sample final;
+    if (read(final)) {
+        if (!haveFirst) {
+            first = final;
+            haveFirst = true;
+        }
+        last = final;
+        lastSec = monotonicSec();
+        maxRssKb = std::max(maxRssKb, final.rssKb);
+        rssKbSum += static_cast<double>(final.rssKb);
+        maxThreads = std::max(maxThreads, final.threads);
+        samples++;
+    }
+
+    ProcessStats stats;
+    if (!haveFirst || samples < 2) return stats;
+    stats.valid = true;
+    stats.samples = samples;
+    stats.wallSec = lastSec - startedSec;
+    stats.cpuUserSec = last.userSec - first.userSec;
+    stats.cpuSysSec = last.sysSec - first.sysSec;
+    stats.cpuCores = stats.wallSec > 0 ? (stats.cpuUserSec + stats.cpuSysSec) / stats.wallSec : 0.0;
+    stats.avgRssKb = rssKbSum / samples;
+    stats.maxRssKb = maxRssKb;
+    stats.hwmSumKb = last.hwmSumKb;
+    stats.voluntarySwitches = last.voluntarySwitches - first.voluntarySwitches;
+    stats.involuntarySwitches = last.involuntarySwitches - first.involuntarySwitches;
+    stats.maxThreads = maxThreads;
+    return stats;
+}
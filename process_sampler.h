@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include <sys/types.h>
+
+#include "benchmark_types.h"
+
+// Samples a server's process group from /proc/<pid>/stat and /proc/<pid>/status
+// on a background thread while a measurement runs: CPU time, RSS, VmHWM,
+// context switches and thread count, summed over every process in the group so
+// multi-worker servers are counted in full. Context switches are summed over each
+// process's threads. Counters are reported as deltas over
+// the sampled window. Linux only; elsewhere stop() returns an invalid result.
+class ProcessSampler {
+public:
+    ProcessSampler(pid_t group, int intervalMs);
+    ~ProcessSampler();
+
+    void start();
+    ProcessStats stop();
+
+    // RSS summed over the group at the latest sample; readable while sampling.
+    long latestRssKb() const { return currentRssKb.load(std::memory_order_relaxed); }
+
+private:
+    struct Sample {
+        double userSec = 0.0;
+        double sysSec = 0.0;
+        long rssKb = 0;
+        long hwmSumKb = 0;
+        long voluntarySwitches = 0;
+        long involuntarySwitches = 0;
+        int threads = 0;
+    };
+
+    bool read(Sample& sample) const;
+    bool readProcess(const std::string& pid, Sample& sample) const;
+    void loop();
+
+    pid_t group;
+    int intervalMs;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<long> currentRssKb{0};
+
+    // Written by the sampler thread, read after join.
+    bool haveFirst = false;
+    Sample first;
+    Sample last;
+    long maxRssKb = 0;
+    double rssKbSum = 0.0;
+    int maxThreads = 0;
+    int samples = 0;
+    double startedSec = 0.0;
+    double lastSec = 0.0;
+};
@@ -0,0 +1,387 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "json_value.h"
+
+namespace {
+
+double monotonicUs() {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Every process whose process group is `group`.
+std::vector<std::string> groupPids(pid_t group) {
+    std::vector<std::string> pids;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc", ec)) {
+        const std::string pid = entry.path().filename().string();
+        if (pid.empty() || !std::isdigit(static_cast<unsigned char>(pid[0]))) continue;
+        std::ifstream statFile(entry.path() / "stat");
+        std::string stat;
+        if (!std::getline(statFile, stat)) continue;
+        // comm may contain spaces; state, ppid and pgrp follow the last ')'.
+        size_t close = stat.rfind(')');
+        if (close == std::string::npos) continue;
+        std::istringstream fields(stat.substr(close + 2));
+        std::string state;
+        long ppid = 0, pgrp = 0;
+        if (fields >> state >> ppid >> pgrp && pgrp == group) pids.push_back(pid);
+    }
+    return pids;
+}
+
+// Separators of the collapsed format cannot appear inside a frame.
+std::string frameName(std::string name) {
+    std::replace(name.begin(), name.end(), ';', ':');
+    std::replace(name.begin(), name.end(), '\n', ' ');
+    return name;
+}
+
+// "\t    7f3a2c1b symbol+0x1f (/usr/lib/libc.so.6)" -> "symbol"
+std::string perfFrame(const std::string& line) {
+    size_t start = line.find_first_not_of(" \t");
+    size_t symbol = line.find_first_of(" \t", start);
+    if (symbol == std::string::npos) return "[unknown]";
+    symbol = line.find_first_not_of(" \t", symbol);
+    std::string text = symbol == std::string::npos ? "" : line.substr(symbol);
+    std::string dso;
+    size_t open = text.rfind(" (");
+    if (!text.empty() && text.back() == ')' && open != std::string::npos) {
+        dso = text.substr(open + 2, text.size() - open - 3);
+        text.erase(open);
+    }
+    size_t offset = text.rfind("+0x");
+    if (offset != std::string::npos) text.erase(offset);
+    if (text.empty() || text == "[unknown]") {
+        if (dso.empty() || dso[0] == '[') return "[unknown]";
+        return "[" + std::filesystem::path(dso).filename().string() + "]";
+    }
+    return frameName(text);
+}
+
+int integer(const JsonValue* value) {
+    return value != nullptr && value->type == JsonValue::Number ? static_cast<int>(value->number) : 0;
+}
+
+// "handler hono_server.js:12" from a V8 call frame.
+std::string cpuProfileFrame(const JsonValue& node) {
+    const JsonValue* callFrame = findMember(node, "callFrame");
+    if (callFrame == nullptr) return "(unknown)";
+    const JsonValue* function = findMember(*callFrame, "functionName");
+    const JsonValue* url = findMember(*callFrame, "url");
+    std::string name = function != nullptr && !function->text.empty() ? function->text : "(anonymous)";
+    if (url != nullptr && !url->text.empty()) {
+        name += " " + std::filesystem::path(url->text).filename().string() + ":" +
+                std::to_string(integer(findMember(*callFrame, "lineNumber")) + 1);
+    }
+    return frameName(name);
+}
+
+// Adds one process's profile to `all`, and its samples taken in [startUs, endUs] to `inWindow`.
+void foldCpuProfile(const JsonValue& profile, double startUs, double endUs, FoldedStacks& inWindow,
+                    FoldedStacks& all) {
+    const JsonValue* nodes = findMember(profile, "nodes");
+    const JsonValue* samples = findMember(profile, "samples");
+    const JsonValue* deltas = findMember(profile, "timeDeltas");
+    if (nodes == nullptr || samples == nullptr || deltas == nullptr) throw std::runtime_error("not a .cpuprofile");
+
+    std::map<int, std::string> names;
+    std::map<int, int> parents;
+    int root = 0;
+    for (const auto& node : nodes->items) {
+        int id = integer(findMember(node, "id"));
+        names[id] = cpuProfileFrame(node);
+        if (root == 0) root = id;  // "(root)" comes first
+        if (const JsonValue* children = findMember(node, "children")) {
+            for (const auto& child : children->items) parents[integer(&child)] = id;
+        }
+    }
+    std::map<int, std::string> stacks;
+    auto stackOf = [&](int id) -> const std::string& {
+        auto known = stacks.find(id);
+        if (known != stacks.end()) return known->second;
+        std::vector<int> path;
+        for (int at = id; at != 0 && at != root; at = parents.count(at) ? parents[at] : 0) path.push_back(at);
+        std::string stack;
+        for (auto it = path.rbegin(); it != path.rend(); ++it) stack += (stack.empty() ? "" : ";") + names[*it];
+        return stacks[id] = stack.empty() ? "(root)" : stack;
+    };
+
+    double at = findMember(profile, "startTime") != nullptr ? findMember(profile, "startTime")->number : 0.0;
+    size_t count = std::min(samples->items.size(), deltas->items.size());
+    for (size_t i = 0; i < count; i++) {
+        at += deltas->items[i].number;
+        const std::string& stack = stackOf(integer(&samples->items[i]));
+        all[stack]++;
+        if (at >= startUs && at <= endUs) inWindow[stack]++;
+    }
+}
+
+}  // namespace
+
+ServerProfiler::ServerProfiler(const std::string& mode, const std::string& basePath, int frequency)
+    : mode(mode), basePath(basePath), frequency(std::max(frequency, 1)) {
+    if (mode != "perf" && mode != "cpu-prof") {
+        throw std::runtime_error("profileMode must be \"perf\" or \"cpu-prof\", got \"" + mode + "\"");
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(basePath).parent_path(), ec);
+    if (mode == "cpu-prof") {
+        // Only this window's profiles may be in the directory.
+        std::filesystem::remove_all(basePath + "-cpuprofile", ec);
+        std::filesystem::create_directories(basePath + "-cpuprofile", ec);
+    }
+}
+
+ServerProfiler::~ServerProfiler() {
+    stop();
+}
+
+void ServerProfiler::prepare(Setup& setup) const {
+    if (mode == "perf") {
+        if (setup.runtime == "node") {
+            setup.runtimeArgs.push_back("--perf-basic-prof");
+            setup.runtimeArgs.push_back("--interpreted-frames-native-stack");
+        } else if (setup.runtime == "bun") {
+            setup.runtimeEnv.push_back("BUN_JSC_logJITCodeForPerf=1");
+        }
+        return;
+    }
+    if (setup.runtime != "node") {
+        throw std::runtime_error("profileMode \"cpu-prof\" needs Node.js; profile " + setup.name + " with \"perf\"");
+    }
+    setup.runtimeArgs.push_back("--cpu-prof");
+    setup.runtimeArgs.push_back("--cpu-prof-dir=" + std::filesystem::absolute(basePath + "-cpuprofile").string());
+}
+
+void ServerProfiler::start(pid_t group) {
+    windowStartUs = monotonicUs();
+    if (mode != "perf") return;
+
+    std::vector<std::string> pids = groupPids(group);
+    if (pids.empty()) throw std::runtime_error("server exited before profiling");
+    std::string pidList;
+    for (const auto& pid : pids) pidList += (pidList.empty() ? "" : ",") + pid;
+    std::vector<std::string> argStrings = {"perf", "record", "-g", "-F", std::to_string(frequency),
+                                           "-o", basePath + ".perf.data", "-p", pidList};
+    std::vector<char*> argv;
+    for (auto& arg : argStrings) argv.push_back(&arg[0]);
+    argv.push_back(nullptr);
+    std::string logFile = basePath + ".perf.log";
+
+    perf = fork();
+    if (perf == 0) {
+        int log = open(logFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log >= 0) {
+            dup2(log, STDOUT_FILENO);
+            dup2(log, STDERR_FILENO);
+        }
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    if (perf < 0) throw std::runtime_error("cannot fork perf");
+    // perf needs a moment to attach; if it exits instead, its log says why.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    int status = 0;
+    if (waitpid(perf, &status, WNOHANG) == perf) {
+        perf = -1;
+        throw std::runtime_error("perf record exited at once (see " + logFile + ")");
+    }
+    windowStartUs = monotonicUs();
+}
+
+void ServerProfiler::stop() {
+    if (windowEndUs == 0.0 && windowStartUs > 0.0) windowEndUs = monotonicUs();
+    if (perf <= 0) return;
+    // SIGINT makes perf record flush and close the data file.
+    kill(perf, SIGINT);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    int status = 0;
+    while (waitpid(perf, &status, WNOHANG) == 0) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            kill(perf, SIGKILL);
+            waitpid(perf, &status, 0);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    perf = -1;
+}
+
+ProfileResult ServerProfiler::finish() {
+    stop();
+    ProfileResult result;
+    result.mode = mode;
+    result.windowSec = (windowEndUs - windowStartUs) / 1e6;
+    FoldedStacks stacks;
+    try {
+        if (mode == "perf") {
+            result.rawFile = basePath + ".perf.data";
+            stacks = foldPerfData(result.rawFile);
+        } else {
+            result.rawFile = basePath + "-cpuprofile";
+            stacks = foldCpuProfiles(result.rawFile, windowStartUs, windowEndUs, result.wholeProcess);
+        }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        return result;
+    }
+    if (stacks.empty()) {
+        result.error = "no samples recorded";
+        return result;
+    }
+
+    result.foldedFile = basePath + ".folded";
+    std::ofstream folded(result.foldedFile);
+    std::map<std::string, long> self;
+    for (const auto& [stack, count] : stacks) {
+        folded << stack << " " << count << "\n";
+        result.samples += count;
+        size_t leaf = stack.rfind(';');
+        self[leaf == std::string::npos ? stack : stack.substr(leaf + 1)] += count;
+    }
+    folded.close();
+    for (const auto& [name, count] : self) result.topFrames.push_back({name, count});
+    std::sort(result.topFrames.begin(), result.topFrames.end(),
+              [](const ProfileFrame& a, const ProfileFrame& b) { return a.samples > b.samples; });
+    if (result.topFrames.size() > 10) result.topFrames.resize(10);
+
+    if (std::system("command -v flamegraph.pl >/dev/null 2>&1") == 0) {
+        std::string svg = basePath + ".svg";
+        if (std::system(("flamegraph.pl '" + result.foldedFile + "' > '" + svg + "' 2>/dev/null").c_str()) == 0) {
+            result.flamegraphFile = svg;
+        }
+    }
+    return result;
+}
+
+bool perfAvailable() {
+    return std::system("perf --version >/dev/null 2>&1") == 0;
+}
+
+FoldedStacks foldPerfData(const std::string& dataFile) {
+    std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(("perf script -i '" + dataFile + "' 2>/dev/null").c_str(), "r"),
+                                                  pclose);
+    if (!pipe) throw std::runtime_error("cannot run perf script");
+    FoldedStacks stacks;
+    std::string comm;
+    std::vector<std::string> frames;  // leaf first, as perf prints them
+    auto flush = [&]() {
+        if (!comm.empty()) {
+            std::string stack = comm;
+            for (auto it = frames.rbegin(); it != frames.rend(); ++it) stack += ";" + *it;
+            stacks[stack]++;
+        }
+        comm.clear();
+        frames.clear();
+    };
+    char* buffer = nullptr;
+    size_t capacity = 0;
+    ssize_t length;
+    while ((length = getline(&buffer, &capacity, pipe.get())) >= 0) {
+        std::string line(buffer, length);
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+        if (line.find_first_not_of(" \t") == std::string::npos) {
+            flush();
+        } else if (line[0] == ' ' || line[0] == '\t') {
+            frames.push_back(perfFrame(line));
+        } else {
+            // "comm pid[/tid] [cpu] time: period event:"; thread names may contain spaces.
+            flush();
+            std::istringstream words(line);
+            std::string word;
+            while (words >> word && !std::isdigit(static_cast<unsigned char>(word[0]))) {
+                comm += (comm.empty() ? "" : " ") + word;
+            }
+            comm = frameName(comm.empty() ? "[unknown]" : comm);
+        }
+    }
+    flush();
+    free(buffer);
+    if (pclose(pipe.release()) != 0) throw std::runtime_error("perf script failed on " + dataFile);
+    return stacks;
+}
+
+FoldedStacks foldCpuProfiles(const std::string& dir, double startUs, double endUs, bool& wholeProcess) {
+    FoldedStacks inWindow, all;
+    int files = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.path().extension() != ".cpuprofile") continue;
+        std::ifstream in(entry.path());
+        std::stringstream text;
+        text << in.rdbuf();
+        try {
+            foldCpuProfile(parseJson(text.str()), startUs, endUs, inWindow, all);
+        } catch (const std::exception& e) {
+            throw std::runtime_error(entry.path().string() + ": " + e.what());
+        }
+        files++;
+    }
+    if (files == 0) throw std::runtime_error("no .cpuprofile in " + dir + " (the server must exit cleanly on SIGTERM)");
+    wholeProcess = inWindow.empty() && !all.empty();
+    return wholeProcess ? all : inWindow;
+}
+
+void printProfileReport(std::ostream& out, const std::vector<ProfileResult>& results) {
+    if (results.empty()) return;
+    out << "\nCPU Profiles (separate window after the measured runs):" << std::endl;
+    for (const auto& result : results) {
+        out << "\n" << result.environment << " [" << result.scenario << "], " << result.mode << ": ";
+        if (!result.error.empty()) {
+            out << "failed: " << result.error << std::endl;
+            continue;
+        }
+        out << result.samples << " samples over " << std::fixed << std::setprecision(1) << result.windowSec << "s"
+            << (result.wholeProcess ? " (whole process: sample times did not match the window)" : "") << std::endl;
+        out << "  Collapsed stacks: " << result.foldedFile << std::endl;
+        if (!result.flamegraphFile.empty()) out << "  Flamegraph: " << result.flamegraphFile << std::endl;
+        out << "  " << std::left << std::setw(10) << "Self %" << "Frame" << std::endl;
+        for (const auto& frame : result.topFrames) {
+            std::ostringstream share;
+            share << std::fixed << std::setprecision(1) << 100.0 * frame.samples / result.samples << "%";
+            out << "  " << std::left << std::setw(10) << share.str() << frame.name << std::endl;
+        }
+    }
+}
+
+void writeProfileJson(std::ostream& out, const std::vector<ProfileResult>& results, const std::string& indent) {
+    out << "[";
+    for (size_t i = 0; i < results.size(); i++) {
+        const ProfileResult& result = results[i];
+        out << (i > 0 ? "," : "") << "\n" << indent << "  {\"environment\": " << jsonString(result.environment)
+            << ", \"scenario\": " << jsonString(result.scenario)
+            << ", \"mode\": " << jsonString(result.mode)
+            << ", \"samples\": " << result.samples
+            << ", \"windowSec\": " << result.windowSec
+            << ", \"wholeProcess\": " << (result.wholeProcess ? "true" : "false")
+            << ", \"folded\": " << jsonString(result.foldedFile)
+            << ", \"flamegraph\": " << jsonString(result.flamegraphFile)
+            << ", \"raw\": " << jsonString(result.rawFile)
+            << ", \"error\": " << jsonString(result.error)
+            << ",\n" << indent << "   \"topFrames\": [";
+        for (size_t f = 0; f < result.topFrames.size(); f++) {
+            out << (f > 0 ? ", " : "") << "{\"name\": " << jsonString(result.topFrames[f].name)
+                << ", \"samples\": " << result.topFrames[f].samples << "}";
+        }
+        out << "]}";
+    }
+    out << (results.empty() ? "" : "\n" + indent) << "]";
+}
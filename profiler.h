@@ -0,0 +1,93 @@
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "benchmark_types.h"
+
+// CPU profiles of a server under load, taken in a window of their own after a
+// setup's measured runs so that profiler overhead never reaches the headline
+// numbers. Two modes:
+//
+//   "perf"      perf record -g attached to every process of the server group.
+//               Node.js runs with --perf-basic-prof and Bun with
+//               BUN_JSC_logJITCodeForPerf=1, so JIT frames resolve through
+//               /tmp/perf-<pid>.map.
+//   "cpu-prof"  Node.js's own sampling profiler (--cpu-prof). It writes a
+//               .cpuprofile per process on exit; only samples taken inside the
+//               profiled window are kept.
+//
+// Both end as collapsed stacks ("outer;inner;leaf count" per line), which
+// flamegraph.pl, inferno and speedscope read; with flamegraph.pl on PATH an SVG
+// is rendered next to them.
+
+using FoldedStacks = std::map<std::string, long>;
+
+struct ProfileFrame {
+    std::string name;
+    long samples = 0;  // self samples
+};
+
+struct ProfileResult {
+    std::string environment;
+    std::string scenario;
+    std::string mode;
+    long samples = 0;
+    double windowSec = 0.0;
+    bool wholeProcess = false;  // cpu-prof timestamps did not match the window, so every sample was kept
+    std::string foldedFile;
+    std::string flamegraphFile;  // empty without flamegraph.pl
+    std::string rawFile;         // perf.data, or the directory of .cpuprofile files
+    std::vector<ProfileFrame> topFrames;  // most self samples first
+    std::string error;           // the profile is missing or partial when set
+};
+
+class ServerProfiler {
+public:
+    // `basePath` is the output path without extension; `frequency` is perf's sampling rate in Hz.
+    // Throws std::runtime_error for an unknown mode.
+    ServerProfiler(const std::string& mode, const std::string& basePath, int frequency);
+    ~ServerProfiler();
+    ServerProfiler(const ServerProfiler&) = delete;
+    ServerProfiler& operator=(const ServerProfiler&) = delete;
+
+    // Adds the runtime flags and environment the mode needs. Throws
+    // std::runtime_error for cpu-prof on a runtime other than Node.js.
+    void prepare(Setup& setup) const;
+
+    // Brackets the profiled window on a running server group. start() throws
+    // std::runtime_error when perf cannot be started.
+    void start(pid_t group);
+    void stop();
+
+    // Collects the profile; for cpu-prof, only once the server has exited.
+    ProfileResult finish();
+
+private:
+    std::string mode;
+    std::string basePath;
+    int frequency;
+    pid_t perf = -1;
+    double windowStartUs = 0.0;  // CLOCK_MONOTONIC, the clock V8 timestamps samples with
+    double windowEndUs = 0.0;
+};
+
+// True when `perf` can be run.
+bool perfAvailable();
+
+// Collapsed stacks from `perf script` over a perf.data file; throws std::runtime_error if it fails.
+FoldedStacks foldPerfData(const std::string& dataFile);
+
+// Collapsed stacks of every .cpuprofile in `dir`, limited to samples taken in
+// [startUs, endUs]. Falls back to every sample, and sets `wholeProcess`, when none fall inside.
+FoldedStacks foldCpuProfiles(const std::string& dir, double startUs, double endUs, bool& wholeProcess);
+
+// "CPU Profiles" section: where each profile went and its hottest frames.
+void printProfileReport(std::ostream& out, const std::vector<ProfileResult>& results);
+
+// The JSON `profiles` array.
+void writeProfileJson(std::ostream& out, const std::vector<ProfileResult>& results, const std::string& indent);
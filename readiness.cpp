@@ -0,0 +1,94 @@
+#include "readiness.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// One nonblocking connect; a refused connection fails immediately, anything
+// still in progress gets `timeoutMs` to complete.
+bool tcpConnects(const sockaddr_storage& address, socklen_t addressLen, int timeoutMs) {
+    int fd = socket(address.ss_family, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    bool connected = connect(fd, reinterpret_cast<const sockaddr*>(&address), addressLen) == 0;
+    if (!connected && errno == EINPROGRESS) {
+        pollfd waiting{fd, POLLOUT, 0};
+        int error = 0;
+        socklen_t errorLen = sizeof(error);
+        connected = poll(&waiting, 1, timeoutMs) == 1 &&
+                    getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &errorLen) == 0 && error == 0;
+    }
+    close(fd);
+    return connected;
+}
+
+// IPv4 preferred, as the servers bind 0.0.0.0.
+socklen_t resolveServer(const std::string& host, int port, sockaddr_storage& address) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* resolved = nullptr;
+    std::string service = std::to_string(port);
+    int rc = getaddrinfo(host.c_str(), service.c_str(), &hints, &resolved);
+    if (rc != 0 || resolved == nullptr) {
+        throw std::runtime_error("Failed to resolve " + host + ": " + gai_strerror(rc));
+    }
+    const addrinfo* chosen = resolved;
+    for (const addrinfo* ai = resolved; ai != nullptr; ai = ai->ai_next) {
+        if (ai->ai_family == AF_INET) {
+            chosen = ai;
+            break;
+        }
+    }
+    std::memcpy(&address, chosen->ai_addr, chosen->ai_addrlen);
+    socklen_t addressLen = chosen->ai_addrlen;
+    freeaddrinfo(resolved);
+    return addressLen;
+}
+
+}  // namespace
+
+bool pollWithBackoff(const std::function<bool()>& probe, std::chrono::steady_clock::time_point deadline,
+                     const std::function<bool()>& alive) {
+    auto backoff = std::chrono::microseconds(50);
+    const auto maxBackoff = std::chrono::microseconds(2000);
+    while (alive()) {
+        if (probe()) return true;
+        if (std::chrono::steady_clock::now() + backoff >= deadline) return false;
+        std::this_thread::sleep_for(backoff);
+        backoff = std::min(backoff * 2, maxBackoff);
+    }
+    return false;
+}
+
+bool waitForListen(const std::string& host, int port, std::chrono::steady_clock::time_point deadline,
+                   const std::function<bool()>& alive) {
+    sockaddr_storage address{};
+    socklen_t addressLen = resolveServer(host, port, address);
+    return pollWithBackoff([&]() { return tcpConnects(address, addressLen, 100); }, deadline, alive);
+}
+
+double measureConnectRtt(const std::string& host, int port, int samples) {
+    sockaddr_storage address{};
+    socklen_t addressLen = resolveServer(host, port, address);
+    std::vector<double> times;
+    for (int i = 0; i < samples; i++) {
+        auto start = std::chrono::steady_clock::now();
+        if (!tcpConnects(address, addressLen, 1000)) continue;
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    if (times.empty()) return 0.0;
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+// Startup probing for freshly spawned servers. Instead of sleeping a fixed
+// interval between probes, attempts back off from 50us, doubling up to 2ms, so
+// the moment a server becomes ready is resolved to about a millisecond and
+// its startup time can be reported.
+
+// Calls `probe` until it returns true. Returns false once `deadline` passes or
+// `alive` (checked before every attempt) returns false.
+bool pollWithBackoff(const std::function<bool()>& probe, std::chrono::steady_clock::time_point deadline,
+                     const std::function<bool()>& alive);
+
+// Polls with nonblocking TCP connects until host:port accepts one (IPv4 preferred,
+// as the servers bind 0.0.0.0). Throws std::runtime_error if the host does not resolve.
+bool waitForListen(const std::string& host, int port, std::chrono::steady_clock::time_point deadline,
+                   const std::function<bool()>& alive);
+
+// Median time of `samples` TCP handshakes with host:port in ms, about one network
+// round trip; 0 when none succeeded.
+double measureConnectRtt(const std::string& host, int port, int samples);
@@ -0,0 +1,461 @@
+#include "report.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "hdr_histogram.h"
+#include "json_value.h"
+#include "results_store.h"
+
+namespace {
+
+const char* const kReadmeStart = "<!-- benchmark-results:start -->";
+const char* const kReadmeEnd = "<!-- benchmark-results:end -->";
+const char* const kPalette[] = {"#1f77b4", "#ff7f0e", "#2ca02c", "#d62728", "#9467bd",
+                                "#8c564b", "#e377c2", "#7f7f7f", "#bcbd22", "#17becf"};
+constexpr size_t kMaxSeries = sizeof(kPalette) / sizeof(kPalette[0]);
+
+// What the report needs of one entry of "results"; the rest of the entry is dropped
+// as soon as it has been read.
+struct ResultCell {
+    std::string environment;
+    std::string scenario;
+    double requestsPerSecond = 0.0;
+    double avgLatency = 0.0;
+    double p50Latency = 0.0;
+    double p90Latency = 0.0;
+    double p99Latency = 0.0;
+    double throughput = 0.0;
+    double errors = 0.0;
+    int clientBoundRuns = 0;
+    std::vector<double> runRps;
+    std::vector<double> runP99;
+    std::string histogram;
+    std::vector<std::string> timelines;
+};
+
+struct Series {
+    std::string name;
+    std::vector<std::pair<double, double>> points;
+};
+
+struct CellSummary {
+    ConfidenceInterval rps;
+    ConfidenceInterval p99;
+    Series cdf;                        // latency in ms against the percentile at or below it
+    std::vector<Series> rpsTimeline;   // one per run
+    std::vector<Series> p99Timeline;
+};
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Cannot read " + path);
+    std::ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+std::string stringMember(const JsonValue& object, const char* key) {
+    const JsonValue* value = findMember(object, key);
+    return value && value->type == JsonValue::String ? value->text : "";
+}
+
+double numberMember(const JsonValue& object, const char* key) {
+    const JsonValue* value = findMember(object, key);
+    return value && value->type == JsonValue::Number ? value->number : 0.0;
+}
+
+ResultCell readCell(const JsonValue& entry) {
+    ResultCell cell;
+    cell.environment = stringMember(entry, "environment");
+    cell.scenario = stringMember(entry, "scenario");
+    cell.requestsPerSecond = numberMember(entry, "requestsPerSecond");
+    cell.avgLatency = numberMember(entry, "avgLatency");
+    cell.p50Latency = numberMember(entry, "p50Latency");
+    cell.p90Latency = numberMember(entry, "p90Latency");
+    cell.p99Latency = numberMember(entry, "p99Latency");
+    cell.throughput = numberMember(entry, "throughput");
+    cell.errors = numberMember(entry, "errors");
+    cell.clientBoundRuns = static_cast<int>(numberMember(entry, "clientBoundRuns"));
+    cell.histogram = stringMember(entry, "latencyHistogram");
+    if (const JsonValue* runs = findMember(entry, "runs")) {
+        for (const auto& run : runs->items) {
+            cell.runRps.push_back(numberMember(run, "requestsPerSecond"));
+            cell.runP99.push_back(numberMember(run, "p99Latency"));
+        }
+    }
+    if (const JsonValue* timelines = findMember(entry, "timelines")) {
+        for (const auto& path : timelines->items) {
+            if (path.type == JsonValue::String && !path.text.empty()) cell.timelines.push_back(path.text);
+        }
+    }
+    return cell;
+}
+
+double lineNumber(const std::string& line, const char* key) {
+    std::string pattern = std::string("\"") + key + "\":";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos) return 0.0;
+    return std::strtod(line.c_str() + pos + pattern.size(), nullptr);
+}
+
+// Timeline paths are saved as the run wrote them, relative to where it ran; a report
+// made elsewhere also looks next to the results file.
+std::string locate(const std::string& path, const std::string& resultsDir) {
+    if (std::filesystem::exists(path) || resultsDir.empty()) return path;
+    return (std::filesystem::path(resultsDir) / path).string();
+}
+
+void readTimeline(const std::string& path, const std::string& name, Series& rps, Series& p99) {
+    std::ifstream in(path);
+    std::string line;
+    rps.name = p99.name = name;
+    while (std::getline(in, line)) {
+        if (line.find("\"requests\":") == std::string::npos) continue;
+        double t = lineNumber(line, "t");
+        rps.points.emplace_back(t, lineNumber(line, "rps"));
+        p99.points.emplace_back(t, lineNumber(line, "p99"));
+    }
+}
+
+CellSummary summarise(const ResultCell& cell, double alpha, const std::string& resultsDir) {
+    CellSummary summary;
+    summary.rps = meanConfidenceInterval(cell.runRps, alpha);
+    summary.p99 = meanConfidenceInterval(cell.runP99, alpha);
+    if (cell.runRps.empty()) summary.rps.mean = summary.rps.low = summary.rps.high = cell.requestsPerSecond;
+
+    summary.cdf.name = cell.environment;
+    HdrHistogram histogram;
+    if (!cell.histogram.empty() && HdrHistogram::deserialize(cell.histogram, histogram) && histogram.totalCount() > 0) {
+        // Evenly up to P99, then the tail in nines, which is where runtimes differ.
+        std::vector<double> percentiles;
+        for (int p = 0; p < 99; p++) percentiles.push_back(p);
+        for (double p : {99.0, 99.5, 99.9, 99.95, 99.99, 99.999, 100.0}) percentiles.push_back(p);
+        for (double p : percentiles) {
+            double ms = std::max(histogram.valueAtPercentile(p), int64_t{1}) / 1000.0;
+            summary.cdf.points.emplace_back(ms, p);
+        }
+    }
+
+    for (size_t r = 0; r < cell.timelines.size(); r++) {
+        Series rps, p99;
+        readTimeline(locate(cell.timelines[r], resultsDir), "run " + std::to_string(r + 1), rps, p99);
+        if (rps.points.empty()) continue;
+        summary.rpsTimeline.push_back(std::move(rps));
+        summary.p99Timeline.push_back(std::move(p99));
+    }
+    return summary;
+}
+
+std::string fixed(double value, int digits) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(digits) << value;
+    return out.str();
+}
+
+std::string htmlEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        switch (c) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '"': out += "&quot;"; break;
+            default: out += c;
+        }
+    }
+    return out;
+}
+
+std::string markdownEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '<') {
+            out += "&lt;";
+            continue;
+        }
+        if (c == '|') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+std::string formatInterval(const ConfidenceInterval& interval, size_t samples, int digits) {
+    if (samples < 2) return "-";
+    return fixed(interval.low, digits) + " - " + fixed(interval.high, digits);
+}
+
+// 1, 2 or 5 times a power of ten, so that about `count` ticks cover the range.
+std::vector<double> linearTicks(double low, double high, int count) {
+    std::vector<double> ticks;
+    double range = high - low;
+    if (range <= 0) return {low};
+    double step = std::pow(10.0, std::floor(std::log10(range / count)));
+    for (double multiple : {1.0, 2.0, 5.0, 10.0}) {
+        if (range / (step * multiple) <= count) {
+            step *= multiple;
+            break;
+        }
+    }
+    for (double tick = std::ceil(low / step) * step; tick <= high + step * 1e-9; tick += step) ticks.push_back(tick);
+    return ticks;
+}
+
+std::string tickLabel(double value) {
+    std::ostringstream out;
+    out << std::setprecision(value != 0 && std::fabs(value) < 1 ? 2 : 6) << value;
+    return out.str();
+}
+
+// A line chart as inline SVG; with logX the x axis has one tick per decade.
+std::string svgChart(const std::vector<Series>& series, const std::string& xLabel, const std::string& yLabel, bool logX) {
+    const double width = 720, height = 320, left = 64, right = 16, top = 16, bottom = 48;
+    double xMin = INFINITY, xMax = -INFINITY, yMin = 0, yMax = -INFINITY;
+    for (const auto& s : series) {
+        for (const auto& [x, y] : s.points) {
+            double px = logX ? std::log10(x) : x;
+            xMin = std::min(xMin, px);
+            xMax = std::max(xMax, px);
+            yMax = std::max(yMax, y);
+        }
+    }
+    if (!std::isfinite(xMin)) return "";
+    if (logX) {
+        xMin = std::floor(xMin);
+        xMax = std::max(std::ceil(xMax), xMin + 1);
+    }
+    if (xMax <= xMin) xMax = xMin + 1;
+    if (yMax <= yMin) yMax = yMin + 1;
+    // The y axis ends on a tick at or above the highest value.
+    std::vector<double> yTicks = linearTicks(yMin, yMax, 5);
+    if (yTicks.size() > 1 && yTicks.back() < yMax) yTicks.push_back(2 * yTicks.back() - yTicks[yTicks.size() - 2]);
+    yMax = std::max(yMax, yTicks.back());
+    auto sx = [&](double x) { return left + (x - xMin) / (xMax - xMin) * (width - left - right); };
+    auto sy = [&](double y) { return height - bottom - (y - yMin) / (yMax - yMin) * (height - top - bottom); };
+
+    std::ostringstream svg;
+    svg << std::fixed << std::setprecision(1);
+    svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"0 0 " << width << " " << height
+        << "\" width=\"" << width << "\" height=\"" << height << "\">\n";
+    std::vector<double> xTicks;
+    if (logX) {
+        for (double decade = xMin; decade <= xMax; decade++) xTicks.push_back(decade);
+    } else {
+        xTicks = linearTicks(xMin, xMax, 8);
+    }
+    for (double tick : xTicks) {
+        svg << "<line class=\"grid\" x1=\"" << sx(tick) << "\" y1=\"" << top << "\" x2=\"" << sx(tick) << "\" y2=\""
+            << height - bottom << "\"/><text x=\"" << sx(tick) << "\" y=\"" << height - bottom + 16
+            << "\" text-anchor=\"middle\">" << tickLabel(logX ? std::pow(10.0, tick) : tick) << "</text>\n";
+    }
+    for (double tick : yTicks) {
+        svg << "<line class=\"grid\" x1=\"" << left << "\" y1=\"" << sy(tick) << "\" x2=\"" << width - right << "\" y2=\""
+            << sy(tick) << "\"/><text x=\"" << left - 6 << "\" y=\"" << sy(tick) + 4 << "\" text-anchor=\"end\">"
+            << tickLabel(tick) << "</text>\n";
+    }
+    svg << "<text x=\"" << (left + width - right) / 2 << "\" y=\"" << height - 8 << "\" text-anchor=\"middle\">"
+        << htmlEscape(xLabel) << "</text>\n";
+    svg << "<text transform=\"translate(14," << (top + height - bottom) / 2 << ") rotate(-90)\" text-anchor=\"middle\">"
+        << htmlEscape(yLabel) << "</text>\n";
+    for (size_t i = 0; i < series.size() && i < kMaxSeries; i++) {
+        svg << "<polyline fill=\"none\" stroke=\"" << kPalette[i] << "\" stroke-width=\"1.5\" points=\"";
+        for (const auto& [x, y] : series[i].points) svg << sx(logX ? std::log10(x) : x) << "," << sy(y) << " ";
+        svg << "\"><title>" << htmlEscape(series[i].name) << "</title></polyline>\n";
+    }
+    svg << "</svg>\n";
+    return svg.str();
+}
+
+std::string legend(const std::vector<Series>& series) {
+    std::ostringstream out;
+    out << "<p class=\"legend\">";
+    for (size_t i = 0; i < series.size() && i < kMaxSeries; i++) {
+        out << "<span style=\"color:" << kPalette[i] << "\">&#9632;</span> " << htmlEscape(series[i].name) << " ";
+    }
+    if (series.size() > kMaxSeries) out << "(top " << kMaxSeries << " of " << series.size() << " by req/sec)";
+    out << "</p>\n";
+    return out.str();
+}
+
+std::string formatDate(const std::string& timestamp) {
+    std::time_t seconds = static_cast<std::time_t>(std::strtoll(timestamp.c_str(), nullptr, 10));
+    if (seconds <= 0) return "";
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M UTC", std::gmtime(&seconds));
+    return date;
+}
+
+void writeHtml(const std::string& path, const JsonValue& header, const std::vector<ResultCell>& cells,
+               const std::vector<CellSummary>& summaries, const std::vector<std::vector<size_t>>& scenarios,
+               double confidence) {
+    std::ofstream html(path);
+    if (!html) throw std::runtime_error("Cannot write " + path);
+    std::string level = fixed(confidence * 100, 0) + "%";
+    html << "<!DOCTYPE html>\n<html lang=\"en\">\n<head>\n<meta charset=\"utf-8\">\n"
+         << "<title>Framework Benchmark Report</title>\n<style>\n"
+         << "body { font-family: system-ui, sans-serif; margin: 2em auto; max-width: 960px; color: #222; }\n"
+         << "table { border-collapse: collapse; margin: 1em 0; font-size: 14px; }\n"
+         << "th, td { border-bottom: 1px solid #ddd; padding: 4px 10px; text-align: right; }\n"
+         << "th:nth-child(2), td:nth-child(2) { text-align: left; }\n"
+         << "svg { font-size: 11px; } svg .grid { stroke: #e4e4e4; } .legend { font-size: 13px; }\n"
+         << ".bound { color: #d62728; }\n</style>\n</head>\n<body>\n"
+         << "<h1>Framework Benchmark Report</h1>\n<p>";
+    std::string date = formatDate(stringMember(header, "timestamp"));
+    if (!date.empty()) html << "Recorded " << htmlEscape(date) << " with the ";
+    html << htmlEscape(stringMember(header, "benchmarkTool")) << " load generator. Intervals are " << level
+         << " confidence intervals of the mean over runs; percentiles are those of the merged histograms.</p>\n";
+
+    for (const auto& indices : scenarios) {
+        const std::string& scenario = cells[indices.front()].scenario;
+        html << "<h2>Scenario: " << htmlEscape(scenario) << "</h2>\n<table>\n<tr><th>Rank</th><th>Environment</th>"
+             << "<th>Req/sec</th><th>" << level << " CI</th><th>P50 ms</th><th>P99 ms</th><th>P99 " << level
+             << " CI</th><th>Errors</th><th>Runs</th></tr>\n";
+        std::vector<Series> cdfs;
+        for (size_t rank = 0; rank < indices.size(); rank++) {
+            const ResultCell& cell = cells[indices[rank]];
+            const CellSummary& summary = summaries[indices[rank]];
+            html << "<tr><td>" << rank + 1 << "</td><td>" << htmlEscape(cell.environment);
+            if (cell.clientBoundRuns > 0) {
+                html << " <span class=\"bound\" title=\"the load generator may have set these numbers\">(client-bound "
+                     << cell.clientBoundRuns << "/" << cell.runRps.size() << ")</span>";
+            }
+            html << "</td><td>" << fixed(cell.requestsPerSecond, 0) << "</td><td>"
+                 << formatInterval(summary.rps, cell.runRps.size(), 0) << "</td><td>" << fixed(cell.p50Latency, 3)
+                 << "</td><td>" << fixed(cell.p99Latency, 3) << "</td><td>"
+                 << formatInterval(summary.p99, cell.runP99.size(), 3) << "</td><td>" << fixed(cell.errors, 0)
+                 << "</td><td>" << cell.runRps.size() << "</td></tr>\n";
+            if (!summary.cdf.points.empty()) cdfs.push_back(summary.cdf);
+        }
+        html << "</table>\n";
+        if (!cdfs.empty()) {
+            html << "<h3>Latency CDF</h3>\n" << svgChart(cdfs, "latency (ms, log scale)", "percentile", true)
+                 << legend(cdfs);
+        }
+        for (size_t index : indices) {
+            const CellSummary& summary = summaries[index];
+            if (summary.rpsTimeline.empty()) continue;
+            html << "<details>\n<summary>Timeline: " << htmlEscape(cells[index].environment) << "</summary>\n"
+                 << svgChart(summary.rpsTimeline, "seconds into the run", "req/sec", false)
+                 << svgChart(summary.p99Timeline, "seconds into the run", "P99 latency (ms)", false)
+                 << legend(summary.rpsTimeline) << "</details>\n";
+        }
+    }
+    html << "</body>\n</html>\n";
+}
+
+std::string markdownTable(const std::vector<ResultCell>& cells, const std::vector<CellSummary>& summaries,
+                          const std::vector<std::vector<size_t>>& scenarios, const JsonValue& header,
+                          double confidence, const std::string& resultsPath) {
+    std::ostringstream md;
+    std::string level = fixed(confidence * 100, 0) + "%";
+    for (const auto& indices : scenarios) {
+        if (scenarios.size() > 1) md << "#### Scenario: " << markdownEscape(cells[indices.front()].scenario) << "\n\n";
+        md << "| Rank | Framework & Runtime | Requests/sec | " << level
+           << " CI | Avg Latency | P90 Latency | P99 Latency | Throughput |\n"
+           << "|------|-------------------|--------------|--------|-------------|-------------|-------------|------------|\n";
+        for (size_t rank = 0; rank < indices.size(); rank++) {
+            const ResultCell& cell = cells[indices[rank]];
+            const CellSummary& summary = summaries[indices[rank]];
+            md << "| " << rank + 1 << " | " << markdownEscape(cell.environment) << (cell.clientBoundRuns > 0 ? " *" : "")
+               << " | " << fixed(cell.requestsPerSecond, 0) << " | " << formatInterval(summary.rps, cell.runRps.size(), 0)
+               << " | " << fixed(cell.avgLatency, 2) << "ms | " << fixed(cell.p90Latency, 2) << "ms | "
+               << fixed(cell.p99Latency, 2) << "ms | " << fixed(cell.throughput / 1024 / 1024, 2) << " MB/s |\n";
+        }
+        md << "\n";
+    }
+    bool anyBound = std::any_of(cells.begin(), cells.end(), [](const ResultCell& c) { return c.clientBoundRuns > 0; });
+    if (anyBound) md << "\\* client-bound in at least one run: the load generator may have set these numbers.\n\n";
+    std::string date = formatDate(stringMember(header, "timestamp"));
+    md << "*Generated from `" << std::filesystem::path(resultsPath).filename().string() << "`"
+       << (date.empty() ? "" : " recorded " + date) << "; " << level
+       << " confidence intervals of the mean req/sec over runs.*\n";
+    return md.str();
+}
+
+void spliceReadme(const std::string& path, const std::string& table) {
+    std::string text = readFile(path);
+    size_t start = text.find(kReadmeStart);
+    size_t end = start == std::string::npos ? std::string::npos : text.find(kReadmeEnd, start);
+    if (end == std::string::npos) {
+        throw std::runtime_error(path + " has no " + kReadmeStart + " ... " + kReadmeEnd + " block to replace");
+    }
+    start += std::char_traits<char>::length(kReadmeStart);
+    text = text.substr(0, start) + "\n" + table + text.substr(end);
+    std::ofstream out(path, std::ios::binary);
+    if (!out) throw std::runtime_error("Cannot write " + path);
+    out << text;
+}
+
+}  // namespace
+
+void writeBenchmarkReport(const std::string& resultsPath, const ReportOptions& options) {
+    std::vector<ResultCell> cells;
+    JsonValue header;
+    try {
+        header = parseJsonStreaming(readFile(resultsPath), "results", [&](JsonValue&& entry) {
+            cells.push_back(readCell(entry));
+        });
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(resultsPath + ": " + e.what());
+    }
+    if (cells.empty()) throw std::runtime_error(resultsPath + " has no results");
+    double confidence = numberMember(header, "confidenceLevel");
+    if (!(confidence > 0 && confidence < 1)) confidence = 0.95;
+
+    // Each worker takes the next result off a shared counter; summaries land in place.
+    std::vector<CellSummary> summaries(cells.size());
+    std::string resultsDir = std::filesystem::path(resultsPath).parent_path().string();
+    int threads = options.threads > 0 ? options.threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::min<int>(threads, cells.size());
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < cells.size(); i = next++) {
+                summaries[i] = summarise(cells[i], 1.0 - confidence, resultsDir);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    // Scenarios in the order they first appear, each ranked by req/sec.
+    std::vector<std::vector<size_t>> scenarios;
+    std::map<std::string, size_t> scenarioIndex;
+    for (size_t i = 0; i < cells.size(); i++) {
+        auto [it, added] = scenarioIndex.emplace(cells[i].scenario, scenarios.size());
+        if (added) scenarios.emplace_back();
+        scenarios[it->second].push_back(i);
+    }
+    for (auto& indices : scenarios) {
+        std::stable_sort(indices.begin(), indices.end(), [&](size_t a, size_t b) {
+            return cells[a].requestsPerSecond > cells[b].requestsPerSecond;
+        });
+    }
+
+    if (!options.htmlPath.empty()) {
+        writeHtml(options.htmlPath, header, cells, summaries, scenarios, confidence);
+        std::cout << "HTML report saved to " << options.htmlPath << std::endl;
+    }
+    std::string table = markdownTable(cells, summaries, scenarios, header, confidence, resultsPath);
+    if (!options.markdownPath.empty()) {
+        std::ofstream md(options.markdownPath);
+        if (!md) throw std::runtime_error("Cannot write " + options.markdownPath);
+        md << table;
+        std::cout << "Markdown table saved to " << options.markdownPath << std::endl;
+    }
+    if (!options.readmePath.empty()) {
+        spliceReadme(options.readmePath, table);
+        std::cout << "Results table updated in " << options.readmePath << std::endl;
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+// The reporting stage: reads a saved benchmark_results_wrk.json one result at a
+// time and writes
+//
+//   - a self-contained HTML report: per scenario a summary table with confidence
+//     intervals of the per-run means and a latency CDF of the merged histograms,
+//     and per result its req/sec and P99 timelines, all as inline SVG;
+//   - a Markdown ranking table ready to paste into the README.
+//
+// Results are summarised in parallel, so thousands of matrix cells with their
+// histograms and timeline files take seconds rather than minutes.
+struct ReportOptions {
+    std::string htmlPath = "benchmark_report.html";
+    std::string markdownPath = "benchmark_report.md";
+    std::string readmePath;  // when set, the table replaces what is between the README's results markers
+    int threads = 0;         // results summarised at once; 0 = one per CPU
+};
+
+// Throws std::runtime_error when the results cannot be read or parsed, or when the
+// README has no results markers.
+void writeBenchmarkReport(const std::string& resultsPath, const ReportOptions& options);
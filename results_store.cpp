@@ -0,0 +1,507 @@
+#include "results_store.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/utsname.h>
+#include <unistd.h>
+
+namespace {
+
+std::string commandOutput(const char* command) {
+    std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(command, "r"), pclose);
+    if (!pipe) return "";
+    std::array<char, 256> buffer;
+    std::string output;
+    while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) output += buffer.data();
+    while (!output.empty() && std::isspace(static_cast<unsigned char>(output.back()))) output.pop_back();
+    return output;
+}
+
+std::string cpuModel() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) != 0) continue;
+        size_t colon = line.find(':');
+        if (colon != std::string::npos) return line.substr(line.find_first_not_of(' ', colon + 1));
+    }
+    std::string brand = commandOutput("sysctl -n machdep.cpu.brand_string 2>/dev/null");
+    return brand.empty() ? "unknown CPU" : brand;
+}
+
+// FNV-1a, as 8 hex digits.
+std::string fingerprint(const std::string& text) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    char hex[9];
+    std::snprintf(hex, sizeof(hex), "%08x", hash);
+    return hex;
+}
+
+void writeString(std::ostream& out, const std::string& value) {
+    out << '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+void writeArray(std::ostream& out, const std::vector<double>& values) {
+    out << '[';
+    for (size_t i = 0; i < values.size(); i++) {
+        if (i > 0) out << ',';
+        out << values[i];
+    }
+    out << ']';
+}
+
+// The reader only has to understand what appendResults writes: one flat object
+// per line with strings, numbers, booleans and arrays of numbers.
+bool stringField(const std::string& line, const char* key, std::string& value) {
+    std::string pattern = std::string("\"") + key + "\":\"";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos) return false;
+    value.clear();
+    for (size_t i = pos + pattern.size(); i < line.size(); i++) {
+        if (line[i] == '"') return true;
+        if (line[i] == '\\' && i + 1 < line.size()) i++;
+        value += line[i];
+    }
+    return false;
+}
+
+double numberField(const std::string& line, const char* key) {
+    std::string pattern = std::string("\"") + key + "\":";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos) return 0.0;
+    return std::strtod(line.c_str() + pos + pattern.size(), nullptr);
+}
+
+std::vector<double> arrayField(const std::string& line, const char* key) {
+    std::vector<double> values;
+    std::string pattern = std::string("\"") + key + "\":[";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos) return values;
+    const char* cursor = line.c_str() + pos + pattern.size();
+    while (*cursor != ']' && *cursor != '\0') {
+        char* end = nullptr;
+        double value = std::strtod(cursor, &end);
+        if (end == cursor) break;
+        values.push_back(value);
+        cursor = end;
+        if (*cursor == ',') cursor++;
+    }
+    return values;
+}
+
+std::string recordId(const StoredResult& record) { return record.key + "\n" + record.host; }
+
+double mean(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double value : values) sum += value;
+    return values.empty() ? 0.0 : sum / values.size();
+}
+
+double variance(const std::vector<double>& values, double average) {
+    if (values.size() < 2) return 0.0;
+    double sum = 0.0;
+    for (double value : values) sum += (value - average) * (value - average);
+    return sum / (values.size() - 1);
+}
+
+// Continued fraction for the regularized incomplete beta function (modified Lentz).
+double betaContinuedFraction(double a, double b, double x) {
+    const double tiny = 1e-300;
+    double c = 1.0;
+    double d = 1.0 - (a + b) * x / (a + 1.0);
+    if (std::fabs(d) < tiny) d = tiny;
+    d = 1.0 / d;
+    double h = d;
+    for (int m = 1; m <= 300; m++) {
+        double aa = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+        d = 1.0 + aa * d;
+        c = 1.0 + aa / c;
+        if (std::fabs(d) < tiny) d = tiny;
+        if (std::fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        h *= d * c;
+        aa = -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+        d = 1.0 + aa * d;
+        c = 1.0 + aa / c;
+        if (std::fabs(d) < tiny) d = tiny;
+        if (std::fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        double step = d * c;
+        h *= step;
+        if (std::fabs(step - 1.0) < 1e-12) break;
+    }
+    return h;
+}
+
+double incompleteBeta(double a, double b, double x) {
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log(1.0 - x));
+    if (x < (a + 1.0) / (a + b + 2.0)) return front * betaContinuedFraction(a, b, x) / a;
+    return 1.0 - front * betaContinuedFraction(b, a, 1.0 - x) / b;
+}
+
+// The t with twoSidedPValue(t, df) == alpha, by bisection.
+double criticalT(double alpha, double df) {
+    double low = 0.0;
+    double high = 1000.0;
+    for (int i = 0; i < 100; i++) {
+        double mid = (low + high) / 2.0;
+        if (twoSidedPValue(mid, df) > alpha) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return (low + high) / 2.0;
+}
+
+std::string label(const std::string& environment, const std::string& scenario) {
+    return scenario == "hello" ? environment : environment + " [" + scenario + "]";
+}
+
+// The record's runtime version change, or "" when it ran on the same one. Records
+// from before the runtime was stored are checked on both versions.
+std::string runtimeChange(const StoredResult& base, const StoredResult& candidate) {
+    std::string runtime = !candidate.runtime.empty() ? candidate.runtime : base.runtime;
+    std::string change;
+    auto check = [&](const char* name, const std::string& from, const std::string& to) {
+        if (!runtime.empty() && runtime != name) return;
+        if (from.empty() || to.empty() || from == to) return;
+        change += (change.empty() ? "" : ", ") + std::string(name) + " " + from + " -> " + to;
+    };
+    check("node", base.nodeVersion, candidate.nodeVersion);
+    check("bun", base.bunVersion, candidate.bunVersion);
+    return change;
+}
+
+std::string describeCommit(const StoredResult& record) {
+    std::string commit = record.commit.substr(0, 12);
+    return record.dirty ? commit + "+dirty" : commit;
+}
+
+}  // namespace
+
+double twoSidedPValue(double t, double df) { return incompleteBeta(df / 2.0, 0.5, df / (df + t * t)); }
+
+void describeCurrentRun(StoredResult& identity) {
+    const char* override = std::getenv("BENCHMARK_COMMIT");
+    if (override != nullptr && *override != '\0') {
+        identity.commit = override;
+    } else {
+        identity.commit = commandOutput("git rev-parse HEAD 2>/dev/null");
+        identity.dirty = !commandOutput("git status --porcelain --untracked-files=no 2>/dev/null").empty();
+    }
+    if (identity.commit.empty()) identity.commit = "unknown";
+
+    char hostname[256] = {};
+    if (gethostname(hostname, sizeof(hostname) - 1) != 0) std::snprintf(hostname, sizeof(hostname), "unknown");
+    utsname system{};
+    std::string kernel = uname(&system) == 0 ? system.release : "unknown";
+    identity.hostInfo = std::string(hostname) + "; " + cpuModel() + "; " +
+                        std::to_string(std::thread::hardware_concurrency()) + " CPUs; " + kernel;
+    identity.host = fingerprint(identity.hostInfo);
+}
+
+void appendResults(const std::string& path, const std::vector<StoredResult>& records) {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+    std::ofstream out(path, std::ios::app);
+    if (!out) throw std::runtime_error("Cannot open results store " + path);
+    for (const auto& record : records) {
+        out << "{\"recordedAt\":" << record.recordedAt << ",\"commit\":";
+        writeString(out, record.commit);
+        out << ",\"dirty\":" << (record.dirty ? "true" : "false") << ",\"host\":";
+        writeString(out, record.host);
+        out << ",\"hostInfo\":";
+        writeString(out, record.hostInfo);
+        out << ",\"node\":";
+        writeString(out, record.nodeVersion);
+        out << ",\"bun\":";
+        writeString(out, record.bunVersion);
+        out << ",\"runtime\":";
+        writeString(out, record.runtime);
+        out << ",\"key\":";
+        writeString(out, record.key);
+        out << ",\"environment\":";
+        writeString(out, record.environment);
+        out << ",\"scenario\":";
+        writeString(out, record.scenario);
+        out << ",\"rps\":";
+        writeArray(out, record.rps);
+        out << ",\"avgLatency\":";
+        writeArray(out, record.avgLatency);
+        out << ",\"p50\":";
+        writeArray(out, record.p50);
+        out << ",\"p99\":";
+        writeArray(out, record.p99);
+        out << "}\n";
+    }
+    if (!out.flush()) throw std::runtime_error("Failed to write results store " + path);
+}
+
+std::vector<StoredResult> loadResults(const std::string& path) {
+    std::vector<StoredResult> history;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        StoredResult record;
+        if (!stringField(line, "commit", record.commit) || !stringField(line, "key", record.key)) continue;
+        record.recordedAt = static_cast<long>(numberField(line, "recordedAt"));
+        record.dirty = line.find("\"dirty\":true") != std::string::npos;
+        stringField(line, "host", record.host);
+        stringField(line, "hostInfo", record.hostInfo);
+        stringField(line, "node", record.nodeVersion);
+        stringField(line, "bun", record.bunVersion);
+        stringField(line, "runtime", record.runtime);
+        stringField(line, "environment", record.environment);
+        stringField(line, "scenario", record.scenario);
+        record.rps = arrayField(line, "rps");
+        record.avgLatency = arrayField(line, "avgLatency");
+        record.p50 = arrayField(line, "p50");
+        record.p99 = arrayField(line, "p99");
+        history.push_back(std::move(record));
+    }
+    return history;
+}
+
+std::vector<StoredResult> recordsForCommit(const std::vector<StoredResult>& history, const std::string& commit) {
+    std::string prefix = commit;
+    if (prefix == "latest") {
+        if (history.empty()) return {};
+        prefix = history.back().commit;
+    }
+    std::map<std::string, size_t> latest;
+    std::vector<StoredResult> records;
+    for (const auto& record : history) {
+        if (record.commit.rfind(prefix, 0) != 0) continue;
+        auto it = latest.find(recordId(record));
+        if (it == latest.end()) {
+            latest[recordId(record)] = records.size();
+            records.push_back(record);
+        } else {
+            records[it->second] = record;
+        }
+    }
+    return records;
+}
+
+std::vector<StoredResult> previousRecords(const std::vector<StoredResult>& history,
+                                          const std::vector<StoredResult>& candidates) {
+    std::vector<StoredResult> records;
+    for (const auto& candidate : candidates) {
+        const StoredResult* previous = nullptr;
+        for (const auto& record : history) {
+            if (record.key == candidate.key && record.host == candidate.host && record.commit != candidate.commit &&
+                record.recordedAt <= candidate.recordedAt) {
+                previous = &record;
+            }
+        }
+        if (previous != nullptr) records.push_back(*previous);
+    }
+    return records;
+}
+
+WelchTest welchTest(const std::vector<double>& baseline, const std::vector<double>& candidate, double alpha) {
+    WelchTest test;
+    test.baselineMean = mean(baseline);
+    test.candidateMean = mean(candidate);
+    if (test.baselineMean != 0.0) test.change = (test.candidateMean - test.baselineMean) / test.baselineMean;
+    if (baseline.size() < 2 || candidate.size() < 2 || test.baselineMean == 0.0) return test;
+    test.valid = true;
+
+    double baselineTerm = variance(baseline, test.baselineMean) / baseline.size();
+    double candidateTerm = variance(candidate, test.candidateMean) / candidate.size();
+    double difference = test.candidateMean - test.baselineMean;
+    double standardError = std::sqrt(baselineTerm + candidateTerm);
+    if (standardError == 0.0) {
+        // Both sides constant: any difference at all is certain.
+        test.pValue = difference == 0.0 ? 1.0 : 0.0;
+        test.ciLow = test.ciHigh = test.change;
+        return test;
+    }
+    test.t = difference / standardError;
+    // Welch-Satterthwaite
+    test.df = (baselineTerm + candidateTerm) * (baselineTerm + candidateTerm) /
+              (baselineTerm * baselineTerm / (baseline.size() - 1) + candidateTerm * candidateTerm / (candidate.size() - 1));
+    test.pValue = twoSidedPValue(test.t, test.df);
+    double margin = criticalT(alpha, test.df) * standardError;
+    test.ciLow = (difference - margin) / test.baselineMean;
+    test.ciHigh = (difference + margin) / test.baselineMean;
+    return test;
+}
+
+ConfidenceInterval meanConfidenceInterval(const std::vector<double>& samples, double alpha) {
+    ConfidenceInterval interval;
+    interval.mean = interval.low = interval.high = mean(samples);
+    if (samples.size() < 2) return interval;
+    double df = samples.size() - 1.0;
+    double margin = criticalT(alpha, df) * std::sqrt(variance(samples, interval.mean) / samples.size());
+    interval.low = interval.mean - margin;
+    interval.high = interval.mean + margin;
+    return interval;
+}
+
+std::vector<MetricComparison> compareResults(const std::vector<StoredResult>& baseline,
+                                             const std::vector<StoredResult>& candidates,
+                                             const CompareOptions& options) {
+    std::map<std::string, const StoredResult*> byId;
+    for (const auto& record : baseline) byId[recordId(record)] = &record;
+
+    std::vector<MetricComparison> comparisons;
+    for (const auto& candidate : candidates) {
+        auto it = byId.find(recordId(candidate));
+        if (it == byId.end()) continue;
+        const StoredResult& base = *it->second;
+        struct Metric {
+            const char* name;
+            const std::vector<double>& baseline;
+            const std::vector<double>& candidate;
+            bool higherIsBetter;
+        };
+        std::string change = runtimeChange(base, candidate);
+        const Metric metrics[] = {{"rps", base.rps, candidate.rps, true},
+                                  {"p50", base.p50, candidate.p50, false},
+                                  {"p99", base.p99, candidate.p99, false}};
+        for (const auto& metric : metrics) {
+            MetricComparison comparison;
+            comparison.environment = candidate.environment;
+            comparison.scenario = candidate.scenario;
+            comparison.metric = metric.name;
+            comparison.test = welchTest(metric.baseline, metric.candidate, options.alpha);
+            comparison.runtimeChange = change;
+            const WelchTest& test = comparison.test;
+            if (change.empty() && test.valid && test.pValue < options.alpha &&
+                std::fabs(test.change) >= options.threshold) {
+                bool better = metric.higherIsBetter ? test.change > 0 : test.change < 0;
+                comparison.improvement = better;
+                comparison.regression = !better;
+            }
+            comparisons.push_back(comparison);
+        }
+    }
+    return comparisons;
+}
+
+int printComparison(std::ostream& out, const std::vector<MetricComparison>& comparisons,
+                    const std::vector<StoredResult>& candidates, const CompareOptions& options) {
+    std::ostringstream criteria;
+    criteria << "Welch's t-test on per-run samples; significant at p < " << options.alpha
+             << " and a change of at least " << options.threshold * 100 << "%";
+    out << criteria.str() << std::endl;
+    out << std::left << std::setw(36) << "Environment"
+        << std::setw(8) << "Metric"
+        << std::setw(13) << "Baseline"
+        << std::setw(13) << "Candidate"
+        << std::setw(10) << "Change"
+        << std::setw(22) << "CI"
+        << std::setw(10) << "p"
+        << "Verdict" << std::endl;
+    out << std::string(124, '-') << std::endl;
+
+    int regressions = 0;
+    for (const auto& comparison : comparisons) {
+        const WelchTest& test = comparison.test;
+        std::ostringstream change, interval, pValue;
+        change << std::showpos << std::fixed << std::setprecision(1) << test.change * 100 << "%";
+        std::string verdict = "no change";
+        if (test.valid) {
+            interval << std::showpos << std::fixed << std::setprecision(1) << "[" << test.ciLow * 100 << "%, "
+                     << test.ciHigh * 100 << "%]";
+            pValue << std::setprecision(3) << test.pValue;
+        } else {
+            interval << "-";
+            pValue << "-";
+            verdict = "n/a (needs 2+ runs)";
+        }
+        if (!comparison.runtimeChange.empty()) {
+            verdict = "not gated (" + comparison.runtimeChange + ")";
+        } else if (comparison.regression) {
+            verdict = "REGRESSION";
+            regressions++;
+        } else if (comparison.improvement) {
+            verdict = "improved";
+        }
+        out << std::left << std::setw(36) << label(comparison.environment, comparison.scenario)
+            << std::setw(8) << comparison.metric
+            << std::setw(13) << std::fixed << std::setprecision(2) << test.baselineMean
+            << std::setw(13) << test.candidateMean
+            << std::setw(10) << change.str()
+            << std::setw(22) << interval.str()
+            << std::setw(10) << pValue.str()
+            << verdict << std::endl;
+    }
+
+    std::vector<std::string> missing;
+    for (const auto& candidate : candidates) {
+        bool compared = std::any_of(comparisons.begin(), comparisons.end(), [&candidate](const MetricComparison& c) {
+            return c.environment == candidate.environment && c.scenario == candidate.scenario;
+        });
+        if (!compared) missing.push_back(label(candidate.environment, candidate.scenario));
+    }
+    size_t ungated = std::count_if(comparisons.begin(), comparisons.end(), [](const MetricComparison& c) {
+        return c.metric == "rps" && !c.runtimeChange.empty();
+    });
+    if (ungated > 0) {
+        out << "Warning: " << ungated << " result(s) ran on a different runtime version than their baseline; "
+            << "their changes are not counted" << std::endl;
+    }
+    if (!missing.empty()) {
+        out << "No baseline on this host for:";
+        for (const auto& name : missing) out << " " << name << ";";
+        out << std::endl;
+    }
+    out << (regressions > 0 ? std::to_string(regressions) + " significant regression(s)" : "No significant regressions")
+        << std::endl;
+    return regressions;
+}
+
+int compareStoredResults(const std::string& storePath, const std::string& baseline, const std::string& candidate,
+                         const CompareOptions& options) {
+    std::vector<StoredResult> history = loadResults(storePath);
+    std::vector<StoredResult> candidates = recordsForCommit(history, candidate);
+    if (candidates.empty()) {
+        throw std::runtime_error("No results for " + candidate + " in " + storePath);
+    }
+    std::vector<StoredResult> baselines =
+        baseline == "previous" ? previousRecords(history, candidates) : recordsForCommit(history, baseline);
+
+    std::cout << "=== Comparison: " << describeCommit(candidates.front()) << " vs ";
+    if (baselines.empty()) {
+        std::cout << baseline << " ===" << std::endl;
+        std::cout << "No baseline results for " << baseline << " in " << storePath << "; nothing to compare" << std::endl;
+        return 0;
+    }
+    std::cout << describeCommit(baselines.front()) << " ===" << std::endl;
+    std::vector<MetricComparison> comparisons = compareResults(baselines, candidates, options);
+    return printComparison(std::cout, comparisons, candidates, options) > 0 ? 2 : 0;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Append-only benchmark history: one NDJSON line per setup, scenario and
+// invocation, carrying the raw per-run samples rather than only their means:
+//
+//   {"recordedAt":1718000000,"commit":"3f2c9e1...","dirty":false,"host":"9c41e2aa",
+//    "hostInfo":"runner-7; AMD EPYC 7763; 4 CPUs; 6.5.0","node":"v22.3.0","bun":"1.1.13",
+//    "runtime":"bun","key":"Hono on Bun|hello|http1|c100|r0","environment":"Hono on Bun","scenario":"hello",
+//    "rps":[41002.1,40877.5,41230.9],"avgLatency":[...],"p50":[...],"p99":[...]}
+//
+// Lines are only ever appended, so stores written on several machines or by
+// several checkouts can simply be concatenated.
+struct StoredResult {
+    long recordedAt = 0;
+    std::string commit;       // git HEAD, or BENCHMARK_COMMIT when set
+    bool dirty = false;       // tracked files had uncommitted changes
+    std::string host;         // fingerprint of hostInfo
+    std::string hostInfo;     // hostname; CPU model; CPU count; kernel release
+    std::string nodeVersion;
+    std::string bunVersion;
+    std::string runtime;      // "node" or "bun": which version above the server ran; empty in older records
+    std::string key;          // what must match for two records to be comparable
+    std::string environment;
+    std::string scenario;
+    std::vector<double> rps;  // one sample per measured run
+    std::vector<double> avgLatency;
+    std::vector<double> p50;
+    std::vector<double> p99;
+};
+
+// Fills commit, dirty, host and hostInfo for records made by this invocation.
+void describeCurrentRun(StoredResult& identity);
+
+// Throws std::runtime_error if the store cannot be written.
+void appendResults(const std::string& path, const std::vector<StoredResult>& records);
+
+// A missing store is empty; unreadable lines are skipped.
+std::vector<StoredResult> loadResults(const std::string& path);
+
+// The latest record per key and host whose commit starts with `commit`; "latest" picks the
+// commit of the last record in the store.
+std::vector<StoredResult> recordsForCommit(const std::vector<StoredResult>& history, const std::string& commit);
+
+// For each candidate, the latest record with the same key and host from another
+// commit, recorded no later than the candidate.
+std::vector<StoredResult> previousRecords(const std::vector<StoredResult>& history,
+                                          const std::vector<StoredResult>& candidates);
+
+// Welch's unequal-variance t-test on the difference of means (candidate - baseline).
+struct WelchTest {
+    bool valid = false;  // both sides have at least two samples
+    double baselineMean = 0.0;
+    double candidateMean = 0.0;
+    double change = 0.0;  // relative to the baseline mean
+    double ciLow = 0.0;   // confidence interval of `change` at 1 - alpha
+    double ciHigh = 0.0;
+    double t = 0.0;
+    double df = 0.0;
+    double pValue = 1.0;  // two-sided
+};
+
+// P(|T| >= t) for Student's t with df degrees of freedom.
+double twoSidedPValue(double t, double df);
+
+WelchTest welchTest(const std::vector<double>& baseline, const std::vector<double>& candidate, double alpha);
+
+// Student's t confidence interval for the mean of `samples` at 1 - alpha; with fewer
+// than two samples it collapses to the mean.
+struct ConfidenceInterval {
+    double mean = 0.0;
+    double low = 0.0;
+    double high = 0.0;
+};
+
+ConfidenceInterval meanConfidenceInterval(const std::vector<double>& samples, double alpha);
+
+struct CompareOptions {
+    double alpha = 0.05;      // significance level
+    double threshold = 0.02;  // relative change below which a significant difference is ignored
+};
+
+struct MetricComparison {
+    std::string environment;
+    std::string scenario;
+    std::string metric;  // "rps", "p50" or "p99"
+    WelchTest test;
+    bool regression = false;
+    bool improvement = false;
+    std::string runtimeChange;  // e.g. "node v20.11.0 -> v22.3.0"; such comparisons are not gated
+};
+
+// Compares every candidate that has a baseline with the same key and host; throughput
+// regresses when it falls, latency when it rises. A candidate whose runtime version
+// differs from its baseline's is compared but never counted as a regression or an
+// improvement, since the change may be the runtime's rather than the commit's.
+std::vector<MetricComparison> compareResults(const std::vector<StoredResult>& baseline,
+                                             const std::vector<StoredResult>& candidates,
+                                             const CompareOptions& options);
+
+// Prints a comparison table and returns the number of regressions.
+int printComparison(std::ostream& out, const std::vector<MetricComparison>& comparisons,
+                    const std::vector<StoredResult>& candidates, const CompareOptions& options);
+
+// benchmark_wrk --compare: compares `candidate` (a commit prefix or "latest")
+// against `baseline` (a commit prefix or "previous") from the store. Returns 2 if
+// anything regressed, 0 otherwise (including when no baseline was recorded);
+// throws std::runtime_error when the candidate has no records.
+int compareStoredResults(const std::string& storePath, const std::string& baseline, const std::string& candidate,
+                         const CompareOptions& options);
@@ -0,0 +1,345 @@
+#include "sample_archive.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "hdr_histogram.h"
+
+namespace {
+
+constexpr size_t kFixedHeaderBytes = 64;
+constexpr uint32_t kVersion = 1;
+// Latencies held at once while windows are sorted; larger ranges take several passes.
+constexpr size_t kMaxBufferedLatencies = 32u << 20;
+
+template <typename T>
+void putField(std::vector<char>& buffer, size_t offset, T value) {
+    std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T readField(const unsigned char* at) {
+    T value;
+    std::memcpy(&value, at, sizeof(T));
+    return value;
+}
+
+bool writeAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool failed(uint16_t status) { return status < 200 || status > 399; }
+
+// Nearest-rank percentile of sorted values.
+double percentileOf(const uint32_t* sorted, size_t count, double percentile) {
+    if (count == 0) return 0.0;
+    size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * count));
+    return sorted[std::min(std::max<size_t>(rank, 1), count) - 1] / 1000.0;
+}
+
+struct WindowCounts {
+    uint64_t completed = 0;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+};
+
+}  // namespace
+
+SampleArchiveWriter::SampleArchiveWriter(const std::string& path, const SampleArchiveInfo& info) {
+    fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) throw std::runtime_error("Cannot create sample archive " + path + ": " + std::strerror(errno));
+
+    std::string names = info.label + '\0';
+    for (const auto& route : info.routes) names += route + '\0';
+    size_t headerBytes = (kFixedHeaderBytes + names.size() + 63) / 64 * 64;
+    std::vector<char> header(headerBytes, 0);
+    std::memcpy(header.data(), "BNCHSMP1", 8);
+    putField<uint32_t>(header, 8, kVersion);
+    putField<uint32_t>(header, 12, sizeof(SampleRecord));
+    putField<uint32_t>(header, 16, static_cast<uint32_t>(headerBytes));
+    putField<uint32_t>(header, 20, static_cast<uint32_t>(info.routes.size()));
+    putField<double>(header, 40, info.durationSec);
+    putField<double>(header, 48, info.rate);
+    putField<uint32_t>(header, 56, static_cast<uint32_t>(info.connections));
+    std::memcpy(header.data() + kFixedHeaderBytes, names.data(), names.size());
+    if (!writeAll(fd, header.data(), header.size())) {
+        std::string reason = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("Cannot write sample archive " + path + ": " + reason);
+    }
+    thread = std::thread([this]() { loop(); });
+}
+
+SampleArchiveWriter::~SampleArchiveWriter() {
+    if (thread.joinable()) {
+        std::string ignored;
+        close(ignored);
+    }
+}
+
+void SampleArchiveWriter::recordStart(uint64_t startNs, double startedAt) {
+    // Positioned writes leave the append offset of the writer thread alone.
+    if (pwrite(fd, &startNs, sizeof(startNs), 24) != sizeof(startNs) ||
+        pwrite(fd, &startedAt, sizeof(startedAt), 32) != sizeof(startedAt)) {
+        startError = std::strerror(errno);
+    }
+}
+
+std::vector<SampleRecord> SampleArchiveWriter::takeBlock() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!spare.empty()) {
+            std::vector<SampleRecord> block = std::move(spare.back());
+            spare.pop_back();
+            return block;
+        }
+    }
+    std::vector<SampleRecord> block;
+    block.reserve(kBlockRecords);
+    return block;
+}
+
+void SampleArchiveWriter::submit(std::vector<SampleRecord>&& block) {
+    if (block.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.push_back(std::move(block));
+    wake.notify_one();
+}
+
+uint64_t SampleArchiveWriter::close(std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+        wake.notify_one();
+    }
+    if (thread.joinable()) thread.join();
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    error = !startError.empty() ? startError : writeError;
+    return written;
+}
+
+void SampleArchiveWriter::loop() {
+    std::vector<std::vector<SampleRecord>> batch;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this]() { return closing || !queue.empty(); });
+        if (queue.empty()) return;  // closing, and everything is written
+        batch.swap(queue);
+        lock.unlock();
+        for (auto& block : batch) {
+            size_t bytes = block.size() * sizeof(SampleRecord);
+            if (writeError.empty() && !writeAll(fd, reinterpret_cast<const char*>(block.data()), bytes)) {
+                writeError = std::strerror(errno);
+            }
+            if (writeError.empty()) written += block.size();
+            block.clear();
+        }
+        lock.lock();
+        for (auto& block : batch) spare.push_back(std::move(block));
+        batch.clear();
+    }
+}
+
+int analyzeSampleArchive(const std::string& path, const SampleAnalysisOptions& options) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < kFixedHeaderBytes) {
+        std::cerr << path << " is not a sample archive" << std::endl;
+        ::close(fd);
+        return 1;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Cannot map " << path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    const auto* base = static_cast<const unsigned char*>(mapped);
+    struct Unmap {
+        void* at;
+        size_t size;
+        ~Unmap() { munmap(at, size); }
+    } unmap{mapped, size};
+
+    uint32_t headerBytes = readField<uint32_t>(base + 16);
+    if (std::memcmp(base, "BNCHSMP1", 8) != 0 || readField<uint32_t>(base + 8) != kVersion ||
+        readField<uint32_t>(base + 12) != sizeof(SampleRecord) || headerBytes < kFixedHeaderBytes || headerBytes > size) {
+        std::cerr << path << " is not a version " << kVersion << " sample archive" << std::endl;
+        return 1;
+    }
+    std::vector<std::string> names;
+    for (size_t at = kFixedHeaderBytes; at < headerBytes && base[at] != '\0';) {
+        const char* name = reinterpret_cast<const char*>(base + at);
+        size_t length = strnlen(name, headerBytes - at);
+        names.emplace_back(name, length);
+        at += length + 1;
+    }
+    std::string label = names.empty() ? "" : names.front();
+    std::vector<std::string> routes(names.size() > 1 ? names.begin() + 1 : names.end(), names.end());
+    uint32_t routeCount = readField<uint32_t>(base + 20);
+    double startedAt = readField<double>(base + 32);
+    double durationSec = readField<double>(base + 40);
+    double rate = readField<double>(base + 48);
+    uint32_t connections = readField<uint32_t>(base + 56);
+
+    const auto* records = reinterpret_cast<const SampleRecord*>(base + headerBytes);
+    size_t count = (size - headerBytes) / sizeof(SampleRecord);
+    int routeFilter = -1;
+    if (!options.route.empty()) {
+        auto it = std::find(routes.begin(), routes.end(), options.route);
+        if (it == routes.end()) {
+            std::cerr << "No route \"" << options.route << "\" in " << path << std::endl;
+            return 1;
+        }
+        routeFilter = static_cast<int>(it - routes.begin());
+    }
+    if (options.windowSec <= 0) {
+        std::cerr << "The window must be longer than 0s" << std::endl;
+        return 1;
+    }
+
+    // Pass 1: per-window counts, the overall and per-route histograms, and the end of the data.
+    uint64_t fromNs = static_cast<uint64_t>(std::max(options.fromSec, 0.0) * 1e9);
+    uint64_t toNs = options.toSec >= 0 ? static_cast<uint64_t>(options.toSec * 1e9) : UINT64_MAX;
+    uint64_t windowNs = std::max<uint64_t>(static_cast<uint64_t>(options.windowSec * 1e9), 1);
+    // Requests that complete during the drain after the deadline count in the last window.
+    uint64_t durationNs = static_cast<uint64_t>(durationSec * 1e9);
+    bool foldTail = options.toSec < 0 && durationNs > fromNs;
+    auto windowOf = [&](uint64_t ns) {
+        if (foldTail && ns >= durationNs) ns = durationNs - 1;
+        return static_cast<size_t>((ns - fromNs) / windowNs);
+    };
+    std::vector<WindowCounts> windows;
+    HdrHistogram overall;
+    std::vector<HdrHistogram> routeLatency(routeFilter < 0 && routeCount > 1 ? routeCount : 0);
+    std::vector<WindowCounts> routeCounts(routeLatency.size());
+    uint64_t lastNs = 0, timeouts = 0, resets = 0;
+    for (size_t i = 0; i < count; i++) {
+        const SampleRecord& record = records[i];
+        if (record.completedNs < fromNs || record.completedNs >= toNs) continue;
+        if (routeFilter >= 0 && record.route != routeFilter) continue;
+        lastNs = std::max(lastNs, record.completedNs);
+        size_t index = windowOf(record.completedNs);
+        if (index >= windows.size()) windows.resize(index + 1);
+        WindowCounts& window = windows[index];
+        if (record.flags & kSampleTimeout) timeouts++;
+        if (record.flags & kSampleReset) resets++;
+        if (failed(record.status)) window.errors++;
+        window.bytes += record.bytes;
+        if (record.status == 0) continue;
+        window.completed++;
+        overall.record(record.latencyUs);
+        if (record.route < routeLatency.size()) {
+            routeLatency[record.route].record(record.latencyUs);
+            routeCounts[record.route].completed++;
+            if (failed(record.status)) routeCounts[record.route].errors++;
+        }
+    }
+    double endSec = toNs != UINT64_MAX ? options.toSec : foldTail ? std::min(lastNs, durationNs) / 1e9 : lastNs / 1e9;
+    double spanSec = std::max(endSec - fromNs / 1e9, 1e-9);
+
+    std::time_t started = static_cast<std::time_t>(startedAt);
+    std::cout << "Sample archive " << path << std::endl;
+    std::cout << "  " << label << ", started " << std::put_time(std::localtime(&started), "%Y-%m-%d %H:%M:%S")
+              << ", " << connections << " connections, "
+              << (rate > 0 ? std::to_string(static_cast<long>(rate)) + " req/s target" : std::string("closed loop"))
+              << std::endl;
+    std::cout << "  " << count << " records";
+    if (!options.route.empty()) std::cout << ", route " << options.route;
+    std::cout << "; " << timeouts << " timeouts, " << resets << " resets in range" << std::endl;
+
+    uint64_t completed = 0, errors = 0, bytes = 0;
+    for (const auto& window : windows) {
+        completed += window.completed;
+        errors += window.errors;
+        bytes += window.bytes;
+    }
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\n" << std::setprecision(1) << fromNs / 1e9 << "s-" << endSec << "s: " << std::setprecision(2)
+              << completed / spanSec << " req/sec, " << errors << " errors, " << bytes / spanSec / 1024 / 1024
+              << "MB/sec" << std::endl;
+    std::cout << "  Latency P50 " << overall.valueAtPercentile(50) / 1000.0 << "ms, P90 "
+              << overall.valueAtPercentile(90) / 1000.0 << "ms, P99 " << overall.valueAtPercentile(99) / 1000.0
+              << "ms, P99.9 " << overall.valueAtPercentile(99.9) / 1000.0 << "ms, max " << overall.max() / 1000.0
+              << "ms" << std::endl;
+    for (size_t r = 0; r < routeLatency.size(); r++) {
+        if (routeCounts[r].completed == 0) continue;
+        std::cout << "  Route " << (r < routes.size() ? routes[r] : std::to_string(r)) << ": "
+                  << routeCounts[r].completed / spanSec << " req/sec, P50 "
+                  << routeLatency[r].valueAtPercentile(50) / 1000.0 << "ms, P99 "
+                  << routeLatency[r].valueAtPercentile(99) / 1000.0 << "ms, errors " << routeCounts[r].errors
+                  << std::endl;
+    }
+    if (windows.empty()) return 0;
+
+    std::cout << "\n" << std::left << std::setw(10) << "Start(s)" << std::setw(10) << "End(s)" << std::setw(12)
+              << "Req/sec" << std::setw(9) << "Errors" << std::setw(10) << "P50 ms" << std::setw(10) << "P90 ms"
+              << std::setw(10) << "P99 ms" << std::setw(11) << "P99.9 ms" << std::setw(10) << "Max ms" << "MB/sec"
+              << std::endl;
+    std::cout << std::string(98, '-') << std::endl;
+
+    // Pass 2, as often as memory needs: scatter each window's latencies into its own
+    // slice, then sort the slices for exact percentiles.
+    std::vector<uint32_t> latencies;
+    std::vector<uint64_t> offsets;
+    for (size_t first = 0; first < windows.size();) {
+        size_t last = first;
+        uint64_t buffered = windows[first].completed;
+        while (last + 1 < windows.size() && buffered + windows[last + 1].completed <= kMaxBufferedLatencies) {
+            buffered += windows[++last].completed;
+        }
+        latencies.assign(buffered, 0);
+        offsets.assign(last - first + 2, 0);
+        for (size_t w = first; w <= last; w++) offsets[w - first + 1] = offsets[w - first] + windows[w].completed;
+        std::vector<uint64_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < count; i++) {
+            const SampleRecord& record = records[i];
+            if (record.status == 0 || record.completedNs < fromNs || record.completedNs >= toNs) continue;
+            if (routeFilter >= 0 && record.route != routeFilter) continue;
+            size_t index = windowOf(record.completedNs);
+            if (index < first || index > last) continue;
+            latencies[fill[index - first]++] = record.latencyUs;
+        }
+        for (size_t w = first; w <= last; w++) {
+            uint32_t* slice = latencies.data() + offsets[w - first];
+            size_t n = windows[w].completed;
+            std::sort(slice, slice + n);
+            double startSec = (fromNs + w * windowNs) / 1e9;
+            double stopSec = std::min((fromNs + (w + 1) * windowNs) / 1e9, endSec);
+            double lengthSec = std::max(stopSec - startSec, 1e-9);
+            std::cout << std::left << std::setprecision(1) << std::setw(10) << startSec << std::setw(10) << stopSec
+                      << std::setprecision(2) << std::setw(12) << n / lengthSec << std::setw(9) << windows[w].errors
+                      << std::setprecision(3) << std::setw(10) << percentileOf(slice, n, 50) << std::setw(10)
+                      << percentileOf(slice, n, 90) << std::setw(10) << percentileOf(slice, n, 99) << std::setw(11)
+                      << percentileOf(slice, n, 99.9) << std::setw(10) << (n > 0 ? slice[n - 1] / 1000.0 : 0.0)
+                      << std::setprecision(2) << windows[w].bytes / lengthSec / 1024 / 1024 << std::endl;
+        }
+        first = last + 1;
+    }
+    return 0;
+}
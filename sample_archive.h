@@ -0,0 +1,96 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Every request of a native run as one fixed-width record, appended to a binary
+// file while the run is in progress, so that windows and percentiles can be cut
+// offline (benchmark_wrk --analyze-samples) without running the load again.
+// Little-endian:
+//
+//   header   0 "BNCHSMP1"   8 u32 version (1)   12 u32 record size (24)
+//           16 u32 header bytes (offset of the first record)   20 u32 routes
+//           24 u64 CLOCK_MONOTONIC ns at the start of the run   32 f64 start, Unix seconds
+//           40 f64 configured duration (s)   48 f64 target rate (0 = closed loop)
+//           56 u32 connections   60 u32 reserved
+//           64 label, then each route name, NUL-terminated, zero-padded to a multiple of 64
+//   record   see SampleRecord
+//
+// Records are appended in blocks per worker thread, so they are in time order
+// within a thread but not across threads. A partial record at the end of the
+// file (an interrupted run) is ignored.
+
+struct SampleRecord {
+    uint64_t completedNs;  // since the start of the run
+    uint32_t latencyUs;    // from the intended send time, as in the run's histograms
+    uint32_t bytes;        // response bytes: HTTP/1.1 including headers, HTTP/2 DATA payload
+    uint16_t status;       // 0 when the request timed out or its stream was reset
+    uint16_t route;
+    uint16_t worker;
+    uint16_t flags;        // kSampleTimeout, kSampleReset
+};
+static_assert(sizeof(SampleRecord) == 24, "SampleRecord is the on-disk layout");
+
+constexpr uint16_t kSampleTimeout = 1;
+constexpr uint16_t kSampleReset = 2;
+
+struct SampleArchiveInfo {
+    std::string label;
+    std::vector<std::string> routes;
+    double durationSec = 0.0;
+    double rate = 0.0;
+    int connections = 0;
+};
+
+// Appends blocks of records to the archive on a thread of its own, so the request
+// loops never wait for the disk. Workers fill a block from takeBlock(), hand it to
+// submit() when it is full, and the emptied block comes back through takeBlock().
+class SampleArchiveWriter {
+public:
+    static constexpr size_t kBlockRecords = 65536;  // 1.5MB per write
+
+    // Throws std::runtime_error when the file cannot be created.
+    SampleArchiveWriter(const std::string& path, const SampleArchiveInfo& info);
+    ~SampleArchiveWriter();
+    SampleArchiveWriter(const SampleArchiveWriter&) = delete;
+    SampleArchiveWriter& operator=(const SampleArchiveWriter&) = delete;
+
+    // Fills in the header's start once the run has one (start is CLOCK_MONOTONIC ns).
+    void recordStart(uint64_t startNs, double startedAt);
+
+    std::vector<SampleRecord> takeBlock();
+    void submit(std::vector<SampleRecord>&& block);
+
+    // Writes what is queued and closes the file. Returns the records written;
+    // `error` is set if a write failed, after which later blocks are dropped.
+    uint64_t close(std::string& error);
+
+private:
+    void loop();
+
+    int fd = -1;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::vector<SampleRecord>> queue;
+    std::vector<std::vector<SampleRecord>> spare;
+    bool closing = false;
+    uint64_t written = 0;
+    std::string writeError;  // the writer thread's
+    std::string startError;  // recordStart()'s
+    std::thread thread;
+};
+
+struct SampleAnalysisOptions {
+    double windowSec = 10.0;
+    double fromSec = 0.0;
+    double toSec = -1.0;  // < 0 = to the end
+    std::string route;    // empty = every route
+};
+
+// Prints the archive's summary over [from, to) and a table of windows; exact
+// percentiles from the mapped file. Returns 0, or 1 with a message on stderr.
+int analyzeSampleArchive(const std::string& path, const SampleAnalysisOptions& options);
@@ -0,0 +1,50 @@
+// Route handlers shared by every server so each framework does identical work
+// per request; the servers only differ in how they route, parse and serialize.
+// The benchmark scenarios (scenarios.cpp) exercise these routes.
+
+const payloadCache = new Map();
+
+// GET /users/:id
+const user = (id) => ({
+  id,
+  name: `user-${id}`,
+  email: `user-${id}@example.com`,
+});
+
+// GET /search?q=&limit=&offset=
+const search = (query) => {
+  const q = String(query.q || "");
+  const limit = Math.min(Math.max(parseInt(query.limit, 10) || 10, 1), 100);
+  const offset = Math.max(parseInt(query.offset, 10) || 0, 0);
+  const results = [];
+  for (let i = 0; i < limit; i++) {
+    results.push({ id: offset + i, title: `${q} result ${offset + i}` });
+  }
+  return { query: q, limit, offset, results };
+};
+
+// POST /echo with {"items":[{"id","name","qty"},...],"pad":"..."}; null if malformed.
+const echo = (body) => {
+  if (!body || !Array.isArray(body.items)) return null;
+  let totalQty = 0;
+  for (const item of body.items) totalQty += Number(item.qty) || 0;
+  return { count: body.items.length, totalQty };
+};
+
+// GET /payload/:kb, roughly kb kilobytes of JSON. The object is built once per
+// size; serializing it is the work being measured.
+const payload = (kb) => {
+  const size = Math.min(Math.max(parseInt(kb, 10) || 1, 1), 1024);
+  let data = payloadCache.get(size);
+  if (!data) {
+    const items = [];
+    for (let i = 0; i < size * 10; i++) {
+      items.push({ id: i, name: `item-${i}`, description: "x".repeat(64) });
+    }
+    data = { size, items };
+    payloadCache.set(size, data);
+  }
+  return data;
+};
+
+module.exports = { user, search, echo, payload };
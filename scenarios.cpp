@@ -0,0 +1,138 @@
+#include "scenarios.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+ScenarioRoute route(const std::string& name, const std::string& method, const std::string& path,
+                    size_t bodyBytes = 0, int weight = 1) {
+    ScenarioRoute r;
+    r.name = name;
+    r.method = method;
+    r.path = path;
+    r.bodyBytes = bodyBytes;
+    r.weight = weight;
+    return r;
+}
+
+std::vector<Scenario> makeBuiltins() {
+    const ScenarioRoute root = route("root", "GET", "/");
+    const ScenarioRoute user = route("user", "GET", "/users/42");
+    const ScenarioRoute search = route("search", "GET", "/search?q=benchmark&limit=20&offset=40");
+    const ScenarioRoute echo1k = route("echo-1k", "POST", "/echo", 1024);
+    const ScenarioRoute echo64k = route("echo-64k", "POST", "/echo", 64 * 1024);
+    const ScenarioRoute echo1m = route("echo-1m", "POST", "/echo", 1024 * 1024);
+    const ScenarioRoute payload64k = route("payload-64k", "GET", "/payload/64");
+
+    auto weighted = [](ScenarioRoute r, int weight) {
+        r.weight = weight;
+        return r;
+    };
+
+    return {
+        {"hello", "GET / returning a small JSON object", {root}},
+        {"params", "GET with a path parameter", {user}},
+        {"query", "GET with query-string parsing and a 20-item result", {search}},
+        {"post-1k", "POST /echo with a 1KB JSON body", {echo1k}},
+        {"post-64k", "POST /echo with a 64KB JSON body", {echo64k}},
+        {"post-1m", "POST /echo with a 1MB JSON body", {echo1m}},
+        {"payload-64k", "GET returning ~64KB of JSON", {payload64k}},
+        {"mixed", "Weighted mix of all routes",
+         {weighted(root, 10), weighted(user, 30), weighted(search, 20), weighted(echo1k, 20),
+          weighted(echo64k, 5), weighted(payload64k, 15)}},
+    };
+}
+
+// Longest run of '=' inside ]...] in the text, so the Lua long string can use one more.
+size_t longBracketLevel(const std::string& text) {
+    size_t level = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] != ']') continue;
+        size_t j = i + 1;
+        while (j < text.size() && text[j] == '=') j++;
+        if (j < text.size() && text[j] == ']') level = std::max(level, j - i);
+    }
+    return level;
+}
+
+}  // namespace
+
+const std::vector<Scenario>& builtinScenarios() {
+    static const std::vector<Scenario> scenarios = makeBuiltins();
+    return scenarios;
+}
+
+const Scenario& findScenario(const std::string& name) {
+    for (const auto& scenario : builtinScenarios()) {
+        if (scenario.name == name) return scenario;
+    }
+    std::string known;
+    for (const auto& scenario : builtinScenarios()) {
+        known += (known.empty() ? "" : ", ") + scenario.name;
+    }
+    throw std::runtime_error("Unknown scenario \"" + name + "\" (known: " + known + ")");
+}
+
+std::string makeJsonBody(size_t bytes) {
+    static const std::string head = "{\"items\":[";
+    static const std::string tail = "],\"pad\":\"\"}";
+    std::string body = head;
+    for (int id = 0;; id++) {
+        std::string item = (id > 0 ? "," : "") + std::string("{\"id\":") + std::to_string(id) +
+                           ",\"name\":\"item-" + std::to_string(id) + "\",\"qty\":" + std::to_string(id % 10 + 1) + "}";
+        if (body.size() + item.size() + tail.size() > bytes) break;
+        body += item;
+    }
+    size_t pad = bytes > body.size() + tail.size() ? bytes - body.size() - tail.size() : 0;
+    body += "],\"pad\":\"" + std::string(pad, 'x') + "\"}";
+    return body;
+}
+
+std::string wrkScenarioScript(const Scenario& scenario) {
+    std::ostringstream lua;
+    lua << "-- Generated by benchmark_wrk for scenario \"" << scenario.name << "\"\n"
+        << "local routes = {}\n"
+        << "local requests = {}\n"
+        << "local total = 0\n"
+        << "local function add(method, path, body, weight)\n"
+        << "  total = total + weight\n"
+        << "  routes[#routes + 1] = {method = method, path = path, body = body, upto = total}\n"
+        << "end\n";
+    for (const auto& r : scenario.routes) {
+        lua << "add(\"" << r.method << "\", \"" << r.path << "\", ";
+        if (r.bodyBytes > 0) {
+            std::string body = makeJsonBody(r.bodyBytes);
+            std::string level(longBracketLevel(body) + 1, '=');
+            lua << "[" << level << "[" << body << "]" << level << "]";
+        } else {
+            lua << "nil";
+        }
+        lua << ", " << r.weight << ")\n";
+    }
+    lua << "init = function(args)\n"
+        << "  for i, r in ipairs(routes) do\n"
+        << "    local headers = nil\n"
+        << "    if r.body then headers = {[\"Content-Type\"] = \"application/json\"} end\n"
+        << "    requests[i] = wrk.format(r.method, r.path, headers, r.body)\n"
+        << "  end\n"
+        << "end\n"
+        << "request = function()\n"
+        << "  local ticket = math.random(total)\n"
+        << "  for i, r in ipairs(routes) do\n"
+        << "    if ticket <= r.upto then return requests[i] end\n"
+        << "  end\n"
+        << "  return requests[#requests]\n"
+        << "end\n";
+    return lua.str();
+}
+
+void summarizeRoute(RouteResult& route) {
+    const HdrHistogram& latency = route.latencyHistogram;
+    route.p50Latency = latency.valueAtPercentile(50) / 1000.0;
+    route.p90Latency = latency.valueAtPercentile(90) / 1000.0;
+    route.p99Latency = latency.valueAtPercentile(99) / 1000.0;
+    route.p999Latency = latency.valueAtPercentile(99.9) / 1000.0;
+    route.maxLatency = latency.max() / 1000.0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "benchmark_types.h"
+
+// One request shape in a workload. Each send picks a route in proportion to its
+// weight; bodyBytes > 0 sends a POST-style JSON body of exactly that many bytes.
+struct ScenarioRoute {
+    std::string name;
+    std::string method = "GET";
+    std::string path;
+    size_t bodyBytes = 0;
+    int weight = 1;
+};
+
+struct Scenario {
+    std::string name;
+    std::string description;
+    std::vector<ScenarioRoute> routes;
+};
+
+// Workloads every server implements identically (see scenario_routes.js):
+// hello, params, query, post-1k, post-64k, post-1m, payload-64k and mixed.
+const std::vector<Scenario>& builtinScenarios();
+
+// Throws std::runtime_error naming the known scenarios when `name` is not one.
+const Scenario& findScenario(const std::string& name);
+
+// Deterministic JSON body of exactly `bytes` bytes in the shape POST /echo expects:
+// {"items":[{"id":0,"name":"item-0","qty":1},...],"pad":"xxxx"}. Sizes below the
+// empty document (21 bytes) return the empty document.
+std::string makeJsonBody(size_t bytes);
+
+// wrk Lua script that sends the scenario's weighted mix (wrk only reports totals).
+std::string wrkScenarioScript(const Scenario& scenario);
+
+// Fills a route's percentiles and max from its latency histogram.
+void summarizeRoute(RouteResult& route);
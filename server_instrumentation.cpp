@@ -0,0 +1,210 @@
+#include "server_instrumentation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <set>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kHeaderBytes = 64;
+constexpr size_t kRecordBytes = 128;
+constexpr uint32_t kFlagGc = 2;
+
+double monotonicSec() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+T readField(const unsigned char* at) {
+    T value;
+    std::memcpy(&value, at, sizeof(T));
+    return value;
+}
+
+uint64_t loadSequence(const unsigned char* at) {
+    return __atomic_load_n(reinterpret_cast<const uint64_t*>(at), __ATOMIC_ACQUIRE);
+}
+
+}  // namespace
+
+void resetInstrumentationDir(const std::string& dir) {
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+}
+
+// Twice per interval is enough to drain each record long before it is overwritten.
+RuntimeMonitor::RuntimeMonitor(const std::string& dir, int intervalMs)
+    : dir(dir), intervalMs(std::max(intervalMs, 1)), pollMs(std::max(intervalMs / 2, 1)) {}
+
+RuntimeMonitor::~RuntimeMonitor() {
+    running = false;
+    if (thread.joinable()) thread.join();
+    for (const auto& ring : rings) munmap(const_cast<unsigned char*>(ring.base), ring.size);
+}
+
+void RuntimeMonitor::start() {
+    mapNewRings();
+    // Only what is published from now on belongs to the window.
+    for (auto& ring : rings) ring.next = loadSequence(ring.base + 32);
+    startedSec = monotonicSec();
+    running = true;
+    thread = std::thread([this]() { loop(); });
+}
+
+std::vector<RuntimeSample> RuntimeMonitor::stop() {
+    stoppedSec = monotonicSec();
+    // One more interval lets the servers publish the one the window ended in.
+    std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs + pollMs));
+    running = false;
+    if (thread.joinable()) thread.join();
+    for (auto& ring : rings) drain(ring);
+
+    std::vector<RuntimeSample> window;
+    for (const auto& sample : samples) {
+        if (sample.monotonicSec > startedSec && sample.monotonicSec - sample.intervalSec < stoppedSec) {
+            window.push_back(sample);
+        }
+    }
+    return window;
+}
+
+void RuntimeMonitor::mapNewRings() {
+    std::set<std::string> known;
+    for (const auto& ring : rings) known.insert(ring.path);
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        const std::string path = entry.path().string();
+        if (entry.path().extension() != ".ring" || known.count(path)) continue;
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) continue;
+        struct stat info;
+        void* base = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= kHeaderBytes) {
+            base = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (base == MAP_FAILED) continue;
+
+        Ring ring;
+        ring.path = path;
+        ring.base = static_cast<const unsigned char*>(base);
+        ring.size = info.st_size;
+        // A header that is not complete yet is tried again on the next scan.
+        bool valid = std::memcmp(ring.base, "BNCHRNG1", 8) == 0 && readField<uint32_t>(ring.base + 8) == 1 &&
+                     readField<uint32_t>(ring.base + 12) == kRecordBytes;
+        ring.capacity = valid ? readField<uint32_t>(ring.base + 16) : 0;
+        if (!valid || ring.capacity == 0 || ring.size < kHeaderBytes + ring.capacity * kRecordBytes) {
+            munmap(base, ring.size);
+            continue;
+        }
+        ring.pid = static_cast<int>(readField<uint32_t>(ring.base + 20));
+        ring.gcObserved = (readField<uint32_t>(ring.base + 24) & kFlagGc) != 0;
+        ring.runtime.assign(reinterpret_cast<const char*>(ring.base + 40), strnlen(reinterpret_cast<const char*>(ring.base + 40), 24));
+        rings.push_back(ring);
+    }
+}
+
+void RuntimeMonitor::drain(Ring& ring) {
+    uint64_t written = loadSequence(ring.base + 32);
+    // Records older than one lap have been overwritten.
+    if (written > ring.next + ring.capacity) ring.next = written - ring.capacity;
+    for (; ring.next < written; ring.next++) {
+        const unsigned char* record = ring.base + kHeaderBytes + (ring.next % ring.capacity) * kRecordBytes;
+        uint64_t expected = ring.next + 1;
+        if (loadSequence(record) != expected) continue;
+        RuntimeSample sample;
+        sample.pid = ring.pid;
+        sample.gcObserved = ring.gcObserved;
+        sample.runtime = ring.runtime;
+        sample.monotonicSec = readField<double>(record + 8) / 1000.0;
+        sample.intervalSec = readField<double>(record + 16) / 1000.0;
+        sample.loopDelayMeanMs = readField<double>(record + 24);
+        sample.loopDelayP50Ms = readField<double>(record + 32);
+        sample.loopDelayP99Ms = readField<double>(record + 40);
+        sample.loopDelayMaxMs = readField<double>(record + 48);
+        sample.gcCount = readField<double>(record + 56);
+        sample.gcPauseMs = readField<double>(record + 64);
+        sample.gcMaxPauseMs = readField<double>(record + 72);
+        sample.activeHandles = readField<double>(record + 80);
+        sample.heapUsedMb = readField<double>(record + 88);
+        sample.loopUtilization = readField<double>(record + 96);
+        if (loadSequence(record + 104) != expected) continue;  // torn
+        samples.push_back(sample);
+    }
+}
+
+void RuntimeMonitor::loop() {
+    auto lastScan = std::chrono::steady_clock::now();
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(pollMs));
+        if (std::chrono::steady_clock::now() - lastScan >= std::chrono::seconds(1)) {
+            // Rings that appear mid-window (a restarted worker) start from their first record.
+            mapNewRings();
+            lastScan = std::chrono::steady_clock::now();
+        }
+        for (auto& ring : rings) drain(ring);
+    }
+}
+
+ServerRuntimeStats summarizeRuntime(const std::vector<RuntimeSample>& samples,
+                                    const std::vector<LatencyBucket>& buckets) {
+    ServerRuntimeStats stats;
+    if (samples.empty()) return stats;
+    stats.valid = true;
+    stats.samples = samples.size();
+    stats.runtime = samples.front().runtime;
+    std::map<int, double> covered;  // seconds reported per process
+    double loopDelaySum = 0.0, utilizationSum = 0.0;
+    for (const auto& sample : samples) {
+        covered[sample.pid] += sample.intervalSec;
+        stats.gcObserved = stats.gcObserved || sample.gcObserved;
+        loopDelaySum += sample.loopDelayMeanMs;
+        utilizationSum += sample.loopUtilization;
+        stats.loopDelayP99Ms = std::max(stats.loopDelayP99Ms, sample.loopDelayP99Ms);
+        stats.loopDelayMaxMs = std::max(stats.loopDelayMaxMs, sample.loopDelayMaxMs);
+        stats.gcCount += static_cast<long>(sample.gcCount);
+        stats.gcPauseMs += sample.gcPauseMs;
+        stats.gcMaxPauseMs = std::max(stats.gcMaxPauseMs, sample.gcMaxPauseMs);
+        stats.maxActiveHandles = std::max(stats.maxActiveHandles, static_cast<int>(sample.activeHandles));
+        stats.maxHeapUsedMb = std::max(stats.maxHeapUsedMb, sample.heapUsedMb);
+    }
+    stats.processes = covered.size();
+    stats.loopDelayMeanMs = loopDelaySum / samples.size();
+    stats.loopUtilization = utilizationSum / samples.size();
+    double coveredSec = 0.0;
+    for (const auto& [pid, seconds] : covered) coveredSec += seconds;
+    stats.gcPauseShare = coveredSec > 0 ? stats.gcPauseMs / (coveredSec * 1000.0) : 0.0;
+
+    if (buckets.size() < 2) return stats;
+    std::vector<double> p99s;
+    for (const auto& bucket : buckets) p99s.push_back(bucket.p99Latency);
+    std::sort(p99s.begin(), p99s.end());
+    double median = p99s[p99s.size() / 2];
+    for (const auto& bucket : buckets) {
+        if (median <= 0 || bucket.p99Latency <= 2 * median) continue;
+        stats.p99Spikes++;
+        double excess = bucket.p99Latency - median;
+        double gcPause = 0.0, loopDelay = 0.0;
+        for (const auto& sample : samples) {
+            bool overlaps = sample.monotonicSec > bucket.startSec && sample.monotonicSec - sample.intervalSec < bucket.endSec;
+            if (!overlaps) continue;
+            gcPause = std::max(gcPause, sample.gcMaxPauseMs);
+            loopDelay = std::max(loopDelay, sample.loopDelayMaxMs);
+        }
+        if (gcPause >= excess / 2) {
+            stats.spikesWithGc++;
+        } else if (loopDelay >= excess / 2) {
+            stats.spikesWithLoopStall++;
+        }
+    }
+    return stats;
+}
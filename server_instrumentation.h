@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_types.h"
+
+// Reads what server_instrumentation.js publishes. Every server process writes
+// its own ring file, <dir>/<pid>.ring, little-endian:
+//
+//   header (64 bytes)   0 "BNCHRNG1"   8 u32 version (1)   12 u32 record size (128)
+//                      16 u32 capacity  20 u32 pid  24 u32 flags  28 u32 interval ms
+//                      32 u64 records written  40 runtime name, NUL-padded
+//   record i at 64 + (i % capacity) * 128
+//                       0 u64 i + 1    8 f64 CLOCK_MONOTONIC ms   16 f64 interval ms
+//                      24 f64 loop delay mean, 32 P50, 40 P99, 48 max (ms)
+//                      56 f64 GC pauses   64 f64 GC pause ms   72 f64 longest GC pause ms
+//                      80 f64 active handles   88 f64 heap used MB   96 f64 event-loop utilization
+//                     104 u64 i + 1 again; a record whose two copies differ was read mid-write
+//
+// The rings are mapped and read from memory, so polling them costs no syscalls
+// (new files are looked for once a second).
+
+struct RuntimeSample {
+    int pid = 0;
+    double monotonicSec = 0.0;  // end of the interval
+    double intervalSec = 0.0;
+    double loopDelayMeanMs = 0.0;
+    double loopDelayP50Ms = 0.0;
+    double loopDelayP99Ms = 0.0;
+    double loopDelayMaxMs = 0.0;
+    double gcCount = 0.0;
+    double gcPauseMs = 0.0;
+    double gcMaxPauseMs = 0.0;
+    double activeHandles = 0.0;
+    double heapUsedMb = 0.0;
+    double loopUtilization = 0.0;
+    bool gcObserved = false;
+    std::string runtime;
+};
+
+// Removes the rings of an earlier server and creates `dir` for the next one.
+void resetInstrumentationDir(const std::string& dir);
+
+// Polls every ring in `dir` on a background thread between start() and stop();
+// `intervalMs` is the servers' BENCH_INSTRUMENT_INTERVAL_MS.
+class RuntimeMonitor {
+public:
+    RuntimeMonitor(const std::string& dir, int intervalMs);
+    ~RuntimeMonitor();
+    RuntimeMonitor(const RuntimeMonitor&) = delete;
+    RuntimeMonitor& operator=(const RuntimeMonitor&) = delete;
+
+    void start();
+    // Samples whose interval overlaps the window between start() and stop().
+    std::vector<RuntimeSample> stop();
+
+private:
+    struct Ring {
+        std::string path;
+        const unsigned char* base = nullptr;
+        size_t size = 0;
+        uint32_t capacity = 0;
+        uint64_t next = 0;  // first record not read yet
+        int pid = 0;
+        bool gcObserved = false;
+        std::string runtime;
+    };
+
+    void mapNewRings();
+    void drain(Ring& ring);
+    void loop();
+
+    std::string dir;
+    int intervalMs;
+    int pollMs;
+    std::vector<Ring> rings;
+    std::vector<RuntimeSample> samples;  // written by the polling thread, read after join
+    std::thread thread;
+    std::atomic<bool> running{false};
+    double startedSec = 0.0;
+    double stoppedSec = 0.0;
+};
+
+// Summary of one measured window; `buckets` (may be empty) attribute client P99 spikes.
+ServerRuntimeStats summarizeRuntime(const std::vector<RuntimeSample>& samples,
+                                    const std::vector<LatencyBucket>& buckets);
@@ -0,0 +1,146 @@
+// Optional runtime instrumentation shared by the servers. When the orchestrator
+// sets BENCH_INSTRUMENT_DIR, every server process publishes its event-loop delay,
+// GC pauses, active handles, heap use and event-loop utilization once per
+// BENCH_INSTRUMENT_INTERVAL_MS into <dir>/<pid>.ring: a fixed-size ring of
+// records, normally on /dev/shm, that the orchestrator maps and reads without
+// syscalls. server_instrumentation.h describes the layout.
+const fs = require("node:fs");
+const path = require("node:path");
+const perfHooks = require("node:perf_hooks");
+
+const HEADER_BYTES = 64;
+const RECORD_BYTES = 128;
+const CAPACITY = 4096;
+const RESOLUTION_MS = 10;
+
+const FLAG_LOOP_HISTOGRAM = 1; // monitorEventLoopDelay; timer drift otherwise
+const FLAG_GC = 2;
+const FLAG_HANDLES = 4;
+const FLAG_ELU = 8;
+
+const nowMs = () => Number(process.hrtime.bigint()) / 1e6; // CLOCK_MONOTONIC, like the orchestrator
+
+// Returns a function that yields [mean, p50, p99, max] delay in ms since its last call.
+const loopDelayMonitor = () => {
+  try {
+    const histogram = perfHooks.monitorEventLoopDelay({ resolution: RESOLUTION_MS });
+    histogram.enable();
+    // The histogram records whole timer periods; the delay is what exceeds the resolution.
+    const delay = (ns) => (Number.isFinite(ns) ? Math.max(ns / 1e6 - RESOLUTION_MS, 0) : 0);
+    const read = () => {
+      const values = histogram.count > 0
+        ? [histogram.mean, histogram.percentile(50), histogram.percentile(99), histogram.max].map(delay)
+        : [0, 0, 0, 0];
+      histogram.reset();
+      return values;
+    };
+    return { read, flags: FLAG_LOOP_HISTOGRAM };
+  } catch {
+    // Runtimes without the histogram: how late a RESOLUTION_MS timer fires.
+    const delays = [];
+    let expected = nowMs() + RESOLUTION_MS;
+    setInterval(() => {
+      const now = nowMs();
+      delays.push(Math.max(now - expected, 0));
+      expected = now + RESOLUTION_MS;
+    }, RESOLUTION_MS).unref();
+    const read = () => {
+      if (delays.length === 0) return [0, 0, 0, 0];
+      const sorted = delays.sort((a, b) => a - b);
+      const at = (p) => sorted[Math.min(sorted.length - 1, Math.floor(p * sorted.length))];
+      const mean = sorted.reduce((sum, value) => sum + value, 0) / sorted.length;
+      const values = [mean, at(0.5), at(0.99), sorted[sorted.length - 1]];
+      delays.length = 0;
+      return values;
+    };
+    return { read, flags: 0 };
+  }
+};
+
+const activeHandles = () => {
+  if (typeof process.getActiveResourcesInfo === "function") return process.getActiveResourcesInfo().length;
+  if (typeof process._getActiveHandles === "function") return process._getActiveHandles().length;
+  return 0;
+};
+
+const start = (dir, intervalMs) => {
+  fs.mkdirSync(dir, { recursive: true });
+  const fd = fs.openSync(path.join(dir, `${process.pid}.ring`), "w+");
+  fs.ftruncateSync(fd, HEADER_BYTES + RECORD_BYTES * CAPACITY);
+
+  const loop = loopDelayMonitor();
+  let flags = loop.flags;
+  let gcCount = 0, gcPauseMs = 0, gcMaxPauseMs = 0;
+  try {
+    if (perfHooks.PerformanceObserver.supportedEntryTypes.includes("gc")) {
+      new perfHooks.PerformanceObserver((list) => {
+        for (const entry of list.getEntries()) {
+          gcCount++;
+          gcPauseMs += entry.duration;
+          gcMaxPauseMs = Math.max(gcMaxPauseMs, entry.duration);
+        }
+      }).observe({ entryTypes: ["gc"] });
+      flags |= FLAG_GC;
+    }
+  } catch {}
+  if (typeof process.getActiveResourcesInfo === "function" || typeof process._getActiveHandles === "function") {
+    flags |= FLAG_HANDLES;
+  }
+  const elu = perfHooks.performance && perfHooks.performance.eventLoopUtilization;
+  if (typeof elu === "function") flags |= FLAG_ELU;
+
+  const runtime = process.versions.bun ? `bun ${process.versions.bun}` : `node ${process.versions.node}`;
+  const header = Buffer.alloc(HEADER_BYTES);
+  header.write("BNCHRNG1", 0, "latin1");
+  header.writeUInt32LE(1, 8); // version
+  header.writeUInt32LE(RECORD_BYTES, 12);
+  header.writeUInt32LE(CAPACITY, 16);
+  header.writeUInt32LE(process.pid, 20);
+  header.writeUInt32LE(flags, 24);
+  header.writeUInt32LE(intervalMs, 28);
+  header.writeBigUInt64LE(0n, 32); // records written
+  header.write(runtime.slice(0, 23), 40, "latin1");
+  fs.writeSync(fd, header, 0, HEADER_BYTES, 0);
+
+  const record = Buffer.alloc(RECORD_BYTES);
+  let written = 0n;
+  let last = nowMs();
+  let lastElu = typeof elu === "function" ? elu.call(perfHooks.performance) : null;
+  const publish = () => {
+    const now = nowMs();
+    const [mean, p50, p99, max] = loop.read();
+    let utilization = 0;
+    if (lastElu) {
+      const current = elu.call(perfHooks.performance);
+      utilization = elu.call(perfHooks.performance, current, lastElu).utilization;
+      lastElu = current;
+    }
+    const seq = written + 1n;
+    // seq at both ends: a reader that sees different values caught the record mid-write.
+    record.writeBigUInt64LE(seq, 0);
+    const values = [now, now - last, mean, p50, p99, max, gcCount, gcPauseMs, gcMaxPauseMs, activeHandles(),
+                    process.memoryUsage().heapUsed / (1024 * 1024), utilization];
+    values.forEach((value, i) => record.writeDoubleLE(value, 8 + i * 8));
+    record.writeBigUInt64LE(seq, 104);
+    fs.writeSync(fd, record, 0, RECORD_BYTES, HEADER_BYTES + Number(written % BigInt(CAPACITY)) * RECORD_BYTES);
+    written = seq;
+    header.writeBigUInt64LE(written, 32);
+    fs.writeSync(fd, header, 32, 8, 32);
+    last = now;
+    gcCount = 0;
+    gcPauseMs = 0;
+    gcMaxPauseMs = 0;
+  };
+  setInterval(publish, intervalMs).unref();
+};
+
+const dir = process.env.BENCH_INSTRUMENT_DIR;
+// A cluster primary only hands connections to its workers; they report for it.
+const clusterPrimary = Number(process.env.CLUSTER_WORKERS) > 1 && require("node:cluster").isPrimary;
+if (dir && !clusterPrimary) {
+  try {
+    start(dir, Math.max(Number(process.env.BENCH_INSTRUMENT_INTERVAL_MS) || 100, 10));
+  } catch (err) {
+    console.error(`Instrumentation disabled: ${err.message}`);
+  }
+}
@@ -0,0 +1,22 @@
+// Transport shared by the servers. The orchestrator sets SERVER_TRANSPORT to
+// http (the default), https or h2, and for the TLS transports points
+// TLS_CERT_FILE / TLS_KEY_FILE at a PEM certificate and key. h2 is HTTP/2 over
+// TLS, negotiated with ALPN; the load generator never uses cleartext h2c.
+const fs = require("node:fs");
+
+const transport = process.env.SERVER_TRANSPORT || "http";
+if (!["http", "https", "h2"].includes(transport)) {
+  console.error(`Unknown SERVER_TRANSPORT "${transport}"`);
+  process.exit(1);
+}
+
+// { key, cert } for the TLS transports, null for plain HTTP.
+const tlsOptions = () => {
+  if (transport === "http") return null;
+  return {
+    key: fs.readFileSync(process.env.TLS_KEY_FILE),
+    cert: fs.readFileSync(process.env.TLS_CERT_FILE),
+  };
+};
+
+module.exports = { transport, tlsOptions };
@@ -0,0 +1,33 @@
+// Multi-process support shared by the servers. The orchestrator picks one of two
+// modes per setup:
+//   REUSE_PORT=1        it starts N copies of the server, each binding its own
+//                       SO_REUSEPORT socket; the kernel spreads connections.
+//   CLUSTER_WORKERS=N   it starts one copy, which forks N node:cluster workers
+//                       sharing a listener owned by the primary.
+// Either way every process is in the orchestrator-created process group, which
+// is what gets SIGTERM at the end of a run.
+const cluster = require("node:cluster");
+
+const reusePort = process.env.REUSE_PORT === "1";
+const clusterWorkers = Math.max(Number(process.env.CLUSTER_WORKERS) || 1, 1);
+
+// Calls start({ reusePort }) in every process that should serve requests.
+const runWorkers = (start) => {
+  if (clusterWorkers <= 1 || !cluster.isPrimary) {
+    start({ reusePort });
+    return;
+  }
+
+  let alive = clusterWorkers;
+  for (let i = 0; i < clusterWorkers; i++) cluster.fork();
+  cluster.on("exit", () => {
+    if (--alive === 0) process.exit(0);
+  });
+  const forward = (signal) => {
+    for (const worker of Object.values(cluster.workers)) worker.process.kill(signal);
+  };
+  process.on("SIGTERM", () => forward("SIGTERM"));
+  process.on("SIGINT", () => forward("SIGINT"));
+};
+
+module.exports = { runWorkers };
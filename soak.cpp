@@ -0,0 +1,169 @@
+#include "soak.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#include "json_value.h"
+#include "results_store.h"
+
+namespace {
+
+std::string percent(double fraction) {
+    std::ostringstream text;
+    text << std::showpos << std::fixed << std::setprecision(1) << fraction * 100 << "%/h";
+    return text.str();
+}
+
+std::string verdict(const SoakResult& result) {
+    if (result.serverExited) return "SERVER EXITED";
+    std::string text;
+    if (result.memoryGrowth) text = "MEMORY GROWTH";
+    if (result.latencyDrift) text += text.empty() ? "P99 DRIFT" : ", P99 DRIFT";
+    return text.empty() ? "ok" : text;
+}
+
+void writeTrend(std::ostream& out, const TrendFit& fit) {
+    if (!fit.valid) {
+        out << "null";
+        return;
+    }
+    out << "{\"points\": " << fit.points
+        << ", \"intercept\": " << fit.intercept
+        << ", \"slopePerHour\": " << fit.slopePerHour
+        << ", \"growthPerHour\": " << fit.growthPerHour
+        << ", \"rSquared\": " << fit.rSquared
+        << ", \"pValue\": " << fit.pValue << "}";
+}
+
+}  // namespace
+
+TrendFit fitTrend(const std::vector<double>& hours, const std::vector<double>& values) {
+    TrendFit fit;
+    size_t n = std::min(hours.size(), values.size());
+    fit.points = static_cast<int>(n);
+    if (n < 3) return fit;
+    double meanX = 0.0, meanY = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        meanX += hours[i];
+        meanY += values[i];
+    }
+    meanX /= n;
+    meanY /= n;
+    double sxx = 0.0, sxy = 0.0, syy = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sxx += (hours[i] - meanX) * (hours[i] - meanX);
+        sxy += (hours[i] - meanX) * (values[i] - meanY);
+        syy += (values[i] - meanY) * (values[i] - meanY);
+    }
+    if (sxx <= 0.0) return fit;
+    fit.valid = true;
+    fit.slopePerHour = sxy / sxx;
+    fit.intercept = meanY + fit.slopePerHour * (hours.front() - meanX);
+    fit.growthPerHour = fit.intercept > 0 ? fit.slopePerHour / fit.intercept : 0.0;
+    double residual = std::max(syy - fit.slopePerHour * sxy, 0.0);
+    fit.rSquared = syy > 0 ? 1.0 - residual / syy : 0.0;
+    // A perfectly straight line has no residual; treat any slope on it as significant.
+    double standardError = std::sqrt(residual / (n - 2) / sxx);
+    if (standardError > 0) {
+        fit.pValue = twoSidedPValue(std::fabs(fit.slopePerHour / standardError), static_cast<double>(n - 2));
+    } else {
+        fit.pValue = fit.slopePerHour != 0.0 ? 0.0 : 1.0;
+    }
+    return fit;
+}
+
+void analyzeSoak(SoakResult& result, const SoakOptions& options) {
+    size_t skip = static_cast<size_t>(result.windows.size() * options.settleFraction);
+    std::vector<double> hours, rps, p99, rssHours, rss;
+    for (size_t i = skip; i < result.windows.size(); i++) {
+        const SoakWindow& window = result.windows[i];
+        double hour = (window.startSec + window.endSec) / 2.0 / 3600.0;
+        hours.push_back(hour);
+        rps.push_back(window.requestsPerSecond);
+        p99.push_back(window.p99Latency);
+        if (window.rssMb > 0) {
+            rssHours.push_back(hour);
+            rss.push_back(window.rssMb);
+        }
+    }
+    result.rpsTrend = fitTrend(hours, rps);
+    result.p99Trend = fitTrend(hours, p99);
+    result.rssTrend = fitTrend(rssHours, rss);
+    result.memoryGrowth = result.rssTrend.valid && result.rssTrend.pValue < options.alpha &&
+                          result.rssTrend.growthPerHour > options.rssGrowthLimit;
+    result.latencyDrift = result.p99Trend.valid && result.p99Trend.pValue < options.alpha &&
+                          result.p99Trend.growthPerHour > options.p99GrowthLimit;
+}
+
+void printSoakReport(std::ostream& out, const std::vector<SoakResult>& results, const SoakOptions& options) {
+    if (results.empty()) return;
+    out << "\nSoak Test (trends fitted after the first " << std::fixed << std::setprecision(0)
+        << options.settleFraction * 100 << "% of windows; flagged when p < " << std::setprecision(2) << options.alpha
+        << " and RSS grows > " << std::setprecision(0) << options.rssGrowthLimit * 100 << "%/h or P99 > "
+        << options.p99GrowthLimit * 100 << "%/h):" << std::endl;
+    out << std::left << std::setw(30) << "Environment"
+        << std::setw(10) << "Duration"
+        << std::setw(12) << "Req/s/h"
+        << std::setw(18) << "P99 first-last"
+        << std::setw(12) << "P99/h"
+        << std::setw(18) << "RSS MB first-last"
+        << std::setw(12) << "RSS/h"
+        << "Verdict" << std::endl;
+    out << std::string(125, '-') << std::endl;
+    for (const auto& result : results) {
+        std::string label = result.scenario == "hello" ? result.environment
+                                                       : result.environment + " [" + result.scenario + "]";
+        std::ostringstream duration, p99Range, rssRange;
+        duration << std::fixed << std::setprecision(1) << result.durationSec / 60.0 << "m";
+        if (!result.windows.empty()) {
+            p99Range << std::fixed << std::setprecision(2) << result.windows.front().p99Latency << "-"
+                     << result.windows.back().p99Latency;
+            rssRange << std::fixed << std::setprecision(1) << result.windows.front().rssMb << "-"
+                     << result.windows.back().rssMb;
+        }
+        out << std::left << std::setw(30) << label
+            << std::setw(10) << duration.str()
+            << std::setw(12) << (result.rpsTrend.valid ? percent(result.rpsTrend.growthPerHour) : "-")
+            << std::setw(18) << p99Range.str()
+            << std::setw(12) << (result.p99Trend.valid ? percent(result.p99Trend.growthPerHour) : "-")
+            << std::setw(18) << rssRange.str()
+            << std::setw(12) << (result.rssTrend.valid ? percent(result.rssTrend.growthPerHour) : "-")
+            << verdict(result) << std::endl;
+    }
+}
+
+void writeSoakJson(std::ostream& out, const std::vector<SoakResult>& results, const std::string& indent) {
+    out << "[";
+    for (size_t i = 0; i < results.size(); i++) {
+        const SoakResult& result = results[i];
+        out << (i > 0 ? "," : "") << "\n" << indent << "  {\"environment\": " << jsonString(result.environment)
+            << ", \"scenario\": " << jsonString(result.scenario)
+            << ", \"durationSec\": " << result.durationSec
+            << ", \"serverExited\": " << (result.serverExited ? "true" : "false")
+            << ", \"memoryGrowth\": " << (result.memoryGrowth ? "true" : "false")
+            << ", \"latencyDrift\": " << (result.latencyDrift ? "true" : "false");
+        if (!result.sampleFile.empty()) out << ", \"sampleFile\": " << jsonString(result.sampleFile);
+        out << ",\n" << indent << "   \"rpsTrend\": ";
+        writeTrend(out, result.rpsTrend);
+        out << ", \"p99Trend\": ";
+        writeTrend(out, result.p99Trend);
+        out << ", \"rssTrend\": ";
+        writeTrend(out, result.rssTrend);
+        out << ",\n" << indent << "   \"windows\": [";
+        for (size_t w = 0; w < result.windows.size(); w++) {
+            const SoakWindow& window = result.windows[w];
+            out << (w > 0 ? ", " : "") << "{\"start\": " << window.startSec
+                << ", \"end\": " << window.endSec
+                << ", \"rps\": " << window.requestsPerSecond
+                << ", \"p50\": " << window.p50Latency
+                << ", \"p99\": " << window.p99Latency
+                << ", \"p999\": " << window.p999Latency
+                << ", \"errors\": " << window.errors
+                << ", \"rssMb\": " << window.rssMb << "}";
+        }
+        out << "]}";
+    }
+    out << (results.empty() ? "" : "\n" + indent) << "]";
+}
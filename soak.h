@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Soak mode: one long run per setup against a single server. It records a time
+// series of fixed windows instead of one average over the run. Each window keeps
+// only its summary, so memory stays flat however long the run is; the window
+// histograms go to the timeline file. Trend lines fitted to server RSS and P99
+// flag memory leaks and latency drift that a short run averages away.
+
+struct SoakWindow {
+    double startSec = 0.0;  // from the start of the soak load
+    double endSec = 0.0;
+    double requestsPerSecond = 0.0;
+    double p50Latency = 0.0;
+    double p99Latency = 0.0;
+    double p999Latency = 0.0;
+    int errors = 0;
+    double rssMb = 0.0;  // server process group, at the end of the window; 0 = not sampled
+};
+
+// Least-squares line through (hours, value) points.
+struct TrendFit {
+    bool valid = false;          // at least three points with spread in time
+    int points = 0;
+    double intercept = 0.0;      // fitted value at the first point's time
+    double slopePerHour = 0.0;
+    double growthPerHour = 0.0;  // slopePerHour relative to the intercept
+    double rSquared = 0.0;
+    double pValue = 1.0;         // two-sided t-test of slope != 0
+};
+
+TrendFit fitTrend(const std::vector<double>& hours, const std::vector<double>& values);
+
+struct SoakOptions {
+    double alpha = 0.05;           // significance of a trend
+    double rssGrowthLimit = 0.10;  // fitted RSS growth per hour that counts as a leak
+    double p99GrowthLimit = 0.20;  // fitted P99 growth per hour that counts as drift
+    double settleFraction = 0.10;  // leading share of windows left out of the fits
+};
+
+struct SoakResult {
+    std::string environment;
+    std::string scenario;
+    double durationSec = 0.0;   // load actually run
+    bool serverExited = false;  // the server died before the soak ended
+    std::string sampleFile;     // per-request archive, with sampleArchiveDir
+    std::vector<SoakWindow> windows;
+    TrendFit rpsTrend;
+    TrendFit p99Trend;
+    TrendFit rssTrend;
+    bool memoryGrowth = false;
+    bool latencyDrift = false;
+
+    bool flagged() const { return memoryGrowth || latencyDrift || serverExited; }
+};
+
+// Fits the trends over the windows after the settle fraction and sets the flags.
+void analyzeSoak(SoakResult& result, const SoakOptions& options);
+
+void printSoakReport(std::ostream& out, const std::vector<SoakResult>& results, const SoakOptions& options);
+
+// JSON array of soak results with their windows; `indent` prefixes every line.
+void writeSoakJson(std::ostream& out, const std::vector<SoakResult>& results, const std::string& indent);
@@ -0,0 +1,143 @@
+#include "timeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "json_value.h"
+
+namespace {
+
+// The reader only has to understand what TimelineWriter produces: flat objects
+// with numeric fields and one string field.
+double numberField(const std::string& line, const char* key, double fallback = 0.0) {
+    std::string pattern = std::string("\"") + key + "\":";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos) return fallback;
+    return std::strtod(line.c_str() + pos + pattern.size(), nullptr);
+}
+
+bool stringField(const std::string& line, const char* key, std::string& value) {
+    std::string pattern = std::string("\"") + key + "\":\"";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos) return false;
+    size_t begin = pos + pattern.size();
+    size_t end = line.find('"', begin);
+    if (end == std::string::npos) return false;
+    value.assign(line, begin, end - begin);
+    return true;
+}
+
+struct BucketRow {
+    double startSec = 0.0;
+    double endSec = 0.0;
+    double requests = 0.0;
+    double errors = 0.0;
+};
+
+}  // namespace
+
+TimelineWriter::TimelineWriter(const std::string& path, const std::string& label, int intervalMs, double rate)
+    : out(path) {
+    out << "{\"type\":\"header\",\"label\":" << jsonString(label) << ",\"intervalMs\":" << intervalMs
+        << ",\"rate\":" << rate << "}\n";
+}
+
+void TimelineWriter::write(const TimelineBucket& bucket) {
+    double span = std::max(bucket.endSec - bucket.startSec, 1e-9);
+    const HdrHistogram& latency = *bucket.latency;
+    out << "{\"t\":" << bucket.startSec
+        << ",\"end\":" << bucket.endSec
+        << ",\"requests\":" << bucket.completed
+        << ",\"errors\":" << bucket.errors
+        << ",\"bytes\":" << bucket.bytesRead
+        << ",\"rps\":" << bucket.completed / span
+        << ",\"p50\":" << latency.valueAtPercentile(50) / 1000.0
+        << ",\"p90\":" << latency.valueAtPercentile(90) / 1000.0
+        << ",\"p99\":" << latency.valueAtPercentile(99) / 1000.0
+        << ",\"max\":" << latency.max() / 1000.0
+        << ",\"hist\":\"" << latency.serialize() << "\"}\n";
+    out.flush();
+}
+
+SteadyState analyzeTimeline(const std::string& path, double tolerance) {
+    SteadyState steady;
+    std::ifstream in(path);
+    if (!in) return steady;
+
+    // Pass 1: counters only, to decide which buckets are stable.
+    std::vector<BucketRow> rows;
+    double intervalSec = 0.0;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find("\"type\":\"header\"") != std::string::npos) {
+            intervalSec = numberField(line, "intervalMs") / 1000.0;
+            continue;
+        }
+        if (line.find("\"requests\":") == std::string::npos) continue;
+        BucketRow row;
+        row.startSec = numberField(line, "t");
+        row.endSec = numberField(line, "end");
+        row.requests = numberField(line, "requests");
+        row.errors = numberField(line, "errors");
+        rows.push_back(row);
+    }
+    if (rows.empty()) return steady;
+    if (intervalSec <= 0) intervalSec = rows.front().endSec - rows.front().startSec;
+
+    size_t end = rows.size();
+    if (end > 1 && rows[end - 1].endSec - rows[end - 1].startSec < 0.5 * intervalSec) end--;
+
+    auto rate = [&](size_t i) { return rows[i].requests / std::max(rows[i].endSec - rows[i].startSec, 1e-9); };
+    std::vector<double> tail;
+    for (size_t i = end / 2; i < end; i++) tail.push_back(rate(i));
+    std::nth_element(tail.begin(), tail.begin() + tail.size() / 2, tail.end());
+    double median = tail[tail.size() / 2];
+
+    size_t window = std::max<size_t>(1, static_cast<size_t>(std::lround(1.0 / std::max(intervalSec, 1e-3))));
+    size_t begin = end / 2;
+    for (size_t i = 0; i + window <= end; i++) {
+        double sum = 0;
+        for (size_t j = i; j < i + window; j++) sum += rate(j);
+        if (median <= 0 || std::fabs(sum / window - median) <= tolerance * median) {
+            begin = i;
+            break;
+        }
+    }
+
+    // Pass 2: merge histograms of the stable buckets only.
+    in.clear();
+    in.seekg(0);
+    size_t index = 0;
+    std::string hist;
+    HdrHistogram bucketLatency;
+    while (std::getline(in, line)) {
+        if (line.find("\"requests\":") == std::string::npos) continue;
+        size_t current = index++;
+        if (current < begin || current >= end) continue;
+        if (stringField(line, "hist", hist) && HdrHistogram::deserialize(hist, bucketLatency)) {
+            steady.latencyHistogram.merge(bucketLatency);
+        }
+    }
+
+    double requests = 0, errors = 0;
+    for (size_t i = begin; i < end; i++) {
+        requests += rows[i].requests;
+        errors += rows[i].errors;
+    }
+    steady.valid = true;
+    steady.startSec = rows[begin].startSec;
+    steady.endSec = rows[end - 1].endSec;
+    steady.buckets = static_cast<int>(end - begin);
+    steady.requestsPerSecond = requests / std::max(steady.endSec - steady.startSec, 1e-9);
+    steady.errors = static_cast<int>(errors);
+    const HdrHistogram& latency = steady.latencyHistogram;
+    steady.p50Latency = latency.valueAtPercentile(50) / 1000.0;
+    steady.p90Latency = latency.valueAtPercentile(90) / 1000.0;
+    steady.p99Latency = latency.valueAtPercentile(99) / 1000.0;
+    steady.p999Latency = latency.valueAtPercentile(99.9) / 1000.0;
+    steady.maxLatency = latency.max() / 1000.0;
+    return steady;
+}
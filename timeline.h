@@ -0,0 +1,31 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+#include "benchmark_types.h"
+#include "load_generator.h"
+
+// Streams a run's timeline to NDJSON as the run goes: one header line, then one
+// line per bucket with its counters, summary percentiles and serialized histogram:
+//
+//   {"type":"header","label":"Hono on Bun run 1","intervalMs":1000,"rate":0}
+//   {"t":0,"end":1,"requests":41234,"errors":0,"bytes":8123456,"rps":41234,
+//    "p50":0.21,"p90":0.35,"p99":1.2,"max":8.4,"hist":"HDR1,..."}
+class TimelineWriter {
+public:
+    TimelineWriter(const std::string& path, const std::string& label, int intervalMs, double rate);
+
+    bool ok() const { return static_cast<bool>(out); }
+    void write(const TimelineBucket& bucket);
+
+private:
+    std::ofstream out;
+};
+
+// Re-reads a timeline file and summarises its stable part. Warmup buckets are
+// trimmed from the front until a rolling one-second window reaches the median
+// rate of the second half of the run (within `tolerance`), and a trailing
+// partial bucket is dropped. Only the kept buckets' histograms are merged, so
+// memory stays at one histogram however long the run was.
+SteadyState analyzeTimeline(const std::string& path, double tolerance);
@@ -0,0 +1,67 @@
+#include "tls_cert.h"
+
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+namespace {
+
+struct PkeyFree {
+    void operator()(EVP_PKEY* key) const { EVP_PKEY_free(key); }
+};
+struct X509Free {
+    void operator()(X509* cert) const { X509_free(cert); }
+};
+
+void addExtension(X509* cert, int nid, const std::string& value) {
+    X509V3_CTX ctx;
+    X509V3_set_ctx_nodb(&ctx);
+    X509V3_set_ctx(&ctx, cert, cert, nullptr, nullptr, 0);
+    X509_EXTENSION* ext = X509V3_EXT_conf_nid(nullptr, &ctx, nid, value.c_str());
+    bool added = ext != nullptr && X509_add_ext(cert, ext, -1) == 1;
+    X509_EXTENSION_free(ext);
+    if (!added) throw std::runtime_error("Failed to add certificate extension " + value);
+}
+
+}  // namespace
+
+void writeSelfSignedCertificate(const std::string& certPath, const std::string& keyPath, const std::string& host) {
+    std::unique_ptr<EVP_PKEY, PkeyFree> key(EVP_EC_gen("P-256"));
+    std::unique_ptr<X509, X509Free> cert(X509_new());
+    if (!key || !cert) throw std::runtime_error("Failed to generate a TLS key pair");
+
+    X509_set_version(cert.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get()), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get()), 365L * 24 * 3600);
+    X509_set_pubkey(cert.get(), key.get());
+    X509_NAME* name = X509_get_subject_name(cert.get());
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>(host.c_str()), -1, -1, 0);
+    X509_set_issuer_name(cert.get(), name);
+    std::string altNames = "DNS:localhost,IP:127.0.0.1,IP:::1";
+    if (host != "localhost") altNames = "DNS:" + host + "," + altNames;
+    addExtension(cert.get(), NID_subject_alt_name, altNames);
+    addExtension(cert.get(), NID_basic_constraints, "critical,CA:FALSE");
+    if (X509_sign(cert.get(), key.get(), EVP_sha256()) == 0) {
+        throw std::runtime_error("Failed to sign the TLS certificate");
+    }
+
+    FILE* keyFile = std::fopen(keyPath.c_str(), "w");
+    if (keyFile == nullptr) throw std::runtime_error("Cannot write " + keyPath);
+    chmod(keyPath.c_str(), 0600);
+    bool keyWritten = PEM_write_PrivateKey(keyFile, key.get(), nullptr, nullptr, 0, nullptr, nullptr) == 1;
+    std::fclose(keyFile);
+
+    FILE* certFile = std::fopen(certPath.c_str(), "w");
+    if (certFile == nullptr) throw std::runtime_error("Cannot write " + certPath);
+    bool certWritten = PEM_write_X509(certFile, cert.get()) == 1;
+    std::fclose(certFile);
+    if (!keyWritten || !certWritten) throw std::runtime_error("Failed to write the TLS certificate as PEM");
+}
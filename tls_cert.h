@@ -0,0 +1,9 @@
+#pragma once
+
+#include <string>
+
+// Writes a self-signed ECDSA P-256 certificate and its private key as PEM, valid for
+// a year for `host` plus localhost/127.0.0.1/::1. The TLS transports use it when no
+// certificate is configured; the load generator does not verify it, so it only puts
+// the servers on the same footing, not the client. Throws std::runtime_error.
+void writeSelfSignedCertificate(const std::string& certPath, const std::string& keyPath, const std::string& host);
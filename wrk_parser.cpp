@@ -0,0 +1,210 @@
+#include "wrk_parser.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+void skipSpaces(std::string_view& s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+}
+
+bool consume(std::string_view& s, std::string_view prefix) {
+    if (s.substr(0, prefix.size()) != prefix) return false;
+    s.remove_prefix(prefix.size());
+    return true;
+}
+
+// Reads an unsigned decimal such as "12", "1.20" or "99.000"; false if none is present.
+bool readNumber(std::string_view& s, double& value) {
+    char digits[64];
+    size_t n = 0;
+    while (n < s.size() && n + 1 < sizeof(digits) && ((s[n] >= '0' && s[n] <= '9') || s[n] == '.')) {
+        digits[n] = s[n];
+        n++;
+    }
+    if (n == 0) return false;
+    digits[n] = '\0';
+    value = std::strtod(digits, nullptr);
+    s.remove_prefix(n);
+    return true;
+}
+
+bool readCount(std::string_view& s, int& value) {
+    double number = 0;
+    if (!readNumber(s, number)) return false;
+    value = static_cast<int>(number);
+    return true;
+}
+
+std::string_view readUnit(std::string_view& s) {
+    size_t n = 0;
+    while (n < s.size() && ((s[n] >= 'a' && s[n] <= 'z') || (s[n] >= 'A' && s[n] <= 'Z'))) n++;
+    std::string_view unit = s.substr(0, n);
+    s.remove_prefix(n);
+    return unit;
+}
+
+// wrk prints durations as us/ms/s/m/h; values are reported in milliseconds.
+bool readLatency(std::string_view& s, double& ms) {
+    skipSpaces(s);
+    double value = 0;
+    if (!readNumber(s, value)) return false;
+    std::string_view unit = readUnit(s);
+    if (unit == "us") ms = value / 1000.0;
+    else if (unit == "s") ms = value * 1000.0;
+    else if (unit == "m") ms = value * 60.0 * 1000.0;
+    else if (unit == "h") ms = value * 3600.0 * 1000.0;
+    else ms = value;
+    return true;
+}
+
+double toBytes(double value, std::string_view unit) {
+    if (unit == "KB") return value * 1024;
+    if (unit == "MB") return value * 1024 * 1024;
+    if (unit == "GB") return value * 1024 * 1024 * 1024;
+    if (unit == "TB") return value * 1024 * 1024 * 1024 * 1024;
+    return value;
+}
+
+}  // namespace
+
+BenchmarkResult parseWrkOutput(std::string_view output, bool keepRaw) {
+    BenchmarkResult result;
+    int non2xx = 0;
+
+    size_t pos = 0;
+    while (pos < output.size()) {
+        size_t end = output.find('\n', pos);
+        if (end == std::string_view::npos) end = output.size();
+        std::string_view line = output.substr(pos, end - pos);
+        pos = end + 1;
+
+        skipSpaces(line);
+        if (line.empty()) continue;
+
+        double value = 0;
+        if (consume(line, "Requests/sec:")) {
+            skipSpaces(line);
+            readNumber(line, result.requestsPerSecond);
+        } else if (consume(line, "Transfer/sec:")) {
+            skipSpaces(line);
+            if (readNumber(line, value)) result.throughput = toBytes(value, readUnit(line));
+        } else if (consume(line, "Latency")) {
+            // Thread stats row: avg, stdev, max, +/- stdev. "Latency Distribution" has no numbers.
+            double avg = 0, stdev = 0, max = 0;
+            if (readLatency(line, avg) && readLatency(line, stdev) && readLatency(line, max)) {
+                result.avgLatency = avg;
+                result.maxLatency = max;
+            }
+        } else if (consume(line, "Socket errors: connect ")) {
+            int connect = 0, read = 0, write = 0, timeout = 0;
+            if (readCount(line, connect) && consume(line, ", read ") && readCount(line, read) &&
+                consume(line, ", write ") && readCount(line, write) && consume(line, ", timeout ") &&
+                readCount(line, timeout)) {
+                result.socketErrors = connect + read + write;
+                result.timeouts = timeout;
+            }
+        } else if (consume(line, "Non-2xx or 3xx responses:")) {
+            skipSpaces(line);
+            readCount(line, non2xx);
+        } else if (readNumber(line, value)) {
+            if (consume(line, "%")) {
+                // "50%  1.10ms" (wrk) or "50.000%  1.10ms" (wrk2)
+                double latency = 0;
+                if (!readLatency(line, latency)) continue;
+                if (value == 50) result.p50Latency = latency;
+                else if (value == 75) result.p75Latency = latency;
+                else if (value == 90) result.p90Latency = latency;
+                else if (value == 99) result.p99Latency = latency;
+            } else if (consume(line, " requests in")) {
+                result.totalRequests = static_cast<int>(value);
+            }
+        }
+    }
+
+    result.errors = result.socketErrors + result.timeouts + non2xx;
+    if (keepRaw) result.rawOutput = std::string(output);
+    return result;
+}
+
+int parseWrkDirectory(const std::string& directory, const std::string& csvPath) {
+    namespace fs = std::filesystem;
+
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (entry.is_regular_file()) files.push_back(entry.path());
+    }
+    if (ec) {
+        std::cerr << "Cannot read directory " << directory << ": " << ec.message() << std::endl;
+        return 1;
+    }
+    std::sort(files.begin(), files.end());
+
+    std::ofstream csvFile(csvPath);
+    csvFile << "File,Requests/sec,Avg Latency,P50,P75,P90,P99,Max Latency,Throughput,Total Requests,Errors,Timeouts\n";
+
+    std::cout << std::left << std::setw(40) << "File"
+              << std::setw(12) << "Req/sec"
+              << std::setw(12) << "Avg(ms)"
+              << std::setw(12) << "P50(ms)"
+              << std::setw(12) << "P90(ms)"
+              << std::setw(12) << "P99(ms)"
+              << std::setw(12) << "Max(ms)"
+              << std::setw(12) << "Requests"
+              << "Errors" << std::endl;
+    std::cout << std::string(130, '-') << std::endl;
+
+    // One buffer reused for every file; parsing itself does not allocate.
+    std::string buffer;
+    int failures = 0;
+    int parsed = 0;
+    for (const auto& path : files) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::cerr << "Cannot open " << path.string() << std::endl;
+            failures++;
+            continue;
+        }
+        in.seekg(0, std::ios::end);
+        buffer.resize(static_cast<size_t>(std::max<std::streamoff>(in.tellg(), 0)));
+        in.seekg(0, std::ios::beg);
+        in.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+
+        BenchmarkResult result = parseWrkOutput(buffer, false);
+        if (result.totalRequests == 0 && result.requestsPerSecond == 0) continue;  // no wrk summary in this file
+        parsed++;
+        std::string name = path.filename().string();
+        std::cout << std::left << std::setw(40) << name
+                  << std::setw(12) << std::fixed << std::setprecision(2) << result.requestsPerSecond
+                  << std::setw(12) << result.avgLatency
+                  << std::setw(12) << result.p50Latency
+                  << std::setw(12) << result.p90Latency
+                  << std::setw(12) << result.p99Latency
+                  << std::setw(12) << result.maxLatency
+                  << std::setw(12) << result.totalRequests
+                  << result.errors << std::endl;
+        csvFile << name << ","
+                << result.requestsPerSecond << ","
+                << result.avgLatency << ","
+                << result.p50Latency << ","
+                << result.p75Latency << ","
+                << result.p90Latency << ","
+                << result.p99Latency << ","
+                << result.maxLatency << ","
+                << result.throughput << ","
+                << result.totalRequests << ","
+                << result.errors << ","
+                << result.timeouts << "\n";
+    }
+
+    std::cout << "\n" << parsed << " of " << files.size() << " file(s) contained wrk results; table saved to "
+              << csvPath << std::endl;
+    return failures;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "benchmark_types.h"
+
+// Single-pass parser for wrk/wrk2 text output. Scans the buffer once line by line
+// without building per-line strings or regexes; unknown lines (thread stats,
+// wrk2's detailed percentile spectrum, Lua done() dumps) are skipped. The raw
+// text is copied into rawOutput only when keepRaw is set.
+BenchmarkResult parseWrkOutput(std::string_view output, bool keepRaw = true);
+
+// Parses every regular file in `directory` as a saved wrk output, prints a results
+// table and writes it to `csvPath`. Returns the number of files that failed to read.
+int parseWrkDirectory(const std::string& directory, const std::string& csvPath);